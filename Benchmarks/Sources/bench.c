@@ -0,0 +1,424 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-3.0-or-later
+//
+//  Benchmarks for the SLCAN protocol stack (SerialCAN)
+//
+//  Copyright (c) 2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of SerialCAN.
+//
+//  SerialCAN is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v3.0 (or any later version). You can
+//  choose between one of them if you use SerialCAN in whole or in part.
+//
+//  (see LICENSE.BSD-2-Clause and LICENSE.GPL-3.0-or-later)
+//
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+#include "slcan.h"
+#include "queue.h"
+
+#include "CANAPI_Defines.h"
+#include "SerialCAN_Defines.h"
+#include "can_api.h"
+#include "can_msg.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <signal.h>
+#include <pthread.h>
+#include <inttypes.h>
+#include <sys/wait.h>
+
+#if defined(__linux__)
+#define PLATFORM  "Linux"
+#elif defined(__APPLE__)
+#define PLATFORM  "macOS"
+#else
+#error Platform not supported
+#endif
+
+#define RX_FRAMES      200000U          // frames for the reception benchmark
+#define RX_RATE        100000000U       // frames per second generated by the emulator (as fast as possible)
+#define QUEUE_MSGS     1000000U         // messages for the queue benchmarks
+#define QUEUE_SIZE     65536U           // queue size for the queue benchmarks
+#define QUEUE_THREADS  4U               // consumers for the N-consumer benchmark
+#define FORMAT_MSGS    200000U          // messages for the formatter
+#define E2E_FRAMES     10000U           // frames for the end-to-end benchmark (default)
+
+#define EMULATOR  "../Utilities/slcan_emu/slcan_emu"  // SLCAN device emulator (default)
+
+typedef struct {                        // queue benchmark:
+    queue_t queue;                      //   queue under test
+    volatile bool done;                 //   producer has finished
+    uint64_t count;                     //   dequeued messages (per consumer)
+}   consumer_t;
+
+typedef struct {                        // SLCAN device emulator:
+    pid_t pid;                          //   process id
+    char name[256];                     //   pty slave (for the host)
+}   device_t;
+
+static const char *emulator = EMULATOR;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+static int compare(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x < y) ? -1 : (x > y) ? 1 : 0;
+}
+
+static uint64_t percentile(const uint64_t *sorted, size_t n, double p) {
+    size_t index = (size_t)((p / 100.0) * (double)(n - 1U) + 0.5);
+    return sorted[(index < n) ? index : (n - 1U)];
+}
+
+static void make_message(slcan_message_t *message, uint32_t i) {
+    memset(message, 0, sizeof(slcan_message_t));
+    message->can_id = (i & 1U) ? ((i & 0x1FFFFFFFU) | CAN_XTD_FRAME) : (i & 0x7FFU);
+    message->can_dlc = (uint8_t)(i % 9U);
+    for (uint8_t j = 0U; j < message->can_dlc; j++)
+        message->data[j] = (uint8_t)(i >> j);
+}
+
+/*  ---  SLCAN device emulator (slcan_emu)  --- */
+static bool device_start(device_t *device, const char *const args[]) {
+    const char *argv[16];
+    size_t argc = 0U, length = 0U;
+    int fds[2];
+    char chr;
+
+    argv[argc++] = emulator;
+    while (args && *args && (argc < 15U))
+        argv[argc++] = *args++;
+    argv[argc] = NULL;
+    if (pipe(fds) < 0)
+        return false;
+    if ((device->pid = fork()) < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (device->pid == 0) {
+        // note: the emulator prints the name of the pty slave on stdout
+        int null = open("/dev/null", O_WRONLY);
+        (void)dup2(fds[1], STDOUT_FILENO);
+        if (null >= 0)
+            (void)dup2(null, STDERR_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        execv(emulator, (char * const *)argv);
+        _exit(127);
+    }
+    close(fds[1]);
+    while ((read(fds[0], &chr, 1) == 1) && (chr != '\n')) {
+        if (length < (sizeof(device->name) - 1U))
+            device->name[length++] = chr;
+    }
+    device->name[length] = '\0';
+    close(fds[0]);
+    if (!length) {
+        (void)waitpid(device->pid, NULL, 0);
+        errno = ENOENT;
+        return false;
+    }
+    return true;
+}
+
+static void device_stop(device_t *device) {
+    (void)kill(device->pid, SIGTERM);
+    (void)waitpid(device->pid, NULL, 0);
+}
+
+static int device_open(const device_t *device, uint8_t options, uint8_t policy) {
+    can_sio_param_t param;
+    can_bitrate_t bitrate;
+    int handle;
+
+    param.name = (char*)device->name;
+    param.attr.baudrate = CANSIO_BD115200;
+    param.attr.bytesize = CANSIO_8DATABITS;
+    param.attr.parity = CANSIO_NOPARITY;
+    param.attr.stopbits = CANSIO_1STOPBIT;
+    param.attr.options = CANSIO_SLCAN | options;
+    bitrate.index = CANBTR_INDEX_250K;
+    if ((handle = can_init(CANDEV_SERIAL, CANMODE_DEFAULT, &param)) < 0)
+        return handle;
+    if ((can_start(handle, &bitrate) != CANERR_NOERROR) ||
+        ((policy != SLCAN_WAIT_BLOCK) &&
+         (can_property(handle, CANPROP_SET_VENDOR_PROP + SLCAN_WAIT_POLICY, &policy, sizeof(uint8_t)) != CANERR_NOERROR))) {
+        (void)can_exit(handle);
+        return CANERR_FATAL;
+    }
+    return handle;
+}
+
+/*  ---  (1) reception (decoder and queue)  --- */
+static void bench_rx(FILE *fp, const char *name, uint8_t options) {
+    char rate[32], count[32];
+    const char *const args[] = { rate, count, "--profile=SWEEP", NULL };
+    can_message_t message;
+    device_t device;
+    uint64_t start = 0U, last = 0U, received = 0U;
+    int handle;
+
+    snprintf(rate, sizeof(rate), "--rate=%u", RX_RATE);
+    snprintf(count, sizeof(count), "--count=%u", RX_FRAMES);
+    if (!device_start(&device, args)) {
+        fprintf(fp, "  \"%s\": { \"error\": %i },\n", name, errno);
+        return;
+    }
+    // note: the emulator generates the frames when the channel is open
+    if ((handle = device_open(&device, options, SLCAN_WAIT_BLOCK)) < 0) {
+        fprintf(fp, "  \"%s\": { \"error\": %i },\n", name, handle);
+        device_stop(&device);
+        return;
+    }
+    while (can_read(handle, &message, 100U) == CANERR_NOERROR) {
+        last = now_ns();
+        if (!received++)
+            start = last;
+    }
+    (void)can_exit(handle);
+    device_stop(&device);
+
+    fprintf(fp, "  \"%s\": {\n", name);
+    fprintf(fp, "    \"transport\": \"pty\",\n");
+    fprintf(fp, "    \"frames\": %u,\n", RX_FRAMES);
+    fprintf(fp, "    \"received\": %" PRIu64 ",\n", received);
+    fprintf(fp, "    \"frames_per_sec\": %.0f,\n", (last > start) ? ((double)(received - 1U) * 1e9 / (double)(last - start)) : 0.0);
+    fprintf(fp, "    \"ns_per_frame\": %.1f\n", (received > 1U) ? ((double)(last - start) / (double)(received - 1U)) : 0.0);
+    fprintf(fp, "  },\n");
+}
+
+/*  ---  (2) message queue  --- */
+static void *consumer(void *arg) {
+    consumer_t *self = (consumer_t*)arg;
+    slcan_message_t message;
+
+    for (;;) {
+        if (queue_dequeue(self->queue, &message, sizeof(slcan_message_t), 10U) > 0)
+            self->count++;
+        else if (self->done)
+            break;
+    }
+    return NULL;
+}
+
+static double bench_queue_threads(unsigned consumers, uint64_t *received) {
+    consumer_t context[QUEUE_THREADS];
+    pthread_t threads[QUEUE_THREADS];
+    slcan_message_t message;
+    queue_t queue = queue_create(QUEUE_SIZE, sizeof(slcan_message_t));
+    uint64_t start;
+
+    if (!queue)
+        return 0.0;
+    for (unsigned i = 0U; i < consumers; i++) {
+        context[i].queue = queue;
+        context[i].done = false;
+        context[i].count = 0U;
+    }
+    start = now_ns();
+    for (unsigned i = 0U; i < consumers; i++)
+        (void)pthread_create(&threads[i], NULL, consumer, &context[i]);
+    for (uint32_t i = 0U; i < QUEUE_MSGS; i++) {
+        make_message(&message, i);
+        while (queue_enqueue(queue, &message, sizeof(slcan_message_t)) < 0)
+            (void)sched_yield();  // queue full
+    }
+    for (unsigned i = 0U; i < consumers; i++)
+        context[i].done = true;
+    *received = 0U;
+    for (unsigned i = 0U; i < consumers; i++) {
+        (void)pthread_join(threads[i], NULL);
+        *received += context[i].count;
+    }
+    uint64_t elapsed = now_ns() - start;
+    (void)queue_destroy(queue);
+    return (double)QUEUE_MSGS * 1e9 / (double)elapsed;
+}
+
+static void bench_queue(FILE *fp) {
+    slcan_message_t message;
+    queue_t queue = queue_create(QUEUE_SIZE, sizeof(slcan_message_t));
+    uint64_t start, t_enq = 0U, t_deq = 0U, received_1 = 0U, received_n = 0U;
+
+    if (!queue)
+        return;
+    // single thread: enqueue a batch, then dequeue it
+    for (uint32_t n = 0U; n < QUEUE_MSGS; n += QUEUE_SIZE) {
+        uint32_t batch = ((QUEUE_MSGS - n) < QUEUE_SIZE) ? (QUEUE_MSGS - n) : QUEUE_SIZE;
+        make_message(&message, n);
+        start = now_ns();
+        for (uint32_t i = 0U; i < batch; i++)
+            (void)queue_enqueue(queue, &message, sizeof(slcan_message_t));
+        t_enq += now_ns() - start;
+        start = now_ns();
+        for (uint32_t i = 0U; i < batch; i++)
+            (void)queue_dequeue(queue, &message, sizeof(slcan_message_t), 0U);
+        t_deq += now_ns() - start;
+    }
+    (void)queue_destroy(queue);
+    double rate_1 = bench_queue_threads(1U, &received_1);
+    double rate_n = bench_queue_threads(QUEUE_THREADS, &received_n);
+
+    fprintf(fp, "  \"queue\": {\n");
+    fprintf(fp, "    \"messages\": %u,\n", QUEUE_MSGS);
+    fprintf(fp, "    \"enqueue_ns_per_op\": %.1f,\n", (double)t_enq / QUEUE_MSGS);
+    fprintf(fp, "    \"dequeue_ns_per_op\": %.1f,\n", (double)t_deq / QUEUE_MSGS);
+    fprintf(fp, "    \"consumers_1\": { \"msgs_per_sec\": %.0f, \"received\": %" PRIu64 " },\n", rate_1, received_1);
+    fprintf(fp, "    \"consumers_%u\": { \"msgs_per_sec\": %.0f, \"received\": %" PRIu64 " }\n", QUEUE_THREADS, rate_n, received_n);
+    fprintf(fp, "  },\n");
+}
+
+/*  ---  (3) message formatter  --- */
+static void bench_format(FILE *fp) {
+    msg_message_t message;
+    uint64_t start, length = 0U;
+
+    memset(&message, 0, sizeof(msg_message_t));
+    message.id = 0x123U;
+    message.dlc = 8U;
+    for (uint8_t i = 0U; i < 8U; i++)
+        message.data[i] = (uint8_t)(0x41U + i);
+    (void)msg_set_fmt_time_stamp(MSG_FMT_TIMESTAMP_RELATIVE);
+    start = now_ns();
+    for (uint32_t i = 0U; i < FORMAT_MSGS; i++) {
+        message.timestamp.tv_nsec = (long)(i * 1000U) % 1000000000L;
+        length += strlen(msg_format_message(&message, MSG_RX_MESSAGE, (msg_counter_t)i, 0));
+    }
+    uint64_t elapsed = now_ns() - start;
+    /* reentrant variant with a formatter context and a caller-supplied buffer */
+    msg_formatter_t formatter;
+    char string[MSG_STRING_LENGTH];
+    msg_formatter_init(&formatter);
+    start = now_ns();
+    for (uint32_t i = 0U; i < FORMAT_MSGS; i++) {
+        message.timestamp.tv_nsec = (long)(i * 1000U) % 1000000000L;
+        length += (uint64_t)msg_format_message_r(&formatter, string, sizeof(string), &message, MSG_RX_MESSAGE, (msg_counter_t)i, 0);
+    }
+    uint64_t elapsed_r = now_ns() - start;
+
+    fprintf(fp, "  \"format\": {\n");
+    fprintf(fp, "    \"messages\": %u,\n", FORMAT_MSGS);
+    fprintf(fp, "    \"msg_format_message_ns\": %.1f,\n", (double)elapsed / FORMAT_MSGS);
+    fprintf(fp, "    \"msg_format_message_r_ns\": %.1f,\n", (double)elapsed_r / FORMAT_MSGS);
+    fprintf(fp, "    \"avg_length\": %.1f\n", (double)length / (2U * FORMAT_MSGS));
+    fprintf(fp, "  },\n");
+}
+
+/*  ---  (4) end-to-end with the emulator (loopback)  --- */
+static void bench_e2e(FILE *fp, uint32_t frames, const char *name, uint8_t options, uint8_t policy, bool last) {
+    const char *const args[] = { "--echo", NULL };
+    can_message_t message, received;
+    device_t device;
+    uint64_t *latency = NULL;
+    uint64_t start, t0, errors = 0U;
+    uint32_t n = 0U;
+    size_t count = 0U;
+    int handle = -1;
+
+    if (((latency = (uint64_t*)calloc(frames, sizeof(uint64_t))) == NULL) ||
+        !device_start(&device, args)) {
+        fprintf(fp, "  \"%s\": { \"error\": %i }%s\n", name, errno, last ? "" : ",");
+        free(latency);
+        return;
+    }
+    if ((handle = device_open(&device, options, policy)) < 0) {
+        fprintf(fp, "  \"%s\": { \"error\": %i }%s\n", name, handle, last ? "" : ",");
+        goto teardown;
+    }
+    memset(&message, 0, sizeof(can_message_t));
+    message.id = 0x100U;
+    message.dlc = 8U;
+    start = now_ns();
+    for (n = 0U; n < frames; n++) {
+        memcpy(message.data, &n, sizeof(n));
+        t0 = now_ns();
+        if ((can_write(handle, &message, 0U) != CANERR_NOERROR) ||
+            (can_read(handle, &received, 1000U) != CANERR_NOERROR) ||
+            (memcmp(received.data, message.data, sizeof(n)) != 0)) {
+            errors++;
+            continue;
+        }
+        latency[count++] = now_ns() - t0;
+    }
+    uint64_t elapsed = now_ns() - start;
+    if (!count)
+        latency[count++] = 0U;
+    qsort(latency, count, sizeof(uint64_t), compare);
+
+    fprintf(fp, "  \"%s\": {\n", name);
+    fprintf(fp, "    \"transport\": \"pty\",\n");
+    fprintf(fp, "    \"frames\": %u,\n", frames);
+    fprintf(fp, "    \"errors\": %" PRIu64 ",\n", errors);
+    fprintf(fp, "    \"frames_per_sec\": %.0f,\n", (double)frames * 1e9 / (double)elapsed);
+    fprintf(fp, "    \"roundtrip_ns\": { \"p50\": %" PRIu64 ", \"p90\": %" PRIu64 ", \"p99\": %" PRIu64
+                ", \"p99.9\": %" PRIu64 ", \"max\": %" PRIu64 " }\n",
+                percentile(latency, count, 50.0), percentile(latency, count, 90.0),
+                percentile(latency, count, 99.0), percentile(latency, count, 99.9),
+                latency[count - 1U]);
+    fprintf(fp, "  }%s\n", last ? "" : ",");
+teardown:
+    if (handle >= 0)
+        (void)can_exit(handle);
+    device_stop(&device);
+    free(latency);
+}
+
+int main(int argc, const char *argv[]) {
+    uint32_t frames = E2E_FRAMES;
+    FILE *fp = stdout;
+    int opt;
+
+    while ((opt = getopt(argc, (char * const *)argv, "n:e:o:h")) != -1) {
+        switch (opt) {
+        case 'n':
+            frames = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'e':
+            emulator = optarg;
+            break;
+        case 'o':
+            if ((fp = fopen(optarg, "w")) == NULL) {
+                perror("+++ error");
+                return 1;
+            }
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-n <frames>] [-e <emulator>] [-o <file>]\n", argv[0]);
+            return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (!frames)
+        frames = 1U;
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"library\": \"%s\",\n", can_version());
+    fprintf(fp, "  \"platform\": \"%s\",\n", PLATFORM);
+    fprintf(fp, "  \"timestamp\": %" PRIu64 ",\n", (uint64_t)time(NULL));
+    bench_rx(fp, "rx", 0x00U);
+    bench_rx(fp, "rx_lazy", CANSIO_LAZYDECODE);
+    bench_queue(fp);
+    bench_format(fp);
+    bench_e2e(fp, frames, "e2e", 0x00U, SLCAN_WAIT_BLOCK, false);
+    bench_e2e(fp, frames, "e2e_lazy", CANSIO_LAZYDECODE, SLCAN_WAIT_BLOCK, false);
+    bench_e2e(fp, frames, "e2e_spin", 0x00U, SLCAN_WAIT_SPIN, true);
+    fprintf(fp, "}\n");
+    if (fp != stdout)
+        fclose(fp);
+    return 0;
+}
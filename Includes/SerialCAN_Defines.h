@@ -0,0 +1,264 @@
+/*  SPDX-License-Identifier: BSD-2-Clause OR GPL-3.0-or-later */
+/*
+ *  CAN Interface API, Version 3 (for CAN-over-Serial-Line Interfaces)
+ *
+ *  Copyright (c) 2004-2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+ *  All rights reserved.
+ *
+ *  This file is part of SerialCAN.
+ *
+ *  SerialCAN is dual-licensed under the BSD 2-Clause "Simplified" License
+ *  and under the GNU General Public License v3.0 (or any later version). You can
+ *  choose between one of them if you use SerialCAN in whole or in part.
+ *
+ *  BSD 2-Clause "Simplified" License:
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  SerialCAN IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF SerialCAN, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  GNU General Public License v3.0 or later:
+ *  SerialCAN is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SerialCAN is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with SerialCAN.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/** @file        SerialCAN_Defines.h
+ *
+ *  @brief       CAN API V3 for generic CAN Interfaces - Definitions and Options
+ *
+ *  @author      $Author: quaoar $
+ *
+ *  @version     $Rev: 1312 $
+ *
+ *  @addtogroup  can_api
+ *  @{
+ */
+#ifndef CANAPI_SERIALCAN_H_INCLUDED
+#define CANAPI_SERIALCAN_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*  -----------  includes  ------------------------------------------------
+ */
+
+#include <stdint.h>                     /* C99 header for sized integer types */
+#include <stdbool.h>                    /* C99 header for boolean type */
+
+
+/*  -----------  options  ------------------------------------------------
+ */
+
+/** @name  Compiler Switches
+ *  @brief Options for conditional compilation.
+ *  @{ */
+/** @note  Set define OPTION_CAN_2_0_ONLY to a non-zero value to compile
+ *         with CAN 2.0 frame format only (e.g. in the build environment).
+ */
+#ifndef OPTION_DISABLED
+#define OPTION_DISABLED  0  /**< if a define is not defined, it is automatically set to 0 */
+#endif
+/** @} */
+
+/*  -----------  defines  ------------------------------------------------
+ */
+
+/** @name  CAN API Interfaces
+ *  @brief Serial line interfaces
+ *  @{ */
+#define CANSIO_BOARDS               0  /**< number of serial line interfaces */
+/** @} */
+
+/** @name  Protocol option flags
+ *  @brief SerialCAN protocol options
+ *  @{ */
+#define CANSIO_SLCAN             0x00U  /**< Lawicel SLCAN protocol */
+#define CANSIO_PROTOCOL          0x0FU  /**< bit mask for the protocol */
+#define CANSIO_LOWLATENCY        0x10U  /**< option: low-latency mode (if supported) */
+#define CANSIO_RTSCTS            0x20U  /**< option: RTS/CTS hardware flow control */
+#define CANSIO_LAZYDECODE        0x40U  /**< option: minimal reception thread, lazy decoding */
+ /** @} */
+
+ /** @name  Baud rate option
+  *  @brief Baud rate in bits per second
+  *  @note  CBAUDEX compatible (e.g. Linux)
+  *  @{ */
+#define CANSIO_BD57600          57600U  /**< 57.6 kBd */
+#define CANSIO_BD115200        115200U  /**< 115.2 kBd */
+#define CANSIO_BD230400        230400U  /**< 230.4 kBd */
+#define CANSIO_BD460800        460800U  /**< 460.8 kBd */
+#define CANSIO_BD500000        500000U  /**< 500.0 kBd */
+#define CANSIO_BD576000        576000U  /**< 576.0 kBd */
+#define CANSIO_BD921600        921600U  /**< 921.6 kBd */
+#define CANSIO_BD1000000      1000000U  /**< 1.000 MBd */
+#define CANSIO_BD1152000      1152000U  /**< 1.152 MBd */
+#define CANSIO_BD1500000      1500000U  /**< 1.500 MBd */
+#define CANSIO_BD2000000      2000000U  /**< 2.000 MBd */
+#define CANSIO_BD2500000      2500000U  /**< 2.500 MBd */
+#define CANSIO_BD3000000      3000000U  /**< 3.000 MBd */
+#define CANSIO_BD4000000      4000000U  /**< 4.000 MBd (termios2) */
+#define CANSIO_BD6000000      6000000U  /**< 6.000 MBd (termios2) */
+#define CANSIO_BD12000000    12000000U  /**< 12.00 MBd (termios2) */
+/** @} */                   
+
+/** @name  Data size option
+ *  @brief Number of data bits (5, 6, 7, 8)
+ *  @{ */
+#define CANSIO_5DATABITS            5U  /**< 5 bits per data byte */
+#define CANSIO_6DATABITS            6U  /**< 6 bits per data byte */
+#define CANSIO_7DATABITS            7U  /**< 7 bits per data byte */
+#define CANSIO_8DATABITS            8U  /**< 8 bits per data byte */
+/** @} */
+
+/** @name  Parity option
+ *  @brief Parity bit (None, Even, Odd)
+ *  @{ */
+#define CANSIO_NOPARITY             0U  /**< no parity */
+#define CANSIO_ODDPARITY            1U  /**< odd parity */
+#define CANSIO_EVENPARITY           2U  /**< even parity */
+/** @} */
+
+/** @name  Stop bit option
+ *  @brief Number of stop bits (1 or 2)
+ *  @{ */
+#define CANSIO_1STOPBIT             1U  /**< 1 stop bit */
+#define CANSIO_2STOPBITS            2U  /**< 2 stop bits */
+/** @} */
+
+/** @name  CAN API Property Value
+ *  @brief SLCAN parameter to be read or written
+ *  @{ */
+#define SLCAN_DEVICE_ID          0x00U  /**< device id number */
+#define SLCAN_SERIAL_NUMBER      0x01U  /**< device serial number */
+#define SLCAN_HARDWARE_VERSION   0x02U  /**< device hardware version */
+#define SLCAN_FIRMWARE_VERSION   0x03U  /**< device firmware version */
+#define SLCAN_CLOCK_FREQUENCY    0x05U  /**< CAN clock frequency (in [Hz]) */
+#define SLCAN_STATUS_POLLING     0x10U  /**< status polling interval (in [ms], 0 = off) */
+#define SLCAN_LOW_LATENCY        0x11U  /**< low-latency flag of the serial driver (0 or 1) */
+#define SLCAN_LATENCY_TIMER      0x12U  /**< latency timer of an USB-serial converter (in [ms]) */
+#define SLCAN_OUTPUT_QUEUE       0x13U  /**< bytes in the output queue of the serial port */
+#define SLCAN_LINE_COUNTERS      0x14U  /**< line error counters of the serial port (can_sio_counters_t) */
+#define SLCAN_WAIT_POLICY        0x15U  /**< wait policy of the reader (0 = block, 1 = spin, 2 = poll) */
+#define SLCAN_SPIN_TIME          0x16U  /**< max. spin time of the reader (in [us], wait policy 'spin') */
+#define SLCAN_OVERFLOW_POLICY    0x17U  /**< overflow policy of the receive queue (0 = drop newest, 1 = drop oldest, 2 = keep latest per ID) */
+#define SLCAN_QUEUE_COUNTERS     0x18U  /**< counters of the receive queue (can_queue_counters_t) */
+#define SLCAN_SPILL_FILE         0x19U  /**< spill file of the receive queue (can_spill_param_t) */
+// TODO: define more or all parameters
+// ...
+/** @} */
+
+/** @name  CAN API Library ID
+ *  @brief Library ID and dynamic library names
+ *  @{ */
+#define SLCAN_LIB_ID             900    /**< library ID (CAN/COP API V1 compatible) */
+#if defined(_WIN32) || defined (_WIN64)
+#define SLCAN_LIB_DRIVER        "(driverless)"
+#define SLCAN_LIB_WRAPPER       "u3canslc.dll"
+#elif defined(__linux__)
+#define SLCAN_LIB_DRIVER        "(driverless)"
+#define SLCAN_LIB_WRAPPER       "libuvcanslc.so"
+#elif defined(__APPLE__)
+#define SLCAN_LIB_DRIVER        "(driverless)"
+#define SLCAN_LIB_WRAPPER       "libUVCANSLC.dylib"
+#elif defined(__CYGWIN__)
+#define SLCAN_LIB_DRIVER        "(driverless)"
+#define SLCAN_LIB_WRAPPER       "libuvcanslc.so"
+#else
+#error Platform not supported
+#endif
+ /** @} */
+
+ /** @name  Miscellaneous
+  *  @brief More or less useful stuff
+  *  @{ */
+#define SLCAN_LIB_VENDOR        "(unknown)"
+#define SLCAN_LIB_WEBSITE       "http://info.cern.ch/hypertext/WWW/TheProject.html"
+#define SLCAN_LIB_HAZARD_NOTE   "If you connect your CAN device to a real CAN network when using this library,\n" \
+                                "you might damage your application."
+  /** @} */
+
+  /*  -----------  types  --------------------------------------------------
+ */
+
+/** @brief SerialCAN port attributes
+ */
+typedef struct can_sio_attr_t_ {        /* serial port attributes: */
+    uint32_t baudrate;                  /**<  baud rate (in [bps]) */
+    uint8_t  bytesize;                  /**<  number fo data bits (5, 6, 7, 8) */
+    uint8_t  parity;                    /**<  parity bit (None, Even, Odd) */
+    uint8_t  stopbits;                  /**<  number of stop bits (1 or 2) */
+    uint8_t  options;                   /**<  protocol options */
+} can_sio_attr_t;
+
+/** @brief SerialCAN port parameters
+ */
+typedef struct can_sio_param_t_ {       /* device parameters: */
+    char* name;                         /**< name of the serial port device */
+    can_sio_attr_t attr;                /**< serial communication attributes*/
+} can_sio_param_t;
+
+/** @brief SerialCAN line error counters (since the CAN channel was opened)
+ */
+typedef struct can_sio_counters_t_ {    /* line error counters: */
+    uint32_t overrun;                   /**<  hardware overruns (UART receive FIFO) */
+    uint32_t buf_overrun;               /**<  buffer overruns (driver receive buffer) */
+    uint32_t frame;                     /**<  framing errors */
+    uint32_t parity;                    /**<  parity errors */
+    uint32_t brk;                       /**<  break conditions */
+} can_sio_counters_t;
+
+/** @brief SerialCAN receive queue counters (since the CAN channel was started)
+ */
+typedef struct can_queue_counters_t_ {  /* receive queue counters: */
+    uint64_t enqueued;                  /**<  messages put into the queue */
+    uint64_t dequeued;                  /**<  messages read from the queue */
+    uint64_t dropped;                   /**<  received messages dropped (queue full) */
+    uint64_t overwritten;               /**<  oldest messages overwritten (queue full) */
+    uint64_t coalesced;                 /**<  queued messages replaced by a newer one with the same ID */
+    uint64_t spilled;                   /**<  messages written to the spill file */
+} can_queue_counters_t;
+
+/** @brief SerialCAN spill file of the receive queue
+ */
+typedef struct can_spill_param_t_ {     /* spill file parameters: */
+    char* name;                         /**< path name of the spill file (NULL = none) */
+    uint32_t size;                      /**< number of messages in the spill file (0 = none) */
+    uint32_t mark;                      /**< queued messages from which on messages are spilled (0 = queue full) */
+} can_spill_param_t;
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* CANAPI_SERIALCAN_H_INCLUDED */
+/** @}
+ */
+/*  ----------------------------------------------------------------------
+ *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
+ *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
+ *  E-Mail: uwe.vogt@uv-software.de, Homepage: https://www.uv-software.de/
+ */
@@ -133,6 +133,26 @@ extern "C" {
 #define CANFD_MAX_LEN               64  /**< max. payload length (CAN FD) */
 /** @} */
 
+/** @name  CAN FD Data Length Code
+ *  @brief Conversion between DLC and payload length (CAN 2.0: 0 .. 8)
+ *  @{ */
+#if (OPTION_CAN_2_0_ONLY == 0)
+#define CANFD_DLC2LEN(dlc)  (((dlc) <= 8U) ? (dlc) : \
+                             ((dlc) <= 12U) ? (((dlc) - 6U) * 4U) : \
+                             ((dlc) < 15U) ? (((dlc) - 11U) * 16U) : 64U)
+#define CANFD_LEN2DLC(len)  (((len) > 48U) ? 0xFU : \
+                             ((len) > 32U) ? 0xEU : \
+                             ((len) > 24U) ? 0xDU : \
+                             ((len) > 20U) ? 0xCU : \
+                             ((len) > 16U) ? 0xBU : \
+                             ((len) > 12U) ? 0xAU : \
+                             ((len) > 8U) ? 0x9U : (len))
+#else
+#define CANFD_DLC2LEN(dlc)  (((dlc) <= 8U) ? (dlc) : 8U)
+#define CANFD_LEN2DLC(len)  (((len) <= 8U) ? (len) : 8U)
+#endif
+/** @} */
+
 /** @name  CAN Acceptance Filter
  *  @brief CAN acceptance filter defaults to let all messages pass
  *  @note  Acceptance condition: (code ^ id) & mask == 0
@@ -97,6 +97,10 @@ extern "C" {
  *  @brief SerialCAN protocol options
  *  @{ */
 #define CANSIO_SLCAN             0x00U  /**< Lawicel SLCAN protocol */
+#define CANSIO_PROTOCOL          0x0FU  /**< bit mask for the protocol */
+#define CANSIO_LOWLATENCY        0x10U  /**< option: low-latency mode (if supported) */
+#define CANSIO_RTSCTS            0x20U  /**< option: RTS/CTS hardware flow control */
+#define CANSIO_LAZYDECODE        0x40U  /**< option: minimal reception thread, lazy decoding */
  /** @} */
 
  /** @name  Baud rate option
@@ -116,6 +120,9 @@ extern "C" {
 #define CANSIO_BD2000000      2000000U  /**< 2.000 MBd */
 #define CANSIO_BD2500000      2500000U  /**< 2.500 MBd */
 #define CANSIO_BD3000000      3000000U  /**< 3.000 MBd */
+#define CANSIO_BD4000000      4000000U  /**< 4.000 MBd (termios2) */
+#define CANSIO_BD6000000      6000000U  /**< 6.000 MBd (termios2) */
+#define CANSIO_BD12000000    12000000U  /**< 12.00 MBd (termios2) */
 /** @} */                   
 
 /** @name  Data size option
@@ -150,6 +157,16 @@ extern "C" {
 #define SLCAN_HARDWARE_VERSION   0x02U  /**< device hardware version */
 #define SLCAN_FIRMWARE_VERSION   0x03U  /**< device firmware version */
 #define SLCAN_CLOCK_FREQUENCY    0x05U  /**< CAN clock frequency (in [Hz]) */
+#define SLCAN_STATUS_POLLING     0x10U  /**< status polling interval (in [ms], 0 = off) */
+#define SLCAN_LOW_LATENCY        0x11U  /**< low-latency flag of the serial driver (0 or 1) */
+#define SLCAN_LATENCY_TIMER      0x12U  /**< latency timer of an USB-serial converter (in [ms]) */
+#define SLCAN_OUTPUT_QUEUE       0x13U  /**< bytes in the output queue of the serial port */
+#define SLCAN_LINE_COUNTERS      0x14U  /**< line error counters of the serial port (can_sio_counters_t) */
+#define SLCAN_WAIT_POLICY        0x15U  /**< wait policy of the reader (0 = block, 1 = spin, 2 = poll) */
+#define SLCAN_SPIN_TIME          0x16U  /**< max. spin time of the reader (in [us], wait policy 'spin') */
+#define SLCAN_OVERFLOW_POLICY    0x17U  /**< overflow policy of the receive queue (0 = drop newest, 1 = drop oldest, 2 = keep latest per ID) */
+#define SLCAN_QUEUE_COUNTERS     0x18U  /**< counters of the receive queue (can_queue_counters_t) */
+#define SLCAN_SPILL_FILE         0x19U  /**< spill file of the receive queue (can_spill_param_t) */
 // TODO: define more or all parameters
 // ...
 /** @} */
@@ -204,6 +221,35 @@ typedef struct can_sio_param_t_ {       /* device parameters: */
     can_sio_attr_t attr;                /**< serial communication attributes*/
 } can_sio_param_t;
 
+/** @brief SerialCAN line error counters (since the CAN channel was opened)
+ */
+typedef struct can_sio_counters_t_ {    /* line error counters: */
+    uint32_t overrun;                   /**<  hardware overruns (UART receive FIFO) */
+    uint32_t buf_overrun;               /**<  buffer overruns (driver receive buffer) */
+    uint32_t frame;                     /**<  framing errors */
+    uint32_t parity;                    /**<  parity errors */
+    uint32_t brk;                       /**<  break conditions */
+} can_sio_counters_t;
+
+/** @brief SerialCAN receive queue counters (since the CAN channel was started)
+ */
+typedef struct can_queue_counters_t_ {  /* receive queue counters: */
+    uint64_t enqueued;                  /**<  messages put into the queue */
+    uint64_t dequeued;                  /**<  messages read from the queue */
+    uint64_t dropped;                   /**<  received messages dropped (queue full) */
+    uint64_t overwritten;               /**<  oldest messages overwritten (queue full) */
+    uint64_t coalesced;                 /**<  queued messages replaced by a newer one with the same ID */
+    uint64_t spilled;                   /**<  messages written to the spill file */
+} can_queue_counters_t;
+
+/** @brief SerialCAN spill file of the receive queue
+ */
+typedef struct can_spill_param_t_ {     /* spill file parameters: */
+    char* name;                         /**< path name of the spill file (NULL = none) */
+    uint32_t size;                      /**< number of messages in the spill file (0 = none) */
+    uint32_t mark;                      /**< queued messages from which on messages are spilled (0 = queue full) */
+} can_spill_param_t;
+
 
 #ifdef __cplusplus
 }
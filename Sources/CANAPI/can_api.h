@@ -393,6 +393,72 @@ CANAPI int can_write(int handle, const can_message_t *message, uint16_t timeout)
 CANAPI int can_read(int handle, can_message_t *message, uint16_t timeout);
 
 
+/** @brief       transmits a message over the CAN bus and waits for its
+ *               transmission not longer than the given time in nanoseconds.
+ *
+ *  @param[in]   handle  - handle of the CAN interface
+ *  @param[in]   message - pointer to the message to send
+ *  @param[in]   timeout - time to wait for the transmission of a message:
+ *                              0 or UINT64_MAX means the default time-out,
+ *                              and any other value means the time to wait
+ *                              in nanoseconds
+ *
+ *  @returns     0 if successful, or a negative value on error (see can_write).
+ */
+CANAPI int can_write_ns(int handle, const can_message_t *message, uint64_t timeout);
+
+
+/** @brief       transmits a message over the CAN bus and waits for its
+ *               transmission not longer than until the given deadline.
+ *
+ *  @remarks     The deadline is an absolute time of the monotonic clock, i.e.
+ *               of CLOCK_MONOTONIC (on Windows: of QueryPerformanceCounter).
+ *
+ *  @param[in]   handle   - handle of the CAN interface
+ *  @param[in]   message  - pointer to the message to send
+ *  @param[in]   deadline - absolute time until to wait for the transmission,
+ *                          or NULL for the default time-out
+ *
+ *  @returns     0 if successful, or a negative value on error (see can_write).
+ */
+CANAPI int can_write_until(int handle, const can_message_t *message, const struct timespec *deadline);
+
+
+/** @brief       read one message from the message queue of the CAN interface, if
+ *               any message was received, and waits for it not longer than the
+ *               given time in nanoseconds.
+ *
+ *  @param[in]   handle  - handle of the CAN interface
+ *  @param[out]  message - pointer to a message buffer
+ *  @param[in]   timeout - time to wait for the reception of a message:
+ *                              0 means the function returns immediately,
+ *                              UINT64_MAX means blocking read, and any other
+ *                              value means the time to wait in nanoseconds
+ *
+ *  @returns     0 if successful, or a negative value on error (see can_read).
+ */
+CANAPI int can_read_ns(int handle, can_message_t *message, uint64_t timeout);
+
+
+/** @brief       read one message from the message queue of the CAN interface, if
+ *               any message was received, and waits for it not longer than until
+ *               the given deadline.
+ *
+ *  @remarks     The deadline is an absolute time of the monotonic clock, i.e.
+ *               of CLOCK_MONOTONIC (on Windows: of QueryPerformanceCounter).
+ *               A deadline that has already passed means polling.  Waiting
+ *               until the next cycle of a control loop this way does not drift.
+ *
+ *  @param[in]   handle   - handle of the CAN interface
+ *  @param[out]  message  - pointer to a message buffer
+ *  @param[in]   deadline - absolute time until to wait for the reception of
+ *                          a message, or NULL for a blocking read
+ *
+ *  @returns     0 if successful, or a negative value on error (see can_read).
+ */
+CANAPI int can_read_until(int handle, can_message_t *message, const struct timespec *deadline);
+
+
 /** @brief       retrieves the status register of the CAN interface.
  *
  *  @param[in]   handle  - handle of the CAN interface.
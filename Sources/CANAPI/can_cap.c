@@ -0,0 +1,703 @@
+/*  SPDX-License-Identifier: BSD-2-Clause OR GPL-3.0-or-later */
+/*
+ *  CAN Interface API, Version 3 (Capture File)
+ *
+ *  Copyright (c) 2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+ *  All rights reserved.
+ *
+ *  This file is part of CAN API V3.
+ *
+ *  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+ *  and under the GNU General Public License v3.0 (or any later version).
+ *  You can choose between one of them if you use this file.
+ *
+ *  BSD 2-Clause "Simplified" License:
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  GNU General Public License v3.0 or later:
+ *  CAN API V3 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  CAN API V3 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with CAN API V3.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/** @file        can_cap.c
+ *
+ *  @brief       CAN Capture File (binary recording with time and ID index)
+ *
+ *  @addtogroup  can_cap
+ *  @{
+ */
+
+
+/*  -----------  includes  -----------------------------------------------
+ */
+
+#ifdef _MSC_VER
+//no Microsoft extensions please!
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS 1
+#endif
+#else
+#define _FILE_OFFSET_BITS 64
+#endif
+#include "can_cap.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <assert.h>
+#include <time.h>
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/types.h>
+#endif
+
+/*  -----------  defines  ------------------------------------------------
+ */
+
+#define FILE_MAGIC    "UVCANCAP"        // file header
+#define INDEX_MAGIC   "UVCANIDX"        // index trailer
+#define BLOCK_MAGIC   0x4B4C4243U       // 'CBLK'
+#define BYTE_ORDER_MARK  0x01020304U    // written in host byte order
+#define FILE_VERSION  1U
+
+#define RECORD_MESSAGE  0U              // record type: CAN message
+#define RECORD_TIME     1U              // record type: absolute time (8 bytes)
+
+#define FLAG_XTD  0x01U                 // record flags:
+#define FLAG_RTR  0x02U
+#define FLAG_FDF  0x04U
+#define FLAG_BRS  0x08U
+#define FLAG_ESI  0x10U
+#define FLAG_STS  0x20U
+
+#define MAX_DELTA  0xFFFFFFFFULL        // max. time difference of two records (in [ns])
+#define ALIGN4(x)  (((x) + 3U) & ~3U)
+
+#define BLOOM_BIT(id)  (1ULL << (((uint32_t)(id) * 0x9E3779B1U) >> 26))
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#define FSEEK(fp,off,org)  fseeko(fp, (off_t)(off), org)
+#define FTELL(fp)  (int64_t)ftello(fp)
+#else
+#define FSEEK(fp,off,org)  _fseeki64(fp, (__int64)(off), org)
+#define FTELL(fp)  (int64_t)_ftelli64(fp)
+#endif
+
+
+/*  -----------  types  --------------------------------------------------
+ */
+
+typedef struct cap_header_t_ {          // file header (64 bytes):
+    char magic[8];                      //   "UVCANCAP"
+    uint16_t version;                   //   file format version
+    uint16_t header_size;               //   size of the file header
+    uint32_t block_size;                //   size of a data block
+    uint32_t byte_order;                //   byte order mark
+    uint32_t reserved;
+    uint64_t created;                   //   time of creation (in [ns] since the epoch)
+    uint8_t unused[32];
+} cap_header_t;
+
+typedef struct cap_block_t_ {           // block header (48 bytes):
+    uint32_t magic;                     //   'CBLK'
+    uint32_t count;                     //   number of messages
+    uint32_t used;                      //   used bytes (incl. block header)
+    uint32_t id_min;                    //   lowest identifier
+    uint32_t id_max;                    //   highest identifier
+    uint32_t reserved;
+    uint64_t first;                     //   time-stamp of the first message (in [ns])
+    uint64_t last;                      //   time-stamp of the last message (in [ns])
+    uint64_t bloom;                     //   bloom mask of the identifiers
+} cap_block_t;
+
+typedef struct cap_record_t_ {          // record header (12 bytes):
+    uint32_t delta;                     //   time since the previous record (in [ns])
+    uint32_t id;                        //   CAN identifier
+    uint8_t dlc;                        //   data length code
+    uint8_t length;                     //   payload length (padded to 4 bytes)
+    uint8_t flags;                      //   message flags
+    uint8_t type;                       //   record type
+} cap_record_t;
+
+typedef struct cap_entry_t_ {           // index entry (56 bytes):
+    uint64_t offset;                    //   file offset of the block
+    cap_block_t block;                  //   copy of the block header
+} cap_entry_t;
+
+typedef struct cap_trailer_t_ {         // index trailer (32 bytes):
+    char magic[8];                      //   "UVCANIDX"
+    uint64_t offset;                    //   file offset of the index
+    uint64_t entries;                   //   number of index entries
+    uint64_t reserved;
+} cap_trailer_t;
+
+typedef struct cap_file_t_ {            // capture file (writer or reader):
+    FILE *fp;                           //   file pointer
+    cap_header_t header;                //   file header
+    cap_entry_t *index;                 //   block index
+    uint64_t entries;                   //   number of index entries
+    uint64_t capacity;                  //   capacity of the index
+    uint8_t *block;                     //   current data block
+    uint64_t current;                   //   index of the current block (reader)
+    uint32_t pos;                       //   position in the current block
+    uint64_t time;                      //   time of the previous record (in [ns])
+    bool loaded;                        //   current block loaded (reader)
+    bool indexed;                       //   index read from file (reader)
+    uint32_t id_min;                    //   identifier filter (reader)
+    uint32_t id_max;
+} cap_file_t;
+
+
+/*  -----------  prototypes  ---------------------------------------------
+ */
+
+static int flush_block(cap_file_t *cap);
+static int append_entry(cap_file_t *cap, uint64_t offset, const cap_block_t *block);
+static int read_index(cap_file_t *cap);
+static int load_block(cap_file_t *cap, uint64_t current);
+static bool match_block(const cap_file_t *cap, const cap_block_t *block);
+static int next_record(cap_file_t *cap, can_message_t *message, uint64_t *time);
+static uint64_t ts2ns(const can_timestamp_t *timestamp);
+static void ns2ts(uint64_t time, can_timestamp_t *timestamp);
+static void free_file(cap_file_t *cap);
+
+
+/*  -----------  variables  ----------------------------------------------
+ */
+
+
+/*  -----------  functions  ----------------------------------------------
+ */
+
+cap_writer_t cap_create(const char *filename, uint32_t block_size) {
+    cap_file_t *cap = NULL;
+    struct timespec now;
+    cap_block_t *block;
+
+    errno = 0;
+    if (!filename) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!block_size)
+        block_size = CAP_BLOCK_SIZE;
+    if ((block_size < CAP_BLOCK_MIN) || (block_size > CAP_BLOCK_MAX) || (block_size & 3U)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if ((cap = (cap_file_t*)calloc(1, sizeof(cap_file_t))) == NULL)
+        return NULL;
+    if ((cap->block = (uint8_t*)calloc(1, block_size)) == NULL) {
+        free_file(cap);
+        return NULL;
+    }
+    if ((cap->fp = fopen(filename, "wb")) == NULL) {
+        free_file(cap);
+        return NULL;
+    }
+    /* note: whole data blocks are written, no stream buffering */
+    (void)setvbuf(cap->fp, NULL, _IONBF, 0);
+    /* write the file header */
+    memcpy(cap->header.magic, FILE_MAGIC, sizeof(cap->header.magic));
+    cap->header.version = FILE_VERSION;
+    cap->header.header_size = (uint16_t)sizeof(cap_header_t);
+    cap->header.block_size = block_size;
+    cap->header.byte_order = BYTE_ORDER_MARK;
+    (void)timespec_get(&now, TIME_UTC);
+    cap->header.created = ts2ns(&now);
+    if (fwrite(&cap->header, sizeof(cap_header_t), 1, cap->fp) != 1) {
+        free_file(cap);
+        return NULL;
+    }
+    /* start the first data block */
+    block = (cap_block_t*)cap->block;
+    block->magic = BLOCK_MAGIC;
+    block->used = (uint32_t)sizeof(cap_block_t);
+    block->id_min = UINT32_MAX;
+    return (cap_writer_t)cap;
+}
+
+int cap_write(cap_writer_t writer, const can_message_t *message) {
+    cap_file_t *cap = (cap_file_t*)writer;
+    cap_block_t *block;
+    cap_record_t record;
+    uint64_t time;
+    uint8_t length;
+    bool sync;
+
+    errno = 0;
+    if (!cap || !cap->fp || !cap->block) {
+        errno = ENODEV;
+        return -1;
+    }
+    if (!message) {
+        errno = EINVAL;
+        return -1;
+    }
+    block = (cap_block_t*)cap->block;
+    time = ts2ns(&message->timestamp);
+#if (OPTION_CAN_2_0_ONLY == 0)
+    if (message->fdf) {
+        length = CANFD_DLC2LEN(message->dlc & 0xFU);
+    } else
+#endif
+    length = (message->dlc < 8U) ? message->dlc : 8U;
+    if (message->rtr)
+        length = 0U;
+    /* a time record is needed for the first record, a gap or a step back */
+    sync = (block->count == 0U) || (time < cap->time) || ((time - cap->time) > MAX_DELTA);
+    /* start a new data block when the record does not fit */
+    if ((block->used + (sync ? (sizeof(cap_record_t) + 8U) : 0U) + sizeof(cap_record_t) + ALIGN4(length)) > cap->header.block_size) {
+        if (flush_block(cap) < 0)
+            return -1;
+        sync = true;
+    }
+    if (sync) {
+        /* note: the time record holds the absolute time-stamp */
+        memset(&record, 0, sizeof(cap_record_t));
+        record.length = 8U;
+        record.type = RECORD_TIME;
+        memcpy(&cap->block[block->used], &record, sizeof(cap_record_t));
+        memcpy(&cap->block[block->used + sizeof(cap_record_t)], &time, sizeof(uint64_t));
+        block->used += (uint32_t)(sizeof(cap_record_t) + 8U);
+        cap->time = time;
+    }
+    /* the message record with delta-encoded time-stamp */
+    memset(&record, 0, sizeof(cap_record_t));
+    record.delta = (uint32_t)(time - cap->time);
+    record.id = message->id;
+    record.dlc = message->dlc;
+    record.length = length;
+    record.flags = (message->xtd ? FLAG_XTD : 0U) | (message->rtr ? FLAG_RTR : 0U) | (message->sts ? FLAG_STS : 0U);
+#if (OPTION_CAN_2_0_ONLY == 0)
+    record.flags |= (message->fdf ? FLAG_FDF : 0U) | (message->brs ? FLAG_BRS : 0U) | (message->esi ? FLAG_ESI : 0U);
+#endif
+    record.type = RECORD_MESSAGE;
+    memcpy(&cap->block[block->used], &record, sizeof(cap_record_t));
+    memcpy(&cap->block[block->used + sizeof(cap_record_t)], message->data, length);
+    memset(&cap->block[block->used + sizeof(cap_record_t) + length], 0, ALIGN4(length) - length);
+    block->used += (uint32_t)(sizeof(cap_record_t) + ALIGN4(length));
+    /* update the block header */
+    if (block->count == 0U)
+        block->first = time;
+    block->last = time;
+    block->count++;
+    if (message->id < block->id_min) block->id_min = message->id;
+    if (message->id > block->id_max) block->id_max = message->id;
+    block->bloom |= BLOOM_BIT(message->id);
+    cap->time = time;
+    return 0;
+}
+
+int cap_finish(cap_writer_t writer) {
+    cap_file_t *cap = (cap_file_t*)writer;
+    cap_block_t *block;
+    cap_trailer_t trailer;
+    int res = 0;
+
+    errno = 0;
+    if (!cap || !cap->fp || !cap->block) {
+        errno = ENODEV;
+        return -1;
+    }
+    block = (cap_block_t*)cap->block;
+    /* write the pending data block (only the used bytes) */
+    if (block->count) {
+        if ((append_entry(cap, (uint64_t)FTELL(cap->fp), block) < 0) ||
+            (fwrite(cap->block, block->used, 1, cap->fp) != 1))
+            res = -1;
+    }
+    /* write the index and the trailer */
+    if (res == 0) {
+        memset(&trailer, 0, sizeof(cap_trailer_t));
+        memcpy(trailer.magic, INDEX_MAGIC, sizeof(trailer.magic));
+        trailer.offset = (uint64_t)FTELL(cap->fp);
+        trailer.entries = cap->entries;
+        if ((cap->entries && (fwrite(cap->index, sizeof(cap_entry_t), (size_t)cap->entries, cap->fp) != (size_t)cap->entries)) ||
+            (fwrite(&trailer, sizeof(cap_trailer_t), 1, cap->fp) != 1))
+            res = -1;
+    }
+    if (fclose(cap->fp) != 0)
+        res = -1;
+    cap->fp = NULL;
+    free_file(cap);
+    return res;
+}
+
+cap_reader_t cap_open(const char *filename) {
+    cap_file_t *cap = NULL;
+
+    errno = 0;
+    if (!filename) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if ((cap = (cap_file_t*)calloc(1, sizeof(cap_file_t))) == NULL)
+        return NULL;
+    if ((cap->fp = fopen(filename, "rb")) == NULL) {
+        free_file(cap);
+        return NULL;
+    }
+    /* read and check the file header */
+    if (fread(&cap->header, sizeof(cap_header_t), 1, cap->fp) != 1) {
+        free_file(cap);
+        errno = EBADMSG;
+        return NULL;
+    }
+    if (memcmp(cap->header.magic, FILE_MAGIC, sizeof(cap->header.magic)) ||
+        (cap->header.byte_order != BYTE_ORDER_MARK) ||
+        (cap->header.version != FILE_VERSION) ||
+        (cap->header.header_size < sizeof(cap_header_t)) ||
+        (cap->header.block_size < CAP_BLOCK_MIN) || (cap->header.block_size > CAP_BLOCK_MAX)) {
+        free_file(cap);
+        errno = EBADMSG;
+        return NULL;
+    }
+    if ((cap->block = (uint8_t*)malloc(cap->header.block_size)) == NULL) {
+        free_file(cap);
+        return NULL;
+    }
+    /* read the index, or rebuild it from the block headers */
+    if (read_index(cap) < 0) {
+        free_file(cap);
+        return NULL;
+    }
+    cap->id_min = 0U;
+    cap->id_max = CAP_ALL_IDS;
+    return (cap_reader_t)cap;
+}
+
+int cap_filter(cap_reader_t reader, uint32_t id_min, uint32_t id_max) {
+    cap_file_t *cap = (cap_file_t*)reader;
+
+    errno = 0;
+    if (!cap || !cap->fp) {
+        errno = ENODEV;
+        return -1;
+    }
+    if (id_min > id_max) {
+        errno = EINVAL;
+        return -1;
+    }
+    cap->id_min = id_min;
+    cap->id_max = id_max;
+    return 0;
+}
+
+int cap_seek(cap_reader_t reader, uint64_t time) {
+    cap_file_t *cap = (cap_file_t*)reader;
+    can_message_t message;
+    uint64_t lo = 0U, hi, mid, stamp;
+    uint32_t pos;
+    uint64_t prev;
+
+    errno = 0;
+    if (!cap || !cap->fp) {
+        errno = ENODEV;
+        return -1;
+    }
+    /* binary search: first block with a message at or after the time */
+    hi = cap->entries;
+    while (lo < hi) {
+        mid = lo + ((hi - lo) / 2U);
+        if (cap->index[mid].block.last < time)
+            lo = mid + 1U;
+        else
+            hi = mid;
+    }
+    cap->current = lo;
+    cap->loaded = false;
+    if ((lo >= cap->entries) || (time == CAP_TIME_BEGIN))
+        return 0;
+    if (load_block(cap, lo) < 0)
+        return -1;
+    /* skip the messages before the time within the block */
+    for (;;) {
+        pos = cap->pos;
+        prev = cap->time;
+        if (next_record(cap, &message, &stamp) < 0)
+            break;
+        if (stamp >= time) {
+            cap->pos = pos;
+            cap->time = prev;
+            break;
+        }
+    }
+    return 0;
+}
+
+int cap_read(cap_reader_t reader, can_message_t *message) {
+    cap_file_t *cap = (cap_file_t*)reader;
+    uint64_t time;
+
+    errno = 0;
+    if (!cap || !cap->fp) {
+        errno = ENODEV;
+        return -1;
+    }
+    if (!message) {
+        errno = EINVAL;
+        return -1;
+    }
+    for (;;) {
+        /* load the next matching block, if required */
+        while (!cap->loaded) {
+            if (cap->current >= cap->entries) {
+                errno = ENOMSG;
+                return -1;
+            }
+            if (!match_block(cap, &cap->index[cap->current].block)) {
+                cap->current++;
+                continue;
+            }
+            if (load_block(cap, cap->current) < 0)
+                return -1;
+        }
+        if (next_record(cap, message, &time) < 0) {
+            /* end of the block */
+            cap->loaded = false;
+            cap->current++;
+            continue;
+        }
+        if ((message->id >= cap->id_min) && (message->id <= cap->id_max))
+            return 0;
+    }
+}
+
+int cap_info(cap_reader_t reader, cap_info_t *info) {
+    cap_file_t *cap = (cap_file_t*)reader;
+
+    errno = 0;
+    if (!cap || !cap->fp) {
+        errno = ENODEV;
+        return -1;
+    }
+    if (!info) {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(info, 0, sizeof(cap_info_t));
+    for (uint64_t i = 0U; i < cap->entries; i++)
+        info->messages += cap->index[i].block.count;
+    info->blocks = cap->entries;
+    if (cap->entries) {
+        info->first = cap->index[0].block.first;
+        info->last = cap->index[cap->entries - 1U].block.last;
+    }
+    info->block_size = cap->header.block_size;
+    info->indexed = cap->indexed;
+    return 0;
+}
+
+int cap_close(cap_reader_t reader) {
+    cap_file_t *cap = (cap_file_t*)reader;
+
+    errno = 0;
+    if (!cap || !cap->fp) {
+        errno = ENODEV;
+        return -1;
+    }
+    free_file(cap);
+    return 0;
+}
+
+/*  -----------  local functions  ----------------------------------------
+ */
+
+static int flush_block(cap_file_t *cap) {
+    cap_block_t *block = (cap_block_t*)cap->block;
+    uint64_t offset = (uint64_t)FTELL(cap->fp);
+
+    /* write the whole data block (the unused rest is zeroed) */
+    memset(&cap->block[block->used], 0, cap->header.block_size - block->used);
+    if (append_entry(cap, offset, block) < 0)
+        return -1;
+    if (fwrite(cap->block, cap->header.block_size, 1, cap->fp) != 1)
+        return -1;
+    /* start a new data block */
+    memset(cap->block, 0, sizeof(cap_block_t));
+    block->magic = BLOCK_MAGIC;
+    block->used = (uint32_t)sizeof(cap_block_t);
+    block->id_min = UINT32_MAX;
+    return 0;
+}
+
+static int append_entry(cap_file_t *cap, uint64_t offset, const cap_block_t *block) {
+    cap_entry_t *index;
+
+    if (cap->entries >= cap->capacity) {
+        uint64_t capacity = cap->capacity ? (cap->capacity * 2U) : 1024U;
+        if ((index = (cap_entry_t*)realloc(cap->index, (size_t)capacity * sizeof(cap_entry_t))) == NULL)
+            return -1;
+        cap->index = index;
+        cap->capacity = capacity;
+    }
+    cap->index[cap->entries].offset = offset;
+    memcpy(&cap->index[cap->entries].block, block, sizeof(cap_block_t));
+    cap->entries++;
+    return 0;
+}
+
+static int read_index(cap_file_t *cap) {
+    cap_trailer_t trailer;
+    cap_block_t block;
+    int64_t size, offset;
+
+    if ((FSEEK(cap->fp, 0, SEEK_END) != 0) || ((size = FTELL(cap->fp)) < 0))
+        return -1;
+    /* (1) index written by the writer */
+    if ((size >= (int64_t)(sizeof(cap_header_t) + sizeof(cap_trailer_t))) &&
+        (FSEEK(cap->fp, size - (int64_t)sizeof(cap_trailer_t), SEEK_SET) == 0) &&
+        (fread(&trailer, sizeof(cap_trailer_t), 1, cap->fp) == 1) &&
+        !memcmp(trailer.magic, INDEX_MAGIC, sizeof(trailer.magic)) &&
+        ((trailer.offset + (trailer.entries * sizeof(cap_entry_t)) + sizeof(cap_trailer_t)) == (uint64_t)size)) {
+        cap->capacity = cap->entries = trailer.entries;
+        if (trailer.entries) {
+            if ((cap->index = (cap_entry_t*)malloc((size_t)trailer.entries * sizeof(cap_entry_t))) == NULL)
+                return -1;
+            if ((FSEEK(cap->fp, trailer.offset, SEEK_SET) != 0) ||
+                (fread(cap->index, sizeof(cap_entry_t), (size_t)trailer.entries, cap->fp) != (size_t)trailer.entries)) {
+                errno = EBADMSG;
+                return -1;
+            }
+        }
+        cap->indexed = true;
+        return 0;
+    }
+    /* (2) rebuild the index from the block headers (fixed offsets) */
+    cap->entries = 0U;
+    for (offset = (int64_t)cap->header.header_size;
+         (offset + (int64_t)sizeof(cap_block_t)) <= size;
+         offset += (int64_t)cap->header.block_size) {
+        if ((FSEEK(cap->fp, offset, SEEK_SET) != 0) ||
+            (fread(&block, sizeof(cap_block_t), 1, cap->fp) != 1))
+            break;
+        if ((block.magic != BLOCK_MAGIC) || !block.count ||
+            (block.used > cap->header.block_size) || ((offset + (int64_t)block.used) > size))
+            break;
+        if (append_entry(cap, (uint64_t)offset, &block) < 0)
+            return -1;
+    }
+    cap->indexed = false;
+    return 0;
+}
+
+static int load_block(cap_file_t *cap, uint64_t current) {
+    const cap_entry_t *entry = &cap->index[current];
+
+    if ((FSEEK(cap->fp, entry->offset, SEEK_SET) != 0) ||
+        (fread(cap->block, entry->block.used, 1, cap->fp) != 1)) {
+        errno = EIO;
+        return -1;
+    }
+    cap->current = current;
+    cap->pos = (uint32_t)sizeof(cap_block_t);
+    cap->time = entry->block.first;
+    cap->loaded = true;
+    return 0;
+}
+
+static bool match_block(const cap_file_t *cap, const cap_block_t *block) {
+    uint64_t bloom = 0U;
+
+    /* (1) identifier range of the block */
+    if ((cap->id_min > block->id_max) || (cap->id_max < block->id_min))
+        return false;
+    /* (2) bloom mask for small identifier ranges */
+    if ((cap->id_max - cap->id_min) < 64U) {
+        for (uint32_t id = cap->id_min; id <= cap->id_max; id++)
+            bloom |= BLOOM_BIT(id);
+        return (block->bloom & bloom) ? true : false;
+    }
+    return true;
+}
+
+static int next_record(cap_file_t *cap, can_message_t *message, uint64_t *time) {
+    const cap_block_t *block = &cap->index[cap->current].block;
+    cap_record_t record;
+
+    while ((cap->pos + sizeof(cap_record_t)) <= block->used) {
+        memcpy(&record, &cap->block[cap->pos], sizeof(cap_record_t));
+        if ((cap->pos + sizeof(cap_record_t) + ALIGN4(record.length)) > block->used)
+            break;  // corrupted
+        if (record.type == RECORD_TIME) {
+            memcpy(&cap->time, &cap->block[cap->pos + sizeof(cap_record_t)], sizeof(uint64_t));
+            cap->pos += (uint32_t)(sizeof(cap_record_t) + ALIGN4(record.length));
+            continue;
+        }
+        cap->time += record.delta;
+        memset(message, 0, sizeof(can_message_t));
+        message->id = record.id;
+        message->dlc = record.dlc;
+        message->xtd = (record.flags & FLAG_XTD) ? 1 : 0;
+        message->rtr = (record.flags & FLAG_RTR) ? 1 : 0;
+        message->sts = (record.flags & FLAG_STS) ? 1 : 0;
+#if (OPTION_CAN_2_0_ONLY == 0)
+        message->fdf = (record.flags & FLAG_FDF) ? 1 : 0;
+        message->brs = (record.flags & FLAG_BRS) ? 1 : 0;
+        message->esi = (record.flags & FLAG_ESI) ? 1 : 0;
+#endif
+        memcpy(message->data, &cap->block[cap->pos + sizeof(cap_record_t)],
+               (record.length < sizeof(message->data)) ? record.length : sizeof(message->data));
+        ns2ts(cap->time, &message->timestamp);
+        cap->pos += (uint32_t)(sizeof(cap_record_t) + ALIGN4(record.length));
+        *time = cap->time;
+        return 0;
+    }
+    errno = ENOMSG;
+    return -1;
+}
+
+static uint64_t ts2ns(const can_timestamp_t *timestamp) {
+    return ((uint64_t)timestamp->tv_sec * 1000000000ULL) + (uint64_t)timestamp->tv_nsec;
+}
+
+static void ns2ts(uint64_t time, can_timestamp_t *timestamp) {
+    timestamp->tv_sec = (time_t)(time / 1000000000ULL);
+    timestamp->tv_nsec = (long)(time % 1000000000ULL);
+}
+
+static void free_file(cap_file_t *cap) {
+    if (cap) {
+        if (cap->fp)
+            (void)fclose(cap->fp);
+        free(cap->index);
+        free(cap->block);
+        free(cap);
+    }
+}
+
+/** @}
+ */
+/*  ----------------------------------------------------------------------
+ *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
+ *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
+ *  E-Mail: uwe.vogt@uv-software.de,  Homepage: http://www.uv-software.de/
+ */
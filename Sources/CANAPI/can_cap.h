@@ -0,0 +1,234 @@
+/*  SPDX-License-Identifier: BSD-2-Clause OR GPL-3.0-or-later */
+/*
+ *  CAN Interface API, Version 3 (Capture File)
+ *
+ *  Copyright (c) 2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+ *  All rights reserved.
+ *
+ *  This file is part of CAN API V3.
+ *
+ *  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+ *  and under the GNU General Public License v3.0 (or any later version).
+ *  You can choose between one of them if you use this file.
+ *
+ *  BSD 2-Clause "Simplified" License:
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  GNU General Public License v3.0 or later:
+ *  CAN API V3 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  CAN API V3 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with CAN API V3.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/** @file        can_cap.h
+ *
+ *  @brief       CAN Capture File (binary recording with time and ID index)
+ *
+ *  @remarks     File layout (all fields in host byte order, marked in the header):
+ *               - a file header (64 bytes), followed by
+ *               - data blocks of fixed size (default 64 KiB), each with a block
+ *                 header (first and last time-stamp, ID range and an ID bloom
+ *                 mask) followed by records with delta-encoded time-stamps
+ *                 (12 bytes + payload, padded to 4 bytes), and
+ *               - an index of all block headers and a trailer, written when
+ *                 the file is closed.
+ *
+ *  @remarks     The writer appends whole blocks only. When the index is missing
+ *               (e.g. the capture was not closed properly) the reader rebuilds
+ *               it from the block headers, which are at fixed file offsets.
+ *
+ *  @defgroup    can_cap CAN Capture File
+ *  @{
+ */
+#ifndef CAN_CAP_H_INCLUDED
+#define CAN_CAP_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*  -----------  includes  -----------------------------------------------
+ */
+
+#include "CANAPI_Types.h"               //   CAN API V3 message type
+
+#include <stdint.h>                     //   C99 header for sized integer types
+#include <stdbool.h>                    //   C99 header for boolean type
+
+
+/*  -----------  defines  ------------------------------------------------
+ */
+
+/** @name  Capture File
+ *  @brief Capture file defaults and limits
+ *  @{ */
+#define CAP_BLOCK_SIZE          65536U  /**< default size of a data block */
+#define CAP_BLOCK_MIN            4096U  /**< min. size of a data block */
+#define CAP_BLOCK_MAX        16777216U  /**< max. size of a data block */
+#define CAP_TIME_BEGIN              0U  /**< seek to the beginning */
+#define CAP_ALL_IDS       0x1FFFFFFFU   /**< no filter (highest 29-bit identifier) */
+/** @} */
+
+
+/*  -----------  types  --------------------------------------------------
+ */
+
+typedef void *cap_writer_t;             /**< capture writer (opaque data type) */
+typedef void *cap_reader_t;             /**< capture reader (opaque data type) */
+
+/** @brief  Capture file information
+ */
+typedef struct cap_info_t_ {            /* capture file information: */
+    uint64_t messages;                  /**< number of messages */
+    uint64_t blocks;                    /**< number of data blocks */
+    uint64_t first;                     /**< time-stamp of the first message (in [ns]) */
+    uint64_t last;                      /**< time-stamp of the last message (in [ns]) */
+    uint32_t block_size;                /**< size of a data block */
+    bool indexed;                       /**< index read from file (or rebuilt) */
+} cap_info_t;
+
+
+/*  -----------  prototypes  ---------------------------------------------
+ */
+
+/** @brief       creates a capture file for writing.
+ *
+ *  @param[in]   filename    - name of the capture file
+ *  @param[in]   block_size  - size of a data block (0 = default)
+ *
+ *  @returns     a pointer to a capture writer if successful, or NULL on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ */
+cap_writer_t cap_create(const char *filename, uint32_t block_size);
+
+/** @brief       appends a CAN message to the capture file.
+ *
+ *  @remarks     Messages are collected in a data block, which is written to
+ *               the file when it is full.
+ *
+ *  @param[in]   writer   - pointer to a capture writer
+ *  @param[in]   message  - the message to be recorded (with time-stamp)
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ */
+int cap_write(cap_writer_t writer, const can_message_t *message);
+
+/** @brief       writes the pending data block, the index and the trailer and
+ *               closes the capture file.
+ *
+ *  @param[in]   writer  - pointer to a capture writer
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ */
+int cap_finish(cap_writer_t writer);
+
+/** @brief       opens a capture file for reading.
+ *
+ *  @param[in]   filename  - name of the capture file
+ *
+ *  @returns     a pointer to a capture reader if successful, or NULL on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ */
+cap_reader_t cap_open(const char *filename);
+
+/** @brief       sets an identifier filter (range) for reading.
+ *
+ *  @remarks     Data blocks without an identifier in the range are skipped
+ *               by their block header (ID range and bloom mask).
+ *
+ *  @param[in]   reader  - pointer to a capture reader
+ *  @param[in]   id_min  - lowest identifier (11-bit or 29-bit)
+ *  @param[in]   id_max  - highest identifier (11-bit or 29-bit)
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ */
+int cap_filter(cap_reader_t reader, uint32_t id_min, uint32_t id_max);
+
+/** @brief       positions the reader at the first message at or after the
+ *               given time (binary search in the block index).
+ *
+ *  @param[in]   reader  - pointer to a capture reader
+ *  @param[in]   time    - time-stamp (in [ns] since the epoch), or 0
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ */
+int cap_seek(cap_reader_t reader, uint64_t time);
+
+/** @brief       reads the next message from the capture file (matching the
+ *               identifier filter, if any).
+ *
+ *  @param[in]   reader   - pointer to a capture reader
+ *  @param[out]  message  - the message read (with time-stamp)
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      ENOMSG  - no more messages (end of the capture)
+ */
+int cap_read(cap_reader_t reader, can_message_t *message);
+
+/** @brief       retrieves information about the capture file.
+ *
+ *  @param[in]   reader  - pointer to a capture reader
+ *  @param[out]  info    - capture file information
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ */
+int cap_info(cap_reader_t reader, cap_info_t *info);
+
+/** @brief       closes the capture file.
+ *
+ *  @param[in]   reader  - pointer to a capture reader
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ */
+int cap_close(cap_reader_t reader);
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* CAN_CAP_H_INCLUDED */
+/** @}
+ */
+/*  ----------------------------------------------------------------------
+ *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
+ *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
+ *  E-Mail: uwe.vogt@uv-software.de,  Homepage: http://www.uv-software.de/
+ */
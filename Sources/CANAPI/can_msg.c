@@ -89,60 +89,48 @@
  */
 
 #ifndef DLC2LEN
-#define DLC2LEN(x)  dlc_table[((x) < 16U) ? (x) : 15U]
+#define DLC2LEN(x)  CANFD_DLC2LEN(x)
 #endif
 #ifndef LEN2DLC
-#define LEN2DLC(x)  ((x) > 48U) ? 0xFU : \
-                    ((x) > 32U) ? 0xEU : \
-                    ((x) > 24U) ? 0xDU : \
-                    ((x) > 20U) ? 0xCU : \
-                    ((x) > 16U) ? 0xBU : \
-                    ((x) > 12U) ? 0xAU : \
-                    ((x) > 8U) ?  0x9U : (x)
+#define LEN2DLC(x)  CANFD_LEN2DLC(x)
 #endif
 
 
 /*  -----------  types  --------------------------------------------------
  */
 
+typedef struct msg_buffer_t_ {          /* output buffer: */
+    char *string;                       /*   caller-supplied buffer */
+    size_t size;                        /*   size of the buffer */
+    size_t length;                      /*   length of the output (can exceed the size) */
+} msg_buffer_t;
+
 
 /*  -----------  prototypes  ---------------------------------------------
  */
 
-static void format_time(char *string, const msg_message_t *message);
-static void format_id(char *string, const msg_message_t *message);
-static void format_dlc(char *string, const msg_message_t *message);
-static void format_data(char *string, const msg_message_t *message, int ascii, int indent);
-static void format_ascii(char *string, const msg_message_t *message);
-static void format_data_byte(char *string, unsigned char data);
-static void format_data_ascii(char *string, unsigned char data);
-static void format_fill_byte(char *string);
+static void format_time(msg_formatter_t *formatter, msg_buffer_t *out, const msg_message_t *message);
+static void format_id(const msg_formatter_t *formatter, msg_buffer_t *out, const msg_message_t *message);
+static void format_flags(const msg_formatter_t *formatter, msg_buffer_t *out, const msg_message_t *message);
+static void format_dlc(const msg_formatter_t *formatter, msg_buffer_t *out, const msg_message_t *message);
+static void format_data(const msg_formatter_t *formatter, msg_buffer_t *out, const msg_message_t *message, int ascii, size_t indent);
+static void format_ascii(const msg_formatter_t *formatter, msg_buffer_t *out, const msg_message_t *message);
+static void format_data_byte(const msg_formatter_t *formatter, msg_buffer_t *out, unsigned char data);
+static void format_data_ascii(const msg_formatter_t *formatter, msg_buffer_t *out, unsigned char data);
+static void format_fill_byte(const msg_formatter_t *formatter, msg_buffer_t *out);
+static void format_separator(const msg_formatter_t *formatter, msg_buffer_t *out, const char *spaces);
+static void put_char(msg_buffer_t *out, char c);
+static void put_string(msg_buffer_t *out, const char *string);
+static void put_number(msg_buffer_t *out, uint64_t value, unsigned base, int width, char pad);
+static void put_signed(msg_buffer_t *out, int64_t value, int width, char pad);
+static void put_end(msg_buffer_t *out);
 
 
 /*  -----------  variables  ----------------------------------------------
  */
 
-static struct {                         /* format option: */
-    msg_fmt_timestamp_t  time_stamp;    /*   time-stamp {ZERO, ABS, REL} */
-    msg_fmt_option_t     time_usec;     /*   time-stamp in usec {OFF, ON} */
-    msg_fmt_time_t       time_format;   /*   time format {TIME, SEC, DJD} */
-    msg_fmt_number_t     id;            /*   identifier {HEX, DEC, OCT, BIN} */
-    msg_fmt_option_t     id_xtd;        /*   extended identifier {OFF, ON} */
-    msg_fmt_number_t     dlc;           /*   DLC/length {HEX, DEC, OCT, BIN} */
-    msg_fmt_canfd_t      dlc_format;    /*   CAN FD format {DLC, LENGTH} */
-    int                  dlc_brackets;  /*   DLC in brackets {'\0', '(', '['} */
-    msg_fmt_option_t     flags;         /*   message flags {ON, OFF} */
-    msg_fmt_number_t     data;          /*   message data {HEX, DEC, OCT, BIN} */
-    msg_fmt_option_t     ascii;         /*   data as ASCII {ON, OFF} */
-    int                  ascii_subst;   /*   substitute for non-printables */
-    msg_fmt_option_t     channel;       /*   message source {OFF, ON} */
-    msg_fmt_option_t     counter;       /*   message counter {ON, OFF} */
-    msg_fmt_separator_t  separator;     /*   separator {SPACES, TABS} */
-    msg_fmt_wraparound_t wraparound;    /*   wraparound {NO, 8, 16, 32, 64} */
-    msg_fmt_option_t     end_of_line;   /*   end-of-line character {ON, OFF} */
-    char                 rx_prompt[6+1];/*   prompt for received messages */
-    char                 tx_prompt[6+1];/*   prompt for sent messages */
-}   msg_option = {
+static msg_formatter_t msg_default = {  /* global formatter (legacy API) */
+    .option = {
                         .time_stamp = MSG_FMT_TIMESTAMP_ZERO,
                         .time_usec = MSG_FMT_OPTION_OFF,
                         .time_format = MSG_FMT_TIME_SEC,
@@ -162,189 +150,193 @@ static struct {                         /* format option: */
                         .end_of_line = MSG_FMT_OPTION_OFF,
                         .rx_prompt = "",
                         .tx_prompt = ""
+    },
+    .reference = { 0, 0 },
+    .local = { (time_t)-1, "" }
 };
 static msg_format_t msg_format = MSG_FORMAT_DEFAULT;
 static char msg_string[MSG_STRING_LENGTH] = "";
-static const unsigned char dlc_table[16] = {
-    0U,1U,2U,3U,4U,5U,6U,7U,8U,12U,16U,20U,24U,32U,48U,64U
+static const char hex_digits[16] = {
+    '0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'
+};
+static const char dec_pairs[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
 };
 
 
 /*  -----------  functions  ----------------------------------------------
  */
 
+void msg_formatter_init(msg_formatter_t *formatter)
+{
+    if (formatter) {
+        memset(formatter, 0, sizeof(msg_formatter_t));
+        memcpy(&formatter->option, &msg_default.option, sizeof(msg_fmt_options_t));
+        formatter->local.seconds = (time_t)-1;
+    }
+}
+
+int msg_format_message_r(msg_formatter_t *formatter, char *buffer, size_t size,
+                         const msg_message_t *message, msg_direction_t direction,
+                         msg_counter_t counter, msg_channel_t channel)
+{
+    msg_buffer_t out = { buffer, size, 0U };
+    const msg_fmt_options_t *option;
+
+    if (!buffer || !size || !message)
+        return -1;
+    if (!formatter)
+        formatter = &msg_default;
+    option = &formatter->option;
+
+    /* prompt (optional) */
+    if (option->tx_prompt[0] && (direction == MSG_TX_MESSAGE)) {
+        put_string(&out, option->tx_prompt);
+        format_separator(formatter, &out, " ");
+    }
+    else if (option->rx_prompt[0]) { /* defaults to MSG_DIRECTION_RX_MSG */
+        put_string(&out, option->rx_prompt);
+        format_separator(formatter, &out, " ");
+    }
+    /* counter (optional) */
+    if ((option->counter != MSG_FMT_OPTION_OFF) && ((option->separator == MSG_FMT_SEPARATOR_TABS))) {
+        put_number(&out, counter, 10U, 0, '0');
+        put_char(&out, '\t');
+    }
+    else if (option->counter != MSG_FMT_OPTION_OFF) { /* defaults to MSG_FMT_SEPARATOR_SPACES */
+        put_number(&out, counter, 10U, 7, '-');
+        put_string(&out, "  ");
+    }
+    /* time-stamp (abs/rel/zero) (hhmmss/sec/DJD).(msec/usec) */
+    format_time(formatter, &out, message);
+    format_separator(formatter, &out, "  ");
+
+    /* channel (optional) */
+    if ((option->channel != MSG_FMT_OPTION_OFF) && (option->separator == MSG_FMT_SEPARATOR_TABS)) {
+        put_signed(&out, (int64_t)channel, 0, '0');
+        put_char(&out, '\t');
+    }
+    else if (option->channel != MSG_FMT_OPTION_OFF) { /* defaults to MSG_FMT_SEPARATOR_SPACES */
+        put_signed(&out, (int64_t)channel, 2, '-');
+        put_string(&out, "  ");
+    }
+    /* identifier (hex/dec/oct) */
+    format_id(formatter, &out, message);
+    format_separator(formatter, &out, "  ");
+
+    /* flags (optional) */
+    if (option->flags != MSG_FMT_OPTION_OFF) {
+        format_flags(formatter, &out, message);
+        format_separator(formatter, &out, " ");  /* only one space! */
+    }
+    /* dlc/length (hex/dec/oct) */
+    format_dlc(formatter, &out, message);
+
+    /* data (hex/dec/oct) plus ascii (optional) */
+    if (message->dlc && !message->rtr) {
+        format_separator(formatter, &out, "  ");
+        format_data(formatter, &out, message, (option->ascii == MSG_FMT_OPTION_OFF) ? 0 : 1, out.length);
+    }
+    /* end-of-line (optional) */
+    if (option->end_of_line) {
+        put_char(&out, '\n');
+    }
+    put_end(&out);
+    return (out.length <= (size_t)INT32_MAX) ? (int)out.length : -1;
+}
+
 char *msg_format_message(const msg_message_t *message, msg_direction_t direction,
                                msg_counter_t counter, msg_channel_t channel)
 {
-    char tmp_string[MSG_STRING_LENGTH];
-
-    memset(msg_string, 0, sizeof(msg_string));
+    msg_string[0] = '\0';
 
     if (message) {
-        /* prompt (optional) */
-        if (strlen(msg_option.tx_prompt) && (direction == MSG_TX_MESSAGE)) {
-            strcat(msg_string, msg_option.tx_prompt);
-            strcat(msg_string, (msg_option.separator == MSG_FMT_SEPARATOR_TABS) ? "\t" : " ");
-        }
-        else if (strlen(msg_option.rx_prompt)) { /* defaults to MSG_DIRECTION_RX_MSG */
-            strcat(msg_string, msg_option.rx_prompt);
-            strcat(msg_string, (msg_option.separator == MSG_FMT_SEPARATOR_TABS) ? "\t" : " ");
-        }
-        /* counter (optional) */
-        if ((msg_option.counter != MSG_FMT_OPTION_OFF) && ((msg_option.separator == MSG_FMT_SEPARATOR_TABS))) {
-            sprintf(tmp_string, "%" PRIu64 "\t", counter);
-            strcat(msg_string, tmp_string);
-        }
-        else if (msg_option.counter != MSG_FMT_OPTION_OFF) { /* defaults to MSG_FMT_SEPARATOR_SPACES */
-            sprintf(tmp_string, "%-7" PRIu64 "  ", counter);
-            strcat(msg_string, tmp_string);
-        }
-        /* time-stamp (abs/rel/zero) (hhmmss/sec/DJD).(msec/usec) */
-        format_time(tmp_string, message);
-        strcat(msg_string, tmp_string);
-        strcat(msg_string, (msg_option.separator == MSG_FMT_SEPARATOR_TABS) ? "\t" : "  ");
-
-        /* channel (optional) */
-        if ((msg_option.channel != MSG_FMT_OPTION_OFF) && (msg_option.separator == MSG_FMT_SEPARATOR_TABS)) {
-            sprintf(tmp_string, "%i\t", channel);
-            strcat(msg_string, tmp_string);
-        }
-        else if (msg_option.channel != MSG_FMT_OPTION_OFF) { /* defaults to MSG_FMT_SEPARATOR_SPACES */
-            sprintf(tmp_string, "%-2i  ", channel);
-            strcat(msg_string, tmp_string);
-        }
-        /* identifier (hex/dec/oct) */
-        format_id(tmp_string, message);
-        strcat(msg_string, tmp_string);
-        strcat(msg_string, (msg_option.separator == MSG_FMT_SEPARATOR_TABS) ? "\t" : "  ");
-
-        /* flags (optional) */
-        if (msg_option.flags != MSG_FMT_OPTION_OFF) {
-#if (OPTION_CAN_2_0_ONLY == 0)
-            if (!message->sts) {
-                strcat(msg_string, message->xtd ? "X" : "S");
-                strcat(msg_string, message->fdf ? "F" : "-");
-                strcat(msg_string, message->brs ? "B" : "-");
-                strcat(msg_string, message->esi ? "E" : "-");
-                strcat(msg_string, message->rtr ? "R" : "-");
-            }
-            else {
-                strcat(msg_string, "Error");
-            }
-#else
-            if (!message->sts) {
-                strcat(msg_string, message->xtd ? "X" : "S");
-                strcat(msg_string, message->rtr ? "R" : "-");
-            }
-            else {
-                strcat(msg_string, "E!");
-            }
-#endif
-            strcat(msg_string, (msg_option.separator == MSG_FMT_SEPARATOR_TABS) ? "\t" : " ");  /* only one space! */
-        }
-        /* dlc/length (hex/dec/oct) */
-        format_dlc(tmp_string, message);
-        strcat(msg_string, tmp_string);
-
-        /* data (hex/dec/oct) plus ascii (optional) */
-        if (message->dlc && !message->rtr) {
-            strcat(msg_string, (msg_option.separator == MSG_FMT_SEPARATOR_TABS) ? "\t" : "  ");
-            format_data(tmp_string, message, (msg_option.ascii == MSG_FMT_OPTION_OFF) ? 0 : 1, (int)strlen(msg_string));
-            strcat(msg_string, tmp_string);
-        }
-        /* end-of-line (optional) */
-        if (msg_option.end_of_line) {
-            strcat(msg_string, "\n");
-        }
+        (void)msg_format_message_r(&msg_default, msg_string, sizeof(msg_string), message, direction, counter, channel);
     }
     return msg_string;
 }
 
 char *msg_format_time(const msg_message_t *message)
 {
-    memset(msg_string, 0, sizeof(msg_string));
+    msg_buffer_t out = { msg_string, sizeof(msg_string), 0U };
 
     if (message) {
         /* time-stamp (abs/rel/zero) (hhmmss/sec/DJD).(msec/usec) */
-        format_time(msg_string, message);
+        format_time(&msg_default, &out, message);
     }
+    put_end(&out);
     return msg_string;
 }
 
 char *msg_format_id(const msg_message_t *message)
 {
-    memset(msg_string, 0, sizeof(msg_string));
+    msg_buffer_t out = { msg_string, sizeof(msg_string), 0U };
 
     if (message) {
         /* identifier (hex/dec/oct) */
-        format_id(msg_string, message);
+        format_id(&msg_default, &out, message);
     }
+    put_end(&out);
     return msg_string;
 }
 
 char *msg_format_flags(const msg_message_t *message)
 {
-    memset(msg_string, 0, sizeof(msg_string));
+    msg_buffer_t out = { msg_string, sizeof(msg_string), 0U };
 
     if (message) {
-#if (OPTION_CAN_2_0_ONLY == 0)
-        if (!message->sts) {
-            strcat(msg_string, message->xtd ? "X" : "S");
-            strcat(msg_string, message->fdf ? "F" : "-");
-            strcat(msg_string, message->brs ? "B" : "-");
-            strcat(msg_string, message->esi ? "E" : "-");
-            strcat(msg_string, message->rtr ? "R" : "-");
-        }
-        else {
-            strcat(msg_string, "Error");
-        }
-#else
-        if (!message->sts) {
-            strcat(msg_string, message->xtd ? "X" : "S");
-            strcat(msg_string, message->rtr ? "R" : "-");
-        }
-        else {
-            strcat(msg_string, "E!");
-        }
-#endif
+        format_flags(&msg_default, &out, message);
     }
+    put_end(&out);
     return msg_string;
 }
 
 char *msg_format_dlc(const msg_message_t *message)
 {
-    memset(msg_string, 0, sizeof(msg_string));
+    msg_buffer_t out = { msg_string, sizeof(msg_string), 0U };
 
     if (message) {
         /* dlc/length (hex/dec/oct) */
-        format_dlc(msg_string, message);
+        format_dlc(&msg_default, &out, message);
     }
+    put_end(&out);
     return msg_string;
 }
 
 char *msg_format_data(const msg_message_t *message)
 {
-    memset(msg_string, 0, sizeof(msg_string));
+    msg_buffer_t out = { msg_string, sizeof(msg_string), 0U };
 
     if (message) {
         /* data (hex/dec/oct) */
         if (message->dlc) {
-            format_data(msg_string, message, 0, 0);
+            format_data(&msg_default, &out, message, 0, 0U);
         }
     }
+    put_end(&out);
     return msg_string;
 }
 
 char *msg_format_ascii(const msg_message_t *message)
 {
-    memset(msg_string, 0, sizeof(msg_string));
+    msg_buffer_t out = { msg_string, sizeof(msg_string), 0U };
 
     if (message) {
         /* data (hex/dec/oct) */
         if (message->dlc) {
-            format_ascii(msg_string, message);
+            format_ascii(&msg_default, &out, message);
         }
     }
+    put_end(&out);
     return msg_string;
 }
 
@@ -374,7 +366,7 @@ int  msg_set_fmt_time_stamp(msg_fmt_timestamp_t option)
     case MSG_FMT_TIMESTAMP_ZERO:
     case MSG_FMT_TIMESTAMP_ABSOLUTE:
     case MSG_FMT_TIMESTAMP_RELATIVE:
-        msg_option.time_stamp = option;
+        msg_default.option.time_stamp = option;
         break;
     default:
         rc = 0;
@@ -391,7 +383,7 @@ int msg_set_fmt_time_usec(msg_fmt_option_t option)
     switch (option) {
     case MSG_FMT_OPTION_OFF:
     case MSG_FMT_OPTION_ON:
-        msg_option.time_usec = option;
+        msg_default.option.time_usec = option;
         break;
     default:
         rc = 0;
@@ -409,7 +401,7 @@ int msg_set_fmt_time_format(msg_fmt_time_t option)
     case MSG_FMT_TIME_HHMMSS:
     case MSG_FMT_TIME_SEC:
     case MSG_FMT_TIME_DJD:
-        msg_option.time_format = option;
+        msg_default.option.time_format = option;
         break;
     default:
         rc = 0;
@@ -427,7 +419,7 @@ int msg_set_fmt_id(msg_fmt_number_t option)
     case MSG_FMT_NUMBER_HEX:
     case MSG_FMT_NUMBER_DEC:
     case MSG_FMT_NUMBER_OCT:
-        msg_option.id = option;
+        msg_default.option.id = option;
         break;
     default:
         rc = 0;
@@ -444,7 +436,7 @@ int msg_set_fmt_id_xtd(msg_fmt_option_t option)
     switch (option) {
     case MSG_FMT_OPTION_OFF:
     case MSG_FMT_OPTION_ON:
-        msg_option.id_xtd = option;
+        msg_default.option.id_xtd = option;
         break;
     default:
         rc = 0;
@@ -462,7 +454,7 @@ int msg_set_fmt_dlc(msg_fmt_number_t option)
     case MSG_FMT_NUMBER_HEX:
     case MSG_FMT_NUMBER_DEC:
     case MSG_FMT_NUMBER_OCT:
-        msg_option.dlc = option;
+        msg_default.option.dlc = option;
         break;
     default:
         rc = 0;
@@ -479,7 +471,7 @@ int msg_set_fmt_dlc_format(msg_fmt_canfd_t option)
     switch (option) {
     case  MSG_FMT_CANFD_DLC:
     case  MSG_FMT_CANFD_LENGTH:
-        msg_option.dlc_format = option;
+        msg_default.option.dlc_format = option;
         break;
     default:
         rc = 0;
@@ -497,7 +489,7 @@ int msg_set_fmt_dlc_brackets(int option)
     case '\0':
     case '(':
     case '[':
-        msg_option.dlc_brackets = option;
+        msg_default.option.dlc_brackets = option;
         break;
     default:
         rc = 0;
@@ -514,7 +506,7 @@ int msg_set_fmt_flags(msg_fmt_option_t option)
     switch (option) {
     case MSG_FMT_OPTION_OFF:
     case MSG_FMT_OPTION_ON:
-        msg_option.flags = option;
+        msg_default.option.flags = option;
         break;
     default:
         rc = 0;
@@ -532,7 +524,7 @@ int msg_set_fmt_data(msg_fmt_number_t option)
     case MSG_FMT_NUMBER_HEX:
     case MSG_FMT_NUMBER_DEC:
     case MSG_FMT_NUMBER_OCT:
-        msg_option.data = option;
+        msg_default.option.data = option;
         break;
     default:
         rc = 0;
@@ -549,7 +541,7 @@ int msg_set_fmt_ascii(msg_fmt_option_t option)
     switch (option) {
     case MSG_FMT_OPTION_OFF:
     case MSG_FMT_OPTION_ON:
-        msg_option.ascii = option;
+        msg_default.option.ascii = option;
         break;
     default:
         rc = 0;
@@ -564,7 +556,7 @@ int msg_set_fmt_ascii_subst(int option)
     int rc = 1;
 
     if (isprint(option))
-        msg_option.ascii_subst = option;
+        msg_default.option.ascii_subst = option;
     else
         rc = 0;
     return rc;
@@ -578,7 +570,7 @@ int msg_set_fmt_channel(msg_fmt_option_t option)
     switch (option) {
     case MSG_FMT_OPTION_OFF:
     case MSG_FMT_OPTION_ON:
-        msg_option.channel = option;
+        msg_default.option.channel = option;
         break;
     default:
         rc = 0;
@@ -595,7 +587,7 @@ int msg_set_fmt_counter(msg_fmt_option_t option)
     switch (option) {
     case MSG_FMT_OPTION_OFF:
     case MSG_FMT_OPTION_ON:
-        msg_option.counter = option;
+        msg_default.option.counter = option;
         break;
     default:
         rc = 0;
@@ -612,7 +604,7 @@ int msg_set_fmt_separator(msg_fmt_separator_t option)
     switch (option) {
     case MSG_FMT_SEPARATOR_SPACES:
     case MSG_FMT_SEPARATOR_TABS:
-        msg_option.separator = option;
+        msg_default.option.separator = option;
         break;
     default:
         rc = 0;
@@ -633,7 +625,7 @@ int msg_set_fmt_wraparound(msg_fmt_wraparound_t option)
     case MSG_FMT_WRAPAROUND_16:
     case MSG_FMT_WRAPAROUND_32:
     case MSG_FMT_WRAPAROUND_64:
-        msg_option.wraparound = option;
+        msg_default.option.wraparound = option;
         break;
     default:
         rc = 0;
@@ -650,7 +642,7 @@ int msg_set_fmt_eol(msg_fmt_option_t option)
     switch (option) {
     case MSG_FMT_OPTION_OFF:
     case MSG_FMT_OPTION_ON:
-        msg_option.end_of_line = option;
+        msg_default.option.end_of_line = option;
         break;
     default:
         rc = 0;
@@ -665,7 +657,7 @@ int msg_set_fmt_rx_prompt(const char *option)
     int rc = 1;
 
     if (strlen(option) <= 6)
-        strcpy(msg_option.rx_prompt, option);
+        strcpy(msg_default.option.rx_prompt, option);
     else
         rc = 0;
     return rc;
@@ -677,7 +669,7 @@ int msg_set_fmt_tx_prompt(const char *option)
     int rc = 1;
 
     if (strlen(option) <= 6)
-        strcpy(msg_option.tx_prompt, option);
+        strcpy(msg_default.option.tx_prompt, option);
     else
         rc = 0;
     return rc;
@@ -686,26 +678,26 @@ int msg_set_fmt_tx_prompt(const char *option)
 /*  -----------  local functions  ----------------------------------------
  */
 
-static void format_time(char *string, const msg_message_t *message)
+static void format_time(msg_formatter_t *formatter, msg_buffer_t *out, const msg_message_t *message)
 {
-    static msg_timestamp_t laststamp = { 0, 0 };
+    const msg_fmt_options_t *option = &formatter->option;
     struct timespec difftime;
     struct tm tm; time_t t;
     char   timestring[25];
     double djd;
 
-    assert(string);
+    assert(out);
     assert(message);
 
-    switch (msg_option.time_stamp) {
+    switch (option->time_stamp) {
     case MSG_FMT_TIMESTAMP_RELATIVE:
     case MSG_FMT_TIMESTAMP_ZERO:
-        if (laststamp.tv_sec == 0) { /* first init */
-            laststamp.tv_sec = message->timestamp.tv_sec;
-            laststamp.tv_nsec = message->timestamp.tv_nsec;
+        if (formatter->reference.tv_sec == 0) { /* first init */
+            formatter->reference.tv_sec = message->timestamp.tv_sec;
+            formatter->reference.tv_nsec = message->timestamp.tv_nsec;
         }
-        difftime.tv_sec = message->timestamp.tv_sec - laststamp.tv_sec;
-        difftime.tv_nsec = message->timestamp.tv_nsec - laststamp.tv_nsec;
+        difftime.tv_sec = message->timestamp.tv_sec - formatter->reference.tv_sec;
+        difftime.tv_nsec = message->timestamp.tv_nsec - formatter->reference.tv_nsec;
         if (difftime.tv_nsec < 0) {
             difftime.tv_sec -= 1;
             difftime.tv_nsec += 1000000000;
@@ -714,165 +706,207 @@ static void format_time(char *string, const msg_message_t *message)
             difftime.tv_sec = 0;
             difftime.tv_nsec = 0;
         }
-        if (msg_option.time_stamp == MSG_FMT_TIMESTAMP_RELATIVE) { /* update for delta calculation */
-            laststamp.tv_sec = message->timestamp.tv_sec;
-            laststamp.tv_nsec = message->timestamp.tv_nsec;
+        if (option->time_stamp == MSG_FMT_TIMESTAMP_RELATIVE) { /* update for delta calculation */
+            formatter->reference.tv_sec = message->timestamp.tv_sec;
+            formatter->reference.tv_nsec = message->timestamp.tv_nsec;
+        }
+        if (option->time_format == MSG_FMT_TIME_HHMMSS) {
+            /* note: same as gmtime(), without a call */
+            t = (time_t)difftime.tv_sec;
+            timestring[0] = dec_pairs[2 * ((t / 3600) % 24)];
+            timestring[1] = dec_pairs[2 * ((t / 3600) % 24) + 1];
+            timestring[2] = ':';
+            timestring[3] = dec_pairs[2 * ((t / 60) % 60)];
+            timestring[4] = dec_pairs[2 * ((t / 60) % 60) + 1];
+            timestring[5] = ':';
+            timestring[6] = dec_pairs[2 * (t % 60)];
+            timestring[7] = dec_pairs[2 * (t % 60) + 1];
+            timestring[8] = '\0';
         }
-        t = (time_t)difftime.tv_sec;
-        tm = *gmtime(&t);
         break;
     case MSG_FMT_TIMESTAMP_ABSOLUTE:
     default:
         difftime.tv_sec = message->timestamp.tv_sec;
         difftime.tv_nsec = message->timestamp.tv_nsec;
-        t = (time_t)message->timestamp.tv_sec;
-        tm = *localtime(&t);
+        if (option->time_format == MSG_FMT_TIME_HHMMSS) {
+            /* note: the local time is converted once per second */
+            t = (time_t)message->timestamp.tv_sec;
+            if (t != formatter->local.seconds) {
+#if !defined(_WIN32) && !defined(_WIN64)
+                (void)localtime_r(&t, &tm);
+#else
+                (void)localtime_s(&tm, &t);
+#endif
+                strftime(formatter->local.hhmmss, sizeof(formatter->local.hhmmss), "%H:%M:%S", &tm);
+                formatter->local.seconds = t;
+            }
+            memcpy(timestring, formatter->local.hhmmss, sizeof(formatter->local.hhmmss));
+        }
         break;
     }
-    switch (msg_option.time_format) {
+    switch (option->time_format) {
     case MSG_FMT_TIME_HHMMSS:
-        strftime(timestring, 24, "%H:%M:%S", &tm); // TODO: tm > 24h (?)
-        if (msg_option.time_usec)
-            sprintf(string, "%s.%06li", timestring, (long)difftime.tv_nsec / 1000L);
+        put_string(out, timestring);
+        put_char(out, '.');
+        if (option->time_usec)
+            put_number(out, (uint64_t)difftime.tv_nsec / 1000U, 10U, 6, '0');
         else/* resolution is 0.1 milliseconds! */
-            sprintf(string, "%s.%04li", timestring, (long)difftime.tv_nsec / 100000L);
+            put_number(out, (uint64_t)difftime.tv_nsec / 100000U, 10U, 4, '0');
         break;
     case MSG_FMT_TIME_DJD:
-        if (!msg_option.time_usec)  /* round to milliseconds resolution */
+        if (!option->time_usec)  /* round to milliseconds resolution */
             difftime.tv_nsec = ((difftime.tv_nsec + 500000L) / 1000000L) * 1000000L;
         djd = (double)difftime.tv_sec / (double)86400;
         djd += (double)difftime.tv_nsec / (double)86400000000000;
-        if (msg_option.time_usec)
-            sprintf(string, "%1.12lf", djd);
+        if (option->time_usec)
+            snprintf(timestring, sizeof(timestring), "%1.12lf", djd);
         else
-            sprintf(string, "%1.9lf", djd);
+            snprintf(timestring, sizeof(timestring), "%1.9lf", djd);
+        put_string(out, timestring);
         break;
     case MSG_FMT_TIME_SEC:
     default:
-        if (msg_option.time_usec)
-            sprintf(string, "%3li.%06li", (long)difftime.tv_sec, (long)difftime.tv_nsec / 1000L);
+        put_signed(out, (int64_t)difftime.tv_sec, 3, ' ');
+        put_char(out, '.');
+        if (option->time_usec)
+            put_number(out, (uint64_t)difftime.tv_nsec / 1000U, 10U, 6, '0');
         else/* resolution is 0.1 milliseconds! */
-            sprintf(string, "%3li.%04li", (long)difftime.tv_sec, (long)difftime.tv_nsec / 100000L);
+            put_number(out, (uint64_t)difftime.tv_nsec / 100000U, 10U, 4, '0');
         break;
     }
 }
 
-static void format_id(char *string, const msg_message_t *message)
+static void format_id(const msg_formatter_t *formatter, msg_buffer_t *out, const msg_message_t *message)
 {
-    assert(string);
+    const msg_fmt_options_t *option = &formatter->option;
+
+    assert(out);
     assert(message);
 
-    string[0] = '\0';
-    switch (msg_option.id) {
+    switch (option->id) {
     case MSG_FMT_NUMBER_DEC:
-        if (!msg_option.id_xtd)
-            sprintf(string, "%-4" PRIu32, message->id);
-        else
-            sprintf(string, "%-9" PRIu32, message->id);
+        put_number(out, message->id, 10U, !option->id_xtd ? 4 : 9, '-');
         break;
     case MSG_FMT_NUMBER_OCT:
-        if (!msg_option.id_xtd)
-            sprintf(string, "%04" PRIo32, message->id);
-        else
-            sprintf(string, "%010" PRIo32, message->id);
+        put_number(out, message->id, 8U, !option->id_xtd ? 4 : 10, '0');
         break;
     case MSG_FMT_NUMBER_HEX:
     default:
-        if (!msg_option.id_xtd)
-            sprintf(string, "%03" PRIX32, message->id);
-        else
-            sprintf(string, "%08" PRIX32, message->id);
+        put_number(out, message->id, 16U, !option->id_xtd ? 3 : 8, '0');
         break;
     }
 }
 
-static void format_dlc(char *string, const msg_message_t *message)
+static void format_flags(const msg_formatter_t *formatter, msg_buffer_t *out, const msg_message_t *message)
+{
+    assert(out);
+    assert(message);
+    (void)formatter;
+
+#if (OPTION_CAN_2_0_ONLY == 0)
+    if (!message->sts) {
+        put_char(out, message->xtd ? 'X' : 'S');
+        put_char(out, message->fdf ? 'F' : '-');
+        put_char(out, message->brs ? 'B' : '-');
+        put_char(out, message->esi ? 'E' : '-');
+        put_char(out, message->rtr ? 'R' : '-');
+    }
+    else {
+        put_string(out, "Error");
+    }
+#else
+    if (!message->sts) {
+        put_char(out, message->xtd ? 'X' : 'S');
+        put_char(out, message->rtr ? 'R' : '-');
+    }
+    else {
+        put_string(out, "E!");
+    }
+#endif
+}
+
+static void format_dlc(const msg_formatter_t *formatter, msg_buffer_t *out, const msg_message_t *message)
 {
-    assert(string);
+    const msg_fmt_options_t *option = &formatter->option;
+
+    assert(out);
     assert(message);
 
-    unsigned char length = (msg_option.dlc_format == MSG_FMT_CANFD_DLC) ? message->dlc : DLC2LEN(message->dlc);
+    unsigned char length = (option->dlc_format == MSG_FMT_CANFD_DLC) ? message->dlc : DLC2LEN(message->dlc);
     char pre = '\0', post = '\0';
     int blank = 0;
 
-    string[0] = '\0';
-    switch (msg_option.dlc_brackets) {
+    switch (option->dlc_brackets) {
     case '(': pre = '('; post = ')'; break;
     case '[': pre = '['; post = ']'; break;
     default: break;
     }
-    switch (msg_option.dlc) {
+    if (pre && post)
+        put_char(out, pre);
+    switch (option->dlc) {
     case MSG_FMT_NUMBER_DEC:
-        if (pre && post)
-            sprintf(string, "%c%u%c", pre, length, post);
-        else
-            sprintf(string, "%u", length);
+        put_number(out, length, 10U, 0, '0');
         blank = length >= 10 ? 0 : 1;
         break;
     case MSG_FMT_NUMBER_OCT:
-        if (pre && post)
-            sprintf(string, "%c%02o%c", pre, length, post);
-        else
-            sprintf(string, "%02o", length);
+        put_number(out, length, 8U, 2, '0');
         blank = length >= 64 ? 0 : 1;
         break;
     case MSG_FMT_NUMBER_HEX:
     default:
-        if (pre && post)
-            sprintf(string, "%c%X%c", pre, length, post);
-        else
-            sprintf(string, "%X", length);
+        put_number(out, length, 16U, 0, '0');
         break;
     }
+    if (pre && post)
+        put_char(out, post);
 #if (OPTION_CAN_2_0_ONLY == 0)
     if (message->fdf && blank)
-        strcat(string, " ");
+        put_char(out, ' ');
 #else
     (void)blank;  /* to avoid compiler warnings */
 #endif
 }
 
-static void format_data(char *string, const msg_message_t *message, int ascii, int indent)
+static void format_data(const msg_formatter_t *formatter, msg_buffer_t *out, const msg_message_t *message, int ascii, size_t indent)
 {
-    assert(string);
+    const msg_fmt_options_t *option = &formatter->option;
+
+    assert(out);
     assert(message);
 
     int length = DLC2LEN(message->dlc);
     int i, j, col, wraparound;
-    char datastring[8];
+    size_t n;
 
-    string[0] = '\0';
 #if (OPTION_CAN_2_0_ONLY == 0)
-    if (msg_option.wraparound == MSG_FMT_WRAPAROUND_NO)
+    if (option->wraparound == MSG_FMT_WRAPAROUND_NO)
         wraparound = message->fdf ? (int)MSG_FMT_WRAPAROUND_64 : (int)MSG_FMT_WRAPAROUND_8;
     else
-        wraparound = (int)msg_option.wraparound;
+        wraparound = (int)option->wraparound;
 #else
     wraparound = (int)MSG_FMT_WRAPAROUND_8;
 #endif
     for (i = 0, j = 0, col = 0; i < length; i++) {
-        format_data_byte(datastring, message->data[i]);
-        strcat(string, datastring);
+        format_data_byte(formatter, out, message->data[i]);
         if ((i + 1) < length) {
             if ((col + 1) == wraparound) {
                 if (ascii) {
-                    strcat(string, msg_option.separator == MSG_FMT_SEPARATOR_TABS ? "\t" : "  ");
-                    for (col = 0; col < (int)msg_option.wraparound; j++, col++) {
-                        format_data_ascii(datastring, message->data[j]);
-                        strcat(string, datastring);
+                    format_separator(formatter, out, "  ");
+                    for (col = 0; col < (int)option->wraparound; j++, col++) {
+                        format_data_ascii(formatter, out, message->data[j]);
                     }
                 }
-                strcat(string, "\n");
-                if (msg_option.separator != MSG_FMT_SEPARATOR_TABS) {
-                    for (col = 0; col < indent; col++)
-                        strcat(string, " ");
+                put_char(out, '\n');
+                if (option->separator != MSG_FMT_SEPARATOR_TABS) {
+                    for (n = 0U; n < indent; n++)
+                        put_char(out, ' ');
                 }
                 else
-                    strcat(string, "\t");
+                    put_char(out, '\t');
                 col = 0;
             }
             else {
-                strcat(string, " ");
+                put_char(out, ' ');
                 col++;
             }
         }
@@ -881,97 +915,193 @@ static void format_data(char *string, const msg_message_t *message, int ascii, i
     }
     if (ascii) {
         if ((col < wraparound) && (i != 0)) {
-            strcat(string, " ");
+            put_char(out, ' ');
             for (; col < wraparound; col++) {
-                format_fill_byte(datastring);
-                strcat(string, datastring);
+                format_fill_byte(formatter, out);
                 if ((col + 1) != wraparound)
-                    strcat(string, " ");
+                    put_char(out, ' ');
             }
         }
-        strcat(string, msg_option.separator == MSG_FMT_SEPARATOR_TABS ? "\t" : "  ");
+        format_separator(formatter, out, "  ");
         for (; j < length; j++) {
-            format_data_ascii(datastring, message->data[j]);
-            strcat(string, datastring);
+            format_data_ascii(formatter, out, message->data[j]);
         }
     }
 }
 
-static void format_ascii(char *string, const msg_message_t *message)
+static void format_ascii(const msg_formatter_t *formatter, msg_buffer_t *out, const msg_message_t *message)
 {
-    assert(string);
+    const msg_fmt_options_t *option = &formatter->option;
+
+    assert(out);
     assert(message);
 
     int length = DLC2LEN(message->dlc);
     int i, col, wraparound;
-    char datastring[8];
 
-    string[0] = '\0';
 #if (OPTION_CAN_2_0_ONLY == 0)
-    if (msg_option.wraparound == MSG_FMT_WRAPAROUND_NO)
+    if (option->wraparound == MSG_FMT_WRAPAROUND_NO)
         wraparound = message->fdf ? (int)MSG_FMT_WRAPAROUND_64 : (int)MSG_FMT_WRAPAROUND_8;
     else
-        wraparound = (int)msg_option.wraparound;
+        wraparound = (int)option->wraparound;
 #else
     wraparound = (int)MSG_FMT_WRAPAROUND_8;
+    (void)option;
 #endif
     for (i = 0, col = 0; i < length; i++) {
-        format_data_ascii(datastring, message->data[i]);
-        strcat(string, datastring);
+        format_data_ascii(formatter, out, message->data[i]);
         if ((i + 1) < length) {
             if ((col + 1) == wraparound) {
-                strcat(string, "\n");
+                put_char(out, '\n');
                 col = 0;
             }
             else {
-                strcat(string, " ");
+                put_char(out, ' ');
                 col++;
             }
         }
     }
 }
 
-static void format_data_byte(char *string, unsigned char data)
+static void format_data_byte(const msg_formatter_t *formatter, msg_buffer_t *out, unsigned char data)
 {
-    assert(string);
+    assert(out);
 
-    switch (msg_option.data) {
+    switch (formatter->option.data) {
     case MSG_FMT_NUMBER_DEC:
-        sprintf(string, "%-3u", data);
+        put_number(out, data, 10U, 3, '-');
         break;
     case MSG_FMT_NUMBER_OCT:
-        sprintf(string, "%03o", data);
+        put_char(out, hex_digits[(data >> 6) & 0x7U]);
+        put_char(out, hex_digits[(data >> 3) & 0x7U]);
+        put_char(out, hex_digits[data & 0x7U]);
         break;
     case MSG_FMT_NUMBER_HEX:
     default:
-        sprintf(string, "%02X", data);
+        put_char(out, hex_digits[data >> 4]);
+        put_char(out, hex_digits[data & 0xFU]);
         break;
     }
 }
 
-static void format_fill_byte(char *string)
+static void format_fill_byte(const msg_formatter_t *formatter, msg_buffer_t *out)
 {
-    assert(string);
+    assert(out);
 
-    switch (msg_option.data) {
+    switch (formatter->option.data) {
     case MSG_FMT_NUMBER_DEC:
-        sprintf(string, "   ");
+        put_string(out, "   ");
         break;
     case MSG_FMT_NUMBER_OCT:
-        sprintf(string, "   ");
+        put_string(out, "   ");
         break;
     case MSG_FMT_NUMBER_HEX:
     default:
-        sprintf(string, "  ");
+        put_string(out, "  ");
+        break;
+    }
+}
+
+static void format_data_ascii(const msg_formatter_t *formatter, msg_buffer_t *out, unsigned char data)
+{
+    assert(out);
+
+    put_char(out, isprint((int)data) ? (char)data : (char)formatter->option.ascii_subst);
+}
+
+static void format_separator(const msg_formatter_t *formatter, msg_buffer_t *out, const char *spaces)
+{
+    if (formatter->option.separator == MSG_FMT_SEPARATOR_TABS)
+        put_char(out, '\t');
+    else
+        put_string(out, spaces);
+}
+
+static void put_char(msg_buffer_t *out, char c)
+{
+    if (out->length < out->size)
+        out->string[out->length] = c;
+    out->length++;
+}
+
+static void put_string(msg_buffer_t *out, const char *string)
+{
+    while (*string)
+        put_char(out, *string++);
+}
+
+/* unsigned number with min. width: pad = '0' (right-justified, leading zeros),
+ * ' ' (right-justified, leading spaces) or '-' (left-justified, trailing spaces)
+ */
+static void put_number(msg_buffer_t *out, uint64_t value, unsigned base, int width, char pad)
+{
+    char digits[24];
+    int n = 0;
+    unsigned r;
+
+    switch (base) {
+    case 16U:
+        do { digits[n++] = hex_digits[value & 0xFU]; value >>= 4; } while (value);
+        break;
+    case 8U:
+        do { digits[n++] = hex_digits[value & 0x7U]; value >>= 3; } while (value);
+        break;
+    default:
+        while (value >= 100U) {
+            r = (unsigned)(value % 100U);
+            value /= 100U;
+            digits[n++] = dec_pairs[2U * r + 1U];
+            digits[n++] = dec_pairs[2U * r];
+        }
+        if (value >= 10U) {
+            digits[n++] = dec_pairs[2U * value + 1U];
+            digits[n++] = dec_pairs[2U * value];
+        }
+        else
+            digits[n++] = hex_digits[value];
         break;
     }
+    width -= n;
+    if (pad != '-') {
+        for (; width > 0; width--)
+            put_char(out, pad);
+    }
+    while (n > 0)
+        put_char(out, digits[--n]);
+    if (pad == '-') {
+        for (; width > 0; width--)
+            put_char(out, ' ');
+    }
 }
 
-static void format_data_ascii(char *string, unsigned char data)
+static void put_signed(msg_buffer_t *out, int64_t value, int width, char pad)
 {
-    assert(string);
+    uint64_t magnitude = (uint64_t)0 - (uint64_t)value;
+    int n = 1;
+
+    if (value < 0) {
+        /* note: the sign is part of the width */
+        for (uint64_t tmp = magnitude; tmp; tmp /= 10U)
+            n++;
+        if (pad == ' ') {
+            for (; width > n; width--)
+                put_char(out, ' ');
+        }
+        put_char(out, '-');
+        put_number(out, magnitude, 10U, (pad == '0') ? (width - 1) : 0, '0');
+        if (pad == '-') {
+            for (; width > n; width--)
+                put_char(out, ' ');
+        }
+    }
+    else
+        put_number(out, (uint64_t)value, 10U, width, pad);
+}
 
-    sprintf(string, "%c", isprint((int)data) ? (char)data : (char)msg_option.ascii_subst);
+static void put_end(msg_buffer_t *out)
+{
+    if (out->size)
+        out->string[(out->length < out->size) ? out->length : (out->size - 1U)] = '\0';
 }
 
 /** @}
@@ -74,6 +74,8 @@ extern "C" {
 #include <stdbool.h>                    //   C99 header for boolean type
 #include <time.h>                       //   time types for time-stamp
 #endif
+#include <stddef.h>                     //   C99 header for size_t
+#include <time.h>                       //   time_t for the formatter context
 
 /*  -----------  options  ------------------------------------------------
  */
@@ -273,6 +275,44 @@ typedef enum msg_direction_t_ {
     MSG_TX_MESSAGE = 1
 } msg_direction_t;
 
+/** @brief       Formatter Options
+ */
+typedef struct msg_fmt_options_t_ {
+    msg_fmt_timestamp_t  time_stamp;    /**< time-stamp {ZERO, ABS, REL} */
+    msg_fmt_option_t     time_usec;     /**< time-stamp in usec {OFF, ON} */
+    msg_fmt_time_t       time_format;   /**< time format {TIME, SEC, DJD} */
+    msg_fmt_number_t     id;            /**< identifier {HEX, DEC, OCT, BIN} */
+    msg_fmt_option_t     id_xtd;        /**< extended identifier {OFF, ON} */
+    msg_fmt_number_t     dlc;           /**< DLC/length {HEX, DEC, OCT, BIN} */
+    msg_fmt_canfd_t      dlc_format;    /**< CAN FD format {DLC, LENGTH} */
+    int                  dlc_brackets;  /**< DLC in brackets {'\0', '(', '['} */
+    msg_fmt_option_t     flags;         /**< message flags {ON, OFF} */
+    msg_fmt_number_t     data;          /**< message data {HEX, DEC, OCT, BIN} */
+    msg_fmt_option_t     ascii;         /**< data as ASCII {ON, OFF} */
+    int                  ascii_subst;   /**< substitute for non-printables */
+    msg_fmt_option_t     channel;       /**< message source {OFF, ON} */
+    msg_fmt_option_t     counter;       /**< message counter {ON, OFF} */
+    msg_fmt_separator_t  separator;     /**< separator {SPACES, TABS} */
+    msg_fmt_wraparound_t wraparound;    /**< wraparound {NO, 8, 16, 32, 64} */
+    msg_fmt_option_t     end_of_line;   /**< end-of-line character {ON, OFF} */
+    char                 rx_prompt[6+1];/**< prompt for received messages */
+    char                 tx_prompt[6+1];/**< prompt for sent messages */
+} msg_fmt_options_t;
+
+/** @brief       Formatter Context (options and state of a formatter)
+ *
+ *  @remarks     A formatter context must not be shared between threads
+ *               without locking; use one context per thread instead.
+ */
+typedef struct msg_formatter_t_ {
+    msg_fmt_options_t option;           /**< formatter options */
+    msg_timestamp_t reference;          /**< time-stamp reference (ZERO and REL) */
+    struct {                            /**< local time of the last absolute time-stamp: */
+        time_t seconds;                 /**<   time in seconds */
+        char hhmmss[8+1];               /**<   formatted as hh:mm:ss */
+    } local;
+} msg_formatter_t;
+
 
 /*  -----------  variables  ----------------------------------------------
  */
@@ -281,6 +321,35 @@ typedef enum msg_direction_t_ {
 /*  -----------  prototypes  ---------------------------------------------
  */
 
+/** @brief       initializes a formatter context with the current formatter
+ *               options (see msg_set_fmt_...).
+ *
+ *  @param[out]  formatter - formatter context
+ */
+void msg_formatter_init(msg_formatter_t *formatter);
+
+/** @brief       formats a CAN message into a caller-supplied buffer.
+ *
+ *  @remarks     The function is reentrant when each thread uses its own
+ *               formatter context. With a NULL pointer as formatter context
+ *               the global formatter options are used (not thread-safe).
+ *
+ *  @param[in]   formatter - formatter context (or NULL)
+ *  @param[out]  buffer    - buffer for the zero-terminated string
+ *  @param[in]   size      - size of the buffer (in bytes)
+ *  @param[in]   message   - the message to be formatted
+ *  @param[in]   direction - message direction (RX or TX)
+ *  @param[in]   counter   - message counter
+ *  @param[in]   channel   - message source
+ *
+ *  @returns     the length of the formatted string (without the terminating
+ *               zero), or a negative value on error. If the returned length
+ *               is not less than the buffer size the string was truncated.
+ */
+int msg_format_message_r(msg_formatter_t *formatter, char *buffer, size_t size,
+                         const msg_message_t *message, msg_direction_t direction,
+                         msg_counter_t counter, msg_channel_t channel);
+
 /** @brief       ...
  *
  *  @param[in]   message - ...
@@ -0,0 +1,462 @@
+/*  SPDX-License-Identifier: BSD-2-Clause OR GPL-3.0-or-later */
+/*
+ *  CAN Interface API, Version 3 (pcapng Writer)
+ *
+ *  Copyright (c) 2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+ *  All rights reserved.
+ *
+ *  This file is part of CAN API V3.
+ *
+ *  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+ *  and under the GNU General Public License v3.0 (or any later version).
+ *  You can choose between one of them if you use this file.
+ *
+ *  BSD 2-Clause "Simplified" License:
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  GNU General Public License v3.0 or later:
+ *  CAN API V3 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  CAN API V3 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with CAN API V3.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/** @file        can_pcapng.c
+ *
+ *  @brief       CAN Capture in pcapng Format (LINKTYPE_CAN_SOCKETCAN)
+ *
+ *  @addtogroup  can_pcapng
+ *  @{
+ */
+
+
+/*  -----------  includes  -----------------------------------------------
+ */
+
+#ifdef _MSC_VER
+//no Microsoft extensions please!
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS 1
+#endif
+#endif
+#include "can_pcapng.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <assert.h>
+
+
+/*  -----------  defines  ------------------------------------------------
+ */
+
+#define BLOCK_SHB  0x0A0D0D0AU          // Section Header Block
+#define BLOCK_IDB  0x00000001U          // Interface Description Block
+#define BLOCK_EPB  0x00000006U          // Enhanced Packet Block
+
+#define BYTE_ORDER_MAGIC  0x1A2B3C4DU
+#define VERSION_MAJOR  1U
+#define VERSION_MINOR  0U
+
+#define OPT_ENDOFOPT    0U              // option codes:
+#define OPT_SHB_USERAPPL  4U
+#define OPT_IF_NAME     2U
+#define OPT_IF_TSRESOL  9U
+
+#define TSRESOL_NSEC  9U                // 10^-9 s
+
+#define CAN_EFF_FLAG  0x80000000U       // SocketCAN frame:
+#define CAN_RTR_FLAG  0x40000000U
+#define CAN_ERR_FLAG  0x20000000U
+#define CANFD_BRS  0x01U
+#define CANFD_ESI  0x02U
+#define CANFD_FDF  0x04U
+#define CAN_FRAME_SIZE    16U           //   struct can_frame
+#define CANFD_FRAME_SIZE  72U           //   struct canfd_frame
+
+#define MAX_NAME  256U                  // max. length of an option string
+#define MAX_BLOCK  (28U + CANFD_FRAME_SIZE + 4U)
+
+#define ALIGN4(x)  (((x) + 3U) & ~3U)
+
+
+/*  -----------  types  --------------------------------------------------
+ */
+
+typedef struct pcapng_file_t_ {         // pcapng writer:
+    FILE *fp;                           //   file pointer
+    char *stem;                         //   file name without extension
+    char *ext;                          //   file extension (incl. dot)
+    char *application;                  //   application name
+    char *names[PCAPNG_MAX_INTERFACES]; //   interface names
+    int interfaces;                     //   number of interfaces
+    uint8_t *buffer;                    //   write buffer
+    size_t size;                        //   size of the write buffer
+    size_t used;                        //   used bytes in the write buffer
+    uint64_t written;                   //   bytes written into the current file
+    uint64_t opened;                    //   time of the first packet in the file (in [ns])
+    uint64_t rotate_size;               //   rotation by file size
+    uint64_t rotate_time;               //   rotation by time (in [ns])
+    unsigned sequence;                  //   file sequence number (rotation)
+} pcapng_file_t;
+
+
+/*  -----------  prototypes  ---------------------------------------------
+ */
+
+static int open_file(pcapng_file_t *pcap);
+static int rotate_file(pcapng_file_t *pcap);
+static int write_shb(pcapng_file_t *pcap);
+static int write_idb(pcapng_file_t *pcap, const char *name);
+static int append(pcapng_file_t *pcap, const void *data, size_t length);
+static int flush_buffer(pcapng_file_t *pcap);
+static size_t put_option(uint8_t *buffer, uint16_t code, const void *data, uint16_t length);
+static char *copy_string(const char *string, size_t length);
+static void free_file(pcapng_file_t *pcap);
+
+
+/*  -----------  variables  ----------------------------------------------
+ */
+
+
+/*  -----------  functions  ----------------------------------------------
+ */
+
+pcapng_writer_t pcapng_create(const char *filename, const pcapng_param_t *param) {
+    pcapng_file_t *pcap = NULL;
+    const char *dot, *sep;
+
+    errno = 0;
+    if (!filename || !*filename) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (param && param->buffer_size && (param->buffer_size < PCAPNG_BUFFER_MIN)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if ((pcap = (pcapng_file_t*)calloc(1, sizeof(pcapng_file_t))) == NULL)
+        return NULL;
+    /* split the file name for rotation (<stem>_<nnnnn><ext>) */
+    dot = strrchr(filename, '.');
+    sep = strrchr(filename, '/');
+    if (!sep) sep = strrchr(filename, '\\');
+    if (!dot || (sep && (dot < sep)) || (dot == filename))
+        dot = filename + strlen(filename);
+    pcap->stem = copy_string(filename, (size_t)(dot - filename));
+    pcap->ext = copy_string(dot, strlen(dot));
+    pcap->application = copy_string((param && param->application) ? param->application : "",
+                                    (param && param->application) ? strlen(param->application) : 0U);
+    pcap->size = (param && param->buffer_size) ? (size_t)param->buffer_size : (size_t)PCAPNG_BUFFER_SIZE;
+    pcap->buffer = (uint8_t*)malloc(pcap->size);
+    if (!pcap->stem || !pcap->ext || !pcap->application || !pcap->buffer) {
+        free_file(pcap);
+        return NULL;
+    }
+    pcap->rotate_size = param ? param->rotate_size : 0U;
+    pcap->rotate_time = param ? (uint64_t)param->rotate_time * 1000000000ULL : 0U;
+    pcap->sequence = 1U;
+    if (open_file(pcap) < 0) {
+        free_file(pcap);
+        return NULL;
+    }
+    return (pcapng_writer_t)pcap;
+}
+
+int pcapng_add_interface(pcapng_writer_t writer, const char *name) {
+    pcapng_file_t *pcap = (pcapng_file_t*)writer;
+    int id;
+
+    errno = 0;
+    if (!pcap || !pcap->fp) {
+        errno = ENODEV;
+        return -1;
+    }
+    if (pcap->interfaces >= (int)PCAPNG_MAX_INTERFACES) {
+        errno = ENOSPC;
+        return -1;
+    }
+    id = pcap->interfaces;
+    if ((pcap->names[id] = copy_string(name ? name : "", name ? strlen(name) : 0U)) == NULL)
+        return -1;
+    if (write_idb(pcap, pcap->names[id]) < 0) {
+        free(pcap->names[id]);
+        pcap->names[id] = NULL;
+        return -1;
+    }
+    pcap->interfaces++;
+    return id;
+}
+
+int pcapng_write(pcapng_writer_t writer, int interface, const can_message_t *message) {
+    pcapng_file_t *pcap = (pcapng_file_t*)writer;
+    uint8_t block[MAX_BLOCK];
+    uint32_t can_id, frame_size, block_size, value;
+    uint64_t time;
+    uint8_t *frame;
+
+    errno = 0;
+    if (!pcap || !pcap->fp) {
+        errno = ENODEV;
+        return -1;
+    }
+    if (!message || (interface < 0) || (interface >= pcap->interfaces)) {
+        errno = EINVAL;
+        return -1;
+    }
+    time = ((uint64_t)message->timestamp.tv_sec * 1000000000ULL) + (uint64_t)message->timestamp.tv_nsec;
+#if (OPTION_CAN_2_0_ONLY == 0)
+    frame_size = message->fdf ? CANFD_FRAME_SIZE : CAN_FRAME_SIZE;
+#else
+    frame_size = CAN_FRAME_SIZE;
+#endif
+    block_size = 28U + frame_size + 4U;
+    /* rotate the file by size or by time (not an empty file) */
+    if (pcap->opened &&
+        ((pcap->rotate_size && ((pcap->written + pcap->used + block_size) > pcap->rotate_size)) ||
+         (pcap->rotate_time && ((time - pcap->opened) >= pcap->rotate_time)))) {
+        if (rotate_file(pcap) < 0)
+            return -1;
+    }
+    if (!pcap->opened)
+        pcap->opened = time ? time : 1U;
+    /* Enhanced Packet Block */
+    memset(block, 0, block_size);
+    value = BLOCK_EPB; memcpy(&block[0], &value, 4U);
+    memcpy(&block[4], &block_size, 4U);
+    value = (uint32_t)interface; memcpy(&block[8], &value, 4U);
+    value = (uint32_t)(time >> 32); memcpy(&block[12], &value, 4U);
+    value = (uint32_t)(time & 0xFFFFFFFFULL); memcpy(&block[16], &value, 4U);
+    memcpy(&block[20], &frame_size, 4U);
+    memcpy(&block[24], &frame_size, 4U);
+    /* packet data: SocketCAN frame, CAN identifier in network byte order */
+    frame = &block[28];
+    can_id = message->id & (message->xtd ? 0x1FFFFFFFU : 0x7FFU);
+    if (message->xtd) can_id |= CAN_EFF_FLAG;
+    if (message->rtr) can_id |= CAN_RTR_FLAG;
+    if (message->sts) can_id |= CAN_ERR_FLAG;
+    frame[0] = (uint8_t)(can_id >> 24);
+    frame[1] = (uint8_t)(can_id >> 16);
+    frame[2] = (uint8_t)(can_id >> 8);
+    frame[3] = (uint8_t)(can_id);
+#if (OPTION_CAN_2_0_ONLY == 0)
+    if (message->fdf) {
+        frame[4] = (uint8_t)CANFD_DLC2LEN(message->dlc & 0xFU);
+        frame[5] = (uint8_t)(CANFD_FDF | (message->brs ? CANFD_BRS : 0U) | (message->esi ? CANFD_ESI : 0U));
+    } else
+#endif
+    {
+        frame[4] = (message->dlc < 8U) ? message->dlc : 8U;
+        frame[7] = (message->dlc > 8U) ? message->dlc : 0U;  // len8_dlc
+    }
+    if (!message->rtr)
+        memcpy(&frame[8], message->data, frame[4]);
+    memcpy(&block[28U + frame_size], &block_size, 4U);
+    return append(pcap, block, block_size);
+}
+
+int pcapng_flush(pcapng_writer_t writer) {
+    pcapng_file_t *pcap = (pcapng_file_t*)writer;
+
+    errno = 0;
+    if (!pcap || !pcap->fp) {
+        errno = ENODEV;
+        return -1;
+    }
+    return flush_buffer(pcap);
+}
+
+int pcapng_close(pcapng_writer_t writer) {
+    pcapng_file_t *pcap = (pcapng_file_t*)writer;
+    int res;
+
+    errno = 0;
+    if (!pcap || !pcap->fp) {
+        errno = ENODEV;
+        return -1;
+    }
+    res = flush_buffer(pcap);
+    if (fclose(pcap->fp) != 0)
+        res = -1;
+    pcap->fp = NULL;
+    free_file(pcap);
+    return res;
+}
+
+/*  -----------  local functions  ----------------------------------------
+ */
+
+static int open_file(pcapng_file_t *pcap) {
+    char *filename;
+    size_t length = strlen(pcap->stem) + strlen(pcap->ext) + 16U;
+
+    if ((filename = (char*)malloc(length)) == NULL)
+        return -1;
+    if (pcap->rotate_size || pcap->rotate_time)
+        (void)snprintf(filename, length, "%s_%05u%s", pcap->stem, pcap->sequence, pcap->ext);
+    else
+        (void)snprintf(filename, length, "%s%s", pcap->stem, pcap->ext);
+    pcap->fp = fopen(filename, "wb");
+    free(filename);
+    if (!pcap->fp)
+        return -1;
+    /* note: the blocks are collected in the write buffer */
+    (void)setvbuf(pcap->fp, NULL, _IONBF, 0);
+    pcap->used = 0U;
+    pcap->written = 0U;
+    pcap->opened = 0U;
+    /* every file is a section of its own with all interfaces */
+    if (write_shb(pcap) < 0)
+        return -1;
+    for (int i = 0; i < pcap->interfaces; i++) {
+        if (write_idb(pcap, pcap->names[i]) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+static int rotate_file(pcapng_file_t *pcap) {
+    int res = flush_buffer(pcap);
+
+    if (fclose(pcap->fp) != 0)
+        res = -1;
+    pcap->fp = NULL;
+    if (res < 0)
+        return -1;
+    pcap->sequence++;
+    return open_file(pcap);
+}
+
+static int write_shb(pcapng_file_t *pcap) {
+    uint8_t block[28U + 4U + MAX_NAME + 4U + 4U];
+    size_t length = strlen(pcap->application);
+    uint32_t value, block_size;
+    uint16_t half;
+    int64_t section = -1;
+    size_t n = 8U;
+
+    value = BYTE_ORDER_MAGIC; memcpy(&block[n], &value, 4U); n += 4U;
+    half = VERSION_MAJOR; memcpy(&block[n], &half, 2U); n += 2U;
+    half = VERSION_MINOR; memcpy(&block[n], &half, 2U); n += 2U;
+    memcpy(&block[n], &section, 8U); n += 8U;
+    if (length) {
+        n += put_option(&block[n], OPT_SHB_USERAPPL, pcap->application, (uint16_t)((length < MAX_NAME) ? length : MAX_NAME));
+        n += put_option(&block[n], OPT_ENDOFOPT, NULL, 0U);
+    }
+    block_size = (uint32_t)(n + 4U);
+    value = BLOCK_SHB; memcpy(&block[0], &value, 4U);
+    memcpy(&block[4], &block_size, 4U);
+    memcpy(&block[n], &block_size, 4U);
+    return append(pcap, block, block_size);
+}
+
+static int write_idb(pcapng_file_t *pcap, const char *name) {
+    uint8_t block[16U + 4U + MAX_NAME + 8U + 4U + 4U];
+    size_t length = strlen(name);
+    uint32_t value, block_size;
+    uint16_t half;
+    uint8_t tsresol = TSRESOL_NSEC;
+    size_t n = 8U;
+
+    half = PCAPNG_LINKTYPE; memcpy(&block[n], &half, 2U); n += 2U;
+    half = 0U; memcpy(&block[n], &half, 2U); n += 2U;
+    value = CANFD_FRAME_SIZE; memcpy(&block[n], &value, 4U); n += 4U;
+    if (length)
+        n += put_option(&block[n], OPT_IF_NAME, name, (uint16_t)((length < MAX_NAME) ? length : MAX_NAME));
+    n += put_option(&block[n], OPT_IF_TSRESOL, &tsresol, 1U);
+    n += put_option(&block[n], OPT_ENDOFOPT, NULL, 0U);
+    block_size = (uint32_t)(n + 4U);
+    value = BLOCK_IDB; memcpy(&block[0], &value, 4U);
+    memcpy(&block[4], &block_size, 4U);
+    memcpy(&block[n], &block_size, 4U);
+    return append(pcap, block, block_size);
+}
+
+static int append(pcapng_file_t *pcap, const void *data, size_t length) {
+    assert(length <= pcap->size);
+    if ((pcap->used + length) > pcap->size) {
+        if (flush_buffer(pcap) < 0)
+            return -1;
+    }
+    memcpy(&pcap->buffer[pcap->used], data, length);
+    pcap->used += length;
+    return 0;
+}
+
+static int flush_buffer(pcapng_file_t *pcap) {
+    if (pcap->used) {
+        if (fwrite(pcap->buffer, pcap->used, 1, pcap->fp) != 1)
+            return -1;
+        pcap->written += pcap->used;
+        pcap->used = 0U;
+    }
+    return 0;
+}
+
+static size_t put_option(uint8_t *buffer, uint16_t code, const void *data, uint16_t length) {
+    memcpy(&buffer[0], &code, 2U);
+    memcpy(&buffer[2], &length, 2U);
+    if (length) {
+        memcpy(&buffer[4], data, length);
+        memset(&buffer[4U + length], 0, ALIGN4(length) - length);
+    }
+    return 4U + ALIGN4((size_t)length);
+}
+
+static char *copy_string(const char *string, size_t length) {
+    char *copy = (char*)malloc(length + 1U);
+
+    if (copy) {
+        memcpy(copy, string, length);
+        copy[length] = '\0';
+    }
+    return copy;
+}
+
+static void free_file(pcapng_file_t *pcap) {
+    if (pcap) {
+        if (pcap->fp)
+            (void)fclose(pcap->fp);
+        for (int i = 0; i < (int)PCAPNG_MAX_INTERFACES; i++)
+            free(pcap->names[i]);
+        free(pcap->stem);
+        free(pcap->ext);
+        free(pcap->application);
+        free(pcap->buffer);
+        free(pcap);
+    }
+}
+
+/** @}
+ */
+/*  ----------------------------------------------------------------------
+ *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
+ *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
+ *  E-Mail: uwe.vogt@uv-software.de,  Homepage: http://www.uv-software.de/
+ */
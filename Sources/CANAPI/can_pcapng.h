@@ -0,0 +1,181 @@
+/*  SPDX-License-Identifier: BSD-2-Clause OR GPL-3.0-or-later */
+/*
+ *  CAN Interface API, Version 3 (pcapng Writer)
+ *
+ *  Copyright (c) 2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+ *  All rights reserved.
+ *
+ *  This file is part of CAN API V3.
+ *
+ *  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+ *  and under the GNU General Public License v3.0 (or any later version).
+ *  You can choose between one of them if you use this file.
+ *
+ *  BSD 2-Clause "Simplified" License:
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  GNU General Public License v3.0 or later:
+ *  CAN API V3 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  CAN API V3 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with CAN API V3.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/** @file        can_pcapng.h
+ *
+ *  @brief       CAN Capture in pcapng Format (LINKTYPE_CAN_SOCKETCAN)
+ *
+ *  @remarks     The writer streams a Section Header Block, one Interface
+ *               Description Block per CAN interface (with nanosecond time
+ *               resolution) and an Enhanced Packet Block per CAN message.
+ *               The packet data is a SocketCAN frame (struct can_frame or
+ *               struct canfd_frame) with the CAN identifier in network byte
+ *               order, as expected by Wireshark and tcpdump.
+ *
+ *  @remarks     Optionally the capture is rotated into numbered files
+ *               (<name>_00001.pcapng, ...) by file size or by time.
+ *
+ *  @defgroup    can_pcapng CAN Capture in pcapng Format
+ *  @{
+ */
+#ifndef CAN_PCAPNG_H_INCLUDED
+#define CAN_PCAPNG_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*  -----------  includes  -----------------------------------------------
+ */
+
+#include "CANAPI_Types.h"               //   CAN API V3 message type
+
+#include <stdint.h>                     //   C99 header for sized integer types
+#include <stdbool.h>                    //   C99 header for boolean type
+
+
+/*  -----------  defines  ------------------------------------------------
+ */
+
+/** @name  pcapng Writer
+ *  @brief pcapng writer defaults and limits
+ *  @{ */
+#define PCAPNG_BUFFER_SIZE    1048576U  /**< default size of the write buffer */
+#define PCAPNG_BUFFER_MIN        4096U  /**< min. size of the write buffer */
+#define PCAPNG_MAX_INTERFACES      16U  /**< max. number of CAN interfaces */
+#define PCAPNG_LINKTYPE           227U  /**< LINKTYPE_CAN_SOCKETCAN */
+/** @} */
+
+
+/*  -----------  types  --------------------------------------------------
+ */
+
+typedef void *pcapng_writer_t;          /**< pcapng writer (opaque data type) */
+
+/** @brief  pcapng writer parameter
+ */
+typedef struct pcapng_param_t_ {        /* pcapng writer parameter: */
+    const char *application;            /**< application name (or NULL) */
+    uint32_t buffer_size;               /**< size of the write buffer (0 = default) */
+    uint64_t rotate_size;               /**< rotate after n bytes (0 = off) */
+    uint32_t rotate_time;               /**< rotate after n seconds (0 = off) */
+} pcapng_param_t;
+
+
+/*  -----------  prototypes  ---------------------------------------------
+ */
+
+/** @brief       creates a pcapng file for writing.
+ *
+ *  @remarks     With file rotation enabled a sequence number is inserted in
+ *               front of the file extension.
+ *
+ *  @param[in]   filename  - name of the pcapng file
+ *  @param[in]   param     - writer parameter (or NULL for defaults)
+ *
+ *  @returns     a pointer to a pcapng writer if successful, or NULL on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ */
+pcapng_writer_t pcapng_create(const char *filename, const pcapng_param_t *param);
+
+/** @brief       adds a CAN interface (Interface Description Block).
+ *
+ *  @param[in]   writer  - pointer to a pcapng writer
+ *  @param[in]   name    - name of the CAN interface (or NULL)
+ *
+ *  @returns     the interface id (0..n) if successful, or a negative value
+ *               on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ */
+int pcapng_add_interface(pcapng_writer_t writer, const char *name);
+
+/** @brief       writes a CAN message (Enhanced Packet Block).
+ *
+ *  @param[in]   writer     - pointer to a pcapng writer
+ *  @param[in]   interface  - interface id (from pcapng_add_interface)
+ *  @param[in]   message    - the message to be written (with time-stamp)
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ */
+int pcapng_write(pcapng_writer_t writer, int interface, const can_message_t *message);
+
+/** @brief       writes the buffered blocks to the file.
+ *
+ *  @param[in]   writer  - pointer to a pcapng writer
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ */
+int pcapng_flush(pcapng_writer_t writer);
+
+/** @brief       writes the buffered blocks and closes the pcapng file.
+ *
+ *  @param[in]   writer  - pointer to a pcapng writer
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ */
+int pcapng_close(pcapng_writer_t writer);
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* CAN_PCAPNG_H_INCLUDED */
+/** @}
+ */
+/*  ----------------------------------------------------------------------
+ *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
+ *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
+ *  E-Mail: uwe.vogt@uv-software.de,  Homepage: http://www.uv-software.de/
+ */
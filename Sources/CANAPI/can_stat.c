@@ -0,0 +1,291 @@
+/*  SPDX-License-Identifier: BSD-2-Clause OR GPL-3.0-or-later */
+/*
+ *  CAN Interface API, Version 3 (Statistics Helpers)
+ *
+ *  Copyright (c) 2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+ *  All rights reserved.
+ *
+ *  This file is part of CAN API V3.
+ *
+ *  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+ *  and under the GNU General Public License v3.0 (or any later version).
+ *  You can choose between one of them if you use this file.
+ *
+ *  BSD 2-Clause "Simplified" License:
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  GNU General Public License v3.0 or later:
+ *  CAN API V3 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  CAN API V3 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with CAN API V3.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/** @file        can_stat.c
+ *
+ *  @brief       CAN Statistics Helpers (for the companion tools)
+ *
+ *  @addtogroup  can_stat
+ *  @{
+ */
+
+
+/*  -----------  includes  -----------------------------------------------
+ */
+
+#include "can_stat.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+
+
+/*  -----------  defines  ------------------------------------------------
+ */
+
+#define HASH(id,mask)  ((size_t)(((uint32_t)(id) * 0x9E3779B1U) >> 8) & (mask))
+
+
+/*  -----------  prototypes  ---------------------------------------------
+ */
+
+static int rehash(stat_idmap_t *map);
+static unsigned histo_index(uint64_t value);
+static uint64_t histo_highest(unsigned index);
+
+
+/*  -----------  variables  ----------------------------------------------
+ */
+
+
+/*  -----------  functions  ----------------------------------------------
+ */
+
+int stat_idmap_init(stat_idmap_t *map, size_t size) {
+    size_t slots = 1U;
+
+    errno = 0;
+    if (!map) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!size)
+        size = STAT_IDMAP_SIZE;
+    while (slots < size)
+        slots <<= 1;
+    memset(map, 0, sizeof(stat_idmap_t));
+    if (((map->slots = (uint32_t*)calloc(slots, sizeof(uint32_t))) == NULL) ||
+        ((map->ids = (uint32_t*)calloc(slots, sizeof(uint32_t))) == NULL)) {
+        stat_idmap_free(map);
+        errno = ENOMEM;
+        return -1;
+    }
+    map->size = slots;
+    return 0;
+}
+
+int stat_idmap_lookup(stat_idmap_t *map, uint32_t id, size_t *index) {
+    size_t slot;
+
+    errno = 0;
+    if (!map || !map->slots || !index) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* open addressing with linear probing */
+    slot = HASH(id, map->size - 1U);
+    while (map->slots[slot]) {
+        if (map->ids[slot] == id) {
+            *index = (size_t)(map->slots[slot] - 1U);
+            return 0;
+        }
+        slot = (slot + 1U) & (map->size - 1U);
+    }
+    /* new identifier: insert it (max. load factor 0.7) */
+    if (((map->count + 1U) * 10U) > (map->size * 7U)) {
+        if (rehash(map) < 0)
+            return -1;
+        slot = HASH(id, map->size - 1U);
+        while (map->slots[slot])
+            slot = (slot + 1U) & (map->size - 1U);
+    }
+    map->slots[slot] = (uint32_t)(map->count + 1U);
+    map->ids[slot] = id;
+    *index = map->count++;
+    return 1;
+}
+
+void stat_idmap_free(stat_idmap_t *map) {
+    if (map) {
+        free(map->slots);
+        free(map->ids);
+        memset(map, 0, sizeof(stat_idmap_t));
+    }
+}
+
+void stat_histo_reset(stat_histo_t *histo) {
+    if (!histo)
+        return;
+    memset(histo->counts, 0, sizeof(histo->counts));
+    histo->total = 0U;
+    histo->min = UINT64_MAX;
+    histo->max = 0U;
+    histo->sum = 0.0;
+}
+
+void stat_histo_record(stat_histo_t *histo, uint64_t value) {
+    if (!histo)
+        return;
+    histo->counts[histo_index(value)]++;
+    histo->total++;
+    if (value < histo->min)
+        histo->min = value;
+    if (value > histo->max)
+        histo->max = value;
+    histo->sum += (double)value;
+}
+
+void stat_histo_add(stat_histo_t *histo, const stat_histo_t *other) {
+    unsigned i;
+
+    if (!histo || !other || !other->total)
+        return;
+    for (i = 0U; i < STAT_HISTO_BUCKETS; i++)
+        histo->counts[i] += other->counts[i];
+    histo->total += other->total;
+    if (other->min < histo->min)
+        histo->min = other->min;
+    if (other->max > histo->max)
+        histo->max = other->max;
+    histo->sum += other->sum;
+}
+
+uint64_t stat_histo_percentile(const stat_histo_t *histo, double percentile) {
+    uint64_t target, count = 0U, value;
+    unsigned i;
+
+    if (!histo || !histo->total)
+        return 0U;
+    if (percentile >= 100.0)
+        return histo->max;
+    /* the smallest value with at least the given percentage below or equal */
+    target = (uint64_t)ceil((percentile / 100.0) * (double)histo->total);
+    if (target == 0U)
+        target = 1U;
+    for (i = 0U; i < STAT_HISTO_BUCKETS; i++) {
+        count += histo->counts[i];
+        if (count >= target) {
+            value = histo_highest(i);
+            return (value < histo->max) ? value : histo->max;
+        }
+    }
+    return histo->max;
+}
+
+uint64_t stat_frame_bits(const can_message_t *message, double data_ratio) {
+    uint64_t length;
+
+    if (!message)
+        return 0U;
+    length = message->rtr ? 0U : (uint64_t)CANFD_DLC2LEN(message->dlc & 0xFU);
+#if (OPTION_CAN_2_0_ONLY == 0)
+    if (message->fdf) {
+        /* arbitration phase + ACK, EOF and IFS at the nominal bit-rate,
+         * data phase (ESI, DLC, data, stuff count, CRC) at the data bit-rate */
+        uint64_t arbitration = (message->xtd ? 36U : 17U) + 12U;
+        uint64_t data = 5U + 8U * length + 4U + ((length <= 16U) ? 17U : 21U) + 1U;
+        if (message->brs)
+            return arbitration + (uint64_t)((double)data * data_ratio + 0.5);
+        return arbitration + data;
+    }
+#else
+    (void)data_ratio;
+#endif
+    /* classic frame: 47 bits (11-bit) or 67 bits (29-bit) + data */
+    return (message->xtd ? 67U : 47U) + 8U * length;
+}
+
+
+/*  -----------  local functions  ----------------------------------------
+ */
+
+static int rehash(stat_idmap_t *map) {
+    size_t size = map->size << 1;
+    uint32_t *slots, *ids;
+    size_t i, slot;
+
+    if (((slots = (uint32_t*)calloc(size, sizeof(uint32_t))) == NULL) ||
+        ((ids = (uint32_t*)calloc(size, sizeof(uint32_t))) == NULL)) {
+        free(slots);
+        errno = ENOMEM;
+        return -1;
+    }
+    for (i = 0U; i < map->size; i++) {
+        if (!map->slots[i])
+            continue;
+        slot = HASH(map->ids[i], size - 1U);
+        while (slots[slot])
+            slot = (slot + 1U) & (size - 1U);
+        slots[slot] = map->slots[i];
+        ids[slot] = map->ids[i];
+    }
+    free(map->slots);
+    free(map->ids);
+    map->slots = slots;
+    map->ids = ids;
+    map->size = size;
+    return 0;
+}
+
+static unsigned histo_index(uint64_t value) {
+    unsigned msb = 0U, shift;
+    uint64_t v;
+
+    /* note: values below 2^SUB_BITS are recorded exactly */
+    if (value < ((uint64_t)1 << STAT_HISTO_SUB_BITS))
+        return (unsigned)value;
+    for (v = value; v >>= 1; )
+        msb++;
+    shift = msb - (STAT_HISTO_SUB_BITS - 1U);
+    return (shift * STAT_HISTO_SUB_HALF) + (unsigned)(value >> shift);
+}
+
+static uint64_t histo_highest(unsigned index) {
+    unsigned shift = (index < (2U * STAT_HISTO_SUB_HALF)) ? 0U : (index / STAT_HISTO_SUB_HALF) - 1U;
+    uint64_t sub = (uint64_t)(index - (shift * STAT_HISTO_SUB_HALF));
+
+    return ((sub + 1U) << shift) - 1U;
+}
+
+/** @}
+ */
+/*  ----------------------------------------------------------------------
+ *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
+ *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
+ *  E-Mail: uwe.vogt@uv-software.de,  Homepage: http://www.uv-software.de/
+ */
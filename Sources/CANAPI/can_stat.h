@@ -0,0 +1,215 @@
+/*  SPDX-License-Identifier: BSD-2-Clause OR GPL-3.0-or-later */
+/*
+ *  CAN Interface API, Version 3 (Statistics Helpers)
+ *
+ *  Copyright (c) 2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+ *  All rights reserved.
+ *
+ *  This file is part of CAN API V3.
+ *
+ *  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+ *  and under the GNU General Public License v3.0 (or any later version).
+ *  You can choose between one of them if you use this file.
+ *
+ *  BSD 2-Clause "Simplified" License:
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  GNU General Public License v3.0 or later:
+ *  CAN API V3 is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  CAN API V3 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with CAN API V3.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/** @file        can_stat.h
+ *
+ *  @brief       CAN Statistics Helpers (for the companion tools)
+ *
+ *  @remarks     Identifier map: 29-bit identifiers are mapped onto a dense
+ *               index (0, 1, 2, ... in the order of their appearance) by an
+ *               open-addressing hash table with linear probing. The caller
+ *               keeps its per-identifier data in an array at this index.
+ *
+ *               Histogram: high-dynamic-range histogram with log-linear
+ *               buckets. Values are recorded with a relative error of less
+ *               than 1/2^(STAT_HISTO_SUB_BITS-1) (0.8%) over the full 64-bit
+ *               range, e.g. 1ns to some hours. Recording a value is O(1)
+ *               and does not allocate memory.
+ *
+ *               Bit times: the length of a CAN frame in bits at the nominal
+ *               bit-rate, without stuff bits but including the intermission
+ *               (e.g. to compute the bus load).
+ *
+ *  @defgroup    can_stat CAN Statistics Helpers
+ *  @{
+ */
+#ifndef CAN_STAT_H_INCLUDED
+#define CAN_STAT_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*  -----------  includes  -----------------------------------------------
+ */
+
+#include "CANAPI_Types.h"               //   CAN API V3 message type
+
+#include <stdint.h>                     //   C99 header for sized integer types
+#include <stddef.h>                     //   C99 header for size_t
+
+
+/*  -----------  defines  ------------------------------------------------
+ */
+
+/** @name  Identifier Map
+ *  @brief Identifier map defaults
+ *  @{ */
+#define STAT_IDMAP_SIZE          4096U  /**< default number of slots (power of 2) */
+/** @} */
+
+/** @name  Histogram
+ *  @brief Histogram resolution
+ *  @{ */
+#define STAT_HISTO_SUB_BITS         8U  /**< 256 sub-buckets per power of 2 */
+#define STAT_HISTO_SUB_HALF  (1U << (STAT_HISTO_SUB_BITS - 1U))
+#define STAT_HISTO_BUCKETS   ((64U - STAT_HISTO_SUB_BITS + 2U) * STAT_HISTO_SUB_HALF)
+/** @} */
+
+
+/*  -----------  types  --------------------------------------------------
+ */
+
+/** @brief  Identifier map (open-addressing hash table)
+ */
+typedef struct stat_idmap_t_ {          /* identifier map: */
+    uint32_t *slots;                    /**< index + 1 per slot (0 = free) */
+    uint32_t *ids;                      /**< identifier per slot */
+    size_t size;                        /**< number of slots (power of 2) */
+    size_t count;                       /**< number of identifiers */
+} stat_idmap_t;
+
+/** @brief  Histogram (log-linear buckets)
+ */
+typedef struct stat_histo_t_ {          /* histogram: */
+    uint64_t counts[STAT_HISTO_BUCKETS];/**< counts per bucket */
+    uint64_t total;                     /**< number of recorded values */
+    uint64_t min;                       /**< exact min. value (UINT64_MAX if empty) */
+    uint64_t max;                       /**< exact max. value */
+    double sum;                         /**< sum of all values (for the mean) */
+} stat_histo_t;
+
+
+/*  -----------  prototypes  ---------------------------------------------
+ */
+
+/** @brief       initializes an identifier map.
+ *
+ *  @param[out]  map   - pointer to an identifier map
+ *  @param[in]   size  - initial number of slots (0 = default, rounded up to a power of 2)
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ */
+int stat_idmap_init(stat_idmap_t *map, size_t size);
+
+/** @brief       looks up an identifier and inserts it if it is new.
+ *
+ *  @remarks     The table is doubled when its load factor exceeds 0.7.
+ *
+ *  @param[in]   map    - pointer to an identifier map
+ *  @param[in]   id     - CAN identifier
+ *  @param[out]  index  - dense index of the identifier
+ *
+ *  @returns     0 if the identifier was found, 1 if it was inserted (its
+ *               index is the previous number of identifiers), or a negative
+ *               value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ */
+int stat_idmap_lookup(stat_idmap_t *map, uint32_t id, size_t *index);
+
+/** @brief       releases the memory of an identifier map.
+ *
+ *  @param[in]   map  - pointer to an identifier map
+ */
+void stat_idmap_free(stat_idmap_t *map);
+
+/** @brief       clears a histogram.
+ *
+ *  @param[out]  histo  - pointer to a histogram
+ */
+void stat_histo_reset(stat_histo_t *histo);
+
+/** @brief       records a value in a histogram.
+ *
+ *  @param[in]   histo  - pointer to a histogram
+ *  @param[in]   value  - value to be recorded
+ */
+void stat_histo_record(stat_histo_t *histo, uint64_t value);
+
+/** @brief       adds the counts of another histogram to a histogram.
+ *
+ *  @param[in]   histo  - pointer to a histogram
+ *  @param[in]   other  - pointer to the histogram to be added
+ */
+void stat_histo_add(stat_histo_t *histo, const stat_histo_t *other);
+
+/** @brief       returns the smallest value with at least the given percentage
+ *               of the recorded values below or equal to it.
+ *
+ *  @remarks     The value is the highest value equivalent to its bucket,
+ *               but not greater than the max. value recorded.
+ *
+ *  @param[in]   histo       - pointer to a histogram
+ *  @param[in]   percentile  - percentile (0.0 .. 100.0)
+ *
+ *  @returns     the value, or 0 if the histogram is empty.
+ */
+uint64_t stat_histo_percentile(const stat_histo_t *histo, double percentile);
+
+/** @brief       returns the length of a CAN frame in bit times (at the nominal
+ *               bit-rate, without stuff bits, including the intermission).
+ *
+ *  @remarks     The data phase of a CAN FD frame with bit-rate switching is
+ *               scaled by the ratio of the nominal to the data bit-rate.
+ *
+ *  @param[in]   message     - pointer to a CAN message
+ *  @param[in]   data_ratio  - nominal bit-rate / data bit-rate (CAN FD with BRS)
+ *
+ *  @returns     the number of bit times, or 0 if the message is NULL.
+ */
+uint64_t stat_frame_bits(const can_message_t *message, double data_ratio);
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* CAN_STAT_H_INCLUDED */
+/** @}
+ */
@@ -66,6 +66,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <time.h>
 
 
 /*  -----------  options  ------------------------------------------------
@@ -159,6 +160,28 @@ extern int buffer_clear(buffer_t buffer);
 extern int buffer_put(buffer_t buffer, const void *data, size_t nbytes);
 
 
+/** @brief       appends n data bytes to the buffer, if there is enough room.
+ *
+ *  @remarks     Other than 'buffer_put' the function does not require an empty
+ *               buffer, so that several responses can be collected by one call
+ *               of 'buffer_get'. Data bytes are not truncated.
+ *
+ *  @param[in]   buffer  - pointer to a buffer instance
+ *  @param[in]   data    - data to be appended to the buffer
+ *  @param[in]   nbytes  - number of bytes to be appended to the buffer
+ *
+ *  @returns     the number of bytes appended to the buffer if successful, or
+ *               a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      EFAULT  - bad address (invalid buffer instance)
+ *  @retval      EINVAL  - invalid argument (data or nbytes)
+ *  @retval      ENOSPC  - no space left (not enough room)
+ */
+extern int buffer_append(buffer_t buffer, const void *data, size_t nbytes);
+
+
 /** @brief       copies the data bytes from the buffer, if any.
  *
  *  @remark      The buffer content is entirely emptied after this.
@@ -184,6 +207,32 @@ extern int buffer_put(buffer_t buffer, const void *data, size_t nbytes);
 extern int buffer_get(buffer_t buffer, void *data, size_t maxbytes, uint16_t timeout);
 
 
+/** @brief       copies the buffer content into data, if any, and waits for it
+ *               not longer than until the given deadline.
+ *
+ *  @remark      The deadline is an absolute time of the monotonic clock (see
+ *               'queue_dequeue_until').  A deadline that has already passed
+ *               means polling.
+ *
+ *  @param[in]   buffer   - pointer to a buffer instance
+ *  @param[out]  data     - pointer to an array into which the data are copied
+ *  @param[in]   maxbytes - maximum number of bytes to be copied from the buffer
+ *  @param[in]   deadline - absolute time until to wait for data available
+ *                          in the buffer, or NULL for a blocking read
+ *
+ *  @returns     the number of bytes copied from the buffer if successful, or
+ *               a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      EFAULT    - bad address (invalid buffer instance)
+ *  @retval      EINVAL    - invalid argument (data or maxbytes)
+ *  @retval      ENOMSG    - no data available (polling)
+ *  @retval      ETIMEDOUT - timed out (blocking read)
+ */
+extern int buffer_get_until(buffer_t buffer, void *data, size_t maxbytes, const struct timespec *deadline);
+
+
 /** @brief       signals waiting objects, if any.
  *
  *  @param[in]   buffer  - pointer to a buffer instance
@@ -81,13 +81,8 @@
 #define ENTER_CRITICAL_SECTION(buf)  assert(0 == pthread_mutex_lock(&buf->wait.mutex))
 #define LEAVE_CRITICAL_SECTION(buf)  assert(0 == pthread_mutex_unlock(&buf->wait.mutex))
 
-#define GET_TIME(ts)  do{ clock_gettime(CLOCK_REALTIME, &ts); } while(0)
-#define ADD_TIME(ts,to)  do{ ts.tv_sec += (time_t)(to / 1000U); \
-                             ts.tv_nsec += (long)(to % 1000U) * (long)1000000; \
-                             if (ts.tv_nsec >= (long)1000000000) { \
-                                 ts.tv_nsec %= (long)1000000000; \
-                                 ts.tv_sec += (time_t)1; \
-                             } } while(0)
+#define NO_WAIT       0U               /* deadline: polling */
+#define WAIT_FOREVER  UINT64_MAX       /* deadline: infinite blocking read */
 
 #define SIGNAL_WAIT_CONDITION(buf,flg)  do{ buf->wait.flag = flg; \
                                             assert(0 == pthread_cond_signal(&buf->wait.cond)); } while(0)
@@ -114,6 +109,11 @@ typedef struct object_t_ {
 /*  -----------  prototypes  ---------------------------------------------
  */
 
+static int get_wait(object_t *buffer, void *data, size_t maxbytes, uint64_t deadline);
+
+static int init_condition(pthread_cond_t *cond);
+static void wait_time(struct timespec *abstime, uint64_t deadline);
+static uint64_t get_nanos(void);
 
 /*  -----------  variables  ----------------------------------------------
  */
@@ -145,7 +145,7 @@ buffer_t buffer_create(size_t size) {
         object->nbytes = 0;
         /* create a mutex and a waitable condition */
         if ((pthread_mutex_init(&object->wait.mutex, NULL) < 0) ||
-            (pthread_cond_init(&object->wait.cond, NULL)) < 0) {
+            (init_condition(&object->wait.cond) != 0)) {
             /* errno set */
             free(object->data);
             free(object);
@@ -242,15 +242,63 @@ int buffer_put(buffer_t buffer, const void *data, size_t nbytes) {
     return res;
 }
 
-int buffer_get(buffer_t buffer, void *data, size_t maxbytes, uint16_t timeout) {
+int buffer_append(buffer_t buffer, const void *data, size_t nbytes) {
     object_t *object = (object_t*)buffer;
     int res = 0;
+
+    /* sanity check */
+    errno = 0;
+    if (!object || !object->data) {
+        errno = EFAULT;
+        return -1;
+    }
+    if (!data || !nbytes) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* append data to the buffer, if there is enough room */
+    ENTER_CRITICAL_SECTION(object);
+    if ((object->nbytes + nbytes) <= object->maxbytes) {
+        memcpy(&((uint8_t*)object->data)[object->nbytes], data, nbytes);
+        object->nbytes += nbytes;
+        SIGNAL_WAIT_CONDITION(object, true);
+        res = (int)nbytes;
+    } else {  /* no room */
+        errno = ENOSPC;
+    }
+    LEAVE_CRITICAL_SECTION(object);
+    /* return number of bytes copied */
+    return res;
+}
+
+int buffer_get(buffer_t buffer, void *data, size_t maxbytes, uint16_t timeout) {
+    uint64_t deadline = NO_WAIT;
+
+    /* the time-out (in [ms]) is taken as deadline from the monotonic clock */
+    if (timeout == 65535U)
+        deadline = WAIT_FOREVER;
+    else if (timeout != 0U)
+        deadline = get_nanos() + ((uint64_t)timeout * 1000000U);
+    return get_wait((object_t*)buffer, data, maxbytes, deadline);
+}
+
+int buffer_get_until(buffer_t buffer, void *data, size_t maxbytes, const struct timespec *deadline) {
+    uint64_t until = WAIT_FOREVER;
+
+    /* a deadline that has already passed means polling */
+    if (deadline) {
+        until = ((uint64_t)deadline->tv_sec * 1000000000U) + (uint64_t)deadline->tv_nsec;
+        if (until <= get_nanos())
+            until = NO_WAIT;
+    }
+    return get_wait((object_t*)buffer, data, maxbytes, until);
+}
+
+static int get_wait(object_t *object, void *data, size_t maxbytes, uint64_t deadline) {
+    int res = 0;
     int waitCond = 0;
     struct timespec absTime;
 
-    GET_TIME(absTime);
-    ADD_TIME(absTime, timeout);
-
     /* sanity check */
     errno = 0;
     if (!object || !object->data) {
@@ -269,19 +317,20 @@ again:
         res = (int)MIN(object->nbytes, maxbytes);
         object->nbytes = 0;
     } else {
-        if (timeout == 65535U) {  /* infinite blocking read */
+        if (deadline == WAIT_FOREVER) {  /* infinite blocking read */
             WAIT_CONDITION_INFINITE(object, waitCond);
             if ((waitCond == 0) && object->wait.flag)
                 goto again;
             else
                 errno = ENOMSG;
-        } else if (timeout != 0U) {  /* timed blocking read */
+        } else if (deadline != NO_WAIT) {  /* timed blocking read */
+            wait_time(&absTime, deadline);
             WAIT_CONDITION_TIMEOUT(object, absTime, waitCond);
             if ((waitCond == 0) && object->wait.flag)
                 goto again;
             else
                 errno = ETIMEDOUT;
-        } else {  /* polling (timeout == 0) */
+        } else {  /* polling (no deadline) */
             errno = ENOMSG;
         }
     }
@@ -290,6 +339,43 @@ again:
     return res;
 }
 
+static int init_condition(pthread_cond_t *cond) {
+    pthread_condattr_t attr;
+    int res;
+
+    if ((res = pthread_condattr_init(&attr)) != 0)
+        return res;
+#if !defined(__APPLE__)
+    /* note: the wait condition is timed by the monotonic clock (not on macOS) */
+    if ((res = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC)) == 0)
+#endif
+        res = pthread_cond_init(cond, &attr);
+    (void)pthread_condattr_destroy(&attr);
+    return res;
+}
+
+static void wait_time(struct timespec *abstime, uint64_t deadline) {
+#if !defined(__APPLE__)
+    abstime->tv_sec = (time_t)(deadline / 1000000000U);
+    abstime->tv_nsec = (long)(deadline % 1000000000U);
+#else
+    uint64_t now = get_nanos();
+    uint64_t rel = (deadline > now) ? (deadline - now) : 0U;
+
+    (void)clock_gettime(CLOCK_REALTIME, abstime);
+    rel += (uint64_t)abstime->tv_nsec;
+    abstime->tv_sec += (time_t)(rel / 1000000000U);
+    abstime->tv_nsec = (long)(rel % 1000000000U);
+#endif
+}
+
+static uint64_t get_nanos(void) {
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000U) + (uint64_t)now.tv_nsec;
+}
+
 /*  ----------------------------------------------------------------------
  *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
  *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
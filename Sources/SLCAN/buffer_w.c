@@ -95,6 +95,7 @@ typedef struct object_t_ {
 /*  -----------  prototypes  ---------------------------------------------
  */
 
+static uint64_t get_nanos(void);
 
 /*  -----------  variables  ----------------------------------------------
  */
@@ -226,6 +227,35 @@ int buffer_put(buffer_t buffer, const void *data, size_t nbytes) {
     return res;
 }
 
+int buffer_append(buffer_t buffer, const void *data, size_t nbytes) {
+    object_t *object = (object_t*)buffer;
+    int res = 0;
+
+    /* sanity check */
+    errno = 0;
+    if (!object || !object->data) {
+        errno = EFAULT;
+        return -1;
+    }
+    if (!data || !nbytes) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* append data to the buffer, if there is enough room */
+    ENTER_CRITICAL_SECTION(object);
+    if ((object->nbytes + nbytes) <= object->maxbytes) {
+        memcpy(&((uint8_t*)object->data)[object->nbytes], data, nbytes);
+        object->nbytes += nbytes;
+        (void)SetEvent(object->hEvent);
+        res = (int)nbytes;
+    } else {  /* no room */
+        errno = ENOSPC;
+    }
+    LEAVE_CRITICAL_SECTION(object);
+    /* return number of bytes copied */
+    return res;
+}
+
 int buffer_get(buffer_t buffer, void *data, size_t maxbytes, uint16_t timeout) {
     object_t *object = (object_t*)buffer;
     int res = 0;
@@ -281,6 +311,30 @@ int buffer_get(buffer_t buffer, void *data, size_t maxbytes, uint16_t timeout) {
     return res;
 }
 
+int buffer_get_until(buffer_t buffer, void *data, size_t maxbytes, const struct timespec *deadline) {
+    uint64_t until, now;
+
+    /* note: the event object is waited for in milliseconds, so the time to
+     *       the deadline is rounded up (and limited to 65534 milliseconds).
+     */
+    if (!deadline)
+        return buffer_get(buffer, data, maxbytes, 65535U);
+    until = ((uint64_t)deadline->tv_sec * 1000000000U) + (uint64_t)deadline->tv_nsec;
+    now = get_nanos();
+    if (until <= now)
+        return buffer_get(buffer, data, maxbytes, 0U);
+    return buffer_get(buffer, data, maxbytes, (uint16_t)MIN((until - now + 999999U) / 1000000U, 65534U));
+}
+
+static uint64_t get_nanos(void) {
+    LARGE_INTEGER counter, frequency;
+
+    (void)QueryPerformanceFrequency(&frequency);
+    (void)QueryPerformanceCounter(&counter);
+    return ((uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000U) +
+           (((uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000U) / (uint64_t)frequency.QuadPart);
+}
+
 /*  ----------------------------------------------------------------------
  *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
  *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
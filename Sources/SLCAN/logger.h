@@ -49,6 +49,12 @@
  *
  *  @brief       Writing log messages into an ASCII file.
  *
+ *  @remarks     The POSIX variant writes fixed-size binary records with
+ *               time-stamps into a lock-free ring per thread; a background
+ *               thread drains the rings and formats the records lazily
+ *               (or dumps them binary). The trace level can be changed
+ *               at run-time and costs a single compare when disabled.
+ *
  *  @author      $Author: quaoar $
  *
  *  @version     $Rev: 811 $
@@ -70,6 +76,15 @@
 /*  -----------  defines  ------------------------------------------------
  */
 
+#define LOG_LEVEL_OFF    0              /**< tracing disabled */
+#define LOG_LEVEL_ERROR  1              /**< error messages */
+#define LOG_LEVEL_INFO   2              /**< information messages */
+#define LOG_LEVEL_DATA   3              /**< sent and received data */
+
+/** @brief       tests if the given trace level is enabled (and the logger opened).
+ */
+#define LOG_ENABLED(level)  (log_trace_level >= (level))
+
 
 /*  -----------  types  --------------------------------------------------
  */
@@ -78,6 +93,8 @@
 /*  -----------  variables  ----------------------------------------------
  */
 
+extern volatile int log_trace_level;    /**< active trace level (0 = logger closed) */
+
 
 /*  -----------  prototypes  ---------------------------------------------
  */
@@ -142,6 +159,29 @@ extern int log_async(const uint8_t *buffer, size_t nbytes);
 extern int log_printf(const char *format, ...);
 
 
+/** @brief       sets the trace level (LOG_LEVEL_OFF to LOG_LEVEL_DATA).
+ *
+ *  @remarks     The trace level can be set before and after the log file
+ *               is opened. It takes effect by the macro LOG_ENABLED.
+ *
+ *  @param[in]   level - trace level (default LOG_LEVEL_DATA)
+ *
+ *  @returns     the previous trace level, or a negative value on error
+ */
+extern int log_set_level(int level);
+
+
+/** @brief       selects binary output (raw trace records) instead of ASCII.
+ *
+ *  @remarks     This function must be called before the log file is opened.
+ *
+ *  @param[in]   binary - non-zero to dump the trace records binary
+ *
+ *  @returns     0 if successful, or a negative value on error
+ */
+extern int log_set_binary(int binary);
+
+
 #ifdef __cplusplus
 }
 #endif
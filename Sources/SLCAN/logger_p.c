@@ -51,26 +51,21 @@
  *
  *  @remarks     POSIX compatible variant (e.g. Linux, macOS)
  *
- *  @author      $Author: quaoar $
- *
- *  @version     $Rev: 811 $
- *
  *  @addtogroup  logger
  *  @{
  */
 #include "logger.h"
 
 #include <inttypes.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
 #include <errno.h>
 #include <time.h>
 
 #include <unistd.h>
-#include <assert.h>
+#include <sched.h>
 #include <pthread.h>
-#include <sys/select.h>
-#include <sys/time.h>
 
 
 /*  -----------  options  ------------------------------------------------
@@ -86,27 +81,84 @@
 #ifndef LOG_CONSOLE
 #define LOG_CONSOLE  stderr
 #endif
-#define PIPO  0  /* read from pipe */
-#define PIPI  1  /* write into pipe */
+#ifndef LOG_MAX_THREADS
+#define LOG_MAX_THREADS  16
+#endif
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE  1024             /* records per thread (power of 2) */
+#endif
+#define LOG_RING_MASK  (LOG_RING_SIZE - 1U)
+#define LOG_REC_DATA  48                /* payload per record */
+#define LOG_DRAIN_INTERVAL  10000000L   /* drain the rings every 10ms */
+
+#define LOG_REC_HEADER  0               /* file header (binary) */
+#define LOG_REC_SYNC  1                 /* data from the owner (>>>) */
+#define LOG_REC_ASYNC  2                /* data from other threads (<<<) */
+#define LOG_REC_TEXT  3                 /* formatted string (+++) */
+#define LOG_REC_MORE  0x01U             /* continued in the next record */
+
+#define RING_FREE  0                    /* ring not owned by a thread */
+#define RING_USED  1                    /* ring owned by a thread */
+#define RING_CLOSED  2                  /* thread terminated (to be drained) */
 
 
 /*  -----------  types  --------------------------------------------------
  */
 
+typedef struct log_record_tag {         /* trace record (64 bytes): */
+    uint64_t time;                      /*   time-stamp (CLOCK_MONOTONIC) */
+    uint32_t dropped;                   /*   records dropped before this */
+    uint8_t type;                       /*   record type */
+    uint8_t flags;                      /*   record flags */
+    uint8_t length;                     /*   length of the payload */
+    uint8_t thread;                     /*   ring index */
+    uint8_t data[LOG_REC_DATA];         /*   payload */
+} log_record_t;
+
+typedef struct log_ring_tag {           /* trace ring (one per thread): */
+    uint32_t head;                      /*   written by the owner thread */
+    uint32_t tail;                      /*   written by the drainer */
+    int state;                          /*   RING_FREE, RING_USED, RING_CLOSED */
+    uint32_t dropped;                   /*   records dropped (owner thread) */
+    uint8_t index;                      /*   ring index */
+    log_record_t records[LOG_RING_SIZE];
+} log_ring_t;
+
 
 /*  -----------  prototypes  ---------------------------------------------
  */
 
 static void *logging(void *arg);
+static void release(void *arg);
+static log_ring_t *ring_self(void);
+static uint32_t ring_pin(int index);
+static void ring_unpin(int index);
+static int ring_write(uint8_t type, const uint8_t *buffer, size_t nbytes);
+static void drain(void);
+static uint64_t get_time(void);
 
 
 /*  -----------  variables  ----------------------------------------------
  */
 
+volatile int log_trace_level = LOG_LEVEL_OFF;
+
 static pthread_t thread;
-static pthread_mutex_t mutex;
-static int fildes[2] = {-1, -1};
+static pthread_key_t key;
+static volatile int running = 0;
 static FILE *logger = NULL;
+static int level = LOG_LEVEL_DATA;
+static int binary = 0;
+static uint64_t start = 0U;
+static uint32_t generation = 0U;     /* odd while the logger is running */
+static uint32_t lost = 0U;
+static log_ring_t *rings[LOG_MAX_THREADS];
+static uint32_t writers[LOG_MAX_THREADS];
+static uint64_t counter[LOG_REC_TEXT+1];
+static __thread log_ring_t *self = NULL;
+static __thread uint32_t self_gen = 0U;
+static __thread int self_idx = 0;
+static __thread int self_cancel = PTHREAD_CANCEL_ENABLE;
 
 
 /*  -----------  functions  ----------------------------------------------
@@ -114,114 +166,124 @@ static FILE *logger = NULL;
 
 int log_init(const char *pathname/*, flags*/)
 {
+    log_record_t header;
+
     /* sanity check */
     errno = 0;
     if (logger) {
         errno = EALREADY;
         return -1;
     }
-    /* create a pipe for log messages from a critical thread */
-    if (pipe(fildes) < 0) {
-        /* errno set */
-        return -1;
-    }
-    /* create a mutex for mutual write operations into the log file */
-    if (pthread_mutex_init(&mutex, NULL) < 0) {
-        /* errno set */
-        close(fildes[PIPI]);
-        close(fildes[PIPO]);
-        return -1;
-    }
-    /* create a logging thread for log messages from other threads */
-    if (pthread_create(&thread, NULL, logging, NULL) < 0) {
-        /* errno set */
-        pthread_mutex_destroy(&mutex);
-        close(fildes[PIPI]);
-        close(fildes[PIPO]);
+    /* create a key to release the ring of a terminated thread */
+    if (pthread_key_create(&key, release) != 0) {
+        errno = ENOMEM;
         return -1;
     }
     /* open a log file (or use stderr when not given) */
     if (pathname) {
-        if ((logger = fopen(pathname, "w+")) == NULL) {
+        if ((logger = fopen(pathname, binary ? "wb" : "w+")) == NULL) {
             /* errno set */
-            pthread_mutex_destroy(&mutex);
-            close(fildes[PIPI]);
-            close(fildes[PIPO]);
+            pthread_key_delete(key);
             return -1;
         }
     }
     else {
         logger = LOG_CONSOLE;
     }
+    memset(rings, 0, sizeof(rings));
+    memset(counter, 0, sizeof(counter));
+    lost = 0U;
+    start = get_time();
+    __atomic_add_fetch(&generation, 1U, __ATOMIC_SEQ_CST);
     /* write a header into the log file */
-    time_t now = time(NULL);
-    char *str = ctime(&now);
-    str[strlen(str)-1] = '\0';
-    fprintf(logger, "+++ uv-software Logger (%s) +++\n", str);
+    if (binary) {
+        memset(&header, 0, sizeof(log_record_t));
+        header.time = start;
+        header.type = LOG_REC_HEADER;
+        header.length = (uint8_t)sizeof(log_record_t);
+        strcpy((char*)header.data, "uv-software Logger");
+        (void)fwrite(&header, sizeof(log_record_t), 1, logger);
+    }
+    else {
+        time_t now = time(NULL);
+        char *str = ctime(&now);
+        str[strlen(str)-1] = '\0';
+        fprintf(logger, "+++ uv-software Logger (%s) +++\n", str);
+    }
+    /* create a logging thread that drains the rings */
+    __atomic_store_n(&running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&thread, NULL, logging, NULL) != 0) {
+        __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+        if (logger != LOG_CONSOLE)
+            fclose(logger);
+        logger = NULL;
+        pthread_key_delete(key);
+        errno = ENOMEM;
+        return -1;
+    }
+    __atomic_store_n(&log_trace_level, level, __ATOMIC_RELEASE);
     return 0;
 }
 
 int log_exit(void)
 {
+    int i;
+
     /* sanity check */
     errno = 0;
     if (!logger) {
         errno = EBADF;
         return -1;
     }
-    /* kill the logging thread and release all resources */
-    if (pthread_cancel(thread) == 0) {
-#if (1)
-        assert(pthread_join(thread, NULL) == 0);
-#else
-        void *res;
-        pthread_join(thread, &res);
-        if (res != PTHREAD_CANCELED)
-            fprintf(stderr, "+++ error: worker thread not cancelled!\n");
-#endif
-    }
-    assert(pthread_mutex_destroy(&mutex) == 0);
-    assert(close(fildes[PIPI]) == 0);
-    assert(close(fildes[PIPO]) == 0);
+    /* stop tracing and the logging thread, then drain the rest */
+    __atomic_store_n(&log_trace_level, LOG_LEVEL_OFF, __ATOMIC_RELEASE);
+    __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+    (void)pthread_join(thread, NULL);
+    drain();
+    /* note: destructors are not called after the key is deleted */
+    (void)pthread_key_delete(key);
 
     /* write a footer into the log file */
-    time_t now = time(NULL);
-    char *str = ctime(&now);
-    str[strlen(str)-1] = '\0';
-    fprintf(logger, "+++ uv-software Logger (%s) +++\n", str);
-
+    if (!binary) {
+        for (i = 0; i < LOG_MAX_THREADS; i++) {
+            if (rings[i])
+                lost += rings[i]->dropped;
+        }
+        if (lost)
+            fprintf(logger, "+++ (%" PRIu32 " record(s) dropped)\n", lost);
+        time_t now = time(NULL);
+        char *str = ctime(&now);
+        str[strlen(str)-1] = '\0';
+        fprintf(logger, "+++ uv-software Logger (%s) +++\n", str);
+    }
     /* that´s all folks! */
     if (logger != LOG_CONSOLE)
         fclose(logger);
+    else
+        fflush(logger);
     logger = NULL;
+    /* note: a thread still tracing owns a ring of the old generation,
+     *       so a ring is freed when no thread is writing into it */
+    __atomic_add_fetch(&generation, 1U, __ATOMIC_SEQ_CST);
+    for (i = 0; i < LOG_MAX_THREADS; i++) {
+        while (__atomic_load_n(&writers[i], __ATOMIC_SEQ_CST) != 0U)
+            (void)sched_yield();
+        free(rings[i]);
+        rings[i] = NULL;
+    }
     return 0;
 }
 
 int log_sync(const uint8_t *buffer, size_t nbytes)
 {
-    static uint64_t n = 1;
-    size_t i;
-
     /* sanity check */
     errno = 0;
     if (!logger) {
         errno = EBADF;
         return -1;
     }
-    /* enter critical section */
-    assert(pthread_mutex_lock(&mutex) == 0);
-
-    /* write a log message into the log file */
-    fprintf(logger, ">>> (%" PRIu64 ")", n++);
-    for (i = 0; i < nbytes; i++)
-        fprintf(logger, " %02X", buffer[i]);
-    fputc('\n', logger);
-
-    /* leave critical section */
-    assert(pthread_mutex_unlock(&mutex) == 0);
-
-    /* return the number of bytes written */
-    return (int)i;
+    /* write the data into the ring of the calling thread */
+    return ring_write(LOG_REC_SYNC, buffer, nbytes);
 }
 
 int log_async(const uint8_t *buffer, size_t nbytes)
@@ -232,12 +294,13 @@ int log_async(const uint8_t *buffer, size_t nbytes)
         errno = EBADF;
         return -1;
     }
-    /* write a log message into the pipe */
-    return (int)write(fildes[PIPI], buffer, nbytes);
+    /* write the data into the ring of the calling thread */
+    return ring_write(LOG_REC_ASYNC, buffer, nbytes);
 }
 
 int log_printf(const char *format, ...)
 {
+    char string[LOG_BUF_SIZE];
     va_list args;
     int res;
 
@@ -247,56 +310,275 @@ int log_printf(const char *format, ...)
         errno = EBADF;
         return -1;
     }
-    /* enter critical section */
-    assert(pthread_mutex_lock(&mutex) == 0);
-
-    /* write a formatted string into the log file */
-    fputs("+++ ", logger);
+    /* format the string and write it into the ring of the calling thread */
     va_start(args, format);
-    res = vfprintf(logger, format, args);
+    res = vsnprintf(string, LOG_BUF_SIZE, format, args);
     va_end(args);
-    fflush(logger);
-
-    /* leave critical section */
-    assert(pthread_mutex_unlock(&mutex) == 0);
+    if (res < 0)
+        return res;
+    if (ring_write(LOG_REC_TEXT, (const uint8_t*)string, strlen(string)) < 0)
+        return -1;
 
     /* return result from printf */
     return res;
 }
 
-static void *logging(void *arg)
+int log_set_level(int new_level)
 {
-    uint8_t buffer[LOG_BUF_SIZE];
-    ssize_t nbytes, i;
-    uint64_t n = 1;
-    (void) arg;
+    int old_level = level;
 
-    fd_set rdfs;
-    FD_ZERO(&rdfs);
-    FD_SET(fildes[PIPO], &rdfs);
+    /* sanity check */
+    errno = 0;
+    if ((new_level < LOG_LEVEL_OFF) || (LOG_LEVEL_DATA < new_level)) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* takes effect immediately when the logger is running */
+    level = new_level;
+    if (logger)
+        __atomic_store_n(&log_trace_level, level, __ATOMIC_RELEASE);
+    return old_level;
+}
 
-    assert(pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL) == 0);
-    assert(pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, NULL) == 0);
+int log_set_binary(int new_binary)
+{
+    /* sanity check */
+    errno = 0;
+    if (logger) {
+        errno = EALREADY;
+        return -1;
+    }
+    binary = new_binary ? 1 : 0;
+    return 0;
+}
 
-    for (;;) {
-        do {
-            nbytes = read(fildes[PIPO], buffer, LOG_BUF_SIZE);
-
-            if (logger && (nbytes > 0)) {
-                assert(pthread_mutex_lock(&mutex) == 0);
-                fprintf(logger, "<<< (%" PRIu64 ")", n++);
-                for (i = 0; i < nbytes; i++)
-                    fprintf(logger, " %02X", buffer[i]);
-                fputc('\n', logger);
-                assert(pthread_mutex_unlock(&mutex) == 0);
+static log_ring_t *ring_self(void)
+{
+    log_ring_t *ring, *empty;
+    uint32_t gen;
+    int i, expected;
+
+    /* the ring of the calling thread (of the current generation) */
+    if (self) {
+        if (ring_pin(self_idx) == self_gen)
+            return self;
+        ring_unpin(self_idx);
+        self = NULL;
+    }
+    /* claim a free ring (lock-free) */
+    for (i = 0; i < LOG_MAX_THREADS; i++) {
+        if (!((gen = ring_pin(i)) & 1U)) {
+            /* note: the logger has been stopped */
+            ring_unpin(i);
+            return NULL;
+        }
+        if ((ring = __atomic_load_n(&rings[i], __ATOMIC_ACQUIRE)) == NULL) {
+            /* note: rings are allocated on demand and kept until exit */
+            if ((ring = (log_ring_t*)calloc(1, sizeof(log_ring_t))) == NULL) {
+                ring_unpin(i);
+                return NULL;
+            }
+            ring->state = RING_USED;
+            ring->index = (uint8_t)i;
+            empty = NULL;
+            if (!__atomic_compare_exchange_n(&rings[i], &empty, ring,
+                                             0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                free(ring);
+                ring_unpin(i);
+                continue;
             }
-        } while(nbytes > 0);
+            self = ring;
+            break;
+        }
+        expected = RING_FREE;
+        if (__atomic_compare_exchange_n(&ring->state, &expected, RING_USED,
+                                        0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            self = ring;
+            break;
+        }
+        ring_unpin(i);
+    }
+    if (self) {
+        self_gen = gen;
+        self_idx = i;
+        (void)pthread_setspecific(key, (void*)self);
+    }
+    return self;
+}
 
-        if (select(fildes[PIPO]+1, &rdfs, NULL, NULL, NULL) < 0) {
-            perror("+++ error");
-            return NULL;
+static uint32_t ring_pin(int index)
+{
+    /* note: log_exit frees a ring only when no thread has pinned it,
+     *       and the pin is only valid when the generation is unchanged */
+    /* note: a thread cancelled (asynchronously) while it has pinned a ring
+     *       would never unpin it, so cancellation is disabled until then */
+    (void)pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &self_cancel);
+    __atomic_add_fetch(&writers[index], 1U, __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&generation, __ATOMIC_SEQ_CST);
+}
+
+static void ring_unpin(int index)
+{
+    __atomic_sub_fetch(&writers[index], 1U, __ATOMIC_SEQ_CST);
+    (void)pthread_setcancelstate(self_cancel, NULL);
+}
+
+static void release(void *arg)
+{
+    log_ring_t *ring = (log_ring_t*)arg;
+
+    /* the thread terminated: the drainer frees the ring when empty */
+    if (ring && (ring == self)) {
+        if (ring_pin(self_idx) == self_gen)
+            __atomic_store_n(&ring->state, RING_CLOSED, __ATOMIC_RELEASE);
+        ring_unpin(self_idx);
+    }
+    self = NULL;
+}
+
+static int ring_write(uint8_t type, const uint8_t *buffer, size_t nbytes)
+{
+    log_ring_t *ring;
+    log_record_t *record;
+    uint32_t head, tail, n, i;
+    uint64_t now;
+    size_t length;
+
+    /* number of records (all or nothing) */
+    n = (nbytes > 0U) ? (uint32_t)((nbytes + LOG_REC_DATA - 1U) / LOG_REC_DATA) : 1U;
+
+    /* the ring of the calling thread (pinned until the records are written) */
+    if ((ring = ring_self()) == NULL) {
+        __atomic_add_fetch(&lost, n, __ATOMIC_RELAXED);
+        errno = ENOSPC;
+        return -1;
+    }
+    head = ring->head;
+    tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if ((LOG_RING_SIZE - (head - tail)) < n) {
+        /* note: never block the caller */
+        ring->dropped += n;
+        ring_unpin(self_idx);
+        errno = ENOBUFS;
+        return -1;
+    }
+    now = get_time();
+    for (i = 0U; i < n; i++) {
+        record = &ring->records[(head + i) & LOG_RING_MASK];
+        length = (nbytes > LOG_REC_DATA) ? LOG_REC_DATA : nbytes;
+        record->time = now;
+        record->dropped = (i == 0U) ? ring->dropped : 0U;
+        record->type = type;
+        record->flags = ((i + 1U) < n) ? LOG_REC_MORE : 0x00U;
+        record->length = (uint8_t)length;
+        record->thread = ring->index;
+        if (length)
+            memcpy(record->data, buffer, length);
+        buffer += length;
+        nbytes -= length;
+    }
+    ring->dropped = 0U;
+    /* publish the records */
+    __atomic_store_n(&ring->head, head + n, __ATOMIC_RELEASE);
+    ring_unpin(self_idx);
+    return (int)(n * LOG_REC_DATA);
+}
+
+static void drain(void)
+{
+    log_ring_t *ring, *next;
+    log_record_t *record;
+    uint32_t tail, head;
+    uint64_t time;
+    int i, more;
+
+    for (;;) {
+        /* the oldest message of all rings first */
+        next = NULL;
+        time = UINT64_MAX;
+        for (i = 0; i < LOG_MAX_THREADS; i++) {
+            ring = __atomic_load_n(&rings[i], __ATOMIC_ACQUIRE);
+            if (!ring)
+                continue;
+            tail = ring->tail;
+            head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+            if ((tail != head) && (ring->records[tail & LOG_RING_MASK].time < time)) {
+                time = ring->records[tail & LOG_RING_MASK].time;
+                next = ring;
+            }
+        }
+        if (!next)
+            break;
+        /* write the message (one or more records) */
+        tail = next->tail;
+        record = &next->records[tail & LOG_RING_MASK];
+        if (binary) {
+            do {
+                record = &next->records[tail & LOG_RING_MASK];
+                more = record->flags & LOG_REC_MORE;
+                (void)fwrite(record, sizeof(log_record_t), 1, logger);
+                tail++;
+            } while (more);
+        }
+        else {
+            uint64_t t = record->time - start;
+            if (record->dropped)
+                fprintf(logger, "+++ (%" PRIu32 " record(s) dropped)\n", record->dropped);
+            fprintf(logger, "[%" PRIu64 ".%06" PRIu64 "] ", t / 1000000000U, (t % 1000000000U) / 1000U);
+            switch (record->type) {
+            case LOG_REC_SYNC: fprintf(logger, ">>> (%" PRIu64 ")", ++counter[LOG_REC_SYNC]); break;
+            case LOG_REC_ASYNC: fprintf(logger, "<<< (%" PRIu64 ")", ++counter[LOG_REC_ASYNC]); break;
+            default: fputs("+++ ", logger); break;
+            }
+            do {
+                record = &next->records[tail & LOG_RING_MASK];
+                more = record->flags & LOG_REC_MORE;
+                if (record->type == LOG_REC_TEXT)
+                    (void)fwrite(record->data, 1, record->length, logger);
+                else {
+                    for (i = 0; i < (int)record->length; i++)
+                        fprintf(logger, " %02X", record->data[i]);
+                }
+                tail++;
+            } while (more);
+            if (record->type != LOG_REC_TEXT)
+                fputc('\n', logger);
+        }
+        __atomic_store_n(&next->tail, tail, __ATOMIC_RELEASE);
+    }
+    /* release the drained rings of terminated threads */
+    for (i = 0; i < LOG_MAX_THREADS; i++) {
+        ring = __atomic_load_n(&rings[i], __ATOMIC_ACQUIRE);
+        if (ring && (__atomic_load_n(&ring->state, __ATOMIC_ACQUIRE) == RING_CLOSED) &&
+            (ring->tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE))) {
+            ring->head = ring->tail = 0U;
+            ring->dropped = 0U;
+            __atomic_store_n(&ring->state, RING_FREE, __ATOMIC_RELEASE);
         }
     }
+    fflush(logger);
+}
+
+static void *logging(void *arg)
+{
+    struct timespec delay;
+    (void) arg;
+
+    delay.tv_sec = 0;
+    delay.tv_nsec = LOG_DRAIN_INTERVAL;
+    while (__atomic_load_n(&running, __ATOMIC_ACQUIRE)) {
+        drain();
+        (void)nanosleep(&delay, NULL);
+    }
+    return NULL;
+}
+
+static uint64_t get_time(void)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000U) + (uint64_t)now.tv_nsec;
 }
 
 /*  ----------------------------------------------------------------------
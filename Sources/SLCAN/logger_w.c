@@ -98,11 +98,14 @@ static DWORD WINAPI logging(LPVOID lpParam);
 /*  -----------  variables  ----------------------------------------------
  */
 
+volatile int log_trace_level = LOG_LEVEL_OFF;
+
 static HANDLE hThread = NULL;
 static HANDLE hMutex = NULL;
 static HANDLE hPipo, hPipi;
 static FILE *logger = NULL;
 static volatile int running = 0;
+static int level = LOG_LEVEL_DATA;
 
 
 /*  -----------  functions  ----------------------------------------------
@@ -164,6 +167,7 @@ int log_init(const char *pathname/*, flags*/)
     ctime_s(str, 26, &now);
     str[strlen(str)-1] = '\0';
     fprintf(logger, "+++ uv-software Logger (%s) +++\n", str);
+    log_trace_level = level;
     return 0;
 }
 
@@ -176,6 +180,7 @@ int log_exit(void)
         return -1;
     }
     /* kill the logging thread and release all resources */
+    log_trace_level = LOG_LEVEL_OFF;
     running = 0;
     (void)CancelIoEx(hPipo, NULL);  // to cancel ReadPipe
     (void)SetEvent(hThread);
@@ -277,6 +282,30 @@ int log_printf(const char *format, ...)
     return res;
 }
 
+int log_set_level(int new_level)
+{
+    int old_level = level;
+
+    /* sanity check */
+    errno = 0;
+    if ((new_level < LOG_LEVEL_OFF) || (LOG_LEVEL_DATA < new_level)) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* takes effect immediately when the logger is running */
+    level = new_level;
+    if (logger)
+        log_trace_level = level;
+    return old_level;
+}
+
+int log_set_binary(int new_binary)
+{
+    /* note: binary output is not supported on Windows */
+    errno = new_binary ? ENOTSUP : 0;
+    return new_binary ? -1 : 0;
+}
+
 static DWORD WINAPI logging(LPVOID lpParam)
 {
     uint8_t buffer[LOG_BUF_SIZE];
@@ -69,6 +69,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <time.h>
 
 
 /*  -----------  options  ------------------------------------------------
@@ -78,12 +79,41 @@
 /*  -----------  defines  ------------------------------------------------
  */
 
+/** @name  Wait Policy
+ *  @brief How a consumer waits for elements on an empty queue
+ *  @{ */
+#define QUEUE_WAIT_BLOCK  0             /**< block on the wait condition (default) */
+#define QUEUE_WAIT_SPIN   1             /**< spin for a while, then block */
+#define QUEUE_WAIT_POLL   2             /**< busy-poll, never block */
+/** @} */
+
+/** @name  Overflow Policy
+ *  @brief What happens to an element enqueued into a full queue
+ *  @{ */
+#define QUEUE_OVFL_DROP_NEWEST  0       /**< drop the new element (default) */
+#define QUEUE_OVFL_DROP_OLDEST  1       /**< overwrite the oldest element (ring) */
+#define QUEUE_OVFL_COALESCE     2       /**< keep only the latest element per key */
+/** @} */
 
 /*  -----------  types  --------------------------------------------------
  */
 
 typedef void *queue_t;                  /**< queue (opaque data type) */
 
+/** @brief       Queue counters (since the queue was created or cleared)
+ *
+ *  @remarks     enqueued = dequeued + overwritten + coalesced + used
+ *               (where used includes the elements in the spill file)
+ */
+typedef struct queue_counters_t_ {
+    uint64_t enqueued;                  /**< elements taken into the queue */
+    uint64_t dequeued;                  /**< elements taken from the queue */
+    uint64_t dropped;                   /**< new elements dropped (queue full) */
+    uint64_t overwritten;               /**< oldest elements overwritten (queue full) */
+    uint64_t coalesced;                 /**< queued elements replaced by a newer one with the same key */
+    uint64_t spilled;                   /**< elements written to the spill file */
+} queue_counters_t;
+
 
 /*  -----------  variables  ----------------------------------------------
  */
@@ -128,7 +158,7 @@ extern int queue_destroy(queue_t queue);
 
 
 /** @brief       removes all enqueued elements from the queue and reset the
- *               overflow indicator and the overflow counter.
+ *               overflow indicator, the overflow counter and the high-water mark.
  *
  *  @param[in]   queue  - pointer to a queue instance
  *
@@ -191,13 +221,42 @@ extern int queue_enqueue(queue_t queue, const void *element, size_t nbytes);
 extern int queue_dequeue(queue_t queue, void *element, size_t maxbytes, uint16_t timeout);
 
 
+/** @brief       dequeues one element from the queue, if any, and waits for it
+ *               not longer than until the given deadline.
+ *
+ *  @remarks     The deadline is an absolute time of the monotonic clock, i.e.
+ *               of CLOCK_MONOTONIC (on Windows: of QueryPerformanceCounter,
+ *               with a resolution of one millisecond).  A deadline that has
+ *               already passed means polling.
+ *
+ *  @param[in]   queue    - pointer to a queue instance
+ *  @param[out]  element  - pointer to an array into which the element is copied
+ *  @param[in]   maxbytes - maximum number of bytes to be copied from the queue
+ *  @param[in]   deadline - absolute time until to wait for elements available
+ *                          in the queue, or NULL for a blocking read
+ *
+ *  @returns     the number of bytes copied from the queue if successful, or
+ *               a negative value on error.
+ *
+ *  @retval      -30  - when the queue is empty (CAN API compatible)
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      EFAULT     - bad address (invalid queue instance)
+ *  @retval      EINVAL     - invalid argument (element or maxbytes)
+ *  @retval      ENOMSG     - no data available (queue empty)
+ *  @retval      ETIMEDOUT  - no data available until the deadline
+ */
+extern int queue_dequeue_until(queue_t queue, void *element, size_t maxbytes, const struct timespec *deadline);
+
+
 /** @brief       returns true when an overflow has occurred.
  *
  *  @remarks     The overflow indicator can be reset by a call of 'queue_clear'.
  *               @see queue_clear
  *
  *  @param[in]   queue    - pointer to a queue instance
- *  @param[out]  counter  - number of overflows (optional)
+ *  @param[out]  counter  - number of dropped or overwritten elements (optional)
  *
  *  @returns     0 when no overflow has occurred, or a none-zero value otherwise.
  *
@@ -208,6 +267,27 @@ extern int queue_dequeue(queue_t queue, void *element, size_t maxbytes, uint16_t
 extern bool queue_overflow(queue_t queue, uint64_t *counter);
 
 
+/** @brief       returns the number of queued elements.
+ *
+ *  @remarks     The high-water mark can be reset by a call of 'queue_clear'.
+ *               @see queue_clear
+ *
+ *  @remarks     Size and high-water mark are those of the queue in memory;
+ *               the number of queued elements includes spilled elements.
+ *
+ *  @param[in]   queue  - pointer to a queue instance
+ *  @param[out]  size   - total number of elements (optional)
+ *  @param[out]  high   - max. number of queued elements so far (optional)
+ *
+ *  @returns     number of queued elements, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      EFAULT   - bad address (invalid queue instance)
+ */
+extern int queue_usage(queue_t queue, size_t *size, size_t *high);
+
+
 /** @brief       signals waiting objects, if any.
  *
  *  @param[in]   queue  - pointer to a queue instance
@@ -217,6 +297,118 @@ extern bool queue_overflow(queue_t queue, uint64_t *counter);
 extern int queue_signal(queue_t queue);
 
 
+/** @brief       sets the wait policy of a consumer on an empty queue.
+ *
+ *  @remarks     With policy QUEUE_WAIT_SPIN the consumer spins on the queue for
+ *               up to 'spin' microseconds before it blocks on the wait condition.
+ *               The actual spin time adapts to the observed inter-arrival time
+ *               of the elements (twice its moving average); when elements arrive
+ *               more rarely than 'spin' microseconds the consumer blocks at once.
+ *
+ *  @remarks     With policy QUEUE_WAIT_POLL the consumer busy-polls the queue
+ *               until an element arrives or the time-out expires.  It never
+ *               blocks, so this policy is meant for a dedicated CPU core.
+ *
+ *  @remarks     On Windows only policy QUEUE_WAIT_BLOCK is supported; policies
+ *               QUEUE_WAIT_SPIN and QUEUE_WAIT_POLL fail with ENOTSUP.
+ *
+ *  @param[in]   queue   - pointer to a queue instance
+ *  @param[in]   policy  - wait policy (QUEUE_WAIT_BLOCK, _SPIN or _POLL)
+ *  @param[in]   spin    - max. spin time in microseconds (QUEUE_WAIT_SPIN)
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      EFAULT   - bad address (invalid queue instance)
+ *  @retval      EINVAL   - invalid argument (policy)
+ *  @retval      ENOTSUP  - operation not supported (spinning or polling on Windows)
+ */
+extern int queue_wait_policy(queue_t queue, int policy, uint32_t spin);
+
+
+/** @brief       sets the overflow policy of the queue.
+ *
+ *  @remarks     With policy QUEUE_OVFL_DROP_NEWEST an element enqueued into a
+ *               full queue is dropped (default).  With policy QUEUE_OVFL_DROP_OLDEST
+ *               it overwrites the oldest element, i.e. the queue works as ring.
+ *
+ *  @remarks     With policy QUEUE_OVFL_COALESCE the queue holds at most one element
+ *               per key, a 32-bit value at byte offset 'offset' of the element.
+ *               An element whose key is already queued replaces the queued one
+ *               in place (it keeps its position in the queue).  When the queue
+ *               is full with different keys, the new element is dropped.
+ *
+ *  @param[in]   queue   - pointer to a queue instance
+ *  @param[in]   policy  - overflow policy (QUEUE_OVFL_DROP_NEWEST, _DROP_OLDEST or _COALESCE)
+ *  @param[in]   offset  - byte offset of the key in an element (QUEUE_OVFL_COALESCE)
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      EFAULT   - bad address (invalid queue instance)
+ *  @retval      EINVAL   - invalid argument (policy or offset)
+ *  @retval      ENOMEM   - out of memory (key index)
+ *  @retval      ENOTSUP  - operation not supported (with a spill file)
+ */
+extern int queue_overflow_policy(queue_t queue, int policy, size_t offset);
+
+
+/** @brief       retrieves the counters of the queue.
+ *
+ *  @remarks     The counters can be reset by a call of 'queue_clear'.
+ *               @see queue_clear
+ *
+ *  @param[in]   queue     - pointer to a queue instance
+ *  @param[out]  counters  - pointer to a buffer for the counters
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      EFAULT   - bad address (invalid queue instance)
+ *  @retval      EINVAL   - invalid argument (counters)
+ */
+extern int queue_counters(queue_t queue, queue_counters_t *counters);
+
+
+/** @brief       sets up a spill file for elements beyond a high-water mark.
+ *
+ *  @remarks     When 'mark' elements are queued in memory, new elements are
+ *               appended to the spill file, a memory-mapped ring of 'numElem'
+ *               elements, until it has been drained.  The elements are dequeued
+ *               from memory first, then from the spill file, i.e. in the order
+ *               they were enqueued.  When the spill file is full the new element
+ *               is dropped (only policy QUEUE_OVFL_DROP_NEWEST is supported).
+ *
+ *  @remarks     The file is created (it must not exist) with its disk space
+ *               reserved, and it is unlinked at once; it lives only as long as
+ *               the queue is mapped to it.  A NULL pointer for 'path' or a zero
+ *               for 'numElem' removes the spill file, if it is empty.
+ *
+ *  @remarks     A spill file is not supported on Windows: setting it up fails
+ *               with ENOTSUP, removing it succeeds (there is none).
+ *
+ *  @param[in]   queue    - pointer to a queue instance
+ *  @param[in]   path     - path name of the spill file (or NULL)
+ *  @param[in]   numElem  - number of elements in the spill file (or 0)
+ *  @param[in]   mark     - number of elements in memory from which on elements
+ *                          are spilled (0 = when the queue is full)
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      EFAULT   - bad address (invalid queue instance)
+ *  @retval      EINVAL   - invalid argument (mark or numElem)
+ *  @retval      EBUSY    - device or resource busy (spill file not empty)
+ *  @retval      ENOTSUP  - operation not supported (overflow policy, or on Windows)
+ *  @retval      (other)  - from open(2), posix_fallocate(3) or mmap(2)
+ */
+extern int queue_spill(queue_t queue, const char *path, size_t numElem, size_t mark);
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -59,6 +59,7 @@
  *  @{
  */
 #include "queue.h"
+#include "trace.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -66,8 +67,10 @@
 #include <errno.h>
 #include <assert.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <pthread.h>
 #include <time.h>
+#include <sys/mman.h>
 
 
 /*  -----------  options  ------------------------------------------------
@@ -79,13 +82,8 @@
 
 #define MIN(x,y)  ((x) < (y) ? (x) : (y))
 
-#define GET_TIME(ts)  do{ clock_gettime(CLOCK_REALTIME, &ts); } while(0)
-#define ADD_TIME(ts,to)  do{ ts.tv_sec += (time_t)(to / 1000U); \
-                             ts.tv_nsec += (long)(to % 1000U) * (long)1000000; \
-                             if (ts.tv_nsec >= (long)1000000000) { \
-                                 ts.tv_nsec %= (long)1000000000; \
-                                 ts.tv_sec += (time_t)1; \
-                             } } while(0)
+#define NO_WAIT       0U               /* deadline: polling */
+#define WAIT_FOREVER  UINT64_MAX       /* deadline: infinite blocking read */
 
 #define ENTER_CRITICAL_SECTION(que)  assert(0 == pthread_mutex_lock(&que->wait.mutex))
 #define LEAVE_CRITICAL_SECTION(que)  assert(0 == pthread_mutex_unlock(&que->wait.mutex))
@@ -97,12 +95,31 @@
 #define WAIT_CONDITION_TIMEOUT(que,abs,res)  do{ que->wait.flag = false; \
                                                  res = pthread_cond_timedwait(&que->wait.cond, &que->wait.mutex, &abs); } while(0)
 
+#if defined(__x86_64__) || defined(__i386__)
+#define CPU_RELAX()  __builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define CPU_RELAX()  __asm__ __volatile__("yield" ::: "memory")
+#else
+#define CPU_RELAX()  __asm__ __volatile__("" ::: "memory")
+#endif
+#define SPIN_EXPIRED    0
+#define SPIN_ARRIVED    1
+#define SPIN_SIGNALLED  2
+
+#define NO_SLOT  0U                    /* key index: empty entry */
+
 /*  -----------  types  --------------------------------------------------
  */
 
+typedef struct index_entry_t_ {
+    uint32_t key;
+    uint32_t slot;
+} index_entry_t;
+
 typedef struct object_t_ {
     size_t size;
     size_t used;
+    size_t high;
     size_t head;
     size_t tail;
     uint8_t *queueElem;
@@ -111,11 +128,35 @@ typedef struct object_t_ {
         pthread_mutex_t mutex;
         pthread_cond_t cond;
         bool flag;
+        uint32_t count;
+        uint32_t signals;
     } wait;
+    struct wait_policy_t {
+        int policy;
+        uint64_t spin;
+        uint64_t last;
+        uint64_t mean;
+    } spin;
     struct overflow_t {
         bool flag;
         uint64_t counter;
+        int policy;
     } ovfl;
+    struct key_index_t {
+        size_t offset;
+        size_t mask;
+        index_entry_t *entry;
+    } index;
+    struct spill_t {
+        uint8_t *spillElem;
+        size_t length;
+        size_t size;
+        size_t used;
+        size_t head;
+        size_t tail;
+        size_t mark;
+    } spill;
+    queue_counters_t counters;
 } object_t;
 
 
@@ -125,6 +166,25 @@ typedef struct object_t_ {
 static bool enqueue_element(object_t *queue, const void *element, size_t nbytes);
 static bool dequeue_element(object_t *queue, void *element, size_t maxbytes);
 
+static uint32_t element_key(const object_t *queue, const void *element);
+static size_t index_hash(const object_t *queue, uint32_t key);
+static bool index_lookup(const object_t *queue, uint32_t key, size_t *slot);
+static void index_insert(object_t *queue, uint32_t key, size_t slot);
+static void index_remove(object_t *queue, uint32_t key, size_t slot);
+static void index_rebuild(object_t *queue);
+
+static bool spill_element(object_t *queue, const void *element, size_t nbytes);
+static bool unspill_element(object_t *queue, void *element, size_t maxbytes);
+static uint8_t *map_spill(const char *path, size_t length);
+
+static void update_arrival(object_t *queue);
+static int dequeue_wait(object_t *queue, void *element, size_t maxbytes, uint64_t deadline);
+static uint64_t spin_deadline(const object_t *queue, uint64_t deadline);
+static int spin_wait(object_t *queue, uint64_t deadline);
+static int init_condition(pthread_cond_t *cond);
+static void wait_time(struct timespec *abstime, uint64_t deadline);
+static uint64_t get_nanos(void);
+
 
 /*  -----------  variables  ----------------------------------------------
  */
@@ -155,13 +215,14 @@ queue_t queue_create(size_t numElem, size_t elemSize) {
         object->elemSize = elemSize;
         object->size = numElem;
         object->used = 0;
+        object->high = 0;
         object->head = 0;
         object->tail = 0;
         object->ovfl.flag = false;
         object->ovfl.counter = 0U;
         /* create a mutex and a waitable condition */
         if ((pthread_mutex_init(&object->wait.mutex, NULL) < 0) ||
-            (pthread_cond_init(&object->wait.cond, NULL)) < 0) {
+            (init_condition(&object->wait.cond) != 0)) {
             /* errno set */
             free(object->queueElem);
             free(object);
@@ -184,9 +245,14 @@ int queue_destroy(queue_t queue) {
     /* destroy mutex and condition */
     (void)pthread_mutex_destroy(&object->wait.mutex);
     (void)pthread_cond_destroy(&object->wait.cond);
-    /* destroy the message queue */
+    /* destroy the message queue and the key index */
     if (object->queueElem)
         free(object->queueElem);
+    if (object->index.entry)
+        free(object->index.entry);
+    /* unmap the spill file, if any */
+    if (object->spill.spillElem)
+        (void)munmap(object->spill.spillElem, object->spill.length);
     /* C language destructor */
     free(object);
     return 0;
@@ -204,12 +270,135 @@ int queue_signal(queue_t queue) {
     }
     /* signal the wait condition, if waiting */
     ENTER_CRITICAL_SECTION(object);
+    __atomic_store_n(&object->wait.signals, object->wait.signals + 1U, __ATOMIC_RELEASE);
     SIGNAL_WAIT_CONDITION(object, false);
     LEAVE_CRITICAL_SECTION(object);
     /* return success */
     return res;
 }
 
+int queue_wait_policy(queue_t queue, int policy, uint32_t spin) {
+    object_t *object = (object_t*)queue;
+
+    /* sanity check */
+    errno = 0;
+    if (!object) {
+        errno = EFAULT;
+        return -1;
+    }
+    if ((policy != QUEUE_WAIT_BLOCK) && (policy != QUEUE_WAIT_SPIN) && (policy != QUEUE_WAIT_POLL)) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* set the wait policy and reset the inter-arrival time */
+    ENTER_CRITICAL_SECTION(object);
+    object->spin.policy = policy;
+    object->spin.spin = (uint64_t)spin * 1000U;
+    object->spin.last = 0U;
+    object->spin.mean = 0U;
+    LEAVE_CRITICAL_SECTION(object);
+    /* return success */
+    return 0;
+}
+
+int queue_overflow_policy(queue_t queue, int policy, size_t offset) {
+    object_t *object = (object_t*)queue;
+    index_entry_t *entry = NULL;
+    size_t mask = 0U;
+
+    /* sanity check */
+    errno = 0;
+    if (!object) {
+        errno = EFAULT;
+        return -1;
+    }
+    if ((policy != QUEUE_OVFL_DROP_NEWEST) && (policy != QUEUE_OVFL_DROP_OLDEST) && (policy != QUEUE_OVFL_COALESCE)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (policy == QUEUE_OVFL_COALESCE) {
+        if (((offset + sizeof(uint32_t)) > object->elemSize) || (object->size >= (size_t)UINT32_MAX)) {
+            errno = EINVAL;
+            return -1;
+        }
+        /* key index with a load factor of at most 1/2 (size and element size are fixed) */
+        for (mask = 2U; mask < (object->size * 2U); mask <<= 1)
+            ;
+        if ((entry = (index_entry_t*)calloc(mask, sizeof(index_entry_t))) == NULL) {
+            /* errno set */
+            return -1;
+        }
+        mask -= 1U;
+    }
+    /* set the overflow policy and index the queued elements, if required */
+    ENTER_CRITICAL_SECTION(object);
+    /* note: spilled elements cannot be overwritten or coalesced */
+    if (object->spill.spillElem && (policy != QUEUE_OVFL_DROP_NEWEST)) {
+        LEAVE_CRITICAL_SECTION(object);
+        if (entry)
+            free(entry);
+        errno = ENOTSUP;
+        return -1;
+    }
+    if (object->index.entry)
+        free(object->index.entry);
+    object->index.entry = entry;
+    object->index.mask = mask;
+    object->index.offset = offset;
+    object->ovfl.policy = policy;
+    if (policy == QUEUE_OVFL_COALESCE)
+        index_rebuild(object);
+    LEAVE_CRITICAL_SECTION(object);
+    /* return success */
+    return 0;
+}
+
+int queue_spill(queue_t queue, const char *path, size_t numElem, size_t mark) {
+    object_t *object = (object_t*)queue;
+    uint8_t *spillElem = NULL;
+    size_t length = 0U;
+
+    /* sanity check */
+    errno = 0;
+    if (!object) {
+        errno = EFAULT;
+        return -1;
+    }
+    if (!path)
+        numElem = 0U;
+    if ((mark > object->size) || (numElem > (SIZE_MAX / object->elemSize))) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* create the new spill file, if any (size and element size are fixed) */
+    if (numElem) {
+        length = numElem * object->elemSize;
+        if ((spillElem = map_spill(path, length)) == NULL)
+            return -1;  /* errno set */
+    }
+    /* replace the spill file, if it has been drained */
+    ENTER_CRITICAL_SECTION(object);
+    if ((object->ovfl.policy != QUEUE_OVFL_DROP_NEWEST) || (object->spill.used != 0U)) {
+        errno = (object->ovfl.policy != QUEUE_OVFL_DROP_NEWEST) ? ENOTSUP : EBUSY;
+        LEAVE_CRITICAL_SECTION(object);
+        if (spillElem)
+            (void)munmap(spillElem, length);
+        return -1;
+    }
+    if (object->spill.spillElem)
+        (void)munmap(object->spill.spillElem, object->spill.length);
+    object->spill.spillElem = spillElem;
+    object->spill.length = length;
+    object->spill.size = numElem;
+    object->spill.used = 0U;
+    object->spill.head = 0U;
+    object->spill.tail = 0U;
+    object->spill.mark = mark ? mark : object->size;
+    LEAVE_CRITICAL_SECTION(object);
+    /* return success */
+    return 0;
+}
+
 int queue_clear(queue_t queue) {
     object_t *object = (object_t*)queue;
     int res = -1;
@@ -224,10 +413,17 @@ int queue_clear(queue_t queue) {
     ENTER_CRITICAL_SECTION(object);
     res = (int)object->used;
     object->used = 0;
+    object->high = 0;
     object->head = 0;
     object->tail = 0;
     object->ovfl.flag = false;
     object->ovfl.counter = 0U;
+    object->spill.used = 0U;
+    object->spill.head = 0U;
+    object->spill.tail = 0U;
+    (void)memset(&object->counters, 0x00, sizeof(queue_counters_t));
+    if (object->index.entry)
+        (void)memset(object->index.entry, 0x00, (object->index.mask + 1U) * sizeof(index_entry_t));
     LEAVE_CRITICAL_SECTION(object);
     /* return number of elements removed */
     return res;
@@ -253,6 +449,49 @@ bool queue_overflow(queue_t queue, uint64_t *counter) {
     return res;
 }
 
+int queue_counters(queue_t queue, queue_counters_t *counters) {
+    object_t *object = (object_t*)queue;
+
+    /* sanity check */
+    errno = 0;
+    if (!object) {
+        errno = EFAULT;
+        return -1;
+    }
+    if (!counters) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* get a consistent copy of the counters */
+    ENTER_CRITICAL_SECTION(object);
+    (void)memcpy(counters, &object->counters, sizeof(queue_counters_t));
+    LEAVE_CRITICAL_SECTION(object);
+    /* return success */
+    return 0;
+}
+
+int queue_usage(queue_t queue, size_t *size, size_t *high) {
+    object_t *object = (object_t*)queue;
+    int res = -1;
+
+    /* sanity check */
+    errno = 0;
+    if (!object) {
+        errno = EFAULT;
+        return -1;
+    }
+    /* get fill level, capacity and high-water mark */
+    ENTER_CRITICAL_SECTION(object);
+    res = (int)(object->used + object->spill.used);
+    if (size)
+        *size = object->size;
+    if (high)
+        *high = object->high;
+    LEAVE_CRITICAL_SECTION(object);
+    /* return number of queued elements */
+    return res;
+}
+
 int queue_enqueue(queue_t queue, const void *element, size_t nbytes) {
     object_t *object = (object_t*)queue;
     int res = -1;
@@ -269,10 +508,15 @@ int queue_enqueue(queue_t queue, const void *element, size_t nbytes) {
     }
     /* enqueue element (with truncation), if queue not full */
     ENTER_CRITICAL_SECTION(object);
+    if (object->spin.policy == QUEUE_WAIT_SPIN)
+        update_arrival(object);
     if (enqueue_element(object, element, nbytes)) {
         res = (int)MIN(object->elemSize, nbytes);
+        SLCAN_TRACE3(queue_enqueue, object, object->used, object->high);
+        __atomic_store_n(&object->wait.count, object->wait.count + 1U, __ATOMIC_RELEASE);
         SIGNAL_WAIT_CONDITION(object, true);
     } else {
+        SLCAN_TRACE3(queue_overflow, object, object->used, object->ovfl.counter);
         errno = ENOSPC;
         res = -20;
     }
@@ -282,14 +526,35 @@ int queue_enqueue(queue_t queue, const void *element, size_t nbytes) {
 }
 
 int queue_dequeue(queue_t queue, void *element, size_t maxbytes, uint16_t timeout) {
-    object_t *object = (object_t*)queue;
+    uint64_t deadline = NO_WAIT;
+
+    /* the time-out (in [ms]) is taken as deadline from the monotonic clock */
+    if (timeout == 65535U)
+        deadline = WAIT_FOREVER;
+    else if (timeout != 0U)
+        deadline = get_nanos() + ((uint64_t)timeout * 1000000U);
+    return dequeue_wait((object_t*)queue, element, maxbytes, deadline);
+}
+
+int queue_dequeue_until(queue_t queue, void *element, size_t maxbytes, const struct timespec *deadline) {
+    uint64_t until = WAIT_FOREVER;
+
+    /* a deadline that has already passed means polling */
+    if (deadline) {
+        until = ((uint64_t)deadline->tv_sec * 1000000000U) + (uint64_t)deadline->tv_nsec;
+        if (until <= get_nanos())
+            until = NO_WAIT;
+    }
+    return dequeue_wait((object_t*)queue, element, maxbytes, until);
+}
+
+static int dequeue_wait(object_t *object, void *element, size_t maxbytes, uint64_t deadline) {
     int res = -1;
     int waitCond = 0;
+    int spinCond = SPIN_EXPIRED;
+    uint64_t spinTime = 0U;
     struct timespec absTime;
 
-    GET_TIME(absTime);
-    ADD_TIME(absTime, timeout);
-
     /* sanity check */
     errno = 0;
     if (!object) {
@@ -305,20 +570,38 @@ int queue_dequeue(queue_t queue, void *element, size_t maxbytes, uint16_t timeou
 again:
     if (dequeue_element(object, element, maxbytes)) {
         res = (int)MIN(object->elemSize, maxbytes);
+        SLCAN_TRACE2(queue_dequeue, object, object->used);
     } else {
-        if (timeout == 65535U) {  /* infinite blocking read */
+        if ((object->spin.policy != QUEUE_WAIT_BLOCK) && (deadline != NO_WAIT)) {
+            /* spin resp. busy-poll (the deadline is taken only once) */
+            if (spinTime == 0U)
+                spinTime = spin_deadline(object, deadline);
+            spinCond = spin_wait(object, spinTime);
+            if (spinCond == SPIN_ARRIVED)
+                goto again;
+        }
+        if (spinCond == SPIN_SIGNALLED) {  /* signalled while spinning */
+            errno = ENOMSG;
+        } else if ((object->spin.policy == QUEUE_WAIT_POLL) && (deadline != NO_WAIT)) {  /* busy-poll expired */
+            errno = ETIMEDOUT;
+        } else if (deadline == WAIT_FOREVER) {  /* infinite blocking read */
+            SLCAN_TRACE2(queue_wait_start, object, deadline);
             WAIT_CONDITION_INFINITE(object, waitCond);
+            SLCAN_TRACE3(queue_wait_end, object, object->used, waitCond);
             if ((waitCond == 0) && object->wait.flag)
                 goto again;
             else
                 errno = ENOMSG;
-        } else if (timeout != 0U) {  /* timed blocking read */
+        } else if (deadline != NO_WAIT) {  /* timed blocking read */
+            wait_time(&absTime, deadline);
+            SLCAN_TRACE2(queue_wait_start, object, deadline);
             WAIT_CONDITION_TIMEOUT(object, absTime, waitCond);
+            SLCAN_TRACE3(queue_wait_end, object, object->used, waitCond);
             if ((waitCond == 0) && object->wait.flag)
                 goto again;
             else
                 errno = ETIMEDOUT;
-        } else {  /* polling (timeout == 0) */
+        } else {  /* polling (no deadline) */
             errno = ENOMSG;
         }
         res = -30;
@@ -334,17 +617,41 @@ again:
  *  head :  read position of the queue
  *  tail :  write position of the queue
  *  used :  number of queued elements
+ *  high :  max. number of queued elements (high-water mark)
  *
  *  (§1) empty :  used == 0
  *  (§2) full  :  used == size  &&  size > 0
+ *
+ *  (§3) drop-newest :  full -> the new element is dropped
+ *  (§4) drop-oldest :  full -> head and tail are advanced, the oldest element is overwritten
+ *  (§5) coalesce    :  key queued -> the queued element is replaced in place, else (§1)/(§3)
+ *  (§6) spilling    :  used >= mark  ||  spill used > 0  (see SPILL)
  */
 static bool enqueue_element(object_t *queue, const void *element, size_t nbytes) {
+    bool keyed = false;
+    uint32_t key = 0U;
+    size_t slot = 0U;
+
     assert(queue);
     assert(element);
     assert(queue->size);
     assert(queue->elemSize);
     assert(queue->queueElem);
 
+    /* note: once spilling, elements are spilled until the spill file is drained */
+    if (queue->spill.spillElem && ((queue->used >= queue->spill.mark) || (queue->spill.used != 0U)))
+        return spill_element(queue, element, nbytes);
+    /* note: an element too short to hold a key is never coalesced */
+    if ((queue->ovfl.policy == QUEUE_OVFL_COALESCE) && (nbytes >= (queue->index.offset + sizeof(uint32_t)))) {
+        key = element_key(queue, element);
+        keyed = true;
+        if (index_lookup(queue, key, &slot)) {
+            (void)memcpy(&queue->queueElem[(slot * queue->elemSize)], element, MIN(queue->elemSize, nbytes));
+            queue->counters.enqueued += 1U;
+            queue->counters.coalesced += 1U;
+            return true;
+        }
+    }
     if (queue->used < queue->size) {
         if (queue->used != 0U)
             queue->tail = (queue->tail + 1U) % queue->size;
@@ -352,8 +659,23 @@ static bool enqueue_element(object_t *queue, const void *element, size_t nbytes)
             queue->head = queue->tail;  /* to make sure */
         (void)memcpy(&queue->queueElem[(queue->tail * queue->elemSize)], element, MIN(queue->elemSize, nbytes));
         queue->used += 1U;
+        if (queue->high < queue->used)
+            queue->high = queue->used;
+        if (keyed)
+            index_insert(queue, key, queue->tail);
+        queue->counters.enqueued += 1U;
+        return true;
+    } else if (queue->ovfl.policy == QUEUE_OVFL_DROP_OLDEST) {
+        queue->head = (queue->head + 1U) % queue->size;
+        queue->tail = (queue->tail + 1U) % queue->size;
+        (void)memcpy(&queue->queueElem[(queue->tail * queue->elemSize)], element, MIN(queue->elemSize, nbytes));
+        queue->counters.enqueued += 1U;
+        queue->counters.overwritten += 1U;
+        queue->ovfl.counter += 1U;
+        queue->ovfl.flag = true;
         return true;
     } else {
+        queue->counters.dropped += 1U;
         queue->ovfl.counter += 1U;
         queue->ovfl.flag = true;
         return false;
@@ -369,13 +691,262 @@ static bool dequeue_element(object_t *queue, void *element, size_t maxbytes) {
 
     if (queue->used > 0U) {
         (void)memcpy(element, &queue->queueElem[(queue->head * queue->elemSize)], MIN(queue->elemSize, maxbytes));
+        if (queue->ovfl.policy == QUEUE_OVFL_COALESCE)
+            index_remove(queue, element_key(queue, &queue->queueElem[(queue->head * queue->elemSize)]), queue->head);
         queue->head = (queue->head + 1U) % queue->size;
         queue->used -= 1U;
+        queue->counters.dequeued += 1U;
         return true;
+    } else if (queue->spill.used > 0U) {
+        return unspill_element(queue, element, maxbytes);
     } else
         return false;
 }
 
+/*  ---  INDEX  ---
+ *
+ *  entry :  hash table of (key, slot + 1) pairs, slot 0 is an empty entry
+ *  mask  :  number of entries minus one (a power of two, at least twice the queue size)
+ *
+ *  (§1) linear probing, entries are never full (load factor <= 1/2)
+ *  (§2) removal by backward shift (no tombstones)
+ *  (§3) a key maps to the latest queued element with this key
+ */
+static uint32_t element_key(const object_t *queue, const void *element) {
+    uint32_t key;
+
+    (void)memcpy(&key, &((const uint8_t*)element)[queue->index.offset], sizeof(uint32_t));
+    return key;
+}
+
+static size_t index_hash(const object_t *queue, uint32_t key) {
+    key ^= key >> 16;
+    key *= 0x45D9F3BU;
+    key ^= key >> 16;
+    return (size_t)key & queue->index.mask;
+}
+
+static bool index_lookup(const object_t *queue, uint32_t key, size_t *slot) {
+    size_t i = index_hash(queue, key);
+
+    while (queue->index.entry[i].slot != NO_SLOT) {
+        if (queue->index.entry[i].key == key) {
+            *slot = (size_t)queue->index.entry[i].slot - 1U;
+            return true;
+        }
+        i = (i + 1U) & queue->index.mask;
+    }
+    return false;
+}
+
+static void index_insert(object_t *queue, uint32_t key, size_t slot) {
+    size_t i = index_hash(queue, key);
+
+    while ((queue->index.entry[i].slot != NO_SLOT) && (queue->index.entry[i].key != key))
+        i = (i + 1U) & queue->index.mask;
+    queue->index.entry[i].key = key;
+    queue->index.entry[i].slot = (uint32_t)slot + 1U;
+}
+
+static void index_remove(object_t *queue, uint32_t key, size_t slot) {
+    size_t i = index_hash(queue, key);
+    size_t j, k;
+
+    while (queue->index.entry[i].slot != NO_SLOT) {
+        if (queue->index.entry[i].key == key)
+            break;
+        i = (i + 1U) & queue->index.mask;
+    }
+    /* note: the key could map to a newer element (see index_rebuild) */
+    if (queue->index.entry[i].slot != ((uint32_t)slot + 1U))
+        return;
+    for (j = i;;) {
+        j = (j + 1U) & queue->index.mask;
+        if (queue->index.entry[j].slot == NO_SLOT)
+            break;
+        k = index_hash(queue, queue->index.entry[j].key);
+        /* entry j stays when its home position k lies cyclically in (i, j] */
+        if ((i <= j) ? ((i < k) && (k <= j)) : ((i < k) || (k <= j)))
+            continue;
+        queue->index.entry[i] = queue->index.entry[j];
+        i = j;
+    }
+    queue->index.entry[i].slot = NO_SLOT;
+}
+
+static void index_rebuild(object_t *queue) {
+    size_t n, slot;
+
+    /* note: duplicates queued before stay, the key maps to the latest one */
+    for (n = 0U; n < queue->used; n++) {
+        slot = (queue->head + n) % queue->size;
+        index_insert(queue, element_key(queue, &queue->queueElem[(slot * queue->elemSize)]), slot);
+    }
+}
+
+/*  ---  SPILL  ---
+ *
+ *  size :  total number of elements in the spill file
+ *  head :  read position of the spill file
+ *  tail :  write position of the spill file
+ *  used :  number of spilled elements
+ *  mark :  number of queued elements from which on elements are spilled
+ *
+ *  (§1) all spilled elements are younger than the elements in memory
+ *  (§2) full  :  used == size  ->  the new element is dropped
+ */
+static bool spill_element(object_t *queue, const void *element, size_t nbytes) {
+    if (queue->spill.used < queue->spill.size) {
+        if (queue->spill.used != 0U)
+            queue->spill.tail = (queue->spill.tail + 1U) % queue->spill.size;
+        else
+            queue->spill.head = queue->spill.tail;  /* to make sure */
+        (void)memcpy(&queue->spill.spillElem[(queue->spill.tail * queue->elemSize)], element, MIN(queue->elemSize, nbytes));
+        queue->spill.used += 1U;
+        queue->counters.enqueued += 1U;
+        queue->counters.spilled += 1U;
+        return true;
+    } else {
+        queue->counters.dropped += 1U;
+        queue->ovfl.counter += 1U;
+        queue->ovfl.flag = true;
+        return false;
+    }
+}
+
+static bool unspill_element(object_t *queue, void *element, size_t maxbytes) {
+    (void)memcpy(element, &queue->spill.spillElem[(queue->spill.head * queue->elemSize)], MIN(queue->elemSize, maxbytes));
+    queue->spill.head = (queue->spill.head + 1U) % queue->spill.size;
+    queue->spill.used -= 1U;
+    queue->counters.dequeued += 1U;
+    return true;
+}
+
+static uint8_t *map_spill(const char *path, size_t length) {
+    void *addr = MAP_FAILED;
+    int fd, err = 0;
+
+    /* note: the disk space is reserved, so that a full disk does not
+     *       raise SIGBUS when a page of the mapping is written back.
+     */
+    if ((fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0600)) < 0)
+        return NULL;
+#if !defined(__APPLE__)
+    err = posix_fallocate(fd, 0, (off_t)length);
+#else
+    err = (ftruncate(fd, (off_t)length) < 0) ? errno : 0;
+#endif
+    if ((err == 0) && ((addr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED))
+        err = errno;
+    /* the file lives as long as it is mapped */
+    (void)close(fd);
+    (void)unlink(path);
+    errno = err;
+    return (addr != MAP_FAILED) ? (uint8_t*)addr : NULL;
+}
+
+/*  ---  SPIN  ---
+ *
+ *  mean :  moving average of the inter-arrival time (alpha = 1/8)
+ *  spin :  max. spin time (all times in nanoseconds)
+ *
+ *  (§1) spin time = MIN(2 * mean, spin),  if mean <= spin
+ *  (§2) spin time = 0 (block at once),     if mean > spin
+ *  (§3) spin time = spin,                  if mean is unknown
+ */
+static void update_arrival(object_t *queue) {
+    uint64_t now = get_nanos();
+
+    if (queue->spin.last != 0U) {
+        uint64_t delta = now - queue->spin.last;
+        if (queue->spin.mean != 0U)
+            queue->spin.mean = queue->spin.mean - (queue->spin.mean >> 3) + (delta >> 3);
+        else
+            queue->spin.mean = delta;
+    }
+    queue->spin.last = now;
+}
+
+static uint64_t spin_deadline(const object_t *queue, uint64_t deadline) {
+    uint64_t budget = queue->spin.spin;
+
+    if (queue->spin.policy == QUEUE_WAIT_POLL)
+        return deadline;
+    if (queue->spin.mean != 0U)
+        budget = (queue->spin.mean <= budget) ? MIN(2U * queue->spin.mean, budget) : 0U;
+    return MIN(get_nanos() + budget, deadline);
+}
+
+static int spin_wait(object_t *queue, uint64_t deadline) {
+    uint32_t count = queue->wait.count;
+    uint32_t signals = queue->wait.signals;
+    uint64_t start = get_nanos();
+    uint64_t now = start;
+    int res = SPIN_EXPIRED;
+
+    /* note: the caller holds the mutex */
+    LEAVE_CRITICAL_SECTION(queue);
+    while (now < deadline) {
+        if (__atomic_load_n(&queue->wait.count, __ATOMIC_ACQUIRE) != count) {
+            res = SPIN_ARRIVED;
+            break;
+        }
+        if (__atomic_load_n(&queue->wait.signals, __ATOMIC_ACQUIRE) != signals) {
+            res = SPIN_SIGNALLED;
+            break;
+        }
+        CPU_RELAX();
+        now = get_nanos();
+    }
+    ENTER_CRITICAL_SECTION(queue);
+    /* note: an element or a signal could have come in before the mutex was
+     *       taken again; the caller must not block on the condition then.
+     */
+    if ((res == SPIN_EXPIRED) && (queue->wait.count != count))
+        res = SPIN_ARRIVED;
+    if ((res == SPIN_EXPIRED) && (queue->wait.signals != signals))
+        res = SPIN_SIGNALLED;
+    SLCAN_TRACE3(queue_spin, queue, now - start, res);
+    return res;
+}
+
+static int init_condition(pthread_cond_t *cond) {
+    pthread_condattr_t attr;
+    int res;
+
+    if ((res = pthread_condattr_init(&attr)) != 0)
+        return res;
+#if !defined(__APPLE__)
+    /* note: the wait condition is timed by the monotonic clock (not on macOS) */
+    if ((res = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC)) == 0)
+#endif
+        res = pthread_cond_init(cond, &attr);
+    (void)pthread_condattr_destroy(&attr);
+    return res;
+}
+
+static void wait_time(struct timespec *abstime, uint64_t deadline) {
+#if !defined(__APPLE__)
+    abstime->tv_sec = (time_t)(deadline / 1000000000U);
+    abstime->tv_nsec = (long)(deadline % 1000000000U);
+#else
+    uint64_t now = get_nanos();
+    uint64_t rel = (deadline > now) ? (deadline - now) : 0U;
+
+    (void)clock_gettime(CLOCK_REALTIME, abstime);
+    rel += (uint64_t)abstime->tv_nsec;
+    abstime->tv_sec += (time_t)(rel / 1000000000U);
+    abstime->tv_nsec = (long)(rel % 1000000000U);
+#endif
+}
+
+static uint64_t get_nanos(void) {
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000U) + (uint64_t)now.tv_nsec;
+}
+
 /*  ----------------------------------------------------------------------
  *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
  *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
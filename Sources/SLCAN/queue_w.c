@@ -80,13 +80,21 @@
 #define ENTER_CRITICAL_SECTION(que)  do { (void)WaitForSingleObject(que->hMutex, INFINITE); } while(0)
 #define LEAVE_CRITICAL_SECTION(que)  do { (void)ReleaseMutex(que->hMutex); } while(0)
 
+#define NO_SLOT  0U                    /* key index: empty entry */
+
 
 /*  -----------  types  --------------------------------------------------
  */
 
+typedef struct index_entry_t_ {
+    uint32_t key;
+    uint32_t slot;
+} index_entry_t;
+
 typedef struct object_t_ {
     size_t size;
     size_t used;
+    size_t high;
     size_t head;
     size_t tail;
     uint8_t *queueElem;
@@ -96,7 +104,14 @@ typedef struct object_t_ {
     struct overflow_t {
         bool flag;
         uint64_t counter;
+        int policy;
     } ovfl;
+    struct key_index_t {
+        size_t offset;
+        size_t mask;
+        index_entry_t *entry;
+    } index;
+    queue_counters_t counters;
 } object_t;
 
 
@@ -106,6 +121,15 @@ typedef struct object_t_ {
 static bool enqueue_element(object_t *queue, const void *element, size_t nbytes);
 static bool dequeue_element(object_t *queue, void *element, size_t maxbytes);
 
+static uint32_t element_key(const object_t *queue, const void *element);
+static size_t index_hash(const object_t *queue, uint32_t key);
+static bool index_lookup(const object_t *queue, uint32_t key, size_t *slot);
+static void index_insert(object_t *queue, uint32_t key, size_t slot);
+static void index_remove(object_t *queue, uint32_t key, size_t slot);
+static void index_rebuild(object_t *queue);
+
+static uint64_t get_nanos(void);
+
 
 /*  -----------  variables  ----------------------------------------------
  */
@@ -136,6 +160,7 @@ queue_t queue_create(size_t numElem, size_t elemSize) {
         object->elemSize = elemSize;
         object->size = numElem;
         object->used = 0;
+        object->high = 0;
         object->head = 0;
         object->tail = 0;
         object->ovfl.flag = false;
@@ -177,9 +202,11 @@ int queue_destroy(queue_t queue) {
     /* destroy mutex and event handle */
     (void)CloseHandle(object->hEvent);
     (void)CloseHandle(object->hMutex);
-    /* destroy the message queue */
+    /* destroy the message queue and the key index */
     if (object->queueElem)
         free(object->queueElem);
+    if (object->index.entry)
+        free(object->index.entry);
     /* C language destructor */
     free(object);
     return 0;
@@ -199,6 +226,93 @@ int queue_signal(queue_t buffer) {
     return 0;
 }
 
+int queue_wait_policy(queue_t queue, int policy, uint32_t spin) {
+    object_t *object = (object_t*)queue;
+
+    /* sanity check */
+    errno = 0;
+    if (!object) {
+        errno = EFAULT;
+        return -1;
+    }
+    if ((policy != QUEUE_WAIT_BLOCK) && (policy != QUEUE_WAIT_SPIN) && (policy != QUEUE_WAIT_POLL)) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* note: only blocking on the event object is implemented */
+    (void)spin;
+    if (policy != QUEUE_WAIT_BLOCK) {
+        errno = ENOTSUP;
+        return -1;
+    }
+    return 0;
+}
+
+int queue_overflow_policy(queue_t queue, int policy, size_t offset) {
+    object_t *object = (object_t*)queue;
+    index_entry_t *entry = NULL;
+    size_t mask = 0U;
+
+    /* sanity check */
+    errno = 0;
+    if (!object) {
+        errno = EFAULT;
+        return -1;
+    }
+    if ((policy != QUEUE_OVFL_DROP_NEWEST) && (policy != QUEUE_OVFL_DROP_OLDEST) && (policy != QUEUE_OVFL_COALESCE)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (policy == QUEUE_OVFL_COALESCE) {
+        if (((offset + sizeof(uint32_t)) > object->elemSize) || (object->size >= (size_t)UINT32_MAX)) {
+            errno = EINVAL;
+            return -1;
+        }
+        /* key index with a load factor of at most 1/2 (size and element size are fixed) */
+        for (mask = 2U; mask < (object->size * 2U); mask <<= 1)
+            ;
+        if ((entry = (index_entry_t*)calloc(mask, sizeof(index_entry_t))) == NULL) {
+            /* errno set */
+            return -1;
+        }
+        mask -= 1U;
+    }
+    /* set the overflow policy and index the queued elements, if required */
+    ENTER_CRITICAL_SECTION(object);
+    if (object->index.entry)
+        free(object->index.entry);
+    object->index.entry = entry;
+    object->index.mask = mask;
+    object->index.offset = offset;
+    object->ovfl.policy = policy;
+    if (policy == QUEUE_OVFL_COALESCE)
+        index_rebuild(object);
+    LEAVE_CRITICAL_SECTION(object);
+    /* return success */
+    return 0;
+}
+
+int queue_spill(queue_t queue, const char *path, size_t numElem, size_t mark) {
+    object_t *object = (object_t*)queue;
+
+    /* sanity check */
+    errno = 0;
+    if (!object) {
+        errno = EFAULT;
+        return -1;
+    }
+    if (mark > object->size) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* note: a spill file is not implemented (removing it is a no-op) */
+    if (path && numElem) {
+        errno = ENOTSUP;
+        return -1;
+    }
+    return 0;
+}
+
 int queue_clear(queue_t queue) {
     object_t *object = (object_t*)queue;
     int res = -1;
@@ -213,10 +327,14 @@ int queue_clear(queue_t queue) {
     ENTER_CRITICAL_SECTION(object);
     res = (int)object->used;
     object->used = 0;
+    object->high = 0;
     object->head = 0;
     object->tail = 0;
     object->ovfl.flag = false;
     object->ovfl.counter = 0U;
+    (void)memset(&object->counters, 0x00, sizeof(queue_counters_t));
+    if (object->index.entry)
+        (void)memset(object->index.entry, 0x00, (object->index.mask + 1U) * sizeof(index_entry_t));
     LEAVE_CRITICAL_SECTION(object);
     /* return number of elements removed */
     return res;
@@ -242,6 +360,49 @@ bool queue_overflow(queue_t queue, uint64_t *counter) {
     return res;
 }
 
+int queue_counters(queue_t queue, queue_counters_t *counters) {
+    object_t *object = (object_t*)queue;
+
+    /* sanity check */
+    errno = 0;
+    if (!object) {
+        errno = EFAULT;
+        return -1;
+    }
+    if (!counters) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* get a consistent copy of the counters */
+    ENTER_CRITICAL_SECTION(object);
+    (void)memcpy(counters, &object->counters, sizeof(queue_counters_t));
+    LEAVE_CRITICAL_SECTION(object);
+    /* return success */
+    return 0;
+}
+
+int queue_usage(queue_t queue, size_t *size, size_t *high) {
+    object_t *object = (object_t*)queue;
+    int res = -1;
+
+    /* sanity check */
+    errno = 0;
+    if (!object) {
+        errno = EFAULT;
+        return -1;
+    }
+    /* get fill level, capacity and high-water mark */
+    ENTER_CRITICAL_SECTION(object);
+    res = (int)object->used;
+    if (size)
+        *size = object->size;
+    if (high)
+        *high = object->high;
+    LEAVE_CRITICAL_SECTION(object);
+    /* return number of queued elements */
+    return res;
+}
+
 int queue_enqueue(queue_t queue, const void *element, size_t nbytes) {
     object_t *object = (object_t*)queue;
     int res = -1;
@@ -327,23 +488,58 @@ int queue_dequeue(queue_t queue, void *element, size_t maxbytes, uint16_t timeou
     return res;
 }
 
+int queue_dequeue_until(queue_t queue, void *element, size_t maxbytes, const struct timespec *deadline) {
+    uint64_t until, now;
+
+    /* note: the event object is waited for in milliseconds, so the time to
+     *       the deadline is rounded up (and limited to 65534 milliseconds).
+     */
+    if (!deadline)
+        return queue_dequeue(queue, element, maxbytes, 65535U);
+    until = ((uint64_t)deadline->tv_sec * 1000000000U) + (uint64_t)deadline->tv_nsec;
+    now = get_nanos();
+    if (until <= now)
+        return queue_dequeue(queue, element, maxbytes, 0U);
+    return queue_dequeue(queue, element, maxbytes, (uint16_t)MIN((until - now + 999999U) / 1000000U, 65534U));
+}
+
 /*  ---  FIFO  ---
  *
  *  size :  total number of elements
  *  head :  read position of the queue
  *  tail :  write position of the queue
  *  used :  number of queued elements
+ *  high :  max. number of queued elements (high-water mark)
  *
  *  (�1) empty :  used == 0
  *  (�2) full  :  used == size  &&  size > 0
+ *
+ *  (�3) drop-newest :  full -> the new element is dropped
+ *  (�4) drop-oldest :  full -> head and tail are advanced, the oldest element is overwritten
+ *  (�5) coalesce    :  key queued -> the queued element is replaced in place, else (�1)/(�3)
  */
 static bool enqueue_element(object_t *queue, const void *element, size_t nbytes) {
+    bool keyed = false;
+    uint32_t key = 0U;
+    size_t slot = 0U;
+
     assert(queue);
     assert(element);
     assert(queue->size);
     assert(queue->elemSize);
     assert(queue->queueElem);
 
+    /* note: an element too short to hold a key is never coalesced */
+    if ((queue->ovfl.policy == QUEUE_OVFL_COALESCE) && (nbytes >= (queue->index.offset + sizeof(uint32_t)))) {
+        key = element_key(queue, element);
+        keyed = true;
+        if (index_lookup(queue, key, &slot)) {
+            (void)memcpy(&queue->queueElem[(slot * queue->elemSize)], element, MIN(queue->elemSize, nbytes));
+            queue->counters.enqueued += 1U;
+            queue->counters.coalesced += 1U;
+            return true;
+        }
+    }
     if (queue->used < queue->size) {
         if (queue->used != 0U)
             queue->tail = (queue->tail + 1U) % queue->size;
@@ -351,8 +547,23 @@ static bool enqueue_element(object_t *queue, const void *element, size_t nbytes)
             queue->head = queue->tail;  /* to make sure */
         (void)memcpy(&queue->queueElem[(queue->tail * queue->elemSize)], element, MIN(queue->elemSize, nbytes));
         queue->used += 1U;
+        if (queue->high < queue->used)
+            queue->high = queue->used;
+        if (keyed)
+            index_insert(queue, key, queue->tail);
+        queue->counters.enqueued += 1U;
+        return true;
+    } else if (queue->ovfl.policy == QUEUE_OVFL_DROP_OLDEST) {
+        queue->head = (queue->head + 1U) % queue->size;
+        queue->tail = (queue->tail + 1U) % queue->size;
+        (void)memcpy(&queue->queueElem[(queue->tail * queue->elemSize)], element, MIN(queue->elemSize, nbytes));
+        queue->counters.enqueued += 1U;
+        queue->counters.overwritten += 1U;
+        queue->ovfl.counter += 1U;
+        queue->ovfl.flag = true;
         return true;
     } else {
+        queue->counters.dropped += 1U;
         queue->ovfl.counter += 1U;
         queue->ovfl.flag = true;
         return false;
@@ -368,13 +579,106 @@ static bool dequeue_element(object_t *queue, void *element, size_t maxbytes) {
 
     if (queue->used > 0U) {
         (void)memcpy(element, &queue->queueElem[(queue->head * queue->elemSize)], MIN(queue->elemSize, maxbytes));
+        if (queue->ovfl.policy == QUEUE_OVFL_COALESCE)
+            index_remove(queue, element_key(queue, &queue->queueElem[(queue->head * queue->elemSize)]), queue->head);
         queue->head = (queue->head + 1U) % queue->size;
         queue->used -= 1U;
+        queue->counters.dequeued += 1U;
         return true;
     } else
         return false;
 }
 
+/*  ---  INDEX  ---
+ *
+ *  entry :  hash table of (key, slot + 1) pairs, slot 0 is an empty entry
+ *  mask  :  number of entries minus one (a power of two, at least twice the queue size)
+ *
+ *  (�1) linear probing, entries are never full (load factor <= 1/2)
+ *  (�2) removal by backward shift (no tombstones)
+ *  (�3) a key maps to the latest queued element with this key
+ */
+static uint32_t element_key(const object_t *queue, const void *element) {
+    uint32_t key;
+
+    (void)memcpy(&key, &((const uint8_t*)element)[queue->index.offset], sizeof(uint32_t));
+    return key;
+}
+
+static size_t index_hash(const object_t *queue, uint32_t key) {
+    key ^= key >> 16;
+    key *= 0x45D9F3BU;
+    key ^= key >> 16;
+    return (size_t)key & queue->index.mask;
+}
+
+static bool index_lookup(const object_t *queue, uint32_t key, size_t *slot) {
+    size_t i = index_hash(queue, key);
+
+    while (queue->index.entry[i].slot != NO_SLOT) {
+        if (queue->index.entry[i].key == key) {
+            *slot = (size_t)queue->index.entry[i].slot - 1U;
+            return true;
+        }
+        i = (i + 1U) & queue->index.mask;
+    }
+    return false;
+}
+
+static void index_insert(object_t *queue, uint32_t key, size_t slot) {
+    size_t i = index_hash(queue, key);
+
+    while ((queue->index.entry[i].slot != NO_SLOT) && (queue->index.entry[i].key != key))
+        i = (i + 1U) & queue->index.mask;
+    queue->index.entry[i].key = key;
+    queue->index.entry[i].slot = (uint32_t)slot + 1U;
+}
+
+static void index_remove(object_t *queue, uint32_t key, size_t slot) {
+    size_t i = index_hash(queue, key);
+    size_t j, k;
+
+    while (queue->index.entry[i].slot != NO_SLOT) {
+        if (queue->index.entry[i].key == key)
+            break;
+        i = (i + 1U) & queue->index.mask;
+    }
+    /* note: the key could map to a newer element (see index_rebuild) */
+    if (queue->index.entry[i].slot != ((uint32_t)slot + 1U))
+        return;
+    for (j = i;;) {
+        j = (j + 1U) & queue->index.mask;
+        if (queue->index.entry[j].slot == NO_SLOT)
+            break;
+        k = index_hash(queue, queue->index.entry[j].key);
+        /* entry j stays when its home position k lies cyclically in (i, j] */
+        if ((i <= j) ? ((i < k) && (k <= j)) : ((i < k) || (k <= j)))
+            continue;
+        queue->index.entry[i] = queue->index.entry[j];
+        i = j;
+    }
+    queue->index.entry[i].slot = NO_SLOT;
+}
+
+static void index_rebuild(object_t *queue) {
+    size_t n, slot;
+
+    /* note: duplicates queued before stay, the key maps to the latest one */
+    for (n = 0U; n < queue->used; n++) {
+        slot = (queue->head + n) % queue->size;
+        index_insert(queue, element_key(queue, &queue->queueElem[(slot * queue->elemSize)]), slot);
+    }
+}
+
+static uint64_t get_nanos(void) {
+    LARGE_INTEGER counter, frequency;
+
+    (void)QueryPerformanceFrequency(&frequency);
+    (void)QueryPerformanceCounter(&counter);
+    return ((uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000U) +
+           (((uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000U) / (uint64_t)frequency.QuadPart);
+}
+
 /*  ----------------------------------------------------------------------
  *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
  *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
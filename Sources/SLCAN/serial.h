@@ -86,6 +86,11 @@
 typedef void *sio_port_t;               /**< serial port (opaque data type) */
 
 /** @brief       reception callback function
+ *
+ *  @remarks     When the reception thread loses the connection (e.g. the peer
+ *               has closed a socket or the device has gone), the callback is
+ *               called once with buffer NULL and nbytes 0 before the thread
+ *               terminates (not on Windows, where the thread keeps on reading).
  *
  *  @param[in]   receiver -  pointer to an instance to handle the received data
  *  @param[in]   buffer   -  data buffer with the received data
@@ -137,7 +142,7 @@ extern int sio_destroy(sio_port_t port);
 /** @brief       establishes a connection with the serial communication device.
  *
  *  @param[in]   port    - pointer to a port instance
- *  @param[in]   device  - name of the serial device
+ *  @param[in]   device  - name of the serial device, or an URI (see remarks)
  *  @param[in]   attr    - serial port attributes (optional)
  *
  *  @returns     a file descriptor if successful, or a negative value on error.
@@ -147,10 +152,32 @@ extern int sio_destroy(sio_port_t port);
  *  @note        System variable 'errno' will be set in case of an error.
  *
  *  @retval      ENODEV   - no such device (invalid port instance)
- *  @retval      EINVAL   - invalid argument (device name is NULL)
+ *  @retval      EINVAL   - invalid argument (device name is NULL, or
+ *                          baud rate not supported by the device)
  *  @retval      EALREADY - already connected with the serial device
+ *  @retval      EPROTONOSUPPORT - unknown URI scheme
  *  @retval      'errno'  - error code from called system functions:
- *                          'open', 'tcsetattr', 'pthread_create'
+ *                          'open', 'tcsetattr', 'ioctl', 'pthread_create',
+ *                          'getaddrinfo', 'socket', 'connect'
+ *
+ *  @remarks     On POSIX systems the transport is selected by the URI scheme
+ *               of the device name:
+ *               - 'tty://<device>' or '<device>': serial device (termios)
+ *               - 'pty://<device>': pseudo terminal (raw, no line settings)
+ *               - 'tcp://<host>:<port>': TCP stream (e.g. to a ser2net bridge)
+ *               - 'udp://<host>:<port>': UDP datagrams
+ *               The serial port attributes are only applied to serial devices.
+ *
+ *  @remarks     On Linux, arbitrary baud rates are set by termios2 (BOTHER)
+ *               on x86, ARM and RISC-V; elsewhere only the predefined baud
+ *               rates are available. The baud rate actually achieved by the driver is read back
+ *               and can be retrieved by function sio_get_attr.
+ *
+ *  @remarks     With option SIO_OPTION_LOWLATENCY the driver flag ASYNC_LOW_LATENCY
+ *               is set (TIOCSSERIAL) and the latency timer of an USB-serial
+ *               converter is lowered (sysfs), as far as permitted. The effective
+ *               values can be retrieved by function sio_get_latency. The original
+ *               settings are restored by function sio_disconnect.
  */
 extern int sio_connect(sio_port_t port, const char *device, const sio_attr_t *attr);
 
@@ -186,6 +213,60 @@ extern int sio_disconnect(sio_port_t port);
 extern int sio_get_attr(sio_port_t port, sio_attr_t* attr);
 
 
+/** @brief       returns the effective latency settings of the serial device.
+ *
+ *  @param[in]   port     - pointer to a port instance
+ *  @param[out]  latency  - latency settings (SIO_LATENCY_UNKNOWN if a
+ *                          setting is not available for the device)
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      ENODEV   - no such device (invalid port instance)
+ *  @retval      EINVAL   - invalid argument (latency is NULL)
+ */
+extern int sio_get_latency(sio_port_t port, sio_latency_t *latency);
+
+
+/** @brief       samples the line error counters of the serial device (overruns,
+ *               framing and parity errors, break conditions).
+ *
+ *  @remarks     The counters are relative to the time of connecting. They are
+ *               sampled on each call and once more when disconnecting; after
+ *               disconnecting the last sample is returned.
+ *
+ *  @param[in]   port      - pointer to a port instance
+ *  @param[out]  counters  - line error counters
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      ENODEV   - no such device (invalid port instance)
+ *  @retval      EINVAL   - invalid argument (counters is NULL)
+ *  @retval      ENOTSUP  - counters not supported by the device or the driver
+ *                          (e.g. pseudo terminals)
+ */
+extern int sio_get_counters(sio_port_t port, sio_counters_t *counters);
+
+
+/** @brief       returns the number of bytes in the output queue of the serial
+ *               device (not yet transmitted).
+ *
+ *  @param[in]   port    - pointer to a port instance
+ *
+ *  @returns     number of bytes in the output queue, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      ENODEV   - no such device (invalid port instance)
+ *  @retval      EBADF    - bad file descriptor (device not connected)
+ *  @retval      'errno'  - error code from called system function 'ioctl'
+ */
+extern int sio_output_queue(sio_port_t port);
+
+
 /** @brief       transmits n data bytes via a serial communication device.
  *
  *  @remarks     A connection with the serial communication device must be
@@ -195,7 +276,12 @@ extern int sio_get_attr(sio_port_t port, sio_attr_t* attr);
  *  @param[in]   buffer  - data buffer with the data to be sent
  *  @param[in]   nbytes  - number of data bytes to be sent
  *
- *  @returns     0 if successful, or a negative value on error.
+ *  @returns     the number of bytes sent if successful, or a negative value on error.
+ *
+ *  @remarks     Partial writes are continued until all bytes are sent. If the
+ *               output queue is full (e.g. CTS deasserted by the device), the
+ *               function waits for the device to become writable again. When
+ *               this takes too long, the number of bytes sent so far is returned.
  *
  *  @note        System variable 'errno' will be set in case of an error.
  *
@@ -203,7 +289,7 @@ extern int sio_get_attr(sio_port_t port, sio_attr_t* attr);
  *  @retval      EINVAL   - invalid argument (buffer is NULL)
  *  @retval      EBADF    - bad file descriptor (device not connected)
  *  @retval      'errno'  - error code from called system functions:
- *                          'write'
+ *                          'write', 'poll'
  */
 extern int sio_transmit(sio_port_t port, const uint8_t *buffer, size_t nbytes);
 
@@ -69,6 +69,21 @@
 /*  -----------  defines  ------------------------------------------------
  */
 
+/** @name  Port options
+ *  @brief Options for the serial port (bit mask)
+ *  @{ */
+#define SIO_OPTION_NONE         0x00U   /**< no options */
+#define SIO_OPTION_LOWLATENCY   0x01U   /**< low-latency mode (if supported) */
+#define SIO_OPTION_RTSCTS       0x02U   /**< RTS/CTS hardware flow control */
+/* note: bit 7 is reserved for the SLCAN layer (SLCAN_OPTION_LAZYDECODE) */
+/** @} */
+
+/** @name  Latency
+ *  @brief Value for unknown or not applicable latency settings
+ *  @{ */
+#define SIO_LATENCY_UNKNOWN     (-1)    /**< setting not available */
+/** @} */
+
 
 /*  -----------  types  --------------------------------------------------
  */
@@ -107,8 +122,26 @@ typedef struct sio_attr_t_ {            /* serial port attributes: */
     sio_bytesize_t bytesize;            /**<  number of data bits (5, 6, 7, 8) */
     sio_parity_t parity;                /**<  parity bit (none, odd, even, mark, space) */
     sio_stopbits_t stopbits;            /**<  number of stop bits (1 or 1.5 or 2) */
+    uint8_t options;                    /**<  port options (bit mask) */
 } sio_attr_t;
 
+/** @brief       Latency settings (effective values)
+ */
+typedef struct sio_latency_t_ {         /* latency settings: */
+    int low_latency;                    /**<  low-latency flag of the driver (0 or 1) */
+    int latency_timer;                  /**<  latency timer of an USB-serial converter (in [ms]) */
+} sio_latency_t;
+
+/** @brief       Line error counters (since connect)
+ */
+typedef struct sio_counters_t_ {        /* line error counters: */
+    uint32_t overrun;                   /**<  hardware overruns (UART receive FIFO) */
+    uint32_t buf_overrun;               /**<  buffer overruns (driver receive buffer) */
+    uint32_t frame;                     /**<  framing errors */
+    uint32_t parity;                    /**<  parity errors */
+    uint32_t brk;                       /**<  break conditions */
+} sio_counters_t;
+
 
 /*  -----------  variables  ----------------------------------------------
  */
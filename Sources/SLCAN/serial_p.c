@@ -60,7 +60,9 @@
  */
 #include "serial.h"
 #include "logger.h"
+#include "trace.h"
 
+#include <stdbool.h>
 #include <string.h>
 #include <stdlib.h>
 #include <errno.h>
@@ -70,7 +72,19 @@
 #include <pthread.h>
 #include <sys/select.h>
 #include <sys/time.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
 #include <assert.h>
+#if defined(__linux__)
+#include <stdio.h>
+#include <limits.h>
+#include <libgen.h>
+#include <linux/serial.h>
+#endif
 
 
 /*  -----------  options  ------------------------------------------------
@@ -80,21 +94,43 @@
 #error Baudrate limited to 38400 by system (unfeasible)
 #endif
 
+/* note: arbitrary baud rates are set by 'termios2' (BOTHER) on Linux,
+ *       if the architecture provides the ioctls TCGETS2 and TCSETS2 and
+ *       uses the generic layout of 'struct termios2' (see types below).
+ *       MIPS, PowerPC, Alpha and SPARC have their own layouts, there
+ *       only the predefined baud rates are available.
+ */
+#if defined(__linux__) && defined(TCGETS2) && defined(CBAUDEX) && \
+   (defined(__x86_64__) || defined(__i386__) || defined(__aarch64__) || defined(__arm__) || defined(__riscv))
+#define OPTION_SERIAL_TERMIOS2  1
+#else
+#define OPTION_SERIAL_TERMIOS2  0
+#endif
+
+/* note: line error counters are provided by the ioctl TIOCGICOUNT on Linux
+ *       (by UART drivers and most USB-serial drivers, but not by ptys).
+ */
+#if defined(__linux__) && defined(TIOCGICOUNT)
+#define OPTION_SERIAL_ICOUNT  1
+#else
+#define OPTION_SERIAL_ICOUNT  0
+#endif
+
 #if (OPTION_SERIAL_DEBUG_LEVEL > 0)
-#define SERIAL_DEBUG_ERROR(...)  log_printf(__VA_ARGS__)
+#define SERIAL_DEBUG_ERROR(...)  do { if (LOG_ENABLED(LOG_LEVEL_ERROR)) (void)log_printf(__VA_ARGS__); } while (0)
 #else
 #define SERIAL_DEBUG_ERROR(...)  while (0)
 #endif
 
 #if (OPTION_SERIAL_DEBUG_LEVEL > 1)
-#define SERIAL_DEBUG_INFO(...)  log_printf(__VA_ARGS__)
+#define SERIAL_DEBUG_INFO(...)  do { if (LOG_ENABLED(LOG_LEVEL_INFO)) (void)log_printf(__VA_ARGS__); } while (0)
 #else
 #define SERIAL_DEBUG_INFO(...)  while (0)
 #endif
 
 #if (OPTION_SERIAL_DEBUG_LEVEL > 2)
-#define SERIAL_DEBUG_ASYNC(...)  log_async(__VA_ARGS__)
-#define SERIAL_DEBUG_SYNC(...)  log_sync(__VA_ARGS__)
+#define SERIAL_DEBUG_ASYNC(...)  do { if (LOG_ENABLED(LOG_LEVEL_DATA)) (void)log_async(__VA_ARGS__); } while (0)
+#define SERIAL_DEBUG_SYNC(...)  do { if (LOG_ENABLED(LOG_LEVEL_DATA)) (void)log_sync(__VA_ARGS__); } while (0)
 #undef SERIAL_DEBUG_INFO
 #define SERIAL_DEBUG_INFO(...)  while (0)
 #else
@@ -110,28 +146,120 @@
 #define STOPBITS        CSTOPB
 #define BUFFER_SIZE     1024
 
+#define BAUDRATE_TOLERANCE  3U  /* max. deviation of the achieved baud rate (in [%]) */
+
+#define WRITE_TIMEOUT   1000    /* max. waiting time for the device to become writable (in [ms]) */
+#define CONNECT_TIMEOUT 3000    /* max. waiting time for a TCP connection (in [ms]) */
+
+#define URI_TTY         "tty://"
+#define URI_PTY         "pty://"
+#define URI_TCP         "tcp://"
+#define URI_UDP         "udp://"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL    0       /* note: SO_NOSIGPIPE is set instead (macOS) */
+#endif
+
+#define LATENCY_TIMER   1       /* latency timer of USB-serial converters (in [ms]) */
+#define LATENCY_SYSFS   "/sys/bus/usb-serial/devices/%s/latency_timer"
+
+#if (OPTION_SERIAL_TERMIOS2 != 0)
+#ifndef BOTHER
+#define BOTHER          0010000
+#endif
+#ifndef IBSHIFT
+#define IBSHIFT         16
+#endif
+#define K_NCCS          19
+#define K_TCGETS2       _IOR('T', 0x2A, struct termios2_)
+#define K_TCSETS2       _IOW('T', 0x2B, struct termios2_)
+#endif
+
 
 /*  -----------  types  --------------------------------------------------
  */
 
+#if (OPTION_SERIAL_TERMIOS2 != 0)
+/* note: <asm/termbits.h> cannot be included together with <termios.h>,
+ *       so this is a copy of 'struct termios2' from <asm-generic/termbits.h>
+ */
+struct termios2_ {
+    tcflag_t c_iflag;
+    tcflag_t c_oflag;
+    tcflag_t c_cflag;
+    tcflag_t c_lflag;
+    cc_t c_line;
+    cc_t c_cc[K_NCCS];
+    speed_t c_ispeed;
+    speed_t c_ospeed;
+};
+#endif
+
 typedef struct serial_t_ {
     int fildes;
+    const struct transport_t_ *transport;
     pthread_t pthread;
     sio_attr_t attr;
+    sio_latency_t latency;
+#if defined(__linux__)
+    struct {                    /* latency settings changed on connect: */
+        int low_latency;        /*   original driver flag (or -1) */
+        int latency_timer;      /*   original latency timer (or -1) */
+        char path[PATH_MAX];    /*   sysfs attribute of the latency timer */
+    } saved;
+#endif
+    sio_counters_t counters;
+#if (OPTION_SERIAL_ICOUNT != 0)
+    struct serial_icounter_struct icount;
+#endif
     sio_recv_t callback;
     void *receiver;
 } serial_t;
 
+/* note: the transport is selected by the URI scheme of the device name,
+ *       a device name without scheme is opened as TTY (character device).
+ */
+typedef struct transport_t_ {
+    const char *scheme;
+    int (*open)(serial_t *serial, const char *address);
+    int (*close)(serial_t *serial);
+    ssize_t (*write)(int fildes, const uint8_t *buffer, size_t nbytes);
+    bool stream;  /* end-of-file on read means the peer has gone */
+} transport_t;
+
 
 /*  -----------  prototypes  ---------------------------------------------
  */
 
 static void *reception_loop(void *arg);
+static const transport_t *select_transport(const char *device, const char **address);
+static int tty_open(serial_t *serial, const char *device);
+static int tty_close(serial_t *serial);
+static ssize_t tty_write(int fildes, const uint8_t *buffer, size_t nbytes);
+static int pty_open(serial_t *serial, const char *device);
+static int tcp_open(serial_t *serial, const char *address);
+static int udp_open(serial_t *serial, const char *address);
+static int socket_open(const char *address, int type);
+static int socket_close(serial_t *serial);
+static ssize_t socket_write(int fildes, const uint8_t *buffer, size_t nbytes);
+static void low_latency(serial_t *serial, const char *device);
+static void restore_latency(serial_t *serial);
+static int line_counters(serial_t *serial, bool reset);
+#if (OPTION_SERIAL_TERMIOS2 != 0)
+static int termios2_baudrate(int fildes, uint32_t *baudrate, bool other);
+#endif
 
 
 /*  -----------  variables  ----------------------------------------------
  */
 
+static const transport_t transports[] = {
+    { URI_TTY, tty_open, tty_close, tty_write, false },
+    { URI_PTY, pty_open, tty_close, tty_write, false },
+    { URI_TCP, tcp_open, socket_close, socket_write, true },
+    { URI_UDP, udp_open, socket_close, socket_write, false }
+};
+
 
 /*  -----------  functions  ----------------------------------------------
  */
@@ -204,10 +332,15 @@ sio_port_t sio_create(sio_recv_t callback, void *receiver) {
     /* C language constructor */
     if ((serial = (serial_t*)malloc(sizeof(serial_t))) != NULL) {
         serial->fildes = -1;
+        serial->transport = &transports[0];
         serial->attr.baudrate = BAUDRATE;
         serial->attr.bytesize = BYTESIZE8;
         serial->attr.parity = PARITYNONE;
         serial->attr.stopbits = STOPBITS1;
+        serial->attr.options = SIO_OPTION_NONE;
+        serial->latency.low_latency = SIO_LATENCY_UNKNOWN;
+        serial->latency.latency_timer = SIO_LATENCY_UNKNOWN;
+        memset(&serial->counters, 0, sizeof(sio_counters_t));
         serial->callback = callback;
         serial->receiver = receiver;
     }
@@ -249,6 +382,47 @@ int sio_get_attr(sio_port_t port, sio_attr_t* attr) {
     attr->bytesize = serial->attr.bytesize;
     attr->stopbits = serial->attr.stopbits;
     attr->parity = serial->attr.parity;
+    attr->options = serial->attr.options;
+    return 0;
+}
+
+int sio_get_latency(sio_port_t port, sio_latency_t *latency) {
+    serial_t* serial = (serial_t*)port;
+
+    /* sanity check */
+    errno = 0;
+    if (!serial) {
+        errno = ENODEV;
+        return -1;
+    }
+    if (!latency) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* effective latency settings */
+    latency->low_latency = serial->latency.low_latency;
+    latency->latency_timer = serial->latency.latency_timer;
+    return 0;
+}
+
+int sio_get_counters(sio_port_t port, sio_counters_t *counters) {
+    serial_t* serial = (serial_t*)port;
+
+    /* sanity check */
+    errno = 0;
+    if (!serial) {
+        errno = ENODEV;
+        return -1;
+    }
+    if (!counters) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* sample the line error counters (if connected) */
+    if ((serial->fildes != -1) && (line_counters(serial, false) < 0))
+        return -1;
+    /* line error counters (since connect) */
+    memcpy(counters, &serial->counters, sizeof(sio_counters_t));
     return 0;
 }
 
@@ -267,7 +441,9 @@ int sio_signal(sio_port_t port) {
 
 int sio_connect(sio_port_t port, const char *device, const sio_attr_t *param) {
     serial_t *serial = (serial_t*)port;
-    struct termios attr;
+    const transport_t *transport;
+    const char *address;
+    int rc;
 
     /* sanity check */
     errno = 0;
@@ -289,40 +465,30 @@ int sio_connect(sio_port_t port, const char *device, const sio_attr_t *param) {
         serial->attr.bytesize = param->bytesize;
         serial->attr.stopbits = param->stopbits;
         serial->attr.parity = param->parity;
+        serial->attr.options = param->options;
         // TODO: range check required?
     }
-    /* connect to serial port */
-    if ((serial->fildes = open(device, O_RDWR | O_NONBLOCK)) < 0) {
-        /* errno set */
+    /* select the transport by the URI scheme of the device name */
+    if ((transport = select_transport(device, &address)) == NULL) {
+        errno = EPROTONOSUPPORT;
         return -1;
     }
-    /* set connection attributes */
-    tcgetattr(serial->fildes, &attr);
-    attr.c_cflag = CREAD | CLOCAL;
-    attr.c_cflag |= cbytesize(serial->attr.bytesize);
-    attr.c_cflag |= cstopbits(serial->attr.stopbits);
-    attr.c_cflag |= cparity(serial->attr.parity);
-#ifdef CBAUDEX
-    attr.c_cflag |= cbaudex(serial->attr.baudrate);
-#else
-    cfsetispeed(&attr, serial->attr.baudrate);
-    cfsetospeed(&attr, serial->attr.baudrate);
-#endif
-    attr.c_iflag = 0;
-    attr.c_oflag = 0;
-    attr.c_lflag = 0;
-    tcflush(serial->fildes, TCIOFLUSH);
-    if (tcsetattr(serial->fildes, TCSANOW, &attr) < 0) {
+    serial->latency.low_latency = SIO_LATENCY_UNKNOWN;
+    serial->latency.latency_timer = SIO_LATENCY_UNKNOWN;
+    memset(&serial->counters, 0, sizeof(sio_counters_t));
+    /* connect to serial port (or its stand-in) */
+    if (transport->open(serial, address) < 0) {
         /* errno set */
-        close(serial->fildes);
-        serial->fildes = -1;
         return -1;
     }
+    serial->transport = transport;
     /* create the reception thread */
-    if (pthread_create(&serial->pthread, NULL, reception_loop, (void*)serial) < 0) {
-        /* errno set */
-        close(serial->fildes);
+    if ((rc = pthread_create(&serial->pthread, NULL, reception_loop, (void*)serial)) != 0) {
+        /* note: the same teardown as in 'sio_disconnect' (w/o a thread) */
+        (void)serial->transport->close(serial);
+        serial->transport = &transports[0];
         serial->fildes = -1;
+        errno = rc;
         return -1;
     }
     /* everything is a file */
@@ -342,8 +508,9 @@ int sio_disconnect(sio_port_t port) {
         errno = EBADF;
         return -1;
     }
-    /* kill the reception thread */
-    if (pthread_cancel(serial->pthread) == 0) {
+    /* kill the reception thread (note: it terminates by itself on hang-up) */
+    int rc = pthread_cancel(serial->pthread);
+    if ((rc == 0) || (rc == ESRCH)) {
 #if (1)
         assert(pthread_join(serial->pthread, NULL) == 0);
 #else
@@ -353,13 +520,8 @@ int sio_disconnect(sio_port_t port) {
             fprintf(stderr, "+++ error(serial): worker thread not cancelled!\n");
 #endif
     }
-    /* purge all pending transfers */
-    if (tcflush(serial->fildes, TCIOFLUSH) < 0) {
-        /* errno set */
-        errno = 0;
-    }
-    /* disconnect from serial port */
-    int res = close(serial->fildes);
+    /* disconnect from serial port (or its stand-in) */
+    int res = serial->transport->close(serial);
     if (res >= 0)
         serial->fildes = -1;
     return res;
@@ -383,12 +545,482 @@ int sio_transmit(sio_port_t port, const uint8_t *buffer, size_t nbytes) {
         return -1;
     }
     /* send n bytes (errno set on error) */
-    ssize_t sent = write(serial->fildes, buffer, nbytes);
-    SERIAL_DEBUG_SYNC(buffer, (size_t)sent);
-    // TODO: 'blocking write' required?
+    size_t sent = 0U;
+    while (sent < nbytes) {
+        ssize_t res = serial->transport->write(serial->fildes, &buffer[sent], nbytes - sent);
+        SLCAN_TRACE3(serial_write, serial, nbytes - sent, res);
+        if (res > 0) {
+            SERIAL_DEBUG_SYNC(&buffer[sent], (size_t)res);
+            sent += (size_t)res;
+        } else if ((res < 0) && (errno == EINTR)) {
+            continue;
+        } else if ((res == 0) || (errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            /* output queue full: wait until the device becomes writable */
+            struct pollfd fds;
+            fds.fd = serial->fildes;
+            fds.events = POLLOUT;
+            fds.revents = 0;
+            int rdy = poll(&fds, 1, WRITE_TIMEOUT);
+            if ((rdy < 0) && (errno == EINTR))
+                continue;
+            if (rdy < 0)
+                return (sent > 0U) ? (int)sent : -1;
+            if (rdy == 0)
+                break;  /* note: the caller will detect the short write */
+            if (fds.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                errno = EIO;
+                return (sent > 0U) ? (int)sent : -1;
+            }
+        } else {
+            /* errno set */
+            return (sent > 0U) ? (int)sent : -1;
+        }
+    }
+    /* note: EAGAIN from a partial write is not an error */
+    if (sent == nbytes)
+        errno = 0;
     return (int)sent;
 }
 
+int sio_output_queue(sio_port_t port) {
+    serial_t *serial = (serial_t*)port;
+    int count = 0;
+
+    /* sanity check */
+    errno = 0;
+    if (!serial) {
+        errno = ENODEV;
+        return -1;
+    }
+    if (serial->fildes == -1) {
+        errno = EBADF;
+        return -1;
+    }
+    /* number of bytes in the output queue (errno set on error) */
+    if (ioctl(serial->fildes, TIOCOUTQ, &count) < 0)
+        return -1;
+    return count;
+}
+
+static int tty_open(serial_t *serial, const char *device) {
+    struct termios attr;
+#ifdef CBAUDEX
+    tcflag_t speed;
+#endif
+    uint32_t baudrate;
+    uint64_t deviation;
+
+    assert(serial);
+    assert(device);
+
+    if (serial->attr.baudrate == 0U) {
+        errno = EINVAL;
+        return -1;
+    }
+#if defined(CBAUDEX) && (OPTION_SERIAL_TERMIOS2 == 0)
+    /* note: w/o termios2 only the predefined baud rates are possible */
+    if (cbaudex(serial->attr.baudrate) == B0) {
+        errno = EINVAL;
+        return -1;
+    }
+#endif
+    /* connect to serial port */
+    if ((serial->fildes = open(device, O_RDWR | O_NONBLOCK)) < 0) {
+        /* errno set */
+        return -1;
+    }
+    /* set connection attributes */
+    tcgetattr(serial->fildes, &attr);
+    attr.c_cflag = CREAD | CLOCAL;
+    attr.c_cflag |= cbytesize(serial->attr.bytesize);
+    attr.c_cflag |= cstopbits(serial->attr.stopbits);
+    attr.c_cflag |= cparity(serial->attr.parity);
+    if (serial->attr.options & SIO_OPTION_RTSCTS)
+        attr.c_cflag |= CRTSCTS;
+#ifdef CBAUDEX
+    speed = cbaudex(serial->attr.baudrate);
+    /* note: an arbitrary baud rate is set afterwards by termios2 */
+    attr.c_cflag |= (speed != B0) ? speed : B38400;
+#else
+    if ((cfsetispeed(&attr, (speed_t)serial->attr.baudrate) < 0) ||
+        (cfsetospeed(&attr, (speed_t)serial->attr.baudrate) < 0)) {
+        /* errno set */
+        close(serial->fildes);
+        serial->fildes = -1;
+        return -1;
+    }
+#endif
+    attr.c_iflag = 0;
+    attr.c_oflag = 0;
+    attr.c_lflag = 0;
+    tcflush(serial->fildes, TCIOFLUSH);
+    if (tcsetattr(serial->fildes, TCSANOW, &attr) < 0) {
+        /* errno set */
+        close(serial->fildes);
+        serial->fildes = -1;
+        return -1;
+    }
+    /* set arbitrary baud rate (if required) and read back the achieved rate */
+    baudrate = serial->attr.baudrate;
+#if (OPTION_SERIAL_TERMIOS2 != 0)
+    if (termios2_baudrate(serial->fildes, &baudrate, (speed == B0)) < 0) {
+        /* errno set */
+        close(serial->fildes);
+        serial->fildes = -1;
+        return -1;
+    }
+#elif !defined(CBAUDEX)
+    if (tcgetattr(serial->fildes, &attr) == 0)
+        baudrate = (uint32_t)cfgetospeed(&attr);
+#endif
+    /* note: the UART tolerates only a small deviation from the nominal rate */
+    deviation = (baudrate > serial->attr.baudrate) ? (uint64_t)(baudrate - serial->attr.baudrate)
+                                                   : (uint64_t)(serial->attr.baudrate - baudrate);
+    if ((baudrate == 0U) || ((deviation * 100U) > ((uint64_t)serial->attr.baudrate * BAUDRATE_TOLERANCE))) {
+        close(serial->fildes);
+        serial->fildes = -1;
+        errno = EINVAL;
+        return -1;
+    }
+    serial->attr.baudrate = baudrate;
+    /* low-latency settings (optional, as far as permitted) */
+    low_latency(serial, device);
+    /* line error counters (relative to the time of connecting) */
+    if (line_counters(serial, true) < 0)
+        errno = 0;  /* note: not supported by all drivers */
+    return serial->fildes;
+}
+
+static int tty_close(serial_t *serial) {
+    assert(serial);
+
+    /* last sample of the line error counters */
+    if (line_counters(serial, false) < 0)
+        errno = 0;
+    /* restore the latency settings changed on connect */
+    restore_latency(serial);
+    /* purge all pending transfers */
+    if (tcflush(serial->fildes, TCIOFLUSH) < 0) {
+        /* errno set */
+        errno = 0;
+    }
+    return close(serial->fildes);
+}
+
+static ssize_t tty_write(int fildes, const uint8_t *buffer, size_t nbytes) {
+    return write(fildes, buffer, nbytes);
+}
+
+static int pty_open(serial_t *serial, const char *device) {
+    struct termios attr;
+
+    assert(serial);
+    assert(device);
+
+    /* note: the baud rate and the line settings are meaningless for a
+     *       pseudo terminal, so the slave side is just set to raw mode.
+     */
+    if ((serial->fildes = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK)) < 0) {
+        /* errno set */
+        return -1;
+    }
+    if (!isatty(serial->fildes) || (tcgetattr(serial->fildes, &attr) < 0)) {
+        close(serial->fildes);
+        serial->fildes = -1;
+        errno = ENOTTY;
+        return -1;
+    }
+    cfmakeraw(&attr);
+    attr.c_cflag |= CREAD | CLOCAL;
+    tcflush(serial->fildes, TCIOFLUSH);
+    if (tcsetattr(serial->fildes, TCSANOW, &attr) < 0) {
+        /* errno set */
+        close(serial->fildes);
+        serial->fildes = -1;
+        return -1;
+    }
+    return serial->fildes;
+}
+
+static int tcp_open(serial_t *serial, const char *address) {
+    assert(serial);
+
+    /* note: a TCP stream with Nagle's algorithm disabled (TCP_NODELAY),
+     *       e.g. to a ser2net-style bridge in raw mode.
+     */
+    serial->fildes = socket_open(address, SOCK_STREAM);
+    return serial->fildes;
+}
+
+static int udp_open(serial_t *serial, const char *address) {
+    assert(serial);
+
+    /* note: a connected UDP socket, one datagram per transmission. */
+    serial->fildes = socket_open(address, SOCK_DGRAM);
+    return serial->fildes;
+}
+
+static int socket_open(const char *address, int type) {
+    struct addrinfo hints, *list, *info;
+    char host[NI_MAXHOST];
+    const char *service;
+    size_t length;
+    int fildes = -1;
+    int err = ECONNREFUSED;
+    int on = 1;
+
+    assert(address);
+
+    /* split the address into host and port: 'host:port' or '[IPv6]:port' */
+    if (((service = strrchr(address, ':')) == NULL) || (*(service + 1) == '\0')) {
+        errno = EINVAL;
+        return -1;
+    }
+    length = (size_t)(service - address);
+    if ((length >= 2U) && (address[0] == '[') && (address[length - 1U] == ']')) {
+        address += 1;
+        length -= 2U;
+    }
+    if ((length == 0U) || (length >= NI_MAXHOST)) {
+        errno = EINVAL;
+        return -1;
+    }
+    memcpy(host, address, length);
+    host[length] = '\0';
+    service += 1;
+    /* resolve the host name and try all addresses */
+    memset(&hints, 0, sizeof(struct addrinfo));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = type;
+    if ((err = getaddrinfo(host, service, &hints, &list)) != 0) {
+        errno = (err == EAI_SYSTEM) ? errno : EHOSTUNREACH;
+        return -1;
+    }
+    for (info = list; info != NULL; info = info->ai_next) {
+        if ((fildes = socket(info->ai_family, info->ai_socktype, info->ai_protocol)) < 0) {
+            err = errno;
+            continue;
+        }
+        /* non-blocking connect with time-out (UDP: just sets the peer address) */
+        (void)fcntl(fildes, F_SETFL, fcntl(fildes, F_GETFL) | O_NONBLOCK);
+        if (connect(fildes, info->ai_addr, info->ai_addrlen) == 0)
+            break;
+        if (errno == EINPROGRESS) {
+            struct pollfd fds;
+            socklen_t size = sizeof(err);
+            fds.fd = fildes;
+            fds.events = POLLOUT;
+            fds.revents = 0;
+            if (poll(&fds, 1, CONNECT_TIMEOUT) == 1) {
+                if ((getsockopt(fildes, SOL_SOCKET, SO_ERROR, &err, &size) == 0) && (err == 0))
+                    break;
+            } else {
+                err = ETIMEDOUT;
+            }
+        } else {
+            err = errno;
+        }
+        close(fildes);
+        fildes = -1;
+    }
+    freeaddrinfo(list);
+    if (fildes < 0) {
+        errno = err;
+        return -1;
+    }
+    /* socket options (best effort) */
+    if (type == SOCK_STREAM) {
+        (void)setsockopt(fildes, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        (void)setsockopt(fildes, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
+    }
+#ifdef SO_NOSIGPIPE
+    (void)setsockopt(fildes, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+    errno = 0;
+    return fildes;
+}
+
+static int socket_close(serial_t *serial) {
+    assert(serial);
+
+    (void)shutdown(serial->fildes, SHUT_RDWR);
+    return close(serial->fildes);
+}
+
+static ssize_t socket_write(int fildes, const uint8_t *buffer, size_t nbytes) {
+    /* note: a broken connection shall be reported as EPIPE, not by SIGPIPE */
+    return send(fildes, buffer, nbytes, MSG_NOSIGNAL);
+}
+
+static const transport_t *select_transport(const char *device, const char **address) {
+    size_t i;
+
+    assert(device);
+    assert(address);
+
+    for (i = 0U; i < (sizeof(transports) / sizeof(transport_t)); i++) {
+        if (!strncmp(device, transports[i].scheme, strlen(transports[i].scheme))) {
+            *address = device + strlen(transports[i].scheme);
+            return &transports[i];
+        }
+    }
+    /* unknown URI scheme */
+    if (strstr(device, "://") != NULL)
+        return NULL;
+    /* no scheme: TTY device */
+    *address = device;
+    return &transports[0];
+}
+
+#if (OPTION_SERIAL_TERMIOS2 != 0)
+static int termios2_baudrate(int fildes, uint32_t *baudrate, bool other) {
+    struct termios2_ tio;
+
+    assert(baudrate);
+
+    if (ioctl(fildes, K_TCGETS2, &tio) < 0)
+        return -1;
+    if (other) {
+        /* set the baud rate as number (BOTHER) for input and output */
+        tio.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+        tio.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+        tio.c_ispeed = (speed_t)*baudrate;
+        tio.c_ospeed = (speed_t)*baudrate;
+        if (ioctl(fildes, K_TCSETS2, &tio) < 0)
+            return -1;
+        /* read back what the driver has made of it */
+        if (ioctl(fildes, K_TCGETS2, &tio) < 0)
+            return -1;
+    }
+    /* note: the kernel reports the baud rate achieved by the driver */
+    *baudrate = (uint32_t)tio.c_ospeed;
+    return 0;
+}
+#endif
+
+static void low_latency(serial_t *serial, const char *device) {
+#if defined(__linux__)
+    struct serial_struct info;
+    char path[PATH_MAX];
+    char real[PATH_MAX];
+    FILE *fp;
+    int value;
+#endif
+    assert(serial);
+    assert(device);
+
+    serial->latency.low_latency = SIO_LATENCY_UNKNOWN;
+    serial->latency.latency_timer = SIO_LATENCY_UNKNOWN;
+#if defined(__linux__)
+    serial->saved.low_latency = -1;
+    serial->saved.latency_timer = -1;
+    serial->saved.path[0] = '\0';
+
+    /* (1) driver flag ASYNC_LOW_LATENCY (n/a for pseudo terminals) */
+    if (ioctl(serial->fildes, TIOCGSERIAL, &info) == 0) {
+        if ((serial->attr.options & SIO_OPTION_LOWLATENCY) && !(info.flags & ASYNC_LOW_LATENCY)) {
+            info.flags |= ASYNC_LOW_LATENCY;
+            if (ioctl(serial->fildes, TIOCSSERIAL, &info) < 0)
+                SERIAL_DEBUG_INFO("serial: ASYNC_LOW_LATENCY not set (%i)\n", errno);
+            if (ioctl(serial->fildes, TIOCGSERIAL, &info) < 0)
+                info.flags &= ~ASYNC_LOW_LATENCY;
+            /* note: the flag is reset on close */
+            if (info.flags & ASYNC_LOW_LATENCY)
+                serial->saved.low_latency = 0;
+        }
+        serial->latency.low_latency = (info.flags & ASYNC_LOW_LATENCY) ? 1 : 0;
+    }
+    /* (2) latency timer of an USB-serial converter (e.g. FTDI) */
+    if (realpath(device, real) != NULL) {
+        snprintf(path, PATH_MAX, LATENCY_SYSFS, basename(real));
+        if ((fp = fopen(path, "r")) != NULL) {
+            if (fscanf(fp, "%i", &value) == 1)
+                serial->latency.latency_timer = value;
+            fclose(fp);
+        }
+        if ((serial->attr.options & SIO_OPTION_LOWLATENCY) &&
+            (serial->latency.latency_timer > LATENCY_TIMER)) {
+            /* note: requires write permission for the sysfs attribute */
+            if ((fp = fopen(path, "w")) != NULL) {
+                fprintf(fp, "%i", LATENCY_TIMER);
+                fclose(fp);
+                /* note: the original value is written back on close */
+                serial->saved.latency_timer = serial->latency.latency_timer;
+                strncpy(serial->saved.path, path, PATH_MAX - 1);
+                serial->saved.path[PATH_MAX - 1] = '\0';
+            }
+            /* read back the effective value */
+            if ((fp = fopen(path, "r")) != NULL) {
+                if (fscanf(fp, "%i", &value) == 1)
+                    serial->latency.latency_timer = value;
+                fclose(fp);
+            }
+        }
+    }
+    errno = 0;
+#else
+    (void)device;
+#endif
+}
+
+static void restore_latency(serial_t *serial) {
+#if defined(__linux__)
+    struct serial_struct info;
+    FILE *fp;
+#endif
+    assert(serial);
+
+#if defined(__linux__)
+    /* (1) reset the driver flag ASYNC_LOW_LATENCY, if set on connect */
+    if ((serial->saved.low_latency == 0) && (ioctl(serial->fildes, TIOCGSERIAL, &info) == 0)) {
+        info.flags &= ~ASYNC_LOW_LATENCY;
+        if (ioctl(serial->fildes, TIOCSSERIAL, &info) < 0)
+            SERIAL_DEBUG_INFO("serial: ASYNC_LOW_LATENCY not reset (%i)\n", errno);
+    }
+    /* (2) write back the original latency timer, if lowered on connect */
+    if ((serial->saved.latency_timer >= 0) && (serial->saved.path[0] != '\0')) {
+        if ((fp = fopen(serial->saved.path, "w")) != NULL) {
+            fprintf(fp, "%i", serial->saved.latency_timer);
+            fclose(fp);
+        }
+    }
+    serial->saved.low_latency = -1;
+    serial->saved.latency_timer = -1;
+    serial->saved.path[0] = '\0';
+    errno = 0;
+#endif
+}
+
+static int line_counters(serial_t *serial, bool reset) {
+    assert(serial);
+
+#if (OPTION_SERIAL_ICOUNT != 0)
+    struct serial_icounter_struct icount;
+
+    if (ioctl(serial->fildes, TIOCGICOUNT, &icount) < 0) {
+        if (reset)
+            memset(&serial->counters, 0, sizeof(sio_counters_t));
+        errno = ENOTSUP;
+        return -1;
+    }
+    if (reset) {
+        /* note: the kernel counts from loading the driver */
+        memcpy(&serial->icount, &icount, sizeof(struct serial_icounter_struct));
+    }
+    serial->counters.overrun = (uint32_t)icount.overrun - (uint32_t)serial->icount.overrun;
+    serial->counters.buf_overrun = (uint32_t)icount.buf_overrun - (uint32_t)serial->icount.buf_overrun;
+    serial->counters.frame = (uint32_t)icount.frame - (uint32_t)serial->icount.frame;
+    serial->counters.parity = (uint32_t)icount.parity - (uint32_t)serial->icount.parity;
+    serial->counters.brk = (uint32_t)icount.brk - (uint32_t)serial->icount.brk;
+    return 0;
+#else
+    if (reset)
+        memset(&serial->counters, 0, sizeof(sio_counters_t));
+    errno = ENOTSUP;
+    return -1;
+#endif
+}
+
 static void *reception_loop(void *arg) {
     serial_t *serial = (serial_t*)arg;
 
@@ -405,9 +1037,10 @@ static void *reception_loop(void *arg) {
         abort();
     }
     /* blocking read */
-    fd_set rdfs;
-    FD_ZERO(&rdfs);
-    FD_SET(serial->fildes, &rdfs);
+    struct pollfd fds;
+    bool hangup = false;
+    fds.fd = serial->fildes;
+    fds.events = POLLIN;
 
     /* thread cancellation */
     assert(pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL) == 0);
@@ -420,16 +1053,36 @@ static void *reception_loop(void *arg) {
 
         do {
             nbytes = read(serial->fildes, &buffer, BUFFER_SIZE);
+            SLCAN_TRACE2(serial_read, serial, nbytes);
             SERIAL_DEBUG_ASYNC(buffer, nbytes);
             if ((nbytes > 0) && serial->callback)
                 serial->callback(serial->receiver, &buffer[0], (size_t)nbytes);
         } while (nbytes > 0);
 
-        if (select(serial->fildes+1, &rdfs, NULL, NULL, NULL) < 0) {
+        /* note: end-of-file on a stream socket or after a hang-up means the
+         *       peer has closed the connection, and an I/O error means the
+         *       device has gone (e.g. an USB-serial converter has been
+         *       unplugged or a pty closed).
+         */
+        if (((nbytes == 0) && (serial->transport->stream || hangup)) ||
+            ((nbytes < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))) {
+            SERIAL_DEBUG_ERROR("serial: connection lost (%i)\n", (nbytes < 0) ? errno : 0);
+            break;
+        }
+        fds.revents = 0;
+        if ((poll(&fds, 1, -1) < 0) && (errno != EINTR)) {
             perror("serial");
-            return NULL;
+            break;
+        }
+        hangup = (fds.revents & (POLLHUP | POLLERR | POLLNVAL)) ? true : false;
+        if (hangup && !(fds.revents & POLLIN)) {
+            SERIAL_DEBUG_ERROR("serial: connection lost (hang-up)\n");
+            break;
         }
     }
+    /* connection lost: tell the receiver (no data) */
+    if (serial->callback)
+        serial->callback(serial->receiver, NULL, 0U);
     return NULL;
 }
 
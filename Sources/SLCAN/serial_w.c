@@ -72,20 +72,20 @@
  */
 
 #if (OPTION_SERIAL_DEBUG_LEVEL > 0)
-#define SERIAL_DEBUG_ERROR(...)  log_printf(__VA_ARGS__)
+#define SERIAL_DEBUG_ERROR(...)  do { if (LOG_ENABLED(LOG_LEVEL_ERROR)) (void)log_printf(__VA_ARGS__); } while (0)
 #else
 #define SERIAL_DEBUG_ERROR(...)  while (0)
 #endif
 
 #if (OPTION_SERIAL_DEBUG_LEVEL > 1)
-#define SERIAL_DEBUG_INFO(...)  log_printf(__VA_ARGS__)
+#define SERIAL_DEBUG_INFO(...)  do { if (LOG_ENABLED(LOG_LEVEL_INFO)) (void)log_printf(__VA_ARGS__); } while (0)
 #else
 #define SERIAL_DEBUG_INFO(...)  while (0)
 #endif
 
 #if (OPTION_SERIAL_DEBUG_LEVEL > 2)
-#define SERIAL_DEBUG_ASYNC(...)  log_async(__VA_ARGS__)
-#define SERIAL_DEBUG_SYNC(...)  log_sync(__VA_ARGS__)
+#define SERIAL_DEBUG_ASYNC(...)  do { if (LOG_ENABLED(LOG_LEVEL_DATA)) (void)log_async(__VA_ARGS__); } while (0)
+#define SERIAL_DEBUG_SYNC(...)  do { if (LOG_ENABLED(LOG_LEVEL_DATA)) (void)log_sync(__VA_ARGS__); } while (0)
 #undef SERIAL_DEBUG_INFO
 #define SERIAL_DEBUG_INFO(...)  while (0)
 #else
@@ -110,6 +110,7 @@ typedef struct serial_t_ {
     HANDLE hPort;
     HANDLE hThread;
     sio_attr_t attr;
+    sio_counters_t counters;
     sio_recv_t callback;
     void *receiver;
     int running;
@@ -120,6 +121,7 @@ typedef struct serial_t_ {
  */
 
 static DWORD WINAPI reception_loop(LPVOID lpParam);
+static BOOL comm_errors(serial_t *serial, COMSTAT *stat);
 
 
 /*  -----------  variables  ----------------------------------------------
@@ -142,6 +144,8 @@ sio_port_t sio_create(sio_recv_t callback, void *receiver) {
         serial->attr.bytesize = BYTESIZE8;
         serial->attr.stopbits = STOPBITS1;
         serial->attr.parity = PARITYNONE;
+        serial->attr.options = SIO_OPTION_NONE;
+        memset(&serial->counters, 0, sizeof(sio_counters_t));
         serial->callback = callback;
         serial->receiver = receiver;
         serial->running = 0;
@@ -184,6 +188,47 @@ int sio_get_attr(sio_port_t port, sio_attr_t* attr) {
     attr->bytesize = serial->attr.bytesize;
     attr->stopbits = serial->attr.stopbits;
     attr->parity = serial->attr.parity;
+    attr->options = serial->attr.options;
+    return 0;
+}
+
+int sio_get_latency(sio_port_t port, sio_latency_t *latency) {
+    serial_t* serial = (serial_t*)port;
+
+    /* sanity check */
+    errno = 0;
+    if (!serial) {
+        errno = ENODEV;
+        return -1;
+    }
+    if (!latency) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* note: latency settings are vendor-specific on Windows (registry) */
+    latency->low_latency = SIO_LATENCY_UNKNOWN;
+    latency->latency_timer = SIO_LATENCY_UNKNOWN;
+    return 0;
+}
+
+int sio_get_counters(sio_port_t port, sio_counters_t *counters) {
+    serial_t* serial = (serial_t*)port;
+
+    /* sanity check */
+    errno = 0;
+    if (!serial) {
+        errno = ENODEV;
+        return -1;
+    }
+    if (!counters) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* sample the communication errors (if connected) */
+    if (serial->hPort != INVALID_HANDLE_VALUE)
+        (void)comm_errors(serial, NULL);
+    /* line error counters (since connect) */
+    memcpy(counters, &serial->counters, sizeof(sio_counters_t));
     return 0;
 }
 
@@ -228,7 +273,9 @@ int sio_connect(sio_port_t port, const char *device, const sio_attr_t *attr) {
         serial->attr.bytesize = attr->bytesize;
         serial->attr.stopbits = attr->stopbits;
         serial->attr.parity = attr->parity;
+        serial->attr.options = attr->options;
     }
+    BOOL rtscts = (serial->attr.options & SIO_OPTION_RTSCTS) ? TRUE : FALSE;
     /* get comm port number from device name */
     if (((n = sscanf_s(device, "COM%i", &comm)) < 1) &&
         ((n = sscanf_s(device, "\\\\.\\COM%i", &comm)) < 1)) {
@@ -286,7 +333,7 @@ int sio_connect(sio_port_t port, const char *device, const sio_attr_t *attr) {
     dcb.BaudRate = serial->attr.baudrate;   // current baud rate
     dcb.fBinary = TRUE;                     // binary mode, no EOF check
     dcb.fParity = parity;                   // enable parity checking
-    dcb.fOutxCtsFlow = FALSE;               // CTS output flow control
+    dcb.fOutxCtsFlow = rtscts;              // CTS output flow control
     dcb.fOutxDsrFlow = FALSE;               // DSR output flow control
     dcb.fDtrControl = DTR_CONTROL_DISABLE;  // DTR flow control type
     dcb.fDsrSensitivity = FALSE;            // DSR sensitivity
@@ -295,7 +342,7 @@ int sio_connect(sio_port_t port, const char *device, const sio_attr_t *attr) {
     dcb.fInX = FALSE;                       // XON/XOFF in flow control
     dcb.fErrorChar = FALSE;                 // enable error replacement
     dcb.fNull = FALSE;                      // enable null stripping
-    dcb.fRtsControl = RTS_CONTROL_DISABLE;  // RTS flow control
+    dcb.fRtsControl = rtscts ? RTS_CONTROL_HANDSHAKE : RTS_CONTROL_DISABLE;  // RTS flow control
     dcb.fAbortOnError = FALSE;              // abort reads/writes on error
     //dcb.XonLim = 0;                       // transmit XON threshold
     //dcb.XoffLim = 30108;                  // transmit XOFF threshold
@@ -326,12 +373,12 @@ int sio_connect(sio_port_t port, const char *device, const sio_attr_t *attr) {
     }
     /* return the comm port number (zero based) */
     (void)ClearCommError(serial->hPort, &errors, NULL);
+    memset(&serial->counters, 0, sizeof(sio_counters_t));
     return (comm - 1);
 }
 
 int sio_disconnect(sio_port_t port) {
     serial_t *serial = (serial_t*)port;
-    DWORD errors;
 
     /* sanity check */
     errno = 0;
@@ -352,7 +399,7 @@ int sio_disconnect(sio_port_t port) {
     /* purge all pending transfers */
     (void)PurgeComm(serial->hPort,
         (PURGE_TXABORT | PURGE_RXABORT | PURGE_TXCLEAR | PURGE_RXCLEAR));
-    (void)ClearCommError(serial->hPort, &errors, NULL);
+    (void)comm_errors(serial, NULL);
     /* disconnect from serial port */
     if (!CloseHandle(serial->hPort)) {
         errno = ENODEV;
@@ -365,7 +412,6 @@ int sio_disconnect(sio_port_t port) {
 int sio_transmit(sio_port_t port, const uint8_t *buffer, size_t nbytes) {
     serial_t *serial = (serial_t*)port;
     DWORD sent = 0U;
-    DWORD errors;
 
     /* sanity check */
     errno = 0;
@@ -383,7 +429,7 @@ int sio_transmit(sio_port_t port, const uint8_t *buffer, size_t nbytes) {
     }
     /* send n bytes (set errno on error) */
     if (!WriteFile(serial->hPort, buffer, (DWORD)nbytes, &sent, NULL)) {
-        (void)ClearCommError(serial->hPort, &errors, NULL);
+        (void)comm_errors(serial, NULL);
         errno = EBUSY;
         return -1;
     }
@@ -392,9 +438,30 @@ int sio_transmit(sio_port_t port, const uint8_t *buffer, size_t nbytes) {
     return (int)sent;
 }
 
+int sio_output_queue(sio_port_t port) {
+    serial_t *serial = (serial_t*)port;
+    COMSTAT stat;
+
+    /* sanity check */
+    errno = 0;
+    if (!serial) {
+        errno = ENODEV;
+        return -1;
+    }
+    if (serial->hPort == INVALID_HANDLE_VALUE) {
+        errno = EBADF;
+        return -1;
+    }
+    /* number of bytes in the output queue */
+    if (!comm_errors(serial, &stat)) {
+        errno = EIO;
+        return -1;
+    }
+    return (int)stat.cbOutQue;
+}
+
 static DWORD WINAPI reception_loop(LPVOID lpParam) {
     serial_t *serial = (serial_t*)lpParam;
-    DWORD errors;
 
     /* sanity check */
     errno = 0;
@@ -425,12 +492,34 @@ static DWORD WINAPI reception_loop(LPVOID lpParam) {
                 serial->callback(serial->receiver, &buffer[0], (size_t)nbytes);
         }
         else {
-            (void)ClearCommError(serial->hPort, &errors, NULL);
+            (void)comm_errors(serial, NULL);
         }
     }
     return 0;
 }
 
+static BOOL comm_errors(serial_t *serial, COMSTAT *stat) {
+    DWORD errors = 0U;
+    BOOL res;
+
+    /* note: the error flags are cleared by ClearCommError, hence repeated
+     *       errors of the same kind between two calls are counted only once.
+     */
+    if ((res = ClearCommError(serial->hPort, &errors, stat))) {
+        if (errors & CE_OVERRUN)
+            serial->counters.overrun += 1U;
+        if (errors & CE_RXOVER)
+            serial->counters.buf_overrun += 1U;
+        if (errors & CE_FRAME)
+            serial->counters.frame += 1U;
+        if (errors & CE_RXPARITY)
+            serial->counters.parity += 1U;
+        if (errors & CE_BREAK)
+            serial->counters.brk += 1U;
+    }
+    return res;
+}
+
 /*  ----------------------------------------------------------------------
  *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
  *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
@@ -91,32 +91,38 @@ static const char version[] = "Lawicel SLCAN Protocol (Serial-Line CAN), Version
 #include "queue.h"
 #include "buffer.h"
 #include "logger.h"
+#include "trace.h"
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
 #include <errno.h>
 #include <assert.h>
-
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <pthread.h>
+#else
+#include <windows.h>
+#endif
 
 /*  -----------  options  ------------------------------------------------
  */
 
 #if (OPTION_SLCAN_DEBUG_LEVEL > 0)
-#define SLCAN_DEBUG_ERROR(...)  log_printf(__VA_ARGS__)
+#define SLCAN_DEBUG_ERROR(...)  do { if (LOG_ENABLED(LOG_LEVEL_ERROR)) (void)log_printf(__VA_ARGS__); } while (0)
 #else
 #define SLCAN_DEBUG_ERROR(...)  while (0)
 #endif
 
 #if (OPTION_SLCAN_DEBUG_LEVEL > 1)
-#define SLCAN_DEBUG_INFO(...)  log_printf(__VA_ARGS__)
+#define SLCAN_DEBUG_INFO(...)  do { if (LOG_ENABLED(LOG_LEVEL_INFO)) (void)log_printf(__VA_ARGS__); } while (0)
 #else
 #define SLCAN_DEBUG_INFO(...)  while (0)
 #endif
 
 #if (OPTION_SLCAN_DEBUG_LEVEL > 2)
-#define SLCAN_DEBUG_ASYNC(...)  log_async(__VA_ARGS__)
-#define SLCAN_DEBUG_SYNC(...)  log_sync(__VA_ARGS__)
+#define SLCAN_DEBUG_ASYNC(...)  do { if (LOG_ENABLED(LOG_LEVEL_DATA)) (void)log_async(__VA_ARGS__); } while (0)
+#define SLCAN_DEBUG_SYNC(...)  do { if (LOG_ENABLED(LOG_LEVEL_DATA)) (void)log_sync(__VA_ARGS__); } while (0)
 #undef SLCAN_DEBUG_INFO
 #define SLCAN_DEBUG_INFO(...)  while (0)
 #else
@@ -156,19 +162,81 @@ static void _finalizer() {
 #define BUFFER_SIZE 128U
 #define RESPONSE_TIMEOUT  100U
 #define TRANSMIT_TIMEOUT  1000U
+#define BATCH_FRAMES  (BUFFER_SIZE / 2U)
+#define BATCH_SIZE  (BATCH_FRAMES * 32U)
+#define CHUNK_SIZE  256U
+#define CHUNK_RATIO  4U
+#define CHUNK_MIN  64U
+
+#define IS_MESSAGE(chr)  (((chr) == 't') || ((chr) == 'T') || ((chr) == 'r') || ((chr) == 'R'))
+#define RX_QUEUE(slc)  ((slc)->lazy ? (slc)->chunks : (slc)->messages)
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#define ENTER_CRITICAL_SECTION(slc)  assert(0 == pthread_mutex_lock(&slc->mutex))
+#define LEAVE_CRITICAL_SECTION(slc)  assert(0 == pthread_mutex_unlock(&slc->mutex))
+#define ENTER_DECODER_SECTION(slc)  assert(0 == pthread_mutex_lock(&slc->decoder.mutex))
+#define LEAVE_DECODER_SECTION(slc)  assert(0 == pthread_mutex_unlock(&slc->decoder.mutex))
+#else
+#define ENTER_CRITICAL_SECTION(slc)  do { (void)WaitForSingleObject(slc->hMutex, INFINITE); } while(0)
+#define LEAVE_CRITICAL_SECTION(slc)  do { (void)ReleaseMutex(slc->hMutex); } while(0)
+#define ENTER_DECODER_SECTION(slc)  do { (void)WaitForSingleObject(slc->decoder.hMutex, INFINITE); } while(0)
+#define LEAVE_DECODER_SECTION(slc)  do { (void)ReleaseMutex(slc->decoder.hMutex); } while(0)
+#endif
 
 
 /*  -----------  types  --------------------------------------------------
  */
 
+typedef struct slcan_chunk_t_ {         /* chunk queue element (lazy decoding): */
+    struct timespec timestamp;          /*   time of reception */
+    uint32_t sequence;                  /*   sequence number (of raw bytes) */
+    size_t length;                      /*   number of raw bytes (0 = message) */
+    union {
+        uint8_t data[CHUNK_SIZE];       /*   raw bytes of message indications */
+        slcan_message_t message;        /*   message queued in-band */
+    } u;
+} slcan_chunk_t;
+
 typedef struct slcan_t_ {
     sio_port_t port;
     buffer_t response;
     queue_t messages;
+    size_t queueSize;
     uint8_t buffer[BUFFER_SIZE];
     size_t index;
+    bool lazy;
+    queue_t chunks;
+    uint32_t sequence;                  /* sequence number of the next chunk */
+    struct wait_t {                     /* wait policy of the reader: */
+        int policy;                     /*   block, spin or poll */
+        uint32_t spin;                  /*   max. spin time (in [us]) */
+    } wait;
+    int overflow;                       /* overflow policy of the queue */
+    volatile int lost;                  /* connection lost (error code) */
+    struct decoder_t {                  /* lazy decoding (by the reader): */
+        slcan_chunk_t chunk;            /*   current chunk */
+        size_t offset;                  /*   read position in the chunk */
+        uint8_t buffer[BUFFER_SIZE];    /*   message indication */
+        size_t index;                   /*   its length */
+        uint32_t sequence;              /*   sequence number of the next chunk */
+#if !defined(_WIN32) && !defined(_WIN64)
+        pthread_mutex_t mutex;          /*   one reader at a time */
+#else
+        HANDLE hMutex;                  /*   one reader at a time */
+#endif
+    } decoder;
+#if !defined(_WIN32) && !defined(_WIN64)
+    pthread_mutex_t mutex;
+#else
+    HANDLE hMutex;
+#endif
 } slcan_t;
 
+typedef struct slcan_element_t_ {       /* message queue element: */
+    slcan_message_t message;            /*   CAN message */
+    struct timespec timestamp;          /*   time of reception */
+} slcan_element_t;
+
 
 /*  -----------  prototypes  ---------------------------------------------
  */
@@ -178,6 +246,12 @@ static int send_command(slcan_t *slcan, const uint8_t *request, size_t nbytes,
 static bool encode_message(const slcan_message_t *message, uint8_t *buffer, size_t *nbytes);
 static bool decode_message(slcan_message_t *message, const uint8_t *buffer, size_t nbytes);
 static void reception_loop(const void *port, const uint8_t *buffer, size_t nbytes);
+static void reception_raw(slcan_t *slcan, const uint8_t *buffer, size_t nbytes);
+static void enqueue_chunk(slcan_t *slcan, slcan_chunk_t *chunk, size_t length);
+static int dequeue_lazy(slcan_t *slcan, slcan_element_t *element, const struct timespec *deadline);
+static void get_timestamp(struct timespec *timestamp);
+static void get_time(struct timespec *deadline, uint16_t timeout);
+static bool is_before(const struct timespec *time1, const struct timespec *time2);
 
 
 /*  -----------  variables  ----------------------------------------------
@@ -229,8 +303,11 @@ slcan_port_t slcan_create(size_t queueSize) {
             free(slcan);
             return NULL;
         }
-        /* create a message queue for CAN messages */
-        slcan->messages = queue_create(queueSize, sizeof(slcan_message_t));
+        /* create a message queue for CAN messages
+         * (note: the chunk queue for lazy decoding is created on demand)
+         */
+        slcan->messages = queue_create(queueSize, sizeof(slcan_element_t));
+        slcan->queueSize = queueSize;
         if (!slcan->messages) {
             /* errno set */
             (void)buffer_destroy(slcan->response);
@@ -238,6 +315,36 @@ slcan_port_t slcan_create(size_t queueSize) {
             free(slcan);
             return NULL;
         }
+        /* create a mutex for command/response transactions
+         * (note: the status poller sends requests concurrently)
+         */
+#if !defined(_WIN32) && !defined(_WIN64)
+        if (pthread_mutex_init(&slcan->mutex, NULL) != 0) {
+#else
+        if ((slcan->hMutex = CreateMutex(NULL, FALSE, NULL)) == NULL) {
+#endif
+            errno = ENOMEM;
+            (void)queue_destroy(slcan->messages);
+            (void)buffer_destroy(slcan->response);
+            (void)sio_destroy(slcan->port);
+            free(slcan);
+            return NULL;
+        }
+        /* create a mutex for the lazy decoder (shared by all readers) */
+#if !defined(_WIN32) && !defined(_WIN64)
+        if (pthread_mutex_init(&slcan->decoder.mutex, NULL) != 0) {
+            (void)pthread_mutex_destroy(&slcan->mutex);
+#else
+        if ((slcan->decoder.hMutex = CreateMutex(NULL, FALSE, NULL)) == NULL) {
+            (void)CloseHandle(slcan->hMutex);
+#endif
+            errno = ENOMEM;
+            (void)queue_destroy(slcan->messages);
+            (void)buffer_destroy(slcan->response);
+            (void)sio_destroy(slcan->port);
+            free(slcan);
+            return NULL;
+        }
         /* initialize reception buffer */
         slcan->index = 0U;
     }
@@ -265,6 +372,15 @@ int slcan_destroy(slcan_port_t port) {
         (void)buffer_destroy(slcan->response);
     if (slcan->messages)
         (void)queue_destroy(slcan->messages);
+    if (slcan->chunks)
+        (void)queue_destroy(slcan->chunks);
+#if !defined(_WIN32) && !defined(_WIN64)
+    (void)pthread_mutex_destroy(&slcan->decoder.mutex);
+    (void)pthread_mutex_destroy(&slcan->mutex);
+#else
+    (void)CloseHandle(slcan->decoder.hMutex);
+    (void)CloseHandle(slcan->hMutex);
+#endif
     /* C language destructor */
     free(slcan);
     return 0;
@@ -287,6 +403,8 @@ int slcan_signal(slcan_port_t port) {
         (void)buffer_signal(slcan->response);
     if (slcan->messages)
         (void)queue_signal(slcan->messages);
+    if (slcan->chunks)
+        (void)queue_signal(slcan->chunks);
     SLCAN_DEBUG_INFO("slcan_signal\n");
     return 0;
 }
@@ -294,6 +412,8 @@ int slcan_signal(slcan_port_t port) {
 EXPORT
 int slcan_connect(slcan_port_t port, const char *device, const slcan_attr_t *attr) {
     slcan_t *slcan = (slcan_t*)port;
+    bool lazy;
+    size_t size;
     int res = -1;
 
     /* sanity check */
@@ -306,8 +426,37 @@ int slcan_connect(slcan_port_t port, const char *device, const slcan_attr_t *att
      */
     /* reset reception buffer */
     slcan->index = 0U;
+    slcan->lost = 0;
+    /* decoding by the reception thread or by the reader (lazy) */
+    lazy = slcan->lazy;
+    if (attr && (attr->options & SLCAN_OPTION_LAZYDECODE)) {
+        /* note: undecoded bytes cannot be coalesced per identifier */
+        if (slcan->overflow == SLCAN_OVFL_KEEP_LATEST) {
+            errno = ENOTSUP;
+            return -1;
+        }
+        if (!slcan->chunks) {
+            size = slcan->queueSize / CHUNK_RATIO;
+            if ((slcan->chunks = queue_create((size > CHUNK_MIN) ? size : CHUNK_MIN, sizeof(slcan_chunk_t))) == NULL)
+                return -1;  /* errno set */
+            (void)queue_wait_policy(slcan->chunks, slcan->wait.policy, slcan->wait.spin);
+        }
+        (void)queue_overflow_policy(slcan->chunks, slcan->overflow, 0U);
+        (void)queue_clear(slcan->chunks);
+        ENTER_DECODER_SECTION(slcan);
+        slcan->decoder.chunk.length = 0U;
+        slcan->decoder.offset = 0U;
+        slcan->decoder.index = 0U;
+        slcan->decoder.sequence = slcan->sequence;
+        LEAVE_DECODER_SECTION(slcan);
+        slcan->lazy = true;
+    } else {
+        slcan->lazy = false;
+    }
     /* connect to the serial port */
     res = sio_connect(slcan->port, device, attr);
+    if (res < 0)
+        slcan->lazy = lazy;
     /* send three [CR] to purge the data terminal */
 #if (0)
 //    uint8_t cr = 0xAU;
@@ -350,6 +499,184 @@ int slcan_get_attr(slcan_port_t port, slcan_attr_t *attr) {
     return sio_get_attr(slcan->port, attr);
 }
 
+EXPORT
+int slcan_get_latency(slcan_port_t port, slcan_latency_t *latency) {
+    slcan_t* slcan = (slcan_t*)port;
+
+    /* sanity check */
+    errno = 0;
+    if (!slcan) {
+        errno = ENODEV;
+        return -1;
+    }
+    /* latency settings */
+    return sio_get_latency(slcan->port, latency);
+}
+
+EXPORT
+int slcan_get_counters(slcan_port_t port, slcan_counters_t *counters) {
+    slcan_t* slcan = (slcan_t*)port;
+
+    /* sanity check */
+    errno = 0;
+    if (!slcan) {
+        errno = ENODEV;
+        return -1;
+    }
+    /* line error counters */
+    return sio_get_counters(slcan->port, counters);
+}
+
+EXPORT
+int slcan_queue_usage(slcan_port_t port, uint32_t *size, uint32_t *high, uint64_t *overflows) {
+    slcan_t* slcan = (slcan_t*)port;
+    size_t total = 0U, max = 0U;
+    int res = -1;
+
+    /* sanity check */
+    errno = 0;
+    if (!slcan) {
+        errno = ENODEV;
+        return -1;
+    }
+    /* fill level and overflow counter of the message queue
+     * (note: of the chunk queue when decoding is done by the reader)
+     */
+    if ((res = queue_usage(RX_QUEUE(slcan), &total, &max)) < 0)
+        return res;
+    if (size)
+        *size = (uint32_t)total;
+    if (high)
+        *high = (uint32_t)max;
+    if (overflows)
+        (void)queue_overflow(RX_QUEUE(slcan), overflows);
+    return res;
+}
+
+EXPORT
+int slcan_queue_counters(slcan_port_t port, slcan_queue_counters_t *counters) {
+    slcan_t* slcan = (slcan_t*)port;
+    queue_counters_t values;
+    int res = -1;
+
+    /* sanity check */
+    errno = 0;
+    if (!slcan) {
+        errno = ENODEV;
+        return -1;
+    }
+    if (!counters) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* counters of the message queue
+     * (note: of the chunk queue when decoding is done by the reader)
+     */
+    if ((res = queue_counters(RX_QUEUE(slcan), &values)) < 0)
+        return res;
+    counters->enqueued = values.enqueued;
+    counters->dequeued = values.dequeued;
+    counters->dropped = values.dropped;
+    counters->overwritten = values.overwritten;
+    counters->coalesced = values.coalesced;
+    counters->spilled = values.spilled;
+    return res;
+}
+
+EXPORT
+int slcan_spill_file(slcan_port_t port, const char *path, uint32_t size, uint32_t mark) {
+    slcan_t* slcan = (slcan_t*)port;
+    int res = -1;
+
+    /* sanity check */
+    errno = 0;
+    if (!slcan) {
+        errno = ENODEV;
+        return -1;
+    }
+    /* spill file of the message queue
+     * (note: of the chunk queue when decoding is done by the reader)
+     */
+    if ((res = queue_spill(RX_QUEUE(slcan), path, (size_t)size, (size_t)mark)) < 0)
+        return res;
+    SLCAN_DEBUG_INFO("slcan_spill_file (%s, %u, %u)\n", path ? path : "(null)", size, mark);
+    return res;
+}
+
+EXPORT
+int slcan_output_queue(slcan_port_t port) {
+    slcan_t* slcan = (slcan_t*)port;
+
+    /* sanity check */
+    errno = 0;
+    if (!slcan || !slcan->port) {
+        errno = ENODEV;
+        return -1;
+    }
+    /* output queue depth (in [byte]) */
+    return sio_output_queue(slcan->port);
+}
+
+EXPORT
+int slcan_wait_policy(slcan_port_t port, int policy, uint32_t spin) {
+    slcan_t* slcan = (slcan_t*)port;
+    int res = -1;
+
+    /* sanity check */
+    errno = 0;
+    if (!slcan) {
+        errno = ENODEV;
+        return -1;
+    }
+    /* wait policy of the message queue and of the chunk queue (if any)
+     * (note: the policy is kept for a chunk queue created later on)
+     */
+    if ((res = queue_wait_policy(slcan->messages, policy, spin)) < 0)
+        return res;
+    if (slcan->chunks)
+        (void)queue_wait_policy(slcan->chunks, policy, spin);
+    slcan->wait.policy = policy;
+    slcan->wait.spin = spin;
+    SLCAN_DEBUG_INFO("slcan_wait_policy (%i, %u)\n", policy, spin);
+    return res;
+}
+
+EXPORT
+int slcan_overflow_policy(slcan_port_t port, int policy) {
+    slcan_t* slcan = (slcan_t*)port;
+    int res = -1;
+
+    /* sanity check */
+    errno = 0;
+    if (!slcan) {
+        errno = ENODEV;
+        return -1;
+    }
+    if ((policy != SLCAN_OVFL_DROP_NEWEST) && (policy != SLCAN_OVFL_DROP_OLDEST) && (policy != SLCAN_OVFL_KEEP_LATEST)) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* note: the reader decodes the messages when decoding is lazy,
+     *       so they cannot be coalesced per identifier in the queue.
+     */
+    if (slcan->lazy && (policy == SLCAN_OVFL_KEEP_LATEST)) {
+        errno = ENOTSUP;
+        return -1;
+    }
+    /* overflow policy of the chunk queue (if any) and of the message queue
+     * (note: the key of a message queue element is the CAN identifier)
+     */
+    if (slcan->chunks && (policy != SLCAN_OVFL_KEEP_LATEST)) {
+        if ((res = queue_overflow_policy(slcan->chunks, policy, 0U)) < 0)
+            return res;
+    }
+    if ((res = queue_overflow_policy(slcan->messages, policy, offsetof(slcan_element_t, message.can_id))) < 0)
+        return res;
+    slcan->overflow = policy;
+    SLCAN_DEBUG_INFO("slcan_overflow_policy (%i)\n", policy);
+    return res;
+}
+
 EXPORT
 int slcan_setup_bitrate(slcan_port_t port, uint8_t index) {
     slcan_t *slcan = (slcan_t*)port;
@@ -449,6 +776,18 @@ int slcan_open_channel(slcan_port_t port) {
     }
     /* clear the message queue */
     (void)queue_clear(slcan->messages);  // FIXME: (?)
+    /* clear the chunk queue and the decoder state (lazy decoding),
+     * so that chunks received before are not decoded after the open
+     */
+    if (slcan->chunks) {
+        ENTER_DECODER_SECTION(slcan);
+        (void)queue_clear(slcan->chunks);
+        slcan->decoder.chunk.length = 0U;
+        slcan->decoder.offset = 0U;
+        slcan->decoder.index = 0U;
+        slcan->decoder.sequence = slcan->sequence;
+        LEAVE_DECODER_SECTION(slcan);
+    }
     /* send command 'Open the CAN channel' */
     nbytes = send_command(slcan, request, 2, response, 1, RESPONSE_TIMEOUT);
     if ((nbytes == 1) && (response[0] == '\r')) {
@@ -499,12 +838,20 @@ int slcan_close_channel(slcan_port_t port) {
 
 EXPORT
 int slcan_write_message(slcan_port_t port, const slcan_message_t *message, uint16_t timeout) {
+    /* note: the confirmation is awaited for TRANSMIT_TIMEOUT */
+    (void)timeout;
+    return slcan_write_message_until(port, message, NULL);
+}
+
+EXPORT
+int slcan_write_message_until(slcan_port_t port, const slcan_message_t *message, const struct timespec *deadline) {
     slcan_t *slcan = (slcan_t*)port;
     uint8_t buffer[BUFFER_SIZE];
+    struct timespec limit;
+    bool expired = false;
     size_t length;
     int nbytes;
     int res = -1;
-    (void)timeout;
 
     /* sanity check */
     errno = 0;
@@ -521,18 +868,32 @@ int slcan_write_message(slcan_port_t port, const slcan_message_t *message, uint1
         errno = EFAULT;
         return -99;
     }
+    /* one transaction at a time (the response buffer is shared) */
+    ENTER_CRITICAL_SECTION(slcan);
     /* clear pending response, if any */
     (void)buffer_clear(slcan->response);
     /* send CAN message to the device via serial port */
+    SLCAN_TRACE3(transmit_submit, slcan, message->can_id, message->can_dlc);
     nbytes = sio_transmit(slcan->port, buffer, length);
     if (nbytes == (int)length) {
         uint8_t response[2];
-        /* wait for response in the reception buffer */
-        nbytes = buffer_get(slcan->response, (void*)response, 2, TRANSMIT_TIMEOUT);
+        /* wait for response in the reception buffer (not beyond the deadline) */
+        if (deadline) {
+            get_time(&limit, TRANSMIT_TIMEOUT);
+            expired = is_before(deadline, &limit);
+            nbytes = buffer_get_until(slcan->response, (void*)response, 2, expired ? deadline : &limit);
+        } else {
+            nbytes = buffer_get(slcan->response, (void*)response, 2, TRANSMIT_TIMEOUT);
+        }
+        LEAVE_CRITICAL_SECTION(slcan);
         if ((nbytes == 2) && (response[1] == '\r') &&
             ((((response[0] == 'z') && ((buffer[0] == 't') || (buffer[0] == 'r')))) ||
              (((response[0] == 'Z') && ((buffer[0] == 'T') || (buffer[0] == 'R')))))) {
             res = 0;
+        } else if ((nbytes == 0) && expired) {
+            /* note: not confirmed until the deadline of the caller */
+            errno = ETIMEDOUT;
+            res = -1;
         } else if (nbytes >= 0) {
             /* note: Variable 'errno' is set by the called functions according
              *       to their result. On error they return a negative value.
@@ -542,22 +903,171 @@ int slcan_write_message(slcan_port_t port, const slcan_message_t *message, uint1
              errno = EBADMSG;
             res = -1;
         }
-    } else if (nbytes >= 0) {
-        /* note: Variable 'errno' is set by the called functions according to
-         *       their result. On error they return a negative value.
-         *       When a wrong number of bytes has been transmitted this will
-         *       be interpreted as the sender or the receiver is busy (EBUSY).
-         */
-        errno = EBUSY;
-        res = -1;
+    } else {
+        LEAVE_CRITICAL_SECTION(slcan);
+        if (nbytes >= 0) {
+            /* note: Variable 'errno' is set by the called functions according to
+             *       their result. On error they return a negative value.
+             *       When a wrong number of bytes has been transmitted this will
+             *       be interpreted as the sender or the receiver is busy (EBUSY).
+             */
+            errno = EBUSY;
+            res = -1;
+        }
     }
+    SLCAN_TRACE3(transmit_done, slcan, message->can_id, res);
     SLCAN_DEBUG_INFO("slcan_write_message (%i)\n", res);
     return res;
 }
 
+EXPORT
+int slcan_write_messages(slcan_port_t port, const slcan_message_t *messages, size_t count, uint16_t timeout, size_t *rejected) {
+    slcan_t *slcan = (slcan_t*)port;
+    uint8_t buffer[BATCH_SIZE];
+    uint8_t response[BUFFER_SIZE];
+    uint8_t command[BATCH_FRAMES];
+    struct timespec deadline;
+    bool expired = false;
+    size_t length, total = 0U;
+    size_t n, answered = 0U, nacks = 0U, index = 0U;
+    int nbytes;
+    int res = -1;
+
+    /* sanity check */
+    errno = 0;
+    if (!slcan || !slcan->port) {
+        errno = ENODEV;
+        return -1;
+    }
+    if (!messages || !count) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* encode up to BATCH_FRAMES CAN messages into one serial write
+     * (note: the response buffer must hold the confirmations of all)
+     */
+    for (n = 0U; (n < count) && (n < BATCH_FRAMES); n++) {
+        if (!encode_message(&messages[n], &buffer[total], &length)) {
+            errno = EFAULT;
+            return -99;
+        }
+        command[n] = buffer[total];
+        total += length;
+    }
+    /* one transaction at a time (the response buffer is shared) */
+    ENTER_CRITICAL_SECTION(slcan);
+    /* clear pending response, if any */
+    (void)buffer_clear(slcan->response);
+    /* send the CAN messages to the device via serial port */
+    SLCAN_TRACE3(transmit_batch, slcan, n, total);
+    nbytes = sio_transmit(slcan->port, buffer, total);
+    if (nbytes == (int)total) {
+        /* the responses to the batch are awaited until the deadline */
+        get_time(&deadline, timeout ? timeout : TRANSMIT_TIMEOUT);
+        /* collect one response per message from the reception buffer */
+        while (answered < n) {
+            nbytes = buffer_get_until(slcan->response, (void*)&response[index], sizeof(response) - index,
+                                      (timeout != CAN_INFINITE) ? &deadline : NULL);
+            if (nbytes <= 0) {
+                /* note: no (more) responses until the deadline */
+                expired = (nbytes == 0);
+                break;
+            }
+            index += (size_t)nbytes;
+            /* each confirmation is 'z[CR]' or 'Z[CR]', a negative ACK is [BEL]
+             * (note: the device answers every message, also after a NAK)
+             */
+            while ((index >= 1U) && (answered < n)) {
+                if (response[0] == '\a') {
+                    memmove(response, &response[1], index - 1U);
+                    index -= 1U;
+                    nacks++;
+                } else if ((index >= 2U) && (response[1] == '\r') &&
+                           ((((response[0] == 'z') && ((command[answered] == 't') || (command[answered] == 'r')))) ||
+                            (((response[0] == 'Z') && ((command[answered] == 'T') || (command[answered] == 'R')))))) {
+                    memmove(response, &response[2], index - 2U);
+                    index -= 2U;
+                } else {
+                    break;
+                }
+                answered++;
+            }
+            if (index >= 2U) {
+                /* neither a confirmation nor a negative ACK */
+                nbytes = 0;
+                break;
+            }
+        }
+        LEAVE_CRITICAL_SECTION(slcan);
+        if (answered) {
+            /* note: A partially answered batch returns the number of answered
+             *       messages (the caller resubmits the rest), and the negative
+             *       ACKs among them are counted separately.
+             */
+            if (rejected)
+                *rejected = nacks;
+            if (answered == n)
+                errno = 0;
+            else if (expired)
+                errno = ETIMEDOUT;
+            else if (nbytes >= 0)
+                errno = EBADMSG;
+            res = (int)answered;
+        } else if (expired) {
+            /* note: not answered until the deadline */
+            errno = ETIMEDOUT;
+            res = -1;
+        } else if (nbytes >= 0) {
+            /* note: Variable 'errno' is set by the called functions according
+             *       to their result. On error they return a negative value.
+             *       Receiving a wrong response will be interpreted as protocol
+             *       error (EBADMSG).
+             */
+            errno = EBADMSG;
+            res = -1;
+        }
+    } else {
+        LEAVE_CRITICAL_SECTION(slcan);
+        if (nbytes >= 0) {
+            /* note: Variable 'errno' is set by the called functions according to
+             *       their result. On error they return a negative value.
+             *       When a wrong number of bytes has been transmitted this will
+             *       be interpreted as the sender or the receiver is busy (EBUSY).
+             */
+            errno = EBUSY;
+            res = -1;
+        }
+    }
+    SLCAN_TRACE3(transmit_done, slcan, messages[0].can_id, res);
+    SLCAN_DEBUG_INFO("slcan_write_messages (%i)\n", res);
+    return res;
+}
+
 EXPORT
 int slcan_read_message(slcan_port_t port, slcan_message_t *message, uint16_t timeout) {
+    /* note: the time-stamp is discarded */
+    return slcan_read_message_ts(port, message, NULL, timeout);
+}
+
+EXPORT
+int slcan_read_message_ts(slcan_port_t port, slcan_message_t *message, struct timespec *timestamp, uint16_t timeout) {
+    struct timespec deadline = { 0, 0 };
+
+    /* the time-out (in [ms]) is taken as deadline from the monotonic clock
+     * (note: a deadline in the past means polling)
+     */
+    if (timeout == CAN_INFINITE)
+        return slcan_read_message_until(port, message, timestamp, NULL);
+    if (timeout != 0U)
+        get_time(&deadline, timeout);
+    return slcan_read_message_until(port, message, timestamp, &deadline);
+}
+
+EXPORT
+int slcan_read_message_until(slcan_port_t port, slcan_message_t *message, struct timespec *timestamp, const struct timespec *deadline) {
+    static const struct timespec expired = { 0, 0 };
     slcan_t *slcan = (slcan_t*)port;
+    slcan_element_t element;
     int res;
 
     /* sanity check */
@@ -570,13 +1080,34 @@ int slcan_read_message(slcan_port_t port, slcan_message_t *message, uint16_t tim
         errno = EINVAL;
         return -1;
     }
-    /* get one message from the message queue, if any */
-    res = queue_dequeue(slcan->messages, (void*)message, sizeof(slcan_message_t), timeout);
-    if (res == (int)sizeof(slcan_message_t)) {
+    /* get one message from the message queue, if any
+     * (note: or decode it from the chunk queue when the reader does it)
+     */
+    /* note: when the connection is lost, the messages received so far
+     *       are read without waiting, then an error is returned.
+     */
+    if (slcan->lost)
+        deadline = &expired;
+    if (!slcan->lazy) {
+        res = queue_dequeue_until(slcan->messages, (void*)&element, sizeof(slcan_element_t), deadline);
+    } else {
+        /* note: the decoder state is shared, readers are serialized */
+        ENTER_DECODER_SECTION(slcan);
+        res = dequeue_lazy(slcan, &element, deadline);
+        LEAVE_DECODER_SECTION(slcan);
+    }
+    if ((res < 0) && slcan->lost) {
+        errno = slcan->lost;
+        res = -1;
+    }
+    if (res == (int)sizeof(slcan_element_t)) {
         /* note: On success value 0 will be returned (CAN API compatible).
          *       In case of a queue overflow variable 'errno' will be set.
          */
-        if (queue_overflow(slcan->messages, NULL))
+        memcpy(message, &element.message, sizeof(slcan_message_t));
+        if (timestamp)
+            memcpy(timestamp, &element.timestamp, sizeof(struct timespec));
+        if (queue_overflow(RX_QUEUE(slcan), NULL))
             errno = ENOSPC;
         res = 0;
     } else if (res >= 0) {
@@ -590,10 +1121,47 @@ int slcan_read_message(slcan_port_t port, slcan_message_t *message, uint16_t tim
         /* note: CAN API compatible error codes will be returned on error. */
     }
     if (res != -30)  // when not empty
-        SLCAN_DEBUG_INFO("slcan_read_message (%i)\n", res);
+        SLCAN_DEBUG_INFO("slcan_read_message_until (%i)\n", res);
     return (int)res;
 }
 
+EXPORT
+int slcan_queue_message(slcan_port_t port, const slcan_message_t *message) {
+    slcan_t *slcan = (slcan_t*)port;
+    slcan_element_t element;
+    slcan_chunk_t chunk;
+    int res;
+
+    /* sanity check */
+    errno = 0;
+    if (!slcan || !slcan->messages) {
+        errno = ENODEV;
+        return -1;
+    }
+    if (!message) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* put the message into the message queue (in-band with received messages) */
+    if (!slcan->lazy) {
+        memcpy(&element.message, message, sizeof(slcan_message_t));
+        get_timestamp(&element.timestamp);
+        res = queue_enqueue(slcan->messages, (void*)&element, sizeof(slcan_element_t));
+        if (res == (int)sizeof(slcan_element_t))
+            res = 0;
+    } else {
+        /* note: a chunk of length 0 carries a message (not decoded) */
+        memcpy(&chunk.u.message, message, sizeof(slcan_message_t));
+        get_timestamp(&chunk.timestamp);
+        chunk.length = 0U;
+        res = queue_enqueue(slcan->chunks, (void*)&chunk, offsetof(slcan_chunk_t, u) + sizeof(slcan_message_t));
+        if (res == (int)(offsetof(slcan_chunk_t, u) + sizeof(slcan_message_t)))
+            res = 0;
+    }
+    SLCAN_DEBUG_INFO("slcan_queue_message (%i)\n", res);
+    return res;
+}
+
 EXPORT
 int slcan_status_flags(slcan_port_t port, slcan_flags_t *flags) {
     slcan_t *slcan = (slcan_t*)port;
@@ -823,13 +1391,17 @@ static int send_command(slcan_t *slcan, const uint8_t *request, size_t nbytes,
     assert(request);
     assert(response);
 
+    /* one transaction at a time (the response buffer is shared) */
+    ENTER_CRITICAL_SECTION(slcan);
     /* clear pending response, if any */
     (void)buffer_clear(slcan->response);
     /* send request to the device via serial port */
+    SLCAN_TRACE3(command_sent, slcan, request[0], nbytes);
     res = sio_transmit(slcan->port, request, nbytes);
     if (res == (int)nbytes) {
         /* wait for response in the reception buffer */
         res = buffer_get(slcan->response, (void*)response, maxbytes, timeout);
+        SLCAN_TRACE3(command_response, slcan, request[0], res);
         /* note: Interpretation of the received data shall be done by the
          *       caller (e.g. EBADMSG).
          */
@@ -842,6 +1414,7 @@ static int send_command(slcan_t *slcan, const uint8_t *request, size_t nbytes,
         errno = EBUSY;
         res = -1;
     }
+    LEAVE_CRITICAL_SECTION(slcan);
     /* return number of received bytes, or a negative value on error */
     return res;
 }
@@ -958,11 +1531,28 @@ static bool decode_message(slcan_message_t *message, const uint8_t *buffer, size
 
 static void reception_loop(const void *port, const uint8_t *buffer, size_t nbytes) {
     slcan_t *slcan = (slcan_t*)port;
-    slcan_message_t message;
-
+    slcan_element_t element;
+
+    if (slcan && !buffer) {
+        /* connection lost: wake up waiting readers and writers */
+        SLCAN_DEBUG_ERROR("slcan: connection lost\n");
+        slcan->lost = ENOTCONN;
+        if (slcan->messages)
+            (void)queue_signal(slcan->messages);
+        if (slcan->chunks)
+            (void)queue_signal(slcan->chunks);
+        if (slcan->response)
+            (void)buffer_signal(slcan->response);
+        return;
+    }
     if (slcan && buffer) {
         assert(slcan->response);
         assert(slcan->messages);
+        if (slcan->lazy) {
+            /* note: message indications are decoded by the reader */
+            reception_raw(slcan, buffer, nbytes);
+            return;
+        }
         for (size_t index = 0; index < nbytes; index++) {
             /* get next byte (asynchronous reception) */
             if ((slcan->index + 1) < BUFFER_SIZE)
@@ -974,12 +1564,26 @@ static void reception_loop(const void *port, const uint8_t *buffer, size_t nbyte
                     /* message indication or confirmation? */
                     if (slcan->index > 2) {
                         /* new message received (indication) */
-                        if (decode_message(&message, slcan->buffer, slcan->index))
-                            (void)queue_enqueue(slcan->messages, &message, sizeof(slcan_message_t));
+                        SLCAN_TRACE3(frame_received, slcan, slcan->buffer, slcan->index);
+                        if (decode_message(&element.message, slcan->buffer, slcan->index)) {
+                            SLCAN_TRACE3(frame_decoded, slcan, element.message.can_id, element.message.can_dlc);
+                            /* note: the host time of reception (no device time-stamps) */
+                            get_timestamp(&element.timestamp);
+                            if (queue_enqueue(slcan->messages, &element, sizeof(slcan_element_t)) >= 0)
+                                SLCAN_TRACE3(frame_enqueued, slcan, element.message.can_id, element.message.can_dlc);
+                            else
+                                SLCAN_TRACE3(frame_dropped, slcan, element.message.can_id, element.message.can_dlc);
+                        }
                     } else {
                         /* confirmation of a sent message received */
                         (void)buffer_put(slcan->response, slcan->buffer, slcan->index);
                     }
+                } else if ((slcan->buffer[0] == 'z') || (slcan->buffer[0] == 'Z')) {
+                    /* confirmation of a transmitted message received
+                     * (note: the confirmations of a batch are collected)
+                     */
+                    SLCAN_TRACE2(ack_received, slcan, slcan->buffer[0]);
+                    (void)buffer_append(slcan->response, slcan->buffer, slcan->index);
                 } else {
                     /* response of a sent request received */
                     (void)buffer_put(slcan->response, slcan->buffer, slcan->index);
@@ -987,8 +1591,11 @@ static void reception_loop(const void *port, const uint8_t *buffer, size_t nbyte
                 /* done: reset reception buffer */
                 slcan->index = 0U;
             } else if (buffer[index] == '\a') {
-                /* Negative ACKnowledge [BEL] received */
-                (void)buffer_put(slcan->response, slcan->buffer, slcan->index);
+                /* Negative ACKnowledge [BEL] received
+                 * (note: collected like the confirmations of a batch)
+                 */
+                SLCAN_TRACE2(ack_received, slcan, buffer[index]);
+                (void)buffer_append(slcan->response, slcan->buffer, slcan->index);
                 /* done: reset reception buffer */
                 slcan->index = 0U;
             }
@@ -996,6 +1603,167 @@ static void reception_loop(const void *port, const uint8_t *buffer, size_t nbyte
     }
 }
 
+static void reception_raw(slcan_t *slcan, const uint8_t *buffer, size_t nbytes) {
+    slcan_chunk_t chunk;
+    size_t length = 0U;
+    bool message;
+
+    assert(slcan);
+    assert(buffer);
+    assert(slcan->chunks);
+
+    /* note: the host time of reception (one time-stamp per chunk) */
+    get_timestamp(&chunk.timestamp);
+    for (size_t index = 0; index < nbytes; index++) {
+        /* message indications are only copied into the chunk (raw) */
+        message = IS_MESSAGE(slcan->index ? slcan->buffer[0] : buffer[index]);
+        if (message) {
+            chunk.u.data[length++] = buffer[index];
+            if (length == CHUNK_SIZE) {
+                enqueue_chunk(slcan, &chunk, length);
+                length = 0U;
+            }
+            /* note: only the first two bytes are needed to tell a
+             *       message indication from a confirmation
+             */
+            if (slcan->index < 2U)
+                slcan->buffer[slcan->index] = buffer[index];
+            slcan->index++;
+        } else if ((slcan->index + 1) < BUFFER_SIZE) {
+            slcan->buffer[slcan->index++] = buffer[index];
+        }
+        if (buffer[index] == '\r') {
+            /* positive ACKnowledge [CR] received */
+            if (message && (slcan->index > 2)) {
+                /* new message received (indication): in the chunk */
+            } else if ((slcan->buffer[0] == 'z') || (slcan->buffer[0] == 'Z')) {
+                /* confirmation of a transmitted message received */
+                SLCAN_TRACE2(ack_received, slcan, slcan->buffer[0]);
+                (void)buffer_append(slcan->response, slcan->buffer, slcan->index);
+            } else {
+                /* response of a sent request received */
+                (void)buffer_put(slcan->response, slcan->buffer, slcan->index);
+            }
+            /* done: reset reception buffer */
+            slcan->index = 0U;
+        } else if (buffer[index] == '\a') {
+            /* Negative ACKnowledge [BEL] received
+             * (note: collected like the confirmations of a batch)
+             */
+            SLCAN_TRACE2(ack_received, slcan, buffer[index]);
+            if (!message)
+                (void)buffer_append(slcan->response, slcan->buffer, slcan->index);
+            else  /* note: the bytes of a message indication are in the chunk */
+                (void)buffer_append(slcan->response, &buffer[index], 1);
+            /* done: reset reception buffer */
+            slcan->index = 0U;
+        }
+    }
+    if (length)
+        enqueue_chunk(slcan, &chunk, length);
+}
+
+static void enqueue_chunk(slcan_t *slcan, slcan_chunk_t *chunk, size_t length) {
+    assert(slcan);
+    assert(chunk);
+
+    /* note: only the used part of the chunk is copied into the queue,
+     *       the sequence number tells the decoder about lost chunks
+     */
+    chunk->length = length;
+    chunk->sequence = slcan->sequence++;
+    if (queue_enqueue(slcan->chunks, (void*)chunk, offsetof(slcan_chunk_t, u) + length) >= 0)
+        SLCAN_TRACE3(chunk_enqueued, slcan, chunk, length);
+    else
+        SLCAN_TRACE3(chunk_dropped, slcan, chunk, length);
+}
+
+static int dequeue_lazy(slcan_t *slcan, slcan_element_t *element, const struct timespec *deadline) {
+    struct decoder_t *decoder = &slcan->decoder;
+    uint8_t byte;
+    int res;
+
+    assert(slcan);
+    assert(element);
+    assert(slcan->chunks);
+
+    for (;;) {
+        /* decode the next message indication from the current chunk */
+        while (decoder->offset < decoder->chunk.length) {
+            byte = decoder->chunk.u.data[decoder->offset++];
+            /* note: a message indication starts with 't', 'T', 'r' or 'R'
+             *       (to resynchronize after a lost chunk)
+             */
+            if (IS_MESSAGE(byte))
+                decoder->index = 0U;
+            if ((decoder->index + 1) < BUFFER_SIZE)
+                decoder->buffer[decoder->index++] = byte;
+            if (byte == '\r') {
+                res = (decoder->index > 2) && decode_message(&element->message, decoder->buffer, decoder->index);
+                decoder->index = 0U;
+                if (res) {
+                    SLCAN_TRACE3(frame_decoded, slcan, element->message.can_id, element->message.can_dlc);
+                    memcpy(&element->timestamp, &decoder->chunk.timestamp, sizeof(struct timespec));
+                    return (int)sizeof(slcan_element_t);
+                }
+            } else if (byte == '\a') {
+                decoder->index = 0U;
+            }
+        }
+        /* get the next chunk from the chunk queue (until the deadline) */
+        res = queue_dequeue_until(slcan->chunks, (void*)&decoder->chunk, sizeof(slcan_chunk_t), deadline);
+        if (res < 0)
+            return res;
+        decoder->offset = 0U;
+        if (decoder->chunk.length == 0U) {
+            /* message queued in-band (not to be decoded) */
+            memcpy(&element->message, &decoder->chunk.u.message, sizeof(slcan_message_t));
+            memcpy(&element->timestamp, &decoder->chunk.timestamp, sizeof(struct timespec));
+            return (int)sizeof(slcan_element_t);
+        }
+        if (decoder->chunk.sequence != decoder->sequence) {
+            /* chunk(s) lost: the pending message indication is incomplete
+             * (note: its tail in this chunk is skipped by the resync)
+             */
+            decoder->index = 0U;
+        }
+        decoder->sequence = decoder->chunk.sequence + 1U;
+    }
+}
+
+static void get_timestamp(struct timespec *timestamp) {
+    assert(timestamp);
+#if !defined(_WIN32) && !defined(_WIN64)
+    (void)clock_gettime(CLOCK_REALTIME, timestamp);
+#else
+    (void)timespec_get(timestamp, TIME_UTC);
+#endif
+}
+
+static void get_time(struct timespec *deadline, uint16_t timeout) {
+#if !defined(_WIN32) && !defined(_WIN64)
+    (void)clock_gettime(CLOCK_MONOTONIC, deadline);
+#else
+    LARGE_INTEGER counter, frequency;
+
+    (void)QueryPerformanceFrequency(&frequency);
+    (void)QueryPerformanceCounter(&counter);
+    deadline->tv_sec = (time_t)(counter.QuadPart / frequency.QuadPart);
+    deadline->tv_nsec = (long)(((counter.QuadPart % frequency.QuadPart) * 1000000000LL) / frequency.QuadPart);
+#endif
+    deadline->tv_sec += (time_t)(timeout / 1000U);
+    deadline->tv_nsec += (long)(timeout % 1000U) * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_nsec -= 1000000000L;
+        deadline->tv_sec += (time_t)1;
+    }
+}
+
+static bool is_before(const struct timespec *time1, const struct timespec *time2) {
+    return (time1->tv_sec < time2->tv_sec) ||
+           ((time1->tv_sec == time2->tv_sec) && (time1->tv_nsec < time2->tv_nsec));
+}
+
 /*  ----------------------------------------------------------------------
  *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
  *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
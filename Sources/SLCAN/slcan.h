@@ -63,6 +63,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <time.h>
 
 
 /*  -----------  options  ------------------------------------------------
@@ -127,6 +128,28 @@
 
 #define CAN_INFINITE    65535U          /**< infinite time-out (blocking read) */
 
+/** @name  SLCAN Options
+ *  @brief Options of the SLCAN layer (bit mask in slcan_attr_t.options)
+ *  @{ */
+#define SLCAN_OPTION_LAZYDECODE  0x80U  /**< minimal reception thread, decoding by the reader */
+/** @} */
+
+/** @name  SLCAN Wait Policy
+ *  @brief How a reader waits for messages (see slcan_wait_policy)
+ *  @{ */
+#define SLCAN_WAIT_BLOCK  0             /**< block until a message arrives (default) */
+#define SLCAN_WAIT_SPIN   1             /**< spin for a while, then block */
+#define SLCAN_WAIT_POLL   2             /**< busy-poll, never block */
+/** @} */
+
+/** @name  SLCAN Overflow Policy
+ *  @brief What happens to a message received into a full message queue (see slcan_overflow_policy)
+ *  @{ */
+#define SLCAN_OVFL_DROP_NEWEST  0       /**< drop the received message (default) */
+#define SLCAN_OVFL_DROP_OLDEST  1       /**< overwrite the oldest message (ring) */
+#define SLCAN_OVFL_KEEP_LATEST  2       /**< keep only the latest message per identifier */
+/** @} */
+
 
 /*  -----------  types  --------------------------------------------------
  */
@@ -135,6 +158,20 @@ typedef void *slcan_port_t;             /**< SLCAN port (opaque data type) */
 
 typedef sio_attr_t slcan_attr_t;        /**< serial port attributes */
 
+typedef sio_latency_t slcan_latency_t;  /**< serial port latency settings */
+typedef sio_counters_t slcan_counters_t;  /**< serial port line error counters */
+
+/** @brief  Message queue counters (since the CAN channel was opened)
+ */
+typedef struct slcan_queue_counters_t_ {  /* message queue counters: */
+    uint64_t enqueued;                  /**< messages put into the queue */
+    uint64_t dequeued;                  /**< messages read from the queue */
+    uint64_t dropped;                   /**< received messages dropped (queue full) */
+    uint64_t overwritten;               /**< oldest messages overwritten (queue full) */
+    uint64_t coalesced;                 /**< queued messages replaced by a newer one with the same identifier */
+    uint64_t spilled;                   /**< messages written to the spill file */
+} slcan_queue_counters_t;
+
 /** @brief  CAN message (SocketCAN compatible)
  */
 typedef struct slcan_message_t_ {       /* SLCAN message: */
@@ -215,13 +252,23 @@ SLCANAPI int slcan_destroy(slcan_port_t port);
  *               the CAN channel is closed (via command 'Close Channel').
  *
  *  @param[in]   port    - pointer to a SLCAN instance
- *  @param[in]   device  - name of the serial device
+ *  @param[in]   device  - name of the serial device, or an URI such as
+ *                         'tcp://host:port', 'udp://host:port' or
+ *                         'pty:///dev/pts/N' (POSIX only, see sio_connect)
  *  @param[in]   attr    - serial port attributes (optional)
  *
  *  @returns     a file descriptor if successful, or a negative value on error.
  *
  *  @remarks     On Windows, the communication port number (zero based) is returned.
  *
+ *  @remarks     With option SLCAN_OPTION_LAZYDECODE the reception thread only
+ *               handles the responses and copies the raw bytes of received
+ *               CAN messages together with a time-stamp into a chunk queue;
+ *               the messages are decoded in slcan_read_message by the calling
+ *               thread (concurrent readers are serialized). A message split
+ *               by a lost chunk (queue full) is discarded. The queue statistics
+ *               are then counted in chunks (of up to 256 bytes) instead of messages.
+ *
  *  @note        System variable 'errno' will be set in case of an error.
  *
  *  @retval      ENODEV   - no such device (invalid port instance)
@@ -267,6 +314,186 @@ SLCANAPI int slcan_disconnect(slcan_port_t port);
 SLCANAPI int slcan_get_attr(slcan_port_t port, slcan_attr_t *attr);
 
 
+/** @brief       returns the effective latency settings of the serial port.
+ *
+ *  @param[in]   port     - pointer to a SLCAN instance
+ *  @param[out]  latency  - latency settings (-1 if not available)
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      ENODEV  - no such device (invalid port instance)
+ *  @retval      EINVAL  - invalid argument (latency is NULL)
+ */
+SLCANAPI int slcan_get_latency(slcan_port_t port, slcan_latency_t *latency);
+
+
+/** @brief       returns the line error counters of the serial port (overruns,
+ *               framing and parity errors, break conditions since connect).
+ *
+ *  @param[in]   port      - pointer to a SLCAN instance
+ *  @param[out]  counters  - line error counters
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      ENODEV  - no such device (invalid port instance)
+ *  @retval      EINVAL  - invalid argument (counters is NULL)
+ *  @retval      ENOTSUP - not supported by the serial driver
+ */
+SLCANAPI int slcan_get_counters(slcan_port_t port, slcan_counters_t *counters);
+
+
+/** @brief       returns the number of messages in the message queue.
+ *
+ *  @param[in]   port       - pointer to a SLCAN instance
+ *  @param[out]  size       - capacity of the message queue (optional)
+ *  @param[out]  high       - max. number of messages queued so far (optional)
+ *  @param[out]  overflows  - number of lost messages (queue overflows, optional)
+ *
+ *  @returns     number of queued messages, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      ENODEV  - no such device (invalid port instance)
+ */
+SLCANAPI int slcan_queue_usage(slcan_port_t port, uint32_t *size, uint32_t *high, uint64_t *overflows);
+
+
+/** @brief       returns the number of bytes in the output queue of the serial
+ *               port, i.e. data not yet transmitted to the SLCAN device.
+ *
+ *  @param[in]   port  - pointer to a SLCAN instance
+ *
+ *  @returns     number of bytes in the output queue, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      ENODEV  - no such device (invalid port instance)
+ *  @retval      EBADF   - bad file descriptor (device not connected)
+ */
+SLCANAPI int slcan_output_queue(slcan_port_t port);
+
+
+/** @brief       sets the policy how a reader waits for messages on an empty
+ *               message queue (in 'slcan_read_message' with a time-out).
+ *
+ *  @remarks     SLCAN_WAIT_BLOCK blocks on the message queue until a message
+ *               arrives (this costs a wake-up of the reader for each message).
+ *               SLCAN_WAIT_SPIN spins for up to 'spin' microseconds before it
+ *               blocks; the spin time adapts to the inter-arrival time of the
+ *               messages.  SLCAN_WAIT_POLL busy-polls until a message arrives
+ *               or the time-out expires (for a reader on a dedicated CPU core).
+ *
+ *  @remarks     Spinning and polling trade CPU time for wake-up latency.
+ *               They are not supported on Windows (only SLCAN_WAIT_BLOCK).
+ *
+ *  @param[in]   port    - pointer to a SLCAN instance
+ *  @param[in]   policy  - wait policy (SLCAN_WAIT_BLOCK, _SPIN or _POLL)
+ *  @param[in]   spin    - max. spin time in microseconds (SLCAN_WAIT_SPIN)
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      ENODEV   - no such device (invalid port instance)
+ *  @retval      EINVAL   - invalid argument (policy)
+ *  @retval      ENOTSUP  - operation not supported (spinning or polling on Windows)
+ */
+SLCANAPI int slcan_wait_policy(slcan_port_t port, int policy, uint32_t spin);
+
+
+/** @brief       sets the policy what happens to a message received into a full
+ *               message queue.
+ *
+ *  @remarks     SLCAN_OVFL_DROP_NEWEST drops the received message (default).
+ *               SLCAN_OVFL_DROP_OLDEST overwrites the oldest message in the
+ *               queue, i.e. the reader always gets the most recent messages.
+ *               SLCAN_OVFL_KEEP_LATEST keeps at most one message per identifier
+ *               in the queue: a message whose identifier is already queued
+ *               replaces the payload of the queued one (which keeps its place),
+ *               so the queue never holds stale data of an identifier.  It
+ *               overflows only when more identifiers than its capacity are
+ *               pending; then the received message is dropped.
+ *
+ *  @remarks     With option SLCAN_OPTION_LAZYDECODE the queue holds undecoded
+ *               bytes, so SLCAN_OVFL_KEEP_LATEST is not supported then and
+ *               SLCAN_OVFL_DROP_OLDEST overwrites the oldest bytes.
+ *
+ *  @param[in]   port    - pointer to a SLCAN instance
+ *  @param[in]   policy  - overflow policy (SLCAN_OVFL_DROP_NEWEST, _DROP_OLDEST or _KEEP_LATEST)
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      ENODEV   - no such device (invalid port instance)
+ *  @retval      EINVAL   - invalid argument (policy)
+ *  @retval      ENOMEM   - out of memory (identifier index)
+ *  @retval      ENOTSUP  - operation not supported (with lazy decoding or a spill file)
+ */
+SLCANAPI int slcan_overflow_policy(slcan_port_t port, int policy);
+
+
+/** @brief       retrieves the counters of the message queue.
+ *
+ *  @remarks     Their sum satisfies: enqueued = dequeued + overwritten + coalesced
+ *               + the number of queued messages (including spilled messages).  Received messages are either
+ *               enqueued or dropped.  With option SLCAN_OPTION_LAZYDECODE they
+ *               count chunks of undecoded bytes instead of messages.
+ *
+ *  @param[in]   port      - pointer to a SLCAN instance
+ *  @param[out]  counters  - pointer to a buffer for the counters
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      ENODEV  - no such device (invalid port instance)
+ *  @retval      EINVAL  - invalid argument (counters is NULL)
+ */
+SLCANAPI int slcan_queue_counters(slcan_port_t port, slcan_queue_counters_t *counters);
+
+
+/** @brief       sets up a spill file for received messages beyond a high-water
+ *               mark of the message queue.
+ *
+ *  @remarks     When 'mark' messages are queued in memory, received messages
+ *               are appended to a memory-mapped spill file of 'size' messages
+ *               instead of being lost when the reader stalls.  The reader gets
+ *               the messages from memory first, then from the spill file, i.e.
+ *               in the order they were received ('slcan_read_message' is not
+ *               aware of it).  When the spill file is full, received messages
+ *               are dropped.  The spill file requires the overflow policy
+ *               SLCAN_OVFL_DROP_NEWEST; it is not supported on Windows.
+ *
+ *  @remarks     The file is created (it must not exist) with its disk space
+ *               reserved, and it is unlinked at once.  A NULL pointer for 'path'
+ *               or a zero for 'size' removes the spill file, if it is empty.
+ *               With option SLCAN_OPTION_LAZYDECODE chunks of undecoded bytes
+ *               are spilled instead of messages.
+ *
+ *  @param[in]   port  - pointer to a SLCAN instance
+ *  @param[in]   path  - path name of the spill file (or NULL)
+ *  @param[in]   size  - number of messages in the spill file (or 0)
+ *  @param[in]   mark  - number of messages in memory from which on messages
+ *                       are spilled (0 = when the message queue is full)
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      ENODEV   - no such device (invalid port instance)
+ *  @retval      EINVAL   - invalid argument (mark or size)
+ *  @retval      EBUSY    - device or resource busy (spill file not empty)
+ *  @retval      ENOTSUP  - operation not supported (overflow policy, or on Windows)
+ *  @retval      (other)  - when the spill file cannot be created or mapped
+ */
+SLCANAPI int slcan_spill_file(slcan_port_t port, const char *path, uint32_t size, uint32_t mark);
+
+
 /** @brief       setup with standard CAN bit-rates.
  *
  *  @remarks     This command is only active if the CAN channel is closed.
@@ -383,6 +610,77 @@ SLCANAPI int slcan_close_channel(slcan_port_t port);
 SLCANAPI int slcan_write_message(slcan_port_t port, const slcan_message_t *message, uint16_t timeout);
 
 
+/** @brief       transmits a CAN message and waits for its confirmation not
+ *               longer than until the given deadline.
+ *
+ *  @remarks     This command is only active if the CAN channel is open.
+ *
+ *  @remarks     The deadline is an absolute time of the monotonic clock, i.e.
+ *               of CLOCK_MONOTONIC (on Windows: of QueryPerformanceCounter).
+ *               The confirmation is awaited at most for the default time-out
+ *               of a transmission, also when the deadline is later.
+ *
+ *  @param[in]   port     - pointer to a SLCAN instance
+ *  @param[in]   message  - pointer to the message to be sent
+ *  @param[in]   deadline - absolute time until to wait for the confirmation,
+ *                          or NULL for the default time-out
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      ENODEV    - no such device (invalid port instance)
+ *  @retval      EINVAL    - invalid argument (message)
+ *  @retval      EBADF     - bad file descriptor (device not connected)
+ *  @retval      EBUSY     - device / resource busy (disturbance)
+ *  @retval      EBADMSG   - bad message (format or disturbance)
+ *  @retval      ETIMEDOUT - timed out (not acknowledged until the deadline)
+ *  @retval      'errno'   - error code from called system functions:
+ *                           'write', 'read', etc.
+ */
+SLCANAPI int slcan_write_message_until(slcan_port_t port, const slcan_message_t *message, const struct timespec *deadline);
+
+
+/** @brief       transmits a batch of CAN messages with one serial write.
+ *
+ *  @remarks     This command is only active if the CAN channel is open.
+ *
+ *  @remarks     The messages are encoded into one write to the serial port and
+ *               the responses are collected afterwards. The device answers each
+ *               message in order, with a confirmation or a negative acknowledge.
+ *               At most 64 messages are transmitted per call; the caller must
+ *               resubmit the rest, starting at the first unanswered message.
+ *
+ *  @remarks     A message with a negative acknowledge was rejected by the device
+ *               (e.g. its transmit buffer was full). It counts as answered, but
+ *               it is reported in 'rejected'.
+ *
+ *  @param[in]   port      - pointer to a SLCAN instance
+ *  @param[in]   messages  - pointer to an array of messages to be sent
+ *  @param[in]   count     - number of messages in the array
+ *  @param[in]   timeout   - time to wait for the responses of the batch (in [ms]),
+ *                           0 means the default of 1000ms, and 65535 means
+ *                           waiting without a time limit
+ *  @param[out]  rejected  - number of negative acknowledges (optional)
+ *
+ *  @returns     the number of answered messages if successful, or a negative
+ *               value on error. If not all messages are answered, 'errno' is
+ *               set to the reason (e.g. ETIMEDOUT or EBADMSG).
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      ENODEV    - no such device (invalid port instance)
+ *  @retval      EINVAL    - invalid argument (messages or count)
+ *  @retval      EBADF     - bad file descriptor (device not connected)
+ *  @retval      EBUSY     - device / resource busy (disturbance)
+ *  @retval      EBADMSG   - bad message (format or disturbance)
+ *  @retval      ETIMEDOUT - timed out (command not acknowledged)
+ *  @retval      'errno'   - error code from called system functions:
+ *                           'write', 'read', etc.
+ */
+SLCANAPI int slcan_write_messages(slcan_port_t port, const slcan_message_t *messages, size_t count, uint16_t timeout, size_t *rejected);
+
+
 /** @brief       read one message from the message queue, if any.
  *
  *  @param[in]   port     - pointer to a SLCAN instance
@@ -402,6 +700,7 @@ SLCANAPI int slcan_write_message(slcan_port_t port, const slcan_message_t *messa
  *  @retval      EINVAL  - invalid argument (message)
  *  @retval      ENOMSG  - no data available (message queue empty)
  *  @retval      ENOSPC  - no space left (message queue overflow)
+ *  @retval      ENOTCONN - connection lost (and message queue empty)
  *
  *  @remarks     If a message has been successfully read from the message queue,
  *               the value ENOSPC in the system variable 'errno' indicates that
@@ -411,6 +710,87 @@ SLCANAPI int slcan_write_message(slcan_port_t port, const slcan_message_t *messa
 SLCANAPI int slcan_read_message(slcan_port_t port, slcan_message_t *message, uint16_t timeout);
 
 
+/** @brief       read one message from the message queue, if any, together
+ *               with its time-stamp.
+ *
+ *  @remarks     The time-stamp is taken by the host when the message has been
+ *               received from the serial port (the SLCAN protocol does not
+ *               provide device time-stamps in [ns]).
+ *
+ *  @param[in]   port       - pointer to a SLCAN instance
+ *  @param[out]  message    - pointer to a message buffer
+ *  @param[out]  timestamp  - time of reception (wall-clock), or NULL
+ *  @param[in]   timeout    - time to wait for the reception of a message:
+ *                                 0 means the function returns immediately,
+ *                                 65535 means blocking read, and any other
+ *                                 value means the time to wait im milliseconds
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @retval      -30  - when the message queue is empty (CAN API compatible)
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      ENODEV    - no such device (invalid port instance)
+ *  @retval      EINVAL    - invalid argument (message)
+ *  @retval      ENOMSG    - no data available (message queue empty)
+ *  @retval      ENOSPC    - no space left (message queue overflow)
+ *  @retval      ENOTCONN  - connection lost (and message queue empty)
+ */
+SLCANAPI int slcan_read_message_ts(slcan_port_t port, slcan_message_t *message, struct timespec *timestamp, uint16_t timeout);
+
+
+/** @brief       read one message from the message queue, if any, together
+ *               with its time-stamp, and waits for it not longer than until
+ *               the given deadline.
+ *
+ *  @remarks     The deadline is an absolute time of the monotonic clock, i.e.
+ *               of CLOCK_MONOTONIC (on Windows: of QueryPerformanceCounter,
+ *               with a resolution of one millisecond).  A deadline that has
+ *               already passed means polling.  Taking the deadline of a cycle
+ *               instead of a time-out avoids a drift when called repeatedly.
+ *
+ *  @param[in]   port       - pointer to a SLCAN instance
+ *  @param[out]  message    - pointer to a message buffer
+ *  @param[out]  timestamp  - time of reception (wall-clock), or NULL
+ *  @param[in]   deadline   - absolute time until to wait for the reception of
+ *                            a message, or NULL for a blocking read
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @retval      -30  - when the message queue is empty (CAN API compatible)
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      ENODEV    - no such device (invalid port instance)
+ *  @retval      EINVAL    - invalid argument (message)
+ *  @retval      ENOMSG    - no data available (message queue empty)
+ *  @retval      ETIMEDOUT - no data available until the deadline
+ *  @retval      ENOSPC    - no space left (message queue overflow)
+ *  @retval      ENOTCONN  - connection lost (and message queue empty)
+ */
+SLCANAPI int slcan_read_message_until(slcan_port_t port, slcan_message_t *message, struct timespec *timestamp, const struct timespec *deadline);
+
+
+/** @brief       puts a message into the message queue, e.g. an in-band status
+ *               message (CAN_ERR_FRAME) generated by the upper layer.
+ *
+ *  @param[in]   port     - pointer to a SLCAN instance
+ *  @param[in]   message  - pointer to the message to be queued
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @retval      -20  - when the message queue is full (CAN API compatible)
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      ENODEV  - no such device (invalid port instance)
+ *  @retval      EINVAL  - invalid argument (message)
+ *  @retval      ENOSPC  - no space left (message queue overflow)
+ */
+SLCANAPI int slcan_queue_message(slcan_port_t port, const slcan_message_t *message);
+
+
 /** @brief       read status flags.
  *
  *  @remarks     This command is only active if the CAN channel is open.
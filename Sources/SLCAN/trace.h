@@ -0,0 +1,139 @@
+/*  SPDX-License-Identifier: BSD-2-Clause OR GPL-3.0-or-later */
+/*
+ *  Software for Industrial Communication, Motion Control and Automation
+ *
+ *  Copyright (c) 2002-2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+ *  All rights reserved.
+ *
+ *  Module 'trace'
+ *
+ *  This module is dual-licensed under the BSD 2-Clause "Simplified" License
+ *  and under the GNU General Public License v3.0 (or any later version).
+ *  You can choose between one of them if you use this module.
+ *
+ *  BSD 2-Clause "Simplified" License:
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  THIS MODULE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS MODULE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  GNU General Public License v3.0 or later:
+ *  This module is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This module is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this module.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/** @file        trace.h
+ *
+ *  @brief       Static tracepoints (USDT) on the hot paths.
+ *
+ *  @remarks     When the header <sys/sdt.h> (SystemTap SDT) is available, the
+ *               macros SLCAN_TRACE and SLCAN_TRACEn place a static tracepoint
+ *               of provider 'slcan' into the code. A tracepoint is a single
+ *               'nop' instruction until a tracer (e.g. perf, bpftrace) attaches
+ *               to it; the arguments are evaluated anyway, so only cheap ones
+ *               (integers and pointers) shall be passed.
+ *
+ *  @remarks     Tracepoints (provider 'slcan'):
+ *               - serial_read(port, nbytes): bytes received by the reader thread
+ *               - serial_write(port, nbytes, result): bytes sent to the device
+ *               - frame_received(port, buffer, nbytes): SLCAN message indication
+ *               - frame_decoded(port, can_id, can_dlc): decoded CAN message
+ *               - frame_enqueued(port, can_id, can_dlc): CAN message queued
+ *               - frame_dropped(port, can_id, can_dlc): CAN message lost (queue full)
+ *               - chunk_enqueued(port, chunk, nbytes): raw bytes queued (lazy decoding)
+ *               - chunk_dropped(port, chunk, nbytes): raw bytes lost (queue full)
+ *               - transmit_submit(port, can_id, can_dlc): CAN message sent to the device
+ *               - transmit_batch(port, count, nbytes): CAN messages sent to the device
+ *               - ack_received(port, response): 'z' or 'Z' (or BEL) received
+ *               - transmit_done(port, can_id, result): transmission confirmed (or not);
+ *                 for a batch the identifier of the first and the number of confirmed messages
+ *               - command_sent(port, command, nbytes): request sent to the device
+ *               - command_response(port, command, result): response received (or not)
+ *               - queue_enqueue(queue, depth, high): element queued
+ *               - queue_overflow(queue, depth, counter): element lost (queue full)
+ *               - queue_wait_start(queue, deadline): consumer blocks on an empty queue
+ *                 (deadline of the monotonic clock in [ns], UINT64_MAX = infinite)
+ *               - queue_wait_end(queue, depth, result): consumer woken up (result 0)
+ *               - queue_spin(queue, nanos, result): consumer stopped spinning on an
+ *                 empty queue (result 0 = expired, 1 = element arrived, 2 = signalled)
+ *               - queue_dequeue(queue, depth): element dequeued
+ *
+ *  @remarks     The tracepoints queue_enqueue and queue_overflow fire in the
+ *               same thread directly before frame_enqueued resp. frame_dropped,
+ *               so a tracer can correlate the CAN identifier with the queue
+ *               depth by the thread id.
+ *
+ *  @note        Set define OPTION_SLCAN_TRACEPOINTS to 0 to compile without
+ *               tracepoints, or to 1 to demand them (<sys/sdt.h> required).
+ *
+ *  @defgroup    trace Static Tracepoints
+ *  @{
+ */
+#ifndef TRACE_H_INCLUDED
+#define TRACE_H_INCLUDED
+
+
+/*  -----------  options  ------------------------------------------------
+ */
+
+#if !defined(OPTION_SLCAN_TRACEPOINTS)
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define OPTION_SLCAN_TRACEPOINTS  1
+#endif
+#endif
+#endif
+#if !defined(OPTION_SLCAN_TRACEPOINTS)
+#define OPTION_SLCAN_TRACEPOINTS  0
+#endif
+
+
+/*  -----------  defines  ------------------------------------------------
+ */
+
+#if (OPTION_SLCAN_TRACEPOINTS > 0)
+#include <sys/sdt.h>
+
+#define SLCAN_TRACE(name)  DTRACE_PROBE(slcan, name)
+#define SLCAN_TRACE1(name,a1)  DTRACE_PROBE1(slcan, name, a1)
+#define SLCAN_TRACE2(name,a1,a2)  DTRACE_PROBE2(slcan, name, a1, a2)
+#define SLCAN_TRACE3(name,a1,a2,a3)  DTRACE_PROBE3(slcan, name, a1, a2, a3)
+#define SLCAN_TRACE4(name,a1,a2,a3,a4)  DTRACE_PROBE4(slcan, name, a1, a2, a3, a4)
+#else
+#define SLCAN_TRACE(name)  while (0)
+#define SLCAN_TRACE1(name,a1)  while (0)
+#define SLCAN_TRACE2(name,a1,a2)  while (0)
+#define SLCAN_TRACE3(name,a1,a2,a3)  while (0)
+#define SLCAN_TRACE4(name,a1,a2,a3,a4)  while (0)
+#endif
+
+#endif /* TRACE_H_INCLUDED */
+
+/*  ----------------------------------------------------------------------
+ *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
+ *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
+ *  E-Mail: uwe.vogt@uv-software.de,  Homepage: http://www.uv-software.de/
+ */
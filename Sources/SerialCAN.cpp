@@ -295,6 +295,30 @@ CANAPI_Return_t CSerialCAN::ReadMessage(CANAPI_Message_t &message, uint16_t time
     return can_read(m_Handle, &message, timeout);
 }
 
+EXPORT
+CANAPI_Return_t CSerialCAN::WriteMessageNs(CANAPI_Message_t message, uint64_t timeout) {
+    // transmit a message over the CAN bus (time-out in [ns])
+    return can_write_ns(m_Handle, &message, timeout);
+}
+
+EXPORT
+CANAPI_Return_t CSerialCAN::WriteMessageUntil(CANAPI_Message_t message, const struct timespec &deadline) {
+    // transmit a message over the CAN bus (until the deadline)
+    return can_write_until(m_Handle, &message, &deadline);
+}
+
+EXPORT
+CANAPI_Return_t CSerialCAN::ReadMessageNs(CANAPI_Message_t &message, uint64_t timeout) {
+    // read one message from the message queue of the CAN interface (time-out in [ns])
+    return can_read_ns(m_Handle, &message, timeout);
+}
+
+EXPORT
+CANAPI_Return_t CSerialCAN::ReadMessageUntil(CANAPI_Message_t &message, const struct timespec &deadline) {
+    // read one message from the message queue of the CAN interface (until the deadline)
+    return can_read_until(m_Handle, &message, &deadline);
+}
+
 EXPORT
 CANAPI_Return_t CSerialCAN::GetStatus(CANAPI_Status_t &status) {
     // retrieve the status register of the CAN interface
@@ -111,6 +111,12 @@ public:
     CANAPI_Return_t WriteMessage(CANAPI_Message_t message, uint16_t timeout = 0U);
     CANAPI_Return_t ReadMessage(CANAPI_Message_t &message, uint16_t timeout = CANWAIT_INFINITE);
 
+    // extended time-outs: in [ns] or absolute deadline (CLOCK_MONOTONIC)
+    CANAPI_Return_t WriteMessageNs(CANAPI_Message_t message, uint64_t timeout);
+    CANAPI_Return_t WriteMessageUntil(CANAPI_Message_t message, const struct timespec &deadline);
+    CANAPI_Return_t ReadMessageNs(CANAPI_Message_t &message, uint64_t timeout);
+    CANAPI_Return_t ReadMessageUntil(CANAPI_Message_t &message, const struct timespec &deadline);
+
     CANAPI_Return_t GetStatus(CANAPI_Status_t &status);
     CANAPI_Return_t GetBusLoad(uint8_t &load);
 
@@ -176,6 +182,21 @@ public:
 #define SERIALCAN_PROPERTY_SERIAL_NUMBER        (CANPROP_GET_VENDOR_PROP + SLCAN_SERIAL_NUMBER)
 #define SERIALCAN_PROPERTY_HARDWARE_VERSION     (CANPROP_GET_VENDOR_PROP + SLCAN_HARDWARE_VERSION)
 #define SERIALCAN_PROPERTY_FIRMWARE_VERSION     (CANPROP_GET_VENDOR_PROP + SLCAN_FIRMWARE_VERSION)
+#define SERIALCAN_PROPERTY_STATUS_POLLING       (CANPROP_GET_VENDOR_PROP + SLCAN_STATUS_POLLING)
+#define SERIALCAN_PROPERTY_SET_STATUS_POLLING   (CANPROP_SET_VENDOR_PROP + SLCAN_STATUS_POLLING)
+#define SERIALCAN_PROPERTY_LOW_LATENCY          (CANPROP_GET_VENDOR_PROP + SLCAN_LOW_LATENCY)
+#define SERIALCAN_PROPERTY_LATENCY_TIMER        (CANPROP_GET_VENDOR_PROP + SLCAN_LATENCY_TIMER)
+#define SERIALCAN_PROPERTY_OUTPUT_QUEUE         (CANPROP_GET_VENDOR_PROP + SLCAN_OUTPUT_QUEUE)
+#define SERIALCAN_PROPERTY_LINE_COUNTERS        (CANPROP_GET_VENDOR_PROP + SLCAN_LINE_COUNTERS)
+#define SERIALCAN_PROPERTY_WAIT_POLICY          (CANPROP_GET_VENDOR_PROP + SLCAN_WAIT_POLICY)
+#define SERIALCAN_PROPERTY_SET_WAIT_POLICY      (CANPROP_SET_VENDOR_PROP + SLCAN_WAIT_POLICY)
+#define SERIALCAN_PROPERTY_SPIN_TIME            (CANPROP_GET_VENDOR_PROP + SLCAN_SPIN_TIME)
+#define SERIALCAN_PROPERTY_SET_SPIN_TIME        (CANPROP_SET_VENDOR_PROP + SLCAN_SPIN_TIME)
+#define SERIALCAN_PROPERTY_OVERFLOW_POLICY      (CANPROP_GET_VENDOR_PROP + SLCAN_OVERFLOW_POLICY)
+#define SERIALCAN_PROPERTY_SET_OVERFLOW_POLICY  (CANPROP_SET_VENDOR_PROP + SLCAN_OVERFLOW_POLICY)
+#define SERIALCAN_PROPERTY_QUEUE_COUNTERS       (CANPROP_GET_VENDOR_PROP + SLCAN_QUEUE_COUNTERS)
+#define SERIALCAN_PROPERTY_SPILL_FILE           (CANPROP_GET_VENDOR_PROP + SLCAN_SPILL_FILE)
+#define SERIALCAN_PROPERTY_SET_SPILL_FILE       (CANPROP_SET_VENDOR_PROP + SLCAN_SPILL_FILE)
 #define SERIALCAN_PROPERTY_CLOCK_DOMAIN         (CANPROP_GET_CAN_CLOCK)
 /// \}
 #endif // SERIALCAN_H_INCLUDED
@@ -80,12 +80,15 @@
 #include "slcan.h"
 #else
 #include <unistd.h>
+#include <pthread.h>
+#include <time.h>
 #include "slcan.h"
 #endif
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
 #include <errno.h>
+#include <stdint.h>
 
 /*  -----------  options  ------------------------------------------------
  */
@@ -144,6 +147,16 @@ static void _finalizer() {
 #define DEV_DLLNAME             SLCAN_LIB_DRIVER
 #define NUM_CHANNELS            CANSIO_BOARDS
 
+#define POLLING_INTERVAL_MIN    10U     // minimum status polling interval [ms]
+#define POLLING_INTERVAL_MAX    60000U  // maximum status polling interval [ms]
+#define POLLING_FLAGS_MASK      0xF6U   // status flags w/o BEI (cleared on read)
+#define SPIN_TIME_DEFAULT       50U     // default max. spin time [us] (wait policy 'spin')
+#if !defined(_WIN32) && !defined(_WIN64)
+#define STATUS_POLLER_SUPPORTED 1
+#else
+#define STATUS_POLLER_SUPPORTED 0
+#endif
+
 /*  -----------  types  --------------------------------------------------
  */
 typedef struct {                        // message filtering:
@@ -160,6 +173,28 @@ typedef struct {                        // frame counters:
     uint64_t err;                       //   number of receiced error frames
 }   can_counter_t;
 
+typedef struct {                        // status poller:
+    uint32_t interval;                  //   polling interval in [ms] (0 = off)
+    slcan_flags_t flags;                //   last polled SLCAN status flags
+    volatile bool running;              //   flag: poller thread is running
+#if (STATUS_POLLER_SUPPORTED != 0)
+    pthread_t thread;                   //   poller thread
+    pthread_mutex_t mutex;              //   mutex for the wait condition
+    pthread_cond_t cond;                //   wait condition (to stop the poller)
+#endif
+}   can_poller_t;
+
+typedef struct {                        // wait policy of the reader:
+    uint8_t policy;                     //   block, spin or poll (SLCAN_WAIT_xyz)
+    uint32_t spin;                      //   max. spin time in [us]
+}   can_wait_t;
+
+typedef struct {                        // spill file of the receive queue:
+    char name[CANPROP_MAX_BUFFER_SIZE]; //   path name of the spill file
+    uint32_t size;                      //   number of messages (0 = none)
+    uint32_t mark;                      //   high-water mark of the queue
+}   can_spill_t;
+
 typedef struct {                        // SLCAN interface:
     slcan_port_t port;                  //   serial communication port
     can_sio_attr_t attr;                //   serial communication attributes
@@ -167,6 +202,10 @@ typedef struct {                        // SLCAN interface:
     can_filter_t filter;                //   message filter settings
     can_status_t status;                //   8-bit status register
     can_counter_t counters;             //   statistical counters
+    can_poller_t poller;                //   background status poller
+    can_wait_t wait;                    //   wait policy of the reader
+    uint8_t overflow;                   //   overflow policy of the receive queue
+    can_spill_t spill;                  //   spill file of the receive queue
     uint16_t btr0btr1;                  //   bit-rate settings
     char name[CANPROP_MAX_BUFFER_SIZE]; //   TTY device name
 }   can_interface_t;
@@ -185,6 +224,18 @@ static int get_sio_attr(slcan_port_t port, can_sio_attr_t *attr);
 static int set_filter(int handle, uint64_t filter, bool xtd);
 static int reset_filter(int handle);
 
+static int update_status(int handle, slcan_flags_t *flags);
+static void merge_status(int handle, uint8_t mask, uint8_t bits);
+static int start_poller(int handle, uint32_t interval);
+static int stop_poller(int handle);
+#if (STATUS_POLLER_SUPPORTED != 0)
+static void *status_poller(void *arg);
+#endif
+
+static int write_message(int handle, const can_message_t *msg, const struct timespec *deadline);
+static int read_message(int handle, can_message_t *msg, const struct timespec *deadline);
+static void get_deadline(struct timespec *deadline, uint64_t timeout);
+
 static int lib_parameter(uint16_t param, void *value, size_t nbyte);
 static int drv_parameter(int handle, uint16_t param, void *value, size_t nbyte);
 
@@ -240,7 +291,7 @@ int can_test(int32_t channel, uint8_t mode, const void *param, int *result)
         init = 1;                       //   set initialization flag
     }
     // check requested protocol option (SLCAN)
-    if ((((can_sio_param_t*)param)->attr.options & CANSIO_SLCAN) != CANSIO_SLCAN) {
+    if ((((can_sio_param_t*)param)->attr.options & CANSIO_PROTOCOL) != CANSIO_SLCAN) {
         rc = CANERR_ILLPARA;
         goto end_test;
     }
@@ -312,7 +363,7 @@ int can_init(int32_t channel, uint8_t mode, const void *param)
         return CANERR_NOTINIT;
     }
     // check requested protocol option (SLCAN)
-    if ((((can_sio_param_t*)param)->attr.options & CANSIO_SLCAN) != CANSIO_SLCAN) {
+    if ((((can_sio_param_t*)param)->attr.options & CANSIO_PROTOCOL) != CANSIO_SLCAN) {
         rc = CANERR_ILLPARA;
         goto err_init;
     }
@@ -369,6 +420,7 @@ static int exit_channel(int handle)
         return CANERR_HANDLE;
     if (!IS_HANDLE_OPENED(handle))      // must be an open handle
         return CANERR_HANDLE;
+    (void)stop_poller(handle);          // stop the status poller (if any)
     if (!can[handle].status.can_stopped) { // if running then go bus off
         (void)can_reset(handle);
     }
@@ -379,7 +431,13 @@ static int exit_channel(int handle)
     }
     (void)slcan_destroy(can[handle].port);  // destroy SLCAN port
 
-    can[handle].status.byte |= CANSTAT_RESET;  // CAN controller in INIT state
+    merge_status(handle, CANSTAT_RESET, CANSTAT_RESET);  // CAN controller in INIT state
+    can[handle].wait.policy = SLCAN_WAIT_BLOCK;
+    can[handle].wait.spin = SPIN_TIME_DEFAULT;
+    can[handle].overflow = SLCAN_OVFL_DROP_NEWEST;
+    can[handle].spill.name[0] = '\0';
+    can[handle].spill.size = 0U;
+    can[handle].spill.mark = 0U;
     can[handle].port = NULL;            // handle can be used again
     return CANERR_NOERROR;
 }
@@ -491,12 +549,13 @@ int can_start(int handle, const can_bitrate_t *bitrate)
     // store the bit-rate settings
     can[handle].btr0btr1 = btr0btr1;
     // clear old status and counters
-    can[handle].status.byte = 0x00u;
+    merge_status(handle, (uint8_t)~CANSTAT_RESET, 0x00u);
     can[handle].counters.tx = 0ull;
     can[handle].counters.rx = 0ull;
     can[handle].counters.err = 0ull;
+    can[handle].poller.flags.byte = 0x00u;
     // CAN controller started!
-    can[handle].status.can_stopped = 0;
+    merge_status(handle, CANSTAT_RESET, 0x00u);
     return CANERR_NOERROR;
 }
 
@@ -522,101 +581,65 @@ int can_reset(int handle)
     // stop the CAN controller (INIT state)
     rc = slcan_close_channel(can[handle].port);
     rc = slcan_error(rc);
-    can[handle].status.can_stopped = (rc == CANERR_NOERROR) ? 1 : 0;
+    merge_status(handle, CANSTAT_RESET, (rc == CANERR_NOERROR) ? CANSTAT_RESET : 0x00u);
     return rc;
 }
 
 EXPORT
 int can_write(int handle, const can_message_t *msg, uint16_t timeout)
 {
-    slcan_message_t slcan;              // SLCAN message
-    int rc = CANERR_FATAL;              // return value
-
-    if (!init)                          // must be initialized
-        return CANERR_NOTINIT;
-    if (!IS_HANDLE_VALID(handle))       // must be a valid handle
-        return CANERR_HANDLE;
-    if (!IS_HANDLE_OPENED(handle))      // must be an open handle
-        return CANERR_HANDLE;
-    if (msg == NULL)                    // check for null-pointer
-        return CANERR_NULLPTR;
-    if (can[handle].status.can_stopped) // must be running
-        return CANERR_OFFLINE;
+    // note: the confirmation is awaited for the default time-out
+    (void)timeout;
+    return write_message(handle, msg, NULL);
+}
 
-    if (msg->id > (uint32_t)(msg->xtd ? CAN_MAX_XTD_ID : CAN_MAX_STD_ID))
-        return CANERR_ILLPARA;          // invalid identifier
-    if (msg->dlc > CAN_MAX_DLC)
-        return CANERR_ILLPARA;          // invalid data length code
-    if (msg->xtd && can[handle].mode.nxtd)
-        return CANERR_ILLPARA;          // suppress extended frames
-    if (msg->rtr && can[handle].mode.nrtr)
-        return CANERR_ILLPARA;          // suppress remote frames
-    if (msg->sts)
-        return CANERR_ILLPARA;          // error frames cannot be sent
+EXPORT
+int can_write_ns(int handle, const can_message_t *msg, uint64_t timeout)
+{
+    struct timespec deadline;           // absolute time (monotonic)
 
-    // map message layout
-    memset(&slcan, 0x00, sizeof(slcan_message_t));
-    slcan.can_id = msg->id & (msg->xtd ? CAN_XTD_MASK : CAN_STD_MASK);
-    slcan.can_id |= (msg->xtd ? CAN_XTD_FRAME : 0x00000000U);
-    slcan.can_id |= (msg->rtr ? CAN_RTR_FRAME : 0x00000000U);
-    slcan.can_dlc = msg->dlc;
-    memcpy(slcan.data, msg->data, slcan.can_dlc);
-    // transmit the CAN message
-    rc = slcan_write_message(can[handle].port, &slcan, timeout);
-    rc = slcan_error(rc);
-    // update status and tx counter
-    can[handle].status.transmitter_busy = (rc != CANERR_NOERROR) ? 1 : 0;
-    can[handle].counters.tx += (rc == CANERR_NOERROR) ? 1U : 0U;
+    if ((timeout == 0U) || (timeout == UINT64_MAX))
+        return write_message(handle, msg, NULL);
+    get_deadline(&deadline, timeout);
+    return write_message(handle, msg, &deadline);
+}
 
-    return rc;
+EXPORT
+int can_write_until(int handle, const can_message_t *msg, const struct timespec *deadline)
+{
+    return write_message(handle, msg, deadline);
 }
 
 EXPORT
 int can_read(int handle, can_message_t *msg, uint16_t timeout)
 {
-    slcan_message_t slcan;              // SLCAN message
-    int rc = CANERR_FATAL;              // return value
-
-    if (!init)                          // must be initialized
-        return CANERR_NOTINIT;
-    if (!IS_HANDLE_VALID(handle))       // must be a valid handle
-        return CANERR_HANDLE;
-    if (!IS_HANDLE_OPENED(handle))      // must be an open handle
-        return CANERR_HANDLE;
-    if (msg == NULL)                    // check for null-pointer
-        return CANERR_NULLPTR;
-    if (can[handle].status.can_stopped) // must be running
-        return CANERR_OFFLINE;
-
-    memset(msg, 0x00, sizeof(can_message_t));
-    msg->id = 0xFFFFFFFFu;
-    msg->sts = 1;
+    struct timespec deadline = { 0, 0 };  // absolute time (monotonic)
+
+    // note: a deadline in the past means polling
+    if (timeout == CANWAIT_INFINITE)
+        return read_message(handle, msg, NULL);
+    if (timeout != 0U)
+        get_deadline(&deadline, (uint64_t)timeout * 1000000U);
+    return read_message(handle, msg, &deadline);
+}
 
-    // read one CAN message from message queue, if any
-    rc = slcan_read_message(can[handle].port, &slcan, timeout);
-    if (rc == CANERR_NOERROR) {
-        // map message layout
-        msg->xtd = (slcan.can_id & CAN_XTD_FRAME) ? 1 : 0;
-        msg->sts = (slcan.can_id & CAN_ERR_FRAME) ? 1 : 0;
-        msg->rtr = (slcan.can_id & CAN_RTR_FRAME) ? 1 : 0;
-        msg->id = slcan.can_id & (msg->xtd ? CAN_XTD_MASK : CAN_STD_MASK);
-        msg->dlc = (slcan.can_dlc < CAN_DLC_MAX) ? slcan.can_dlc : CAN_LEN_MAX;
-        memcpy(msg->data, slcan.data, msg->dlc);
-        // update receive counter
-        can[handle].counters.rx += !msg->sts ? 1U : 0U;
-        can[handle].counters.err += msg->sts ? 1U : 0U;
-    }
-    else if (rc != CANERR_RX_EMPTY) {
-        rc = slcan_error(rc);
-    }
-    else {
-        rc = CANERR_RX_EMPTY;
-    }
-    // update status register
-    can[handle].status.receiver_empty = (rc != CANERR_NOERROR) ? 1 : 0;
-    can[handle].status.queue_overrun |= (errno == ENOSPC) ? 1 : 0;
+EXPORT
+int can_read_ns(int handle, can_message_t *msg, uint64_t timeout)
+{
+    struct timespec deadline = { 0, 0 };  // absolute time (monotonic)
+
+    // note: a deadline in the past means polling
+    if (timeout == UINT64_MAX)
+        return read_message(handle, msg, NULL);
+    if (timeout != 0U)
+        get_deadline(&deadline, timeout);
+    return read_message(handle, msg, &deadline);
+}
 
-    return rc;
+EXPORT
+int can_read_until(int handle, can_message_t *msg, const struct timespec *deadline)
+{
+    return read_message(handle, msg, deadline);
 }
 
 EXPORT
@@ -624,8 +647,6 @@ int can_status(int handle, uint8_t *status)
 {
     int rc = CANERR_FATAL;              // return value
 
-    slcan_flags_t flags;                // SLCAN flags
-
     if (!init)                          // must be initialized
         return CANERR_NOTINIT;
     if (!IS_HANDLE_VALID(handle))       // must be a valid handle
@@ -633,15 +654,12 @@ int can_status(int handle, uint8_t *status)
     if (!IS_HANDLE_OPENED(handle))      // must be an open handle
         return CANERR_HANDLE;
 
-    if (!can[handle].status.can_stopped) { // if running get bus status
+    // note: when the status poller is running the status register
+    //       is kept up to date in the background (no round trip)
+    if (!can[handle].status.can_stopped && !can[handle].poller.running) {
         // get status-register from device (CAN API V1 compatible)
-        if ((rc = slcan_status_flags(can[handle].port, &flags)) < 0)
-            return slcan_error(rc);
-        // TODO: SJA1000 datasheet, rtfm!
-        can[handle].status.message_lost = (flags.DOI | flags.RxFIFO | flags.TxFIFO) ? 1 : 0;
-        can[handle].status.bus_error = flags.BEI ? 1 : 0;
-        can[handle].status.warning_level = (flags.EI | flags.EPI);
-        can[handle].status.bus_off = flags.ALI;
+        if ((rc = update_status(handle, NULL)) != CANERR_NOERROR)
+            return rc;
     }
     if (status)                         // status-register
         *status = can[handle].status.byte;
@@ -774,13 +792,123 @@ char *can_firmware(int handle)
 
     snprintf(firmware, CANPROP_MAX_BUFFER_SIZE, "Firmware %u.%u (%s protocol)",
         (uint8_t)(sw_version >> 4), (uint8_t)(sw_version & 0xFU),
-        can[handle].attr.options == CANSIO_SLCAN ? "SLCAN" : "?");
+        (can[handle].attr.options & CANSIO_PROTOCOL) == CANSIO_SLCAN ? "SLCAN" : "?");
     firmware[CANPROP_MAX_BUFFER_SIZE] = '\0';
     return (char*)firmware;
 }
 
 /*  -----------  local functions  ----------------------------------------
  */
+static int write_message(int handle, const can_message_t *msg, const struct timespec *deadline)
+{
+    slcan_message_t slcan;              // SLCAN message
+    int rc = CANERR_FATAL;              // return value
+
+    if (!init)                          // must be initialized
+        return CANERR_NOTINIT;
+    if (!IS_HANDLE_VALID(handle))       // must be a valid handle
+        return CANERR_HANDLE;
+    if (!IS_HANDLE_OPENED(handle))      // must be an open handle
+        return CANERR_HANDLE;
+    if (msg == NULL)                    // check for null-pointer
+        return CANERR_NULLPTR;
+    if (can[handle].status.can_stopped) // must be running
+        return CANERR_OFFLINE;
+
+    if (msg->id > (uint32_t)(msg->xtd ? CAN_MAX_XTD_ID : CAN_MAX_STD_ID))
+        return CANERR_ILLPARA;          // invalid identifier
+    if (msg->dlc > CAN_MAX_DLC)
+        return CANERR_ILLPARA;          // invalid data length code
+    if (msg->xtd && can[handle].mode.nxtd)
+        return CANERR_ILLPARA;          // suppress extended frames
+    if (msg->rtr && can[handle].mode.nrtr)
+        return CANERR_ILLPARA;          // suppress remote frames
+    if (msg->sts)
+        return CANERR_ILLPARA;          // error frames cannot be sent
+
+    // map message layout
+    memset(&slcan, 0x00, sizeof(slcan_message_t));
+    slcan.can_id = msg->id & (msg->xtd ? CAN_XTD_MASK : CAN_STD_MASK);
+    slcan.can_id |= (msg->xtd ? CAN_XTD_FRAME : 0x00000000U);
+    slcan.can_id |= (msg->rtr ? CAN_RTR_FRAME : 0x00000000U);
+    slcan.can_dlc = msg->dlc;
+    memcpy(slcan.data, msg->data, slcan.can_dlc);
+    // transmit the CAN message
+    rc = slcan_write_message_until(can[handle].port, &slcan, deadline);
+    rc = slcan_error(rc);
+    // update status and tx counter
+    merge_status(handle, CANSTAT_TX_BUSY, (rc != CANERR_NOERROR) ? CANSTAT_TX_BUSY : 0x00u);
+    can[handle].counters.tx += (rc == CANERR_NOERROR) ? 1U : 0U;
+
+    return rc;
+}
+
+static int read_message(int handle, can_message_t *msg, const struct timespec *deadline)
+{
+    slcan_message_t slcan;              // SLCAN message
+    int rc = CANERR_FATAL;              // return value
+
+    if (!init)                          // must be initialized
+        return CANERR_NOTINIT;
+    if (!IS_HANDLE_VALID(handle))       // must be a valid handle
+        return CANERR_HANDLE;
+    if (!IS_HANDLE_OPENED(handle))      // must be an open handle
+        return CANERR_HANDLE;
+    if (msg == NULL)                    // check for null-pointer
+        return CANERR_NULLPTR;
+    if (can[handle].status.can_stopped) // must be running
+        return CANERR_OFFLINE;
+
+    memset(msg, 0x00, sizeof(can_message_t));
+    msg->id = 0xFFFFFFFFu;
+    msg->sts = 1;
+
+    // read one CAN message from message queue, if any
+    rc = slcan_read_message_until(can[handle].port, &slcan, &msg->timestamp, deadline);
+    if (rc == CANERR_NOERROR) {
+        // map message layout
+        msg->xtd = (slcan.can_id & CAN_XTD_FRAME) ? 1 : 0;
+        msg->sts = (slcan.can_id & CAN_ERR_FRAME) ? 1 : 0;
+        msg->rtr = (slcan.can_id & CAN_RTR_FRAME) ? 1 : 0;
+        msg->id = slcan.can_id & (msg->xtd ? CAN_XTD_MASK : CAN_STD_MASK);
+        msg->dlc = (slcan.can_dlc < CAN_DLC_MAX) ? slcan.can_dlc : CAN_LEN_MAX;
+        memcpy(msg->data, slcan.data, msg->dlc);
+        // update receive counter
+        can[handle].counters.rx += !msg->sts ? 1U : 0U;
+        can[handle].counters.err += msg->sts ? 1U : 0U;
+    }
+    else if (rc != CANERR_RX_EMPTY) {
+        rc = slcan_error(rc);
+    }
+    else {
+        rc = CANERR_RX_EMPTY;
+    }
+    // update status register
+    // note: the queue overrun bit is only set here (it is sticky)
+    merge_status(handle, (errno == ENOSPC) ? (CANSTAT_RX_EMPTY | CANSTAT_QUE_OVR) : CANSTAT_RX_EMPTY,
+                 ((rc != CANERR_NOERROR) ? CANSTAT_RX_EMPTY : 0x00u) | ((errno == ENOSPC) ? CANSTAT_QUE_OVR : 0x00u));
+
+    return rc;
+}
+
+static void get_deadline(struct timespec *deadline, uint64_t timeout)
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+    (void)clock_gettime(CLOCK_MONOTONIC, deadline);
+#else
+    LARGE_INTEGER counter, frequency;
+
+    (void)QueryPerformanceFrequency(&frequency);
+    (void)QueryPerformanceCounter(&counter);
+    deadline->tv_sec = (time_t)(counter.QuadPart / frequency.QuadPart);
+    deadline->tv_nsec = (long)(((counter.QuadPart % frequency.QuadPart) * 1000000000LL) / frequency.QuadPart);
+#endif
+    // note: the time-out is given in [ns]
+    timeout += (uint64_t)deadline->tv_nsec;
+    deadline->tv_sec += (time_t)(timeout / 1000000000U);
+    deadline->tv_nsec = (long)(timeout % 1000000000U);
+}
+
 static void var_init(void)
 {
     int i;
@@ -806,6 +934,12 @@ static void var_init(void)
         can[i].counters.tx = 0ull;
         can[i].counters.rx = 0ull;
         can[i].counters.err = 0ull;
+        can[i].wait.policy = SLCAN_WAIT_BLOCK;
+        can[i].wait.spin = SPIN_TIME_DEFAULT;
+        can[i].overflow = SLCAN_OVFL_DROP_NEWEST;
+        can[i].spill.name[0] = '\0';
+        can[i].spill.size = 0U;
+        can[i].spill.mark = 0U;
     }
 }
 
@@ -862,6 +996,13 @@ static slcan_attr_t* slcan_attr(const can_sio_attr_t *attr)
     case CANSIO_EVENPARITY: slcan.parity = PARITYEVEN; break;
     default: slcan.parity = PARITYNONE; break;
     }
+    slcan.options = SIO_OPTION_NONE;    // port options
+    if (attr->options & CANSIO_LOWLATENCY)
+        slcan.options |= SIO_OPTION_LOWLATENCY;
+    if (attr->options & CANSIO_RTSCTS)
+        slcan.options |= SIO_OPTION_RTSCTS;
+    if (attr->options & CANSIO_LAZYDECODE)
+        slcan.options |= SLCAN_OPTION_LAZYDECODE;
     return &slcan;
 }
 
@@ -951,6 +1092,158 @@ static int reset_filter(int handle)
     return CANERR_NOERROR;
 }
 
+static int update_status(int handle, slcan_flags_t *flags)
+{
+    slcan_flags_t temp;                 // SLCAN flags
+    can_status_t status;                // status bits from the device
+    can_status_t mask;                  // status bits owned by this function
+    int rc;                             // return value
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    // get status flags from device (command 'F')
+    if ((rc = slcan_status_flags(can[handle].port, &temp)) < 0)
+        return slcan_error(rc);
+    // TODO: SJA1000 datasheet, rtfm!
+    status.byte = 0x00u;
+    status.message_lost = (temp.DOI | temp.RxFIFO | temp.TxFIFO) ? 1 : 0;
+    status.bus_error = temp.BEI ? 1 : 0;
+    status.warning_level = (temp.EI | temp.EPI);
+    status.bus_off = temp.ALI;
+    mask.byte = 0x00u;
+    mask.message_lost = 1;
+    mask.bus_error = 1;
+    mask.warning_level = 1;
+    mask.bus_off = 1;
+    merge_status(handle, mask.byte, status.byte);
+    if (flags)
+        flags->byte = temp.byte;
+    return CANERR_NOERROR;
+}
+
+static void merge_status(int handle, uint8_t mask, uint8_t bits)
+{
+    uint8_t value;                      // status register
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+#if (STATUS_POLLER_SUPPORTED != 0)
+    // note: the status poller runs concurrently with the API functions,
+    //       so every writer replaces only its own bits (atomically)
+    value = __atomic_load_n(&can[handle].status.byte, __ATOMIC_ACQUIRE);
+    while (!__atomic_compare_exchange_n(&can[handle].status.byte, &value,
+                                        (uint8_t)((value & ~mask) | (bits & mask)),
+                                        false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+#else
+    value = can[handle].status.byte;
+    can[handle].status.byte = (uint8_t)((value & ~mask) | (bits & mask));
+#endif
+}
+
+static int start_poller(int handle, uint32_t interval)
+{
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+#if (STATUS_POLLER_SUPPORTED != 0)
+    // stop a running poller (e.g. to change the interval)
+    (void)stop_poller(handle);
+    if (interval == 0U)                 // 0 = polling off
+        return CANERR_NOERROR;
+    if ((interval < POLLING_INTERVAL_MIN) || (POLLING_INTERVAL_MAX < interval))
+        return CANERR_ILLPARA;
+    // create a wait condition (to stop the poller w/o delay)
+    if (pthread_mutex_init(&can[handle].poller.mutex, NULL) != 0)
+        return CANERR_FATAL;
+    if (pthread_cond_init(&can[handle].poller.cond, NULL) != 0) {
+        (void)pthread_mutex_destroy(&can[handle].poller.mutex);
+        return CANERR_FATAL;
+    }
+    can[handle].poller.interval = interval;
+    can[handle].poller.running = true;
+    // create the poller thread
+    if (pthread_create(&can[handle].poller.thread, NULL, status_poller, (void*)(intptr_t)handle) != 0) {
+        can[handle].poller.running = false;
+        can[handle].poller.interval = 0U;
+        (void)pthread_cond_destroy(&can[handle].poller.cond);
+        (void)pthread_mutex_destroy(&can[handle].poller.mutex);
+        return CANERR_FATAL;
+    }
+    return CANERR_NOERROR;
+#else
+    // note: background polling requires POSIX threads
+    return (interval == 0U) ? CANERR_NOERROR : CANERR_NOTSUPP;
+#endif
+}
+
+static int stop_poller(int handle)
+{
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+#if (STATUS_POLLER_SUPPORTED != 0)
+    if (!can[handle].poller.running)    // no poller running
+        return CANERR_NOERROR;
+    // signal the poller thread and wait for its termination
+    assert(0 == pthread_mutex_lock(&can[handle].poller.mutex));
+    can[handle].poller.running = false;
+    assert(0 == pthread_cond_signal(&can[handle].poller.cond));
+    assert(0 == pthread_mutex_unlock(&can[handle].poller.mutex));
+    (void)pthread_join(can[handle].poller.thread, NULL);
+    (void)pthread_cond_destroy(&can[handle].poller.cond);
+    (void)pthread_mutex_destroy(&can[handle].poller.mutex);
+#endif
+    can[handle].poller.interval = 0U;
+    return CANERR_NOERROR;
+}
+
+#if (STATUS_POLLER_SUPPORTED != 0)
+static void *status_poller(void *arg)
+{
+    int handle = (int)(intptr_t)arg;    // handle of the CAN interface
+    slcan_message_t message;            // status message (in-band)
+    slcan_flags_t flags;                // SLCAN flags
+    slcan_counters_t counters;          // line error counters
+    struct timespec abstime;            // absolute time-out
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    assert(0 == pthread_mutex_lock(&can[handle].poller.mutex));
+    while (can[handle].poller.running) {
+        // wait for the polling interval or the stop signal
+        clock_gettime(CLOCK_REALTIME, &abstime);
+        abstime.tv_sec += (time_t)(can[handle].poller.interval / 1000U);
+        abstime.tv_nsec += (long)(can[handle].poller.interval % 1000U) * 1000000L;
+        if (abstime.tv_nsec >= 1000000000L) {
+            abstime.tv_nsec -= 1000000000L;
+            abstime.tv_sec += 1;
+        }
+        while (can[handle].poller.running &&
+              (pthread_cond_timedwait(&can[handle].poller.cond, &can[handle].poller.mutex, &abstime) != ETIMEDOUT));
+        if (!can[handle].poller.running)
+            break;
+        assert(0 == pthread_mutex_unlock(&can[handle].poller.mutex));
+        // note: command 'F' is only active when the CAN channel is open
+        if (!can[handle].status.can_stopped &&
+            (update_status(handle, &flags) == CANERR_NOERROR)) {
+            // on a state change push a status message into the message queue
+            if ((flags.byte ^ can[handle].poller.flags.byte) & POLLING_FLAGS_MASK) {
+                memset(&message, 0x00, sizeof(slcan_message_t));
+                message.can_id = CAN_ERR_FRAME;
+                message.can_dlc = 2U;
+                message.data[0] = __atomic_load_n(&can[handle].status.byte, __ATOMIC_ACQUIRE);
+                message.data[1] = flags.byte;
+                (void)slcan_queue_message(can[handle].port, &message);
+            }
+            can[handle].poller.flags.byte = flags.byte;
+        }
+        // sample the line error counters (the last sample is kept by the serial layer)
+        (void)slcan_get_counters(can[handle].port, &counters);
+        assert(0 == pthread_mutex_lock(&can[handle].poller.mutex));
+    }
+    assert(0 == pthread_mutex_unlock(&can[handle].poller.mutex));
+    return NULL;
+}
+#endif
+
 /*  - - - - - -  CAN API V3 properties  - - - - - - - - - - - - - - - - -
  */
 static int lib_parameter(uint16_t param, void *value, size_t nbyte)
@@ -1141,6 +1434,14 @@ static int drv_parameter(int handle, uint16_t param, void *value, size_t nbyte)
     uint8_t load = 0u;                  // bus load
     uint8_t version_no = 0x00u;         // version number (8-bit)
     uint32_t serial_no = 0x00000000u;   // serial number (32-bit)
+    uint32_t interval = 0u;             // polling interval (in [ms])
+    slcan_latency_t latency;            // latency settings
+    slcan_counters_t counters;          // line error counters
+    uint32_t queue_size = 0u;           // receive queue capacity
+    uint32_t queue_high = 0u;           // receive queue high-water mark
+    uint64_t queue_ovfl = 0u;           // receive queue overflow counter
+    slcan_queue_counters_t queue_counters;  // receive queue counters
+    can_spill_param_t *spill;           // spill file parameters
 
     assert(IS_HANDLE_VALID(handle));    // just to make sure
 
@@ -1274,10 +1575,37 @@ static int drv_parameter(int handle, uint16_t param, void *value, size_t nbyte)
         }
         break;
     case CANPROP_GET_RCV_QUEUE_SIZE:    // maximum number of message the receive queue can hold (uint32_t)
+        if (nbyte >= sizeof(uint32_t)) {
+            if ((rc = slcan_queue_usage(can[handle].port, &queue_size, NULL, NULL)) >= 0) {
+                *(uint32_t*)value = queue_size;
+                rc = CANERR_NOERROR;
+            }
+            else {
+                rc = slcan_error(rc);
+            }
+        }
+        break;
     case CANPROP_GET_RCV_QUEUE_HIGH:    // maximum number of message the receive queue has hold (uint32_t)
+        if (nbyte >= sizeof(uint32_t)) {
+            if ((rc = slcan_queue_usage(can[handle].port, NULL, &queue_high, NULL)) >= 0) {
+                *(uint32_t*)value = queue_high;
+                rc = CANERR_NOERROR;
+            }
+            else {
+                rc = slcan_error(rc);
+            }
+        }
+        break;
     case CANPROP_GET_RCV_QUEUE_OVFL:    // overflow counter of the receive queue (uint64_t)
-        // note: cannot be determined
-        rc = CANERR_NOTSUPP;
+        if (nbyte >= sizeof(uint64_t)) {
+            if ((rc = slcan_queue_usage(can[handle].port, NULL, NULL, &queue_ovfl)) >= 0) {
+                *(uint64_t*)value = queue_ovfl;
+                rc = CANERR_NOERROR;
+            }
+            else {
+                rc = slcan_error(rc);
+            }
+        }
         break;
     case CANPROP_GET_FILTER_11BIT:      // acceptance filter code and mask for 11-bit identifier (uint64_t)
         if (nbyte >= sizeof(uint64_t)) {
@@ -1369,6 +1697,195 @@ static int drv_parameter(int handle, uint16_t param, void *value, size_t nbyte)
             }
         }
         break;
+    case (CANPROP_GET_VENDOR_PROP + SLCAN_LOW_LATENCY):         // low-latency flag of the serial driver (uint8_t)
+        if (nbyte >= sizeof(uint8_t)) {
+            if ((rc = slcan_get_latency(can[handle].port, &latency)) == 0) {
+                if (latency.low_latency >= 0) {
+                    *(uint8_t*)value = (uint8_t)latency.low_latency;
+                    rc = CANERR_NOERROR;
+                }
+                else
+                    rc = CANERR_NOTSUPP;
+            }
+            else {
+                rc = slcan_error(rc);
+            }
+        }
+        break;
+    case (CANPROP_GET_VENDOR_PROP + SLCAN_LATENCY_TIMER):       // latency timer of an USB-serial converter in [ms] (uint8_t)
+        if (nbyte >= sizeof(uint8_t)) {
+            if ((rc = slcan_get_latency(can[handle].port, &latency)) == 0) {
+                if (latency.latency_timer >= 0) {
+                    *(uint8_t*)value = (uint8_t)latency.latency_timer;
+                    rc = CANERR_NOERROR;
+                }
+                else
+                    rc = CANERR_NOTSUPP;
+            }
+            else {
+                rc = slcan_error(rc);
+            }
+        }
+        break;
+    case (CANPROP_GET_VENDOR_PROP + SLCAN_LINE_COUNTERS):       // line error counters of the serial port (can_sio_counters_t)
+        if (nbyte >= sizeof(can_sio_counters_t)) {
+            if ((rc = slcan_get_counters(can[handle].port, &counters)) == 0) {
+                ((can_sio_counters_t*)value)->overrun = counters.overrun;
+                ((can_sio_counters_t*)value)->buf_overrun = counters.buf_overrun;
+                ((can_sio_counters_t*)value)->frame = counters.frame;
+                ((can_sio_counters_t*)value)->parity = counters.parity;
+                ((can_sio_counters_t*)value)->brk = counters.brk;
+                rc = CANERR_NOERROR;
+            }
+            else if (errno == ENOTSUP) {
+                rc = CANERR_NOTSUPP;
+            }
+            else {
+                rc = slcan_error(rc);
+            }
+        }
+        break;
+    case (CANPROP_GET_VENDOR_PROP + SLCAN_OUTPUT_QUEUE):        // bytes in the output queue of the serial port (uint32_t)
+        if (nbyte >= sizeof(uint32_t)) {
+            if ((rc = slcan_output_queue(can[handle].port)) >= 0) {
+                *(uint32_t*)value = (uint32_t)rc;
+                rc = CANERR_NOERROR;
+            }
+            else {
+                rc = slcan_error(rc);
+            }
+        }
+        break;
+    case (CANPROP_GET_VENDOR_PROP + SLCAN_STATUS_POLLING):      // status polling interval in [ms] (uint32_t)
+        if (nbyte >= sizeof(uint32_t)) {
+            *(uint32_t*)value = (uint32_t)can[handle].poller.interval;
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case (CANPROP_SET_VENDOR_PROP + SLCAN_STATUS_POLLING):      // set status polling interval in [ms] (uint32_t)
+        if (nbyte >= sizeof(uint32_t)) {
+            interval = *(uint32_t*)value;
+            rc = start_poller(handle, interval);
+        }
+        break;
+    case (CANPROP_GET_VENDOR_PROP + SLCAN_WAIT_POLICY):         // wait policy of the reader (uint8_t)
+        if (nbyte >= sizeof(uint8_t)) {
+            *(uint8_t*)value = (uint8_t)can[handle].wait.policy;
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case (CANPROP_SET_VENDOR_PROP + SLCAN_WAIT_POLICY):         // set wait policy of the reader (uint8_t)
+        if (nbyte >= sizeof(uint8_t)) {
+            if ((rc = slcan_wait_policy(can[handle].port, (int)*(uint8_t*)value, can[handle].wait.spin)) == 0) {
+                can[handle].wait.policy = *(uint8_t*)value;
+                rc = CANERR_NOERROR;
+            }
+            else if (errno == EINVAL) {
+                rc = CANERR_ILLPARA;
+            }
+            else if (errno == ENOTSUP) {
+                rc = CANERR_NOTSUPP;
+            }
+            else {
+                rc = slcan_error(rc);
+            }
+        }
+        break;
+    case (CANPROP_GET_VENDOR_PROP + SLCAN_SPIN_TIME):           // max. spin time of the reader in [us] (uint32_t)
+        if (nbyte >= sizeof(uint32_t)) {
+            *(uint32_t*)value = can[handle].wait.spin;
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case (CANPROP_SET_VENDOR_PROP + SLCAN_SPIN_TIME):           // set max. spin time of the reader in [us] (uint32_t)
+        if (nbyte >= sizeof(uint32_t)) {
+            if ((rc = slcan_wait_policy(can[handle].port, (int)can[handle].wait.policy, *(uint32_t*)value)) == 0) {
+                can[handle].wait.spin = *(uint32_t*)value;
+                rc = CANERR_NOERROR;
+            }
+            else if (errno == ENOTSUP) {
+                rc = CANERR_NOTSUPP;
+            }
+            else {
+                rc = slcan_error(rc);
+            }
+        }
+        break;
+    case (CANPROP_GET_VENDOR_PROP + SLCAN_OVERFLOW_POLICY):     // overflow policy of the receive queue (uint8_t)
+        if (nbyte >= sizeof(uint8_t)) {
+            *(uint8_t*)value = (uint8_t)can[handle].overflow;
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case (CANPROP_SET_VENDOR_PROP + SLCAN_OVERFLOW_POLICY):     // set overflow policy of the receive queue (uint8_t)
+        if (nbyte >= sizeof(uint8_t)) {
+            if ((rc = slcan_overflow_policy(can[handle].port, (int)*(uint8_t*)value)) == 0) {
+                can[handle].overflow = *(uint8_t*)value;
+                rc = CANERR_NOERROR;
+            }
+            else if (errno == EINVAL) {
+                rc = CANERR_ILLPARA;
+            }
+            else if (errno == ENOTSUP) {
+                rc = CANERR_NOTSUPP;
+            }
+            else {
+                rc = slcan_error(rc);
+            }
+        }
+        break;
+    case (CANPROP_GET_VENDOR_PROP + SLCAN_QUEUE_COUNTERS):      // counters of the receive queue (can_queue_counters_t)
+        if (nbyte >= sizeof(can_queue_counters_t)) {
+            if ((rc = slcan_queue_counters(can[handle].port, &queue_counters)) == 0) {
+                ((can_queue_counters_t*)value)->enqueued = queue_counters.enqueued;
+                ((can_queue_counters_t*)value)->dequeued = queue_counters.dequeued;
+                ((can_queue_counters_t*)value)->dropped = queue_counters.dropped;
+                ((can_queue_counters_t*)value)->overwritten = queue_counters.overwritten;
+                ((can_queue_counters_t*)value)->coalesced = queue_counters.coalesced;
+                ((can_queue_counters_t*)value)->spilled = queue_counters.spilled;
+                rc = CANERR_NOERROR;
+            }
+            else {
+                rc = slcan_error(rc);
+            }
+        }
+        break;
+    case (CANPROP_GET_VENDOR_PROP + SLCAN_SPILL_FILE):          // spill file of the receive queue (can_spill_param_t)
+        if (nbyte >= sizeof(can_spill_param_t)) {
+            ((can_spill_param_t*)value)->name = can[handle].spill.size ? (char*)can[handle].spill.name : NULL;
+            ((can_spill_param_t*)value)->size = can[handle].spill.size;
+            ((can_spill_param_t*)value)->mark = can[handle].spill.mark;
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case (CANPROP_SET_VENDOR_PROP + SLCAN_SPILL_FILE):          // set spill file of the receive queue (can_spill_param_t)
+        if (nbyte >= sizeof(can_spill_param_t)) {
+            spill = (can_spill_param_t*)value;
+            if (spill->name && (strlen(spill->name) >= CANPROP_MAX_BUFFER_SIZE)) {
+                rc = CANERR_ILLPARA;
+            }
+            else if ((rc = slcan_spill_file(can[handle].port, spill->name, spill->size, spill->mark)) == 0) {
+                if (spill->name && spill->size) {
+                    strncpy(can[handle].spill.name, spill->name, CANPROP_MAX_BUFFER_SIZE);
+                    can[handle].spill.name[CANPROP_MAX_BUFFER_SIZE - 1] = '\0';
+                    can[handle].spill.size = spill->size;
+                    can[handle].spill.mark = spill->mark;
+                }
+                else {
+                    can[handle].spill.name[0] = '\0';
+                    can[handle].spill.size = 0U;
+                    can[handle].spill.mark = 0U;
+                }
+                rc = CANERR_NOERROR;
+            }
+            else if (errno == ENOTSUP) {
+                rc = CANERR_NOTSUPP;
+            }
+            else {
+                rc = slcan_error(rc);
+            }
+        }
+        break;
     default:
         rc = lib_parameter(param, value, nbyte);   // library properties (see lib_parameter)
         break;
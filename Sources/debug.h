@@ -51,12 +51,14 @@
 #if (OPTION_SLCAN_DEBUG_LEVEL > 0) || (OPTION_SERIAL_DEBUG_LEVEL > 0)
 #define LOGGER_INIT(fn)  log_init(fn)
 #define LOGGER_EXIT()  log_exit()
+#define LOGGER_LEVEL(lvl)  log_set_level(lvl)
 #if defined(_WIN32) || defined(_WIN64)
 #define LOGGER_KILL()  log_kill()
 #endif
 #else
 #define LOGGER_INIT(fn)  while (0)
 #define LOGGER_EXIT()  while (0)
+#define LOGGER_LEVEL(lvl)  while (0)
 #if defined(_WIN32) || defined(_WIN64)
 #define LOGGER_KILL()  while (0)
 #endif
@@ -0,0 +1,76 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  Module tests for the CAN Tester (SerialCAN)
+//
+//  Copyright (c) 2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+#ifndef DRIVER_H_INCLUDED
+#define DRIVER_H_INCLUDED
+
+#include "CANAPI.h"
+
+#include <stdint.h>
+#include <vector>
+
+/// \name   CAN Driver Stub
+/// \brief  Replaces the CAN driver of can_test (see 'Utilities/can_test/Driver.h'):
+///         the messages are read from a script and the clock is simulated.
+///         When the script is exhausted the clock jumps ahead by 2 seconds
+///         and the test is stopped.
+/// \{
+class CCanDriver {
+public:
+    struct SRead {
+        CANAPI_Message_t m_Message;  // message to be read
+        uint64_t m_u64Overflows;  // receive queue overflow counter from now on
+        uint64_t m_u64Delay;  // additional time before the message (in [ns])
+    };
+    std::vector<SRead> m_Script;
+    size_t m_nNext;
+    uint64_t m_u64Overflows;
+    volatile int* m_pRunning;
+    static uint64_t s_u64Clock;  // simulated time (in [ns])
+
+    CCanDriver() : m_nNext(0U), m_u64Overflows(0U), m_pRunning(NULL) {}
+
+    CANAPI_Return_t ReadMessage(CANAPI_Message_t& message, uint16_t timeout = 0U) {
+        (void)timeout;
+        if (m_nNext >= m_Script.size()) {
+            s_u64Clock += 2000000000U;
+            if (m_pRunning)
+                *m_pRunning = 0;
+            return CCanApi::ReceiverEmpty;
+        }
+        s_u64Clock += 1000000U + m_Script[m_nNext].m_u64Delay;
+        message = m_Script[m_nNext].m_Message;
+        m_u64Overflows = m_Script[m_nNext].m_u64Overflows;
+        m_nNext++;
+        return CCanApi::NoError;
+    }
+    CANAPI_Return_t GetProperty(uint16_t param, void* value, uint32_t nbyte) {
+        if ((param != CANPROP_GET_RCV_QUEUE_OVFL) || !value || (nbyte != sizeof(uint64_t)))
+            return CCanApi::NotSupported;
+        *(uint64_t*)value = m_u64Overflows;
+        return CCanApi::NoError;
+    }
+    CANAPI_Return_t GetStatus(CANAPI_Status_t& status) {
+        status.byte = 0x00U;
+        return CCanApi::NoError;
+    }
+};
+/// \}
+
+#endif // DRIVER_H_INCLUDED
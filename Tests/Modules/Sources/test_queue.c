@@ -0,0 +1,561 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-3.0-or-later
+//
+//  Module tests for the message queue (SerialCAN)
+//
+//  Copyright (c) 2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of SerialCAN.
+//
+//  SerialCAN is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v3.0 (or any later version). You can
+//  choose between one of them if you use SerialCAN in whole or in part.
+//
+//  (see LICENSE.BSD-2-Clause and LICENSE.GPL-3.0-or-later)
+//
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+#include "queue.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+
+#define CHECK(cond)  do { if (!(cond)) { fprintf(stderr, "%s:%i: check failed: %s\n", __FILE__, __LINE__, #cond); failed++; } } while (0)
+
+typedef struct element_t_ {             // queue element:
+    uint32_t key;                       //   key (offset 0)
+    uint32_t value;                     //   payload
+}   element_t;
+
+typedef struct producer_t_ {           // producer thread:
+    queue_t queue;                      //   the queue
+    useconds_t delay;                   //   delay before enqueuing [us]
+    uint32_t value;                     //   the element's value
+    bool signal;                        //   signal instead of enqueuing
+}   producer_t;
+
+static int failed = 0;
+
+static int put(queue_t queue, uint32_t key, uint32_t value);
+static bool get(queue_t queue, element_t *element);
+static bool balanced(queue_t queue);
+static void spill_path(char *path, size_t size);
+static void *producer(void *arg);
+static int take(queue_t queue, element_t *element, uint16_t timeout, producer_t *from, uint64_t *elapsed);
+static uint64_t millis(void);
+static void deadline_in(struct timespec *deadline, int64_t msec);
+
+static void test_coalesce_in_place(void);
+static void test_coalesce_backward_shift(void);
+static void test_drop_oldest(void);
+static void test_drop_newest(void);
+static void test_spill_order(void);
+static void test_spill_full(void);
+static void test_spill_remove(void);
+static void test_wait_block(void);
+static void test_wait_spin(void);
+static void test_wait_poll(void);
+static void test_dequeue_until(void);
+
+
+int main(void) {
+    test_coalesce_in_place();
+    test_coalesce_backward_shift();
+    test_drop_oldest();
+    test_drop_newest();
+    test_spill_order();
+    test_spill_full();
+    test_spill_remove();
+    test_wait_block();
+    test_wait_spin();
+    test_wait_poll();
+    test_dequeue_until();
+
+    if (failed)
+        fprintf(stderr, "test_queue: %i check(s) failed\n", failed);
+    else
+        fprintf(stdout, "test_queue: all checks passed\n");
+    return failed ? 1 : 0;
+}
+
+//  A queued element is replaced in place by a newer one with the same key,
+//  i.e. it keeps its position in the queue.
+//
+static void test_coalesce_in_place(void) {
+    queue_counters_t counters;
+    element_t element;
+    queue_t queue;
+    size_t used;
+
+    if ((queue = queue_create(8U, sizeof(element_t))) == NULL) {
+        CHECK(queue != NULL);
+        return;
+    }
+    CHECK(queue_overflow_policy(queue, QUEUE_OVFL_COALESCE, 0U) == 0);
+    CHECK(put(queue, 1U, 100U) == (int)sizeof(element_t));
+    CHECK(put(queue, 2U, 200U) == (int)sizeof(element_t));
+    CHECK(put(queue, 1U, 101U) == (int)sizeof(element_t));
+    CHECK(queue_usage(queue, &used, NULL) == 2);
+    CHECK(get(queue, &element) && (element.key == 1U) && (element.value == 101U));
+    CHECK(get(queue, &element) && (element.key == 2U) && (element.value == 200U));
+    CHECK(!get(queue, &element));
+    // the key of a dequeued element is not found anymore
+    CHECK(put(queue, 1U, 102U) == (int)sizeof(element_t));
+    CHECK(get(queue, &element) && (element.key == 1U) && (element.value == 102U));
+    CHECK(queue_counters(queue, &counters) == 0);
+    CHECK(counters.enqueued == 4U);
+    CHECK(counters.coalesced == 1U);
+    CHECK(counters.dequeued == 3U);
+    CHECK(counters.dropped == 0U);
+    CHECK(balanced(queue));
+    (void)queue_destroy(queue);
+}
+
+//  Removing keys from the index (by backward shift) must not lose the
+//  keys behind them: a sliding window of keys, each of them updated once
+//  while it is queued, and dequeued with its latest value.
+//
+static void test_coalesce_backward_shift(void) {
+    queue_counters_t counters;
+    element_t element;
+    queue_t queue;
+    const uint32_t window = 12U, lag = 4U, rounds = 1000U;
+    uint32_t i, next = 0U;
+    bool ok = true;
+
+    if ((queue = queue_create(16U, sizeof(element_t))) == NULL) {
+        CHECK(queue != NULL);
+        return;
+    }
+    CHECK(queue_overflow_policy(queue, QUEUE_OVFL_COALESCE, 0U) == 0);
+    for (i = 0U; i < rounds; i++) {
+        // note: keys spread over the index (Knuth's multiplicative hash)
+        ok &= (put(queue, i * 2654435761U, i) == (int)sizeof(element_t));
+        if (i >= lag)
+            ok &= (put(queue, (i - lag) * 2654435761U, i) == (int)sizeof(element_t));
+        if (i >= window) {
+            ok &= get(queue, &element);
+            ok &= (element.key == (next * 2654435761U)) && (element.value == (next + lag));
+            next++;
+        }
+    }
+    CHECK(ok);
+    CHECK(queue_usage(queue, NULL, NULL) == (int)window);
+    CHECK(queue_counters(queue, &counters) == 0);
+    CHECK(counters.coalesced == (uint64_t)(rounds - lag));
+    CHECK(counters.dropped == 0U);
+    CHECK(balanced(queue));
+    (void)queue_destroy(queue);
+}
+
+//  A full queue overwrites its oldest element and flags an overflow.
+//
+static void test_drop_oldest(void) {
+    queue_counters_t counters;
+    element_t element;
+    queue_t queue;
+    uint64_t overflows = 0U;
+    uint32_t i;
+
+    if ((queue = queue_create(4U, sizeof(element_t))) == NULL) {
+        CHECK(queue != NULL);
+        return;
+    }
+    CHECK(queue_overflow_policy(queue, QUEUE_OVFL_DROP_OLDEST, 0U) == 0);
+    for (i = 0U; i < 6U; i++)
+        CHECK(put(queue, i, i) == (int)sizeof(element_t));
+    CHECK(queue_overflow(queue, &overflows));
+    CHECK(overflows == 2U);
+    CHECK(queue_counters(queue, &counters) == 0);
+    CHECK(counters.enqueued == 6U);
+    CHECK(counters.overwritten == 2U);
+    CHECK(counters.dropped == 0U);
+    CHECK(balanced(queue));
+    for (i = 2U; i < 6U; i++)
+        CHECK(get(queue, &element) && (element.value == i));
+    CHECK(!get(queue, &element));
+    CHECK(balanced(queue));
+    // the counters are reset by 'queue_clear'
+    CHECK(queue_clear(queue) == 0);
+    CHECK(!queue_overflow(queue, NULL));
+    CHECK(queue_counters(queue, &counters) == 0);
+    CHECK((counters.enqueued == 0U) && (counters.dequeued == 0U) && (counters.overwritten == 0U));
+    (void)queue_destroy(queue);
+}
+
+//  A full queue drops the new element (default).
+//
+static void test_drop_newest(void) {
+    queue_counters_t counters;
+    element_t element;
+    queue_t queue;
+    uint32_t i;
+
+    if ((queue = queue_create(4U, sizeof(element_t))) == NULL) {
+        CHECK(queue != NULL);
+        return;
+    }
+    for (i = 0U; i < 4U; i++)
+        CHECK(put(queue, i, i) == (int)sizeof(element_t));
+    CHECK(put(queue, 4U, 4U) < 0);
+    CHECK(errno == ENOSPC);
+    CHECK(queue_overflow(queue, NULL));
+    CHECK(queue_counters(queue, &counters) == 0);
+    CHECK(counters.enqueued == 4U);
+    CHECK(counters.dropped == 1U);
+    CHECK(balanced(queue));
+    for (i = 0U; i < 4U; i++)
+        CHECK(get(queue, &element) && (element.value == i));
+    CHECK(balanced(queue));
+    (void)queue_destroy(queue);
+}
+
+//  Beyond the high mark the elements go to the spill file, and they stay
+//  there until it is drained (even when there is room in memory again),
+//  so they are dequeued in the order they were enqueued.
+//
+static void test_spill_order(void) {
+    queue_counters_t counters;
+    element_t element;
+    queue_t queue;
+    char path[256];
+    size_t high = 0U;
+    uint32_t i, next = 0U;
+
+    if ((queue = queue_create(4U, sizeof(element_t))) == NULL) {
+        CHECK(queue != NULL);
+        return;
+    }
+    spill_path(path, sizeof(path));
+    CHECK(queue_spill(queue, path, 8U, 2U) == 0);
+    CHECK(access(path, F_OK) < 0);              // unlinked at once
+    for (i = 0U; i < 6U; i++)                   // 0, 1 in memory, 2 .. 5 spilled
+        CHECK(put(queue, i, i) == (int)sizeof(element_t));
+    CHECK(queue_usage(queue, NULL, &high) == 6);
+    CHECK(high == 2U);
+    CHECK(get(queue, &element) && (element.value == next++));
+    CHECK(put(queue, 6U, 6U) == (int)sizeof(element_t));
+    while (get(queue, &element))
+        CHECK(element.value == next++);
+    CHECK(next == 7U);
+    // drained: the next elements are queued in memory again
+    CHECK(put(queue, 7U, 7U) == (int)sizeof(element_t));
+    CHECK(queue_counters(queue, &counters) == 0);
+    CHECK(counters.spilled == 5U);
+    CHECK(counters.dropped == 0U);
+    CHECK(balanced(queue));
+    (void)queue_destroy(queue);
+}
+
+//  A full spill file drops the new element.
+//
+static void test_spill_full(void) {
+    queue_counters_t counters;
+    element_t element;
+    queue_t queue;
+    char path[256];
+    uint32_t i;
+
+    if ((queue = queue_create(4U, sizeof(element_t))) == NULL) {
+        CHECK(queue != NULL);
+        return;
+    }
+    spill_path(path, sizeof(path));
+    CHECK(queue_spill(queue, path, 4U, 0U) == 0);  // mark 0: when the queue is full
+    for (i = 0U; i < 8U; i++)
+        CHECK(put(queue, i, i) == (int)sizeof(element_t));
+    CHECK(put(queue, 8U, 8U) < 0);
+    CHECK(errno == ENOSPC);
+    CHECK(queue_overflow(queue, NULL));
+    CHECK(queue_counters(queue, &counters) == 0);
+    CHECK(counters.spilled == 4U);
+    CHECK(counters.dropped == 1U);
+    CHECK(balanced(queue));
+    for (i = 0U; i < 8U; i++)
+        CHECK(get(queue, &element) && (element.value == i));
+    CHECK(!get(queue, &element));
+    (void)queue_destroy(queue);
+}
+
+//  The spill file can only be removed when it is empty, and it requires
+//  the overflow policy QUEUE_OVFL_DROP_NEWEST.
+//
+static void test_spill_remove(void) {
+    element_t element;
+    queue_t queue;
+    char path[256];
+    uint32_t i;
+
+    if ((queue = queue_create(4U, sizeof(element_t))) == NULL) {
+        CHECK(queue != NULL);
+        return;
+    }
+    spill_path(path, sizeof(path));
+    CHECK(queue_spill(queue, path, 4U, 2U) == 0);
+    CHECK(queue_overflow_policy(queue, QUEUE_OVFL_DROP_OLDEST, 0U) < 0);
+    CHECK(errno == ENOTSUP);
+    CHECK(queue_overflow_policy(queue, QUEUE_OVFL_COALESCE, 0U) < 0);
+    CHECK(errno == ENOTSUP);
+    for (i = 0U; i < 3U; i++)
+        CHECK(put(queue, i, i) == (int)sizeof(element_t));
+    CHECK(queue_spill(queue, NULL, 0U, 0U) < 0);
+    CHECK(errno == EBUSY);
+    for (i = 0U; i < 3U; i++)
+        CHECK(get(queue, &element) && (element.value == i));
+    CHECK(queue_spill(queue, NULL, 0U, 0U) == 0);
+    // without a spill file a full queue drops the new element
+    for (i = 0U; i < 4U; i++)
+        CHECK(put(queue, i, i) == (int)sizeof(element_t));
+    CHECK(put(queue, 4U, 4U) < 0);
+    // and the other overflow policies are possible again
+    CHECK(queue_overflow_policy(queue, QUEUE_OVFL_DROP_OLDEST, 0U) == 0);
+    CHECK(queue_spill(queue, path, 4U, 2U) < 0);
+    CHECK(errno == ENOTSUP);
+    CHECK(access(path, F_OK) < 0);
+    (void)queue_destroy(queue);
+}
+
+//  A blocked consumer is woken up by an element, or by the time-out.
+//
+static void test_wait_block(void) {
+    producer_t from;
+    element_t element;
+    queue_t queue;
+    uint64_t elapsed = 0U;
+
+    if ((queue = queue_create(4U, sizeof(element_t))) == NULL) {
+        CHECK(queue != NULL);
+        return;
+    }
+    CHECK(queue_wait_policy(queue, 3, 0U) < 0);
+    CHECK(errno == EINVAL);
+    CHECK(queue_wait_policy(queue, QUEUE_WAIT_BLOCK, 0U) == 0);
+    memset(&from, 0, sizeof(producer_t));
+    from.queue = queue;
+    from.delay = 20000U;
+    from.value = 1U;
+    CHECK(take(queue, &element, 1000U, &from, &elapsed) == (int)sizeof(element_t));
+    CHECK(element.value == 1U);
+    CHECK(elapsed < 1000U);
+    CHECK(take(queue, &element, 20U, NULL, &elapsed) < 0);
+    CHECK(errno == ETIMEDOUT);
+    CHECK(elapsed >= 20U);
+    (void)queue_destroy(queue);
+}
+
+//  A spinning consumer takes an element arriving within the spin time,
+//  otherwise it blocks after the spin time; a signal ends the spinning.
+//
+static void test_wait_spin(void) {
+    producer_t from;
+    element_t element;
+    queue_t queue;
+    uint64_t elapsed = 0U;
+
+    if ((queue = queue_create(4U, sizeof(element_t))) == NULL) {
+        CHECK(queue != NULL);
+        return;
+    }
+    memset(&from, 0, sizeof(producer_t));
+    from.queue = queue;
+    // an element within the spin time (500ms)
+    CHECK(queue_wait_policy(queue, QUEUE_WAIT_SPIN, 500000U) == 0);
+    from.delay = 5000U;
+    from.value = 1U;
+    CHECK(take(queue, &element, 1000U, &from, &elapsed) == (int)sizeof(element_t));
+    CHECK(element.value == 1U);
+    CHECK(elapsed < 500U);
+    // an element after the spin time (1ms): spin, then block
+    CHECK(queue_wait_policy(queue, QUEUE_WAIT_SPIN, 1000U) == 0);
+    from.delay = 50000U;
+    from.value = 2U;
+    CHECK(take(queue, &element, 1000U, &from, &elapsed) == (int)sizeof(element_t));
+    CHECK(element.value == 2U);
+    CHECK(elapsed < 1000U);
+    // no element: spin, then block until the time-out
+    CHECK(take(queue, &element, 20U, NULL, &elapsed) < 0);
+    CHECK(errno == ETIMEDOUT);
+    CHECK(elapsed >= 20U);
+    // a signal while spinning
+    CHECK(queue_wait_policy(queue, QUEUE_WAIT_SPIN, 500000U) == 0);
+    from.delay = 20000U;
+    from.signal = true;
+    CHECK(take(queue, &element, 1000U, &from, &elapsed) < 0);
+    CHECK(errno == ENOMSG);
+    CHECK(elapsed < 500U);
+    CHECK(balanced(queue));
+    (void)queue_destroy(queue);
+}
+
+//  A polling consumer takes an element, or it polls until the time-out.
+//
+static void test_wait_poll(void) {
+    producer_t from;
+    element_t element;
+    queue_t queue;
+    uint64_t elapsed = 0U;
+
+    if ((queue = queue_create(4U, sizeof(element_t))) == NULL) {
+        CHECK(queue != NULL);
+        return;
+    }
+    CHECK(queue_wait_policy(queue, QUEUE_WAIT_POLL, 0U) == 0);
+    memset(&from, 0, sizeof(producer_t));
+    from.queue = queue;
+    from.delay = 10000U;
+    from.value = 1U;
+    CHECK(take(queue, &element, 1000U, &from, &elapsed) == (int)sizeof(element_t));
+    CHECK(element.value == 1U);
+    CHECK(elapsed < 1000U);
+    CHECK(take(queue, &element, 20U, NULL, &elapsed) < 0);
+    CHECK(errno == ETIMEDOUT);
+    CHECK(elapsed >= 20U);
+    // no time-out: no polling
+    CHECK(take(queue, &element, 0U, NULL, &elapsed) < 0);
+    CHECK(errno == ENOMSG);
+    CHECK(balanced(queue));
+    (void)queue_destroy(queue);
+}
+
+//  A deadline that has passed (or zero) means polling, a deadline in the
+//  far future (or none) waits for an element.
+//
+static void test_dequeue_until(void) {
+    struct timespec deadline;
+    producer_t from;
+    element_t element;
+    queue_t queue;
+    pthread_t thread;
+    uint64_t start;
+
+    if ((queue = queue_create(4U, sizeof(element_t))) == NULL) {
+        CHECK(queue != NULL);
+        return;
+    }
+    // a deadline in the past: a queued element, else empty
+    deadline_in(&deadline, -1000);
+    CHECK(put(queue, 1U, 1U) == (int)sizeof(element_t));
+    CHECK(queue_dequeue_until(queue, &element, sizeof(element_t), &deadline) == (int)sizeof(element_t));
+    CHECK(element.value == 1U);
+    start = millis();
+    CHECK(queue_dequeue_until(queue, &element, sizeof(element_t), &deadline) == -30);
+    CHECK(errno == ENOMSG);
+    CHECK((millis() - start) < 10U);
+    // a zero deadline: the same
+    deadline.tv_sec = 0;
+    deadline.tv_nsec = 0;
+    CHECK(put(queue, 2U, 2U) == (int)sizeof(element_t));
+    CHECK(queue_dequeue_until(queue, &element, sizeof(element_t), &deadline) == (int)sizeof(element_t));
+    CHECK(element.value == 2U);
+    CHECK(queue_dequeue_until(queue, &element, sizeof(element_t), &deadline) == -30);
+    CHECK(errno == ENOMSG);
+    // a deadline in the far future (one year): woken up by an element
+    deadline_in(&deadline, 365LL * 24LL * 3600000LL);
+    memset(&from, 0, sizeof(producer_t));
+    from.queue = queue;
+    from.delay = 20000U;
+    from.value = 3U;
+    (void)pthread_create(&thread, NULL, producer, &from);
+    start = millis();
+    CHECK(queue_dequeue_until(queue, &element, sizeof(element_t), &deadline) == (int)sizeof(element_t));
+    CHECK(element.value == 3U);
+    CHECK((millis() - start) < 1000U);
+    (void)pthread_join(thread, NULL);
+    // no deadline: blocking
+    from.value = 4U;
+    (void)pthread_create(&thread, NULL, producer, &from);
+    CHECK(queue_dequeue_until(queue, &element, sizeof(element_t), NULL) == (int)sizeof(element_t));
+    CHECK(element.value == 4U);
+    (void)pthread_join(thread, NULL);
+    // a deadline shortly ahead: the time-out
+    deadline_in(&deadline, 20);
+    start = millis();
+    CHECK(queue_dequeue_until(queue, &element, sizeof(element_t), &deadline) == -30);
+    CHECK(errno == ETIMEDOUT);
+    CHECK((millis() - start) >= 19U);
+    CHECK(balanced(queue));
+    (void)queue_destroy(queue);
+}
+
+static int put(queue_t queue, uint32_t key, uint32_t value) {
+    element_t element;
+
+    element.key = key;
+    element.value = value;
+    return queue_enqueue(queue, &element, sizeof(element_t));
+}
+
+static bool get(queue_t queue, element_t *element) {
+    return (queue_dequeue(queue, element, sizeof(element_t), 0U) == (int)sizeof(element_t));
+}
+
+static bool balanced(queue_t queue) {
+    queue_counters_t counters;
+    int used;
+
+    // enqueued = dequeued + overwritten + coalesced + used (see queue.h)
+    if ((queue_counters(queue, &counters) < 0) || ((used = queue_usage(queue, NULL, NULL)) < 0))
+        return false;
+    return (counters.enqueued == (counters.dequeued + counters.overwritten + counters.coalesced + (uint64_t)used));
+}
+
+static void spill_path(char *path, size_t size) {
+    const char *tmpdir = getenv("TMPDIR");
+
+    // note: the spill file must not exist
+    snprintf(path, size, "%s/test_queue.%i.spill", tmpdir ? tmpdir : "/tmp", (int)getpid());
+    (void)unlink(path);
+}
+
+static void *producer(void *arg) {
+    producer_t *from = (producer_t*)arg;
+
+    usleep(from->delay);
+    if (from->signal)
+        (void)queue_signal(from->queue);
+    else
+        (void)put(from->queue, from->value, from->value);
+    return NULL;
+}
+
+static int take(queue_t queue, element_t *element, uint16_t timeout, producer_t *from, uint64_t *elapsed) {
+    pthread_t thread;
+    uint64_t start;
+    int res, err;
+
+    // note: dequeues while the producer (if any) enqueues or signals
+    if (from)
+        (void)pthread_create(&thread, NULL, producer, from);
+    start = millis();
+    res = queue_dequeue(queue, element, sizeof(element_t), timeout);
+    err = errno;
+    *elapsed = millis() - start;
+    if (from)
+        (void)pthread_join(thread, NULL);
+    errno = err;
+    return res;
+}
+
+static uint64_t millis(void) {
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000U) + ((uint64_t)now.tv_nsec / 1000000U);
+}
+
+static void deadline_in(struct timespec *deadline, int64_t msec) {
+    int64_t nsec;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, deadline);
+    nsec = ((int64_t)deadline->tv_sec * 1000000000LL) + (int64_t)deadline->tv_nsec + (msec * 1000000LL);
+    deadline->tv_sec = (time_t)(nsec / 1000000000LL);
+    deadline->tv_nsec = (long)(nsec % 1000000000LL);
+}
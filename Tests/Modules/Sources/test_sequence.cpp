@@ -0,0 +1,185 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  Module tests for the sequence analyzer of the CAN Tester (SerialCAN)
+//
+//  Copyright (c) 2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+#include "Sequence.h"
+#include "Parallel.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CHECK(cond)  do { if (!(cond)) { fprintf(stderr, "%s:%i: check failed: %s\n", __FILE__, __LINE__, #cond); failed++; } } while (0)
+
+static int failed = 0;
+
+uint64_t CCanDriver::s_u64Clock = 0U;
+
+//  note: the analyzer needs only these two from the rest of can_test
+//
+SOptions::SOptions() {
+    m_fStopOnError = false;
+    m_u32Analyze = 10U;
+    m_fVerbose = false;
+}
+
+uint64_t CParallelTest::GetTime() {
+    return CCanDriver::s_u64Clock;
+}
+
+static void append(CCanDriver& driver, uint32_t id, uint64_t number, uint64_t overflows, uint64_t delay = 0U);
+static void run(CSequenceAnalyzer& analyzer, CCanDriver& driver, char* output, size_t size);
+
+static void test_reordered(void);
+static void test_burst_split(void);
+static void test_late_second(void);
+
+
+int main(void) {
+    test_reordered();
+    test_burst_split();
+    test_late_second();
+
+    if (failed)
+        fprintf(stderr, "test_sequence: %i check(s) failed\n", failed);
+    else
+        fprintf(stdout, "test_sequence: all checks passed\n");
+    return failed ? 1 : 0;
+}
+
+//  A late frame is not lost: it is taken back from the totals, the sliding
+//  window and the loss bursts. Queue overflows are counted from the start.
+//
+static void test_reordered(void) {
+    SOptions options;
+    CCanDriver driver;
+    char output[4096];
+
+    driver.m_u64Overflows = 5U;                 // before the start
+    append(driver, 0x100U, 0U, 5U);
+    append(driver, 0x100U, 1U, 5U);
+    append(driver, 0x100U, 2U, 5U);
+    append(driver, 0x100U, 4U, 5U);             // 3 is late
+    append(driver, 0x100U, 3U, 5U);
+    append(driver, 0x100U, 5U, 5U);
+    append(driver, 0x200U, 0U, 5U);
+    append(driver, 0x200U, 1U, 5U);
+    append(driver, 0x200U, 3U, 7U);             // 2 is lost (queue overflow)
+    append(driver, 0x200U, 4U, 7U);
+    CSequenceAnalyzer analyzer(driver, options);
+    run(analyzer, driver, output, sizeof(output));
+    CHECK(strstr(output, "Lost=1  Loss=9.091%") != NULL);
+    CHECK(strstr(output, "Lost=1 (") != NULL);
+    CHECK(strstr(output, "Reordered=1\n") != NULL);
+    CHECK(strstr(output, "Loss burst(s)=1 (1 with queue overflow") != NULL);
+    CHECK(strstr(output, "Queue overflow(s)=2\n") != NULL);
+}
+
+//  A loss burst is closed only when all of its frames have been received,
+//  also when late frames in the middle of the gap arrive first.
+//
+static void test_burst_split(void) {
+    SOptions options;
+    CCanDriver driver;
+    char output[4096];
+
+    append(driver, 0x300U, 0U, 0U);
+    append(driver, 0x300U, 1U, 0U);
+    append(driver, 0x300U, 5U, 0U);             // 2, 3, 4 missing
+    append(driver, 0x300U, 3U, 0U);
+    append(driver, 0x300U, 2U, 0U);             // 4 still missing
+    append(driver, 0x301U, 0U, 0U);
+    append(driver, 0x301U, 1U, 0U);
+    append(driver, 0x301U, 5U, 0U);             // 2, 3, 4 missing
+    append(driver, 0x301U, 3U, 0U);
+    append(driver, 0x301U, 2U, 0U);
+    append(driver, 0x301U, 4U, 0U);             // gap closed
+    CSequenceAnalyzer analyzer(driver, options);
+    run(analyzer, driver, output, sizeof(output));
+    CHECK(strstr(output, "Lost=1 (") != NULL);
+    CHECK(strstr(output, "Reordered=5\n") != NULL);
+    CHECK(strstr(output, "Loss burst(s)=1 (") != NULL);
+}
+
+//  A late frame is taken back from the second its loss was counted in,
+//  not from another second in the sliding window.
+//
+static void test_late_second(void) {
+    SOptions options;
+    CCanDriver driver;
+    char output[4096];
+
+    options.m_u32Analyze = 2U;                  // sliding window of 2s
+    append(driver, 0x100U, 0U, 0U);
+    append(driver, 0x100U, 1U, 0U);
+    append(driver, 0x100U, 3U, 0U);             // 2 lost in second 0
+    append(driver, 0x100U, 4U, 0U, 1000000000U);
+    append(driver, 0x100U, 5U, 0U);
+    append(driver, 0x100U, 7U, 0U);             // 6 lost in second 1
+    append(driver, 0x100U, 2U, 0U, 1000000000U);  // late in second 2
+    append(driver, 0x100U, 8U, 0U);
+    CSequenceAnalyzer analyzer(driver, options);
+    run(analyzer, driver, output, sizeof(output));
+    // seconds 1 and 2: 5 frames, 6 lost (the loss of 2 has left the window)
+    CHECK(strstr(output, "     3s  Frames=8  Lost=1  Loss=16.667%") != NULL);
+}
+
+static void append(CCanDriver& driver, uint32_t id, uint64_t number, uint64_t overflows, uint64_t delay) {
+    CCanDriver::SRead read;
+
+    memset(&read, 0, sizeof(read));
+    read.m_Message.id = id;
+    read.m_Message.dlc = 8U;
+    for (uint8_t i = 0U; i < 8U; i++)
+        read.m_Message.data[i] = (uint8_t)(number >> (8U * i));
+    read.m_u64Overflows = overflows;
+    read.m_u64Delay = delay;
+    driver.m_Script.push_back(read);
+}
+
+static void run(CSequenceAnalyzer& analyzer, CCanDriver& driver, char* output, size_t size) {
+    volatile int running = 1;
+    FILE* tmp = tmpfile();
+    int out, err;
+    size_t n;
+
+    // note: the analyzer prints to stdout and stderr, both are captured
+    output[0] = '\0';
+    if (!tmp)
+        return;
+    fflush(stdout);
+    fflush(stderr);
+    out = dup(STDOUT_FILENO);
+    err = dup(STDERR_FILENO);
+    (void)dup2(fileno(tmp), STDOUT_FILENO);
+    (void)dup2(fileno(tmp), STDERR_FILENO);
+    driver.m_pRunning = &running;
+    (void)analyzer.Run(running);
+    analyzer.Report(stdout);
+    fflush(stdout);
+    fflush(stderr);
+    (void)dup2(out, STDOUT_FILENO);
+    (void)dup2(err, STDERR_FILENO);
+    close(out);
+    close(err);
+    rewind(tmp);
+    n = fread(output, 1U, size - 1U, tmp);
+    output[n] = '\0';
+    fclose(tmp);
+}
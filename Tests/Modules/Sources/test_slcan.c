@@ -0,0 +1,397 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-3.0-or-later
+//
+//  Module tests for the SLCAN protocol layer (SerialCAN)
+//
+//  Copyright (c) 2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of SerialCAN.
+//
+//  SerialCAN is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v3.0 (or any later version). You can
+//  choose between one of them if you use SerialCAN in whole or in part.
+//
+//  (see LICENSE.BSD-2-Clause and LICENSE.GPL-3.0-or-later)
+//
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+#include "slcan.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+
+#define DELAY  5000U                    // time for the reception thread to read [us]
+
+#define ID_NAK  0x666U                  // the device answers with a NAK
+#define ID_MUTE  0x555U                 // the device does not answer
+
+#define CHECK(cond)  do { if (!(cond)) { fprintf(stderr, "%s:%i: check failed: %s\n", __FILE__, __LINE__, #cond); failed++; } } while (0)
+
+static int failed = 0;
+
+static volatile bool running = false;
+static uint32_t received[256];
+static volatile size_t nreceived = 0U;
+
+static slcan_port_t open_port(int *master, size_t queueSize, uint8_t options);
+static void close_port(slcan_port_t port, int master);
+static void send(int master, const char *string);
+static void *device(void *arg);
+static void *sender(void *arg);
+static void deadline_in(struct timespec *deadline, int64_t msec);
+static uint64_t millis(void);
+
+static void test_lazy_chunk_lost(void);
+static void test_batch_nak(void);
+static void test_batch_timeout(void);
+static void test_connection_lost(void);
+static void test_read_deadline(void);
+static void test_write_deadline(void);
+
+
+int main(void) {
+    test_lazy_chunk_lost();
+    test_batch_nak();
+    test_batch_timeout();
+    test_connection_lost();
+    test_read_deadline();
+    test_write_deadline();
+
+    if (failed)
+        fprintf(stderr, "test_slcan: %i check(s) failed\n", failed);
+    else
+        fprintf(stdout, "test_slcan: all checks passed\n");
+    return failed ? 1 : 0;
+}
+
+//  A message indication whose middle is in a dropped chunk must not be
+//  completed by the tail of the next chunk (lazy decoding).
+//
+static void test_lazy_chunk_lost(void) {
+    slcan_queue_counters_t counters;
+    slcan_message_t message;
+    slcan_port_t port;
+    int master, i, n;
+    bool stale = false;
+
+    // note: the chunk queue has 64 entries (minimum), one chunk per write
+    if ((port = open_port(&master, 64U, SLCAN_OPTION_LAZYDECODE)) == NULL) {
+        CHECK(port != NULL);
+        return;
+    }
+    for (i = 0; i < 63; i++)
+        send(master, "t0011AA\r");
+    send(master, "t123811223344");              // the last free entry: a prefix
+    send(master, "55667788\rt4568");            // queue full: dropped
+    CHECK(slcan_read_message(port, &message, 1000U) == 0);
+    CHECK(message.can_id == 0x001U);
+    send(master, "99AABBCC\r");                 // a free entry: the tail
+    for (n = 1; slcan_read_message(port, &message, 100U) == 0; n++) {
+        if (message.can_id == 0x123U)
+            stale = true;
+    }
+    CHECK(n == 63);
+    CHECK(!stale);
+    CHECK(slcan_queue_counters(port, &counters) == 0);
+    CHECK(counters.dropped == 1U);
+    close_port(port, master);
+}
+
+//  A NAK in the middle of a batch is counted, and the frames after it are
+//  answered too (so they are not resubmitted by the caller).
+//
+static void test_batch_nak(void) {
+    slcan_message_t messages[8];
+    slcan_port_t port;
+    pthread_t thread;
+    size_t rejected = 0U;
+    int master, i;
+
+    if ((port = open_port(&master, 64U, 0U)) == NULL) {
+        CHECK(port != NULL);
+        return;
+    }
+    memset(messages, 0, sizeof(messages));
+    for (i = 0; i < 8; i++) {
+        messages[i].can_id = (i == 3) ? ID_NAK : (uint32_t)(i + 1);
+        messages[i].can_dlc = 1U;
+        messages[i].data[0] = (uint8_t)i;
+    }
+    nreceived = 0U;
+    running = true;
+    (void)pthread_create(&thread, NULL, device, &master);
+    CHECK(slcan_write_messages(port, messages, 8U, 0U, &rejected) == 8);
+    CHECK(rejected == 1U);
+    CHECK(nreceived == 8U);
+    running = false;
+    (void)pthread_join(thread, NULL);
+    close_port(port, master);
+}
+
+//  A frame not answered within the time-out is not counted as answered.
+//
+static void test_batch_timeout(void) {
+    slcan_message_t messages[4];
+    slcan_port_t port;
+    pthread_t thread;
+    size_t rejected = 0U;
+    int master, i;
+
+    if ((port = open_port(&master, 64U, 0U)) == NULL) {
+        CHECK(port != NULL);
+        return;
+    }
+    memset(messages, 0, sizeof(messages));
+    for (i = 0; i < 4; i++) {
+        messages[i].can_id = (i == 3) ? ID_MUTE : (uint32_t)(i + 1);
+        messages[i].can_dlc = 0U;
+    }
+    running = true;
+    (void)pthread_create(&thread, NULL, device, &master);
+    CHECK(slcan_write_messages(port, messages, 4U, 50U, &rejected) == 3);
+    CHECK(errno == ETIMEDOUT);
+    CHECK(rejected == 0U);
+    CHECK(slcan_write_messages(port, &messages[3], 1U, 50U, &rejected) < 0);
+    CHECK(errno == ETIMEDOUT);
+    running = false;
+    (void)pthread_join(thread, NULL);
+    close_port(port, master);
+}
+
+//  A reader waiting for a message is woken up when the connection is lost.
+//  The messages received before are read first.
+//
+static void test_connection_lost(void) {
+    slcan_message_t message;
+    slcan_port_t port;
+    struct timespec start, stop;
+    int master;
+
+    if ((port = open_port(&master, 64U, 0U)) == NULL) {
+        CHECK(port != NULL);
+        return;
+    }
+    send(master, "t0011AA\r");
+    close(master);                              // the device has gone
+    CHECK(slcan_read_message(port, &message, 1000U) == 0);
+    CHECK(message.can_id == 0x001U);
+    (void)clock_gettime(CLOCK_MONOTONIC, &start);
+    CHECK(slcan_read_message(port, &message, 5000U) < 0);
+    CHECK(errno == ENOTCONN);
+    (void)clock_gettime(CLOCK_MONOTONIC, &stop);
+    CHECK((stop.tv_sec - start.tv_sec) < 1);    // not the time-out
+    (void)slcan_disconnect(port);
+    (void)slcan_destroy(port);
+}
+
+//  Reading with a deadline that has passed (or zero) means polling, with
+//  a deadline in the far future it waits for a message.
+//
+static void test_read_deadline(void) {
+    slcan_message_t message;
+    slcan_port_t port;
+    struct timespec deadline;
+    pthread_t thread;
+    uint64_t start;
+    int master;
+
+    if ((port = open_port(&master, 64U, 0U)) == NULL) {
+        CHECK(port != NULL);
+        return;
+    }
+    // a deadline in the past: a received message, else empty
+    deadline_in(&deadline, -1000);
+    send(master, "t0011AA\r");
+    CHECK(slcan_read_message_until(port, &message, NULL, &deadline) == 0);
+    CHECK(message.can_id == 0x001U);
+    start = millis();
+    CHECK(slcan_read_message_until(port, &message, NULL, &deadline) == -30);
+    CHECK(errno == ENOMSG);
+    CHECK((millis() - start) < 10U);
+    // a zero deadline: the same
+    deadline.tv_sec = 0;
+    deadline.tv_nsec = 0;
+    send(master, "t0021BB\r");
+    CHECK(slcan_read_message_until(port, &message, NULL, &deadline) == 0);
+    CHECK(message.can_id == 0x002U);
+    CHECK(slcan_read_message_until(port, &message, NULL, &deadline) == -30);
+    CHECK(errno == ENOMSG);
+    // a deadline in the far future (one year): woken up by a message
+    deadline_in(&deadline, 365LL * 24LL * 3600000LL);
+    (void)pthread_create(&thread, NULL, sender, &master);
+    start = millis();
+    CHECK(slcan_read_message_until(port, &message, NULL, &deadline) == 0);
+    CHECK(message.can_id == 0x003U);
+    CHECK((millis() - start) < 1000U);
+    (void)pthread_join(thread, NULL);
+    // a deadline shortly ahead: the time-out
+    deadline_in(&deadline, 20);
+    CHECK(slcan_read_message_until(port, &message, NULL, &deadline) == -30);
+    CHECK(errno == ETIMEDOUT);
+    close_port(port, master);
+}
+
+//  Writing with a deadline that has passed (or zero) does not wait for the
+//  confirmation, with a deadline in the far future it waits not longer than
+//  the default time-out of a transmission.
+//
+static void test_write_deadline(void) {
+    slcan_message_t message;
+    slcan_port_t port;
+    struct timespec deadline;
+    pthread_t thread;
+    uint64_t start;
+    int master;
+
+    if ((port = open_port(&master, 64U, 0U)) == NULL) {
+        CHECK(port != NULL);
+        return;
+    }
+    // note: no answer to a frame sent with a passed deadline (it would
+    //       be taken as the confirmation of the next frame)
+    memset(&message, 0, sizeof(slcan_message_t));
+    message.can_id = ID_MUTE;
+    nreceived = 0U;
+    running = true;
+    (void)pthread_create(&thread, NULL, device, &master);
+    // a deadline in the past: not confirmed
+    deadline_in(&deadline, -1000);
+    start = millis();
+    CHECK(slcan_write_message_until(port, &message, &deadline) < 0);
+    CHECK(errno == ETIMEDOUT);
+    CHECK((millis() - start) < 10U);
+    // a zero deadline: the same
+    deadline.tv_sec = 0;
+    deadline.tv_nsec = 0;
+    CHECK(slcan_write_message_until(port, &message, &deadline) < 0);
+    CHECK(errno == ETIMEDOUT);
+    // a deadline in the far future (one year): confirmed
+    deadline_in(&deadline, 365LL * 24LL * 3600000LL);
+    message.can_id = 0x001U;
+    CHECK(slcan_write_message_until(port, &message, &deadline) == 0);
+    // ... or not confirmed within the default time-out
+    message.can_id = ID_MUTE;
+    start = millis();
+    CHECK(slcan_write_message_until(port, &message, &deadline) < 0);
+    CHECK((millis() - start) < 2000U);
+    running = false;
+    (void)pthread_join(thread, NULL);
+    CHECK(nreceived == 4U);
+    close_port(port, master);
+}
+
+static slcan_port_t open_port(int *master, size_t queueSize, uint8_t options) {
+    slcan_attr_t attr;
+    slcan_port_t port;
+    char device[256];
+
+    if (((*master = posix_openpt(O_RDWR | O_NOCTTY)) < 0) ||
+        (grantpt(*master) < 0) || (unlockpt(*master) < 0)) {
+        perror("posix_openpt");
+        return NULL;
+    }
+    snprintf(device, sizeof(device), "pty://%s", ptsname(*master));
+    memset(&attr, 0, sizeof(slcan_attr_t));
+    attr.baudrate = 115200U;
+    attr.bytesize = BYTESIZE8;
+    attr.parity = PARITYNONE;
+    attr.stopbits = STOPBITS1;
+    attr.options = options;
+    if ((port = slcan_create(queueSize)) == NULL) {
+        perror("slcan_create");
+        close(*master);
+        return NULL;
+    }
+    if (slcan_connect(port, device, &attr) < 0) {
+        perror("slcan_connect");
+        (void)slcan_destroy(port);
+        close(*master);
+        return NULL;
+    }
+    return port;
+}
+
+static void close_port(slcan_port_t port, int master) {
+    (void)slcan_disconnect(port);
+    (void)slcan_destroy(port);
+    close(master);
+}
+
+static void *device(void *arg) {
+    int master = *(int*)arg;
+    struct pollfd fds;
+    char line[64];
+    char tmp[9];
+    size_t length = 0U, digits;
+    uint32_t id;
+    char chr;
+
+    // note: answers 't' and 'T' commands, no other commands are sent
+    fds.fd = master;
+    fds.events = POLLIN;
+    while (running) {
+        if ((poll(&fds, 1, 10) <= 0) || (read(master, &chr, 1) != 1))
+            continue;
+        if (chr != '\r') {
+            if (length < (sizeof(line) - 1U))
+                line[length++] = chr;
+            continue;
+        }
+        line[length] = '\0';
+        // identifier: 3 digits ('t') or 8 digits ('T')
+        digits = (line[0] == 'T') ? 8U : 3U;
+        memset(tmp, 0, sizeof(tmp));
+        if (length > digits)
+            memcpy(tmp, &line[1], digits);
+        id = (uint32_t)strtoul(tmp, NULL, 16);
+        length = 0U;
+        if (nreceived < 256U)
+            received[nreceived++] = id;
+        if (id == ID_NAK)
+            (void)write(master, "\a", 1);
+        else if (id != ID_MUTE)
+            (void)write(master, (line[0] == 'T') ? "Z\r" : "z\r", 2);
+    }
+    return NULL;
+}
+
+static void send(int master, const char *string) {
+    // note: one write per chunk (the reception thread reads in between)
+    if (write(master, string, strlen(string)) != (ssize_t)strlen(string))
+        perror("write");
+    usleep(DELAY);
+}
+
+static void *sender(void *arg) {
+    int master = *(int*)arg;
+
+    usleep(20000U);
+    send(master, "t0031CC\r");
+    return NULL;
+}
+
+static void deadline_in(struct timespec *deadline, int64_t msec) {
+    int64_t nsec;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, deadline);
+    nsec = ((int64_t)deadline->tv_sec * 1000000000LL) + (int64_t)deadline->tv_nsec + (msec * 1000000LL);
+    deadline->tv_sec = (time_t)(nsec / 1000000000LL);
+    deadline->tv_nsec = (long)(nsec % 1000000000LL);
+}
+
+static uint64_t millis(void) {
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000U) + ((uint64_t)now.tv_nsec / 1000000U);
+}
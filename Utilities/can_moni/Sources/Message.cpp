@@ -54,12 +54,8 @@
 //  Methods to format a CAN message
 //
 bool CCanMessage::Format(TCanMessage message, uint64_t counter, char *string, size_t length) {
-    char *szMessage = msg_format_message(&message, MSG_RX_MESSAGE, counter, 0);
-    if (szMessage) {
-        strncpy(string, szMessage, length);
-        return true;
-    } else
-        return false;
+    // note: formatted directly into the caller's buffer (global formatter options)
+    return (msg_format_message_r(NULL, string, length, &message, MSG_RX_MESSAGE, counter, 0) >= 0) ? true : false;
 }
 
 bool CCanMessage::SetTimestampFormat(EFormatTimestamp option) {
@@ -68,6 +68,12 @@ struct SOptions {
         uint32_t m_u32Mask;
     } m_StdFilter, m_XtdFilter;
     char* m_szExcludeList;
+    char* m_szCaptureFile;
+    char* m_szPcapngFile;
+    uint64_t m_u64RotateSize;
+    uint32_t m_u32RotateTime;
+    bool m_fBacklogDrop;
+    uint32_t m_u32Statistics;
     bool m_fListBitrates;
     bool m_fListBoards;
     bool m_fTestBoards;
@@ -78,6 +78,12 @@ SOptions::SOptions() {
     m_XtdFilter.m_u32Code = CANACC_CODE_29BIT;
     m_XtdFilter.m_u32Mask = CANACC_MASK_29BIT;
     m_szExcludeList = (char*)c_szExcludeList;
+    m_szCaptureFile = (char*)NULL;
+    m_szPcapngFile = (char*)NULL;
+    m_u64RotateSize = 0U;
+    m_u32RotateTime = 0U;
+    m_fBacklogDrop = false;
+    m_u32Statistics = 0U;
     m_fListBitrates = false;
     m_fListBoards = false;
     m_fTestBoards = false;
@@ -110,6 +116,12 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
     int optFmtWrap = 0;
 #endif
     int optExclude = 0;
+    int optCapture = 0;
+    int optPcapng = 0;
+    int optRotateSize = 0;
+    int optRotateTime = 0;
+    int optBacklog = 0;
+    int optStatistics = 0;
     int optListBitrates = 0;
     int optListBoards = 0;
     int optTestBoards = 0;
@@ -154,6 +166,12 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
         {"wraparound", required_argument, 0, 'w'},
         {"exclude", required_argument, 0, 'x'},
         {"script", required_argument, 0, 's'},
+        {"capture", required_argument, 0, 'c'},
+        {"pcapng", required_argument, 0, '5'},
+        {"rotate-size", required_argument, 0, '6'},
+        {"rotate-time", required_argument, 0, '7'},
+        {"backlog", required_argument, 0, '8'},
+        {"statistics", optional_argument, 0, '9'},
         {"list-bitrates", optional_argument, 0, 'l'},
 #if (OPTION_CANAPI_LIBRARY != 0)
         {"list-boards", optional_argument, 0, 'L'},
@@ -179,9 +197,9 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
 #endif
     // (2) scan command-line for options
 #if (OPTION_CANAPI_LIBRARY != 0)
-    while ((opt = getopt_long(argc, (char * const *)argv, "b:vp:m:t:i:d:a:w:x:s:lLTh", long_options, NULL)) != -1) {
+    while ((opt = getopt_long(argc, (char * const *)argv, "b:vp:m:t:i:d:a:w:x:s:c:lLTh", long_options, NULL)) != -1) {
 #else
-    while ((opt = getopt_long(argc, (char * const *)argv, "b:vm:t:i:d:a:w:x:s:lLTj:h", long_options, NULL)) != -1) {
+    while ((opt = getopt_long(argc, (char * const *)argv, "b:vm:t:i:d:a:w:x:s:c:lLTj:h", long_options, NULL)) != -1) {
 #endif
         switch (opt) {
         /* option '--baudrate=<baudrate>' (-b) */
@@ -573,6 +591,96 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
             }
             m_szExcludeList = optarg;
             break;
+        /* option '--capture=<filename>' (-c) */
+        case 'c':
+            if (optCapture++) {
+                fprintf(err, "%s: duplicated option `--capture' (%c)\n", m_szBasename, opt);
+                return 1;
+            }
+            if (optarg == NULL) {
+                fprintf(err, "%s: missing argument for option `--capture' (%c)\n", m_szBasename, opt);
+                return 1;
+            }
+            m_szCaptureFile = optarg;
+            break;
+        /* option '--pcapng=<filename>' */
+        case '5':
+            if (optPcapng++) {
+                fprintf(err, "%s: duplicated option `--pcapng'\n", m_szBasename);
+                return 1;
+            }
+            if (optarg == NULL) {
+                fprintf(err, "%s: missing argument for option `--pcapng'\n", m_szBasename);
+                return 1;
+            }
+            m_szPcapngFile = optarg;
+            break;
+        /* option '--rotate-size=<megabytes>' */
+        case '6':
+            if (optRotateSize++) {
+                fprintf(err, "%s: duplicated option `--rotate-size'\n", m_szBasename);
+                return 1;
+            }
+            if (optarg == NULL) {
+                fprintf(err, "%s: missing argument for option `--rotate-size'\n", m_szBasename);
+                return 1;
+            }
+            if ((sscanf(optarg, "%" SCNi64, &intarg) != 1) || (intarg < 1) || (intarg > 1048576)) {
+                fprintf(err, "%s: illegal argument for option `--rotate-size'\n", m_szBasename);
+                return 1;
+            }
+            m_u64RotateSize = (uint64_t)intarg * 1048576U;
+            break;
+        /* option '--rotate-time=<seconds>' */
+        case '7':
+            if (optRotateTime++) {
+                fprintf(err, "%s: duplicated option `--rotate-time'\n", m_szBasename);
+                return 1;
+            }
+            if (optarg == NULL) {
+                fprintf(err, "%s: missing argument for option `--rotate-time'\n", m_szBasename);
+                return 1;
+            }
+            if ((sscanf(optarg, "%" SCNi64, &intarg) != 1) || (intarg < 1) || (intarg > UINT32_MAX)) {
+                fprintf(err, "%s: illegal argument for option `--rotate-time'\n", m_szBasename);
+                return 1;
+            }
+            m_u32RotateTime = (uint32_t)intarg;
+            break;
+        /* option '--backlog=(WAIT|DROP)' */
+        case '8':
+            if (optBacklog++) {
+                fprintf(err, "%s: duplicated option `--backlog'\n", m_szBasename);
+                return 1;
+            }
+            if (optarg == NULL) {
+                fprintf(err, "%s: missing argument for option `--backlog'\n", m_szBasename);
+                return 1;
+            }
+            if (!strcasecmp(optarg, "WAIT") || !strcasecmp(optarg, "W"))
+                m_fBacklogDrop = false;
+            else if (!strcasecmp(optarg, "DROP") || !strcasecmp(optarg, "D"))
+                m_fBacklogDrop = true;
+            else {
+                fprintf(err, "%s: illegal argument for option `--backlog'\n", m_szBasename);
+                return 1;
+            }
+            break;
+        /* option '--statistics[=<seconds>]' */
+        case '9':
+            if (optStatistics++) {
+                fprintf(err, "%s: duplicated option `--statistics'\n", m_szBasename);
+                return 1;
+            }
+            if (optarg != NULL) {
+                if ((sscanf(optarg, "%" SCNi64, &intarg) != 1) || (intarg < 1) || (intarg > 3600)) {
+                    fprintf(err, "%s: illegal argument for option `--statistics'\n", m_szBasename);
+                    return 1;
+                }
+                m_u32Statistics = (uint32_t)intarg;
+            } else
+                m_u32Statistics = 1U;
+            break;
         /* option '--list-bitrates[=(2.0|FDF[+BRS])]' */
         case 'l':
             if (optListBitrates++) {
@@ -698,6 +806,16 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
         m_szInterface = (char*)argv[optind];
     }
     // (4) check for illegal combinations
+    /* - check file rotation (only for pcapng) */
+    if ((optRotateSize || optRotateTime) && !optPcapng) {
+        fprintf(err, "%s: option `--rotate-size' or `--rotate-time' requires option `--pcapng'\n", m_szBasename);
+        return 1;
+    }
+    /* - check statistics view (no recording) */
+    if (optStatistics && (optCapture || optPcapng)) {
+        fprintf(err, "%s: illegal combination of options `--statistics' and `--capture' or `--pcapng'\n", m_szBasename);
+        return 1;
+    }
 #if (CAN_FD_SUPPORTED != 0)
     /* - check bit-timing index (n/a for CAN FD) */
     if (m_OpMode.fdoe && (m_Bitrate.btr.frequency <= CANBTR_INDEX_1M) && !m_fExit) {
@@ -740,6 +858,12 @@ void SOptions::ShowUsage(FILE* stream, bool args) {
     fprintf(stream, " -w, --wrap=(NO|8|10|16|32|64)        wraparound after n data bytes (default=NO)\n");
 #endif
     fprintf(stream, " -x, --exclude=[~]<id-list>           exclude CAN-IDs: <id-list> = <id>[-<id>]{,<id>[-<id>]}\n");
+    fprintf(stream, " -c, --capture=<filename>             record into a binary capture file (no display)\n");
+    fprintf(stream, "     --pcapng=<filename>              record into a pcapng file (no display)\n");
+    fprintf(stream, "     --rotate-size=<megabytes>        rotate the pcapng file after n megabytes\n");
+    fprintf(stream, "     --rotate-time=<seconds>          rotate the pcapng file after n seconds\n");
+    fprintf(stream, "     --backlog=(WAIT|DROP)            wait or drop when the display lags behind (default=WAIT)\n");
+    fprintf(stream, "     --statistics[=<seconds>]         display a statistics table per CAN-ID (default=1s)\n");
     fprintf(stream, "     --code=<id>                      acceptance code for 11-bit IDs (default=0x%03x)\n", CANACC_CODE_11BIT);
     fprintf(stream, "     --mask=<id>                      acceptance mask for 11-bit IDs (default=0x%03x)\n", CANACC_MASK_11BIT);
     fprintf(stream, "     --xtd-code=<id>                  acceptance code for 29-bit IDs (default=0x%08x)\n", CANACC_CODE_29BIT);
@@ -74,19 +74,26 @@ extern "C" {
 #define XTD_MASK_CHR      32
 #define SCRIPT_STR        33
 #define SCRIPT_CHR        34
-#define LISTBITRATES_STR  35
-#define LISTBOARDS_STR    36
-#define LISTBOARDS_CHR    37
-#define TESTBOARDS_STR    38
-#define TESTBOARDS_CHR    39
-#define JSON_STR          40
-#define JSON_CHR          41
-#define HELP              42
-#define QUESTION_MARK     43
-#define ABOUT             44
-#define CHARACTER_MJU     45
-#define VERSION           46
-#define MAX_OPTIONS       47
+#define CAPTURE_STR       35
+#define CAPTURE_CHR       36
+#define PCAPNG_STR        37
+#define ROTATESIZE_STR    38
+#define ROTATETIME_STR    39
+#define BACKLOG_STR       40
+#define STATISTICS_STR    41
+#define LISTBITRATES_STR  42
+#define LISTBOARDS_STR    43
+#define LISTBOARDS_CHR    44
+#define TESTBOARDS_STR    45
+#define TESTBOARDS_CHR    46
+#define JSON_STR          47
+#define JSON_CHR          48
+#define HELP              49
+#define QUESTION_MARK     50
+#define ABOUT             51
+#define CHARACTER_MJU     52
+#define VERSION           53
+#define MAX_OPTIONS       54
 
 static char* option[MAX_OPTIONS] = {
     (char*)"BAUDRATE", (char*)"bd",
@@ -107,6 +114,12 @@ static char* option[MAX_OPTIONS] = {
     (char*)"CODE", (char*)"MASK",
     (char*)"XTD-CODE", (char*)"XTD-MASK",
     (char*)"SCRIPT", (char*)"s",
+    (char*)"CAPTURE", (char*)"c",
+    (char*)"PCAPNG",
+    (char*)"ROTATE-SIZE",
+    (char*)"ROTATE-TIME",
+    (char*)"BACKLOG",
+    (char*)"STATISTICS",
     (char*)"LIST-BITRATES",
     (char*)"LIST-BOARDS", (char*)"list",
     (char*)"TEST-BOARDS", (char*)"test",
@@ -152,6 +165,12 @@ SOptions::SOptions() {
     m_XtdFilter.m_u32Code = CANACC_CODE_29BIT;
     m_XtdFilter.m_u32Mask = CANACC_MASK_29BIT;
     m_szExcludeList = (char*)c_szExcludeList;
+    m_szCaptureFile = (char*)NULL;
+    m_szPcapngFile = (char*)NULL;
+    m_u64RotateSize = 0U;
+    m_u32RotateTime = 0U;
+    m_fBacklogDrop = false;
+    m_u32Statistics = 0U;
     m_fListBitrates = false;
     m_fListBoards = false;
     m_fTestBoards = false;
@@ -180,6 +199,12 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
     int optAscii = 0;
     int optWrap = 0;
     int optExclude = 0;
+    int optCapture = 0;
+    int optPcapng = 0;
+    int optRotateSize = 0;
+    int optRotateTime = 0;
+    int optBacklog = 0;
+    int optStatistics = 0;
     int optCode = 0;
     int optMask = 0;
     int optXtdCode = 0;
@@ -587,6 +612,97 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
             }
             m_szExcludeList = optarg;
             break;
+        /* option '--capture=<filename>' (-c) */
+        case CAPTURE_STR:
+        case CAPTURE_CHR:
+            if ((optCapture++)) {
+                fprintf(err, "%s: duplicated option /CAPTURE\n", m_szBasename);
+                return 1;
+            }
+            if ((optarg = getOptionParameter()) == NULL) {
+                fprintf(err, "%s: missing argument for option /CAPTURE\n", m_szBasename);
+                return 1;
+            }
+            m_szCaptureFile = optarg;
+            break;
+        /* option '--pcapng=<filename>' */
+        case PCAPNG_STR:
+            if ((optPcapng++)) {
+                fprintf(err, "%s: duplicated option /PCAPNG\n", m_szBasename);
+                return 1;
+            }
+            if ((optarg = getOptionParameter()) == NULL) {
+                fprintf(err, "%s: missing argument for option /PCAPNG\n", m_szBasename);
+                return 1;
+            }
+            m_szPcapngFile = optarg;
+            break;
+        /* option '--rotate-size=<megabytes>' */
+        case ROTATESIZE_STR:
+            if ((optRotateSize++)) {
+                fprintf(err, "%s: duplicated option /ROTATE-SIZE\n", m_szBasename);
+                return 1;
+            }
+            if ((optarg = getOptionParameter()) == NULL) {
+                fprintf(err, "%s: missing argument for option /ROTATE-SIZE\n", m_szBasename);
+                return 1;
+            }
+            if ((sscanf_s(optarg, "%lli", &intarg) != 1) || (intarg < 1) || (intarg > 1048576)) {
+                fprintf(err, "%s: illegal argument for option /ROTATE-SIZE\n", m_szBasename);
+                return 1;
+            }
+            m_u64RotateSize = (uint64_t)intarg * 1048576U;
+            break;
+        /* option '--rotate-time=<seconds>' */
+        case ROTATETIME_STR:
+            if ((optRotateTime++)) {
+                fprintf(err, "%s: duplicated option /ROTATE-TIME\n", m_szBasename);
+                return 1;
+            }
+            if ((optarg = getOptionParameter()) == NULL) {
+                fprintf(err, "%s: missing argument for option /ROTATE-TIME\n", m_szBasename);
+                return 1;
+            }
+            if ((sscanf_s(optarg, "%lli", &intarg) != 1) || (intarg < 1) || (intarg > UINT32_MAX)) {
+                fprintf(err, "%s: illegal argument for option /ROTATE-TIME\n", m_szBasename);
+                return 1;
+            }
+            m_u32RotateTime = (uint32_t)intarg;
+            break;
+        /* option '--backlog=(WAIT|DROP)' */
+        case BACKLOG_STR:
+            if ((optBacklog++)) {
+                fprintf(err, "%s: duplicated option /BACKLOG\n", m_szBasename);
+                return 1;
+            }
+            if ((optarg = getOptionParameter()) == NULL) {
+                fprintf(err, "%s: missing argument for option /BACKLOG\n", m_szBasename);
+                return 1;
+            }
+            if (!strcasecmp(optarg, "WAIT") || !strcasecmp(optarg, "W"))
+                m_fBacklogDrop = false;
+            else if (!strcasecmp(optarg, "DROP") || !strcasecmp(optarg, "D"))
+                m_fBacklogDrop = true;
+            else {
+                fprintf(err, "%s: illegal argument for option /BACKLOG\n", m_szBasename);
+                return 1;
+            }
+            break;
+        /* option '--statistics[=<seconds>]' */
+        case STATISTICS_STR:
+            if ((optStatistics++)) {
+                fprintf(err, "%s: duplicated option /STATISTICS\n", m_szBasename);
+                return 1;
+            }
+            if ((optarg = getOptionParameter()) != NULL) {
+                if ((sscanf_s(optarg, "%lli", &intarg) != 1) || (intarg < 1) || (intarg > 3600)) {
+                    fprintf(err, "%s: illegal argument for option /STATISTICS\n", m_szBasename);
+                    return 1;
+                }
+                m_u32Statistics = (uint32_t)intarg;
+            } else
+                m_u32Statistics = 1U;
+            break;
         /* option '--code=<11-bit-code>' */
         case STD_CODE_STR:
             if ((optCode++)) {
@@ -780,6 +896,16 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
         return 1;
     }
     // (4) check for illegal combinations
+    /* - check file rotation (only for pcapng) */
+    if ((optRotateSize || optRotateTime) && !optPcapng) {
+        fprintf(err, "%s: option /ROTATE-SIZE or /ROTATE-TIME requires option /PCAPNG\n", m_szBasename);
+        return 1;
+    }
+    /* - check statistics view (no recording) */
+    if (optStatistics && (optCapture || optPcapng)) {
+        fprintf(err, "%s: illegal combination of options /STATISTICS and /CAPTURE or /PCAPNG\n", m_szBasename);
+        return 1;
+    }
 #if (CAN_FD_SUPPORTED != 0)
     /* - check bit-timing index (n/a for CAN FD) */
     if (m_OpMode.fdoe && (m_Bitrate.btr.frequency <= CANBTR_INDEX_1M) && !m_fExit) {
@@ -822,6 +948,12 @@ void SOptions::ShowUsage(FILE* stream, bool args) {
     fprintf(stream, "  /Wraparound:(No|8|10|16|32|64)      wraparound after n data bytes (default=NO)\n");
 #endif
     fprintf(stream, "  /eXclude:[~]<id-list>               exclude CAN-IDs: <id-list> = <id>[-<id>]{,<id>[-<id>]}\n");
+    fprintf(stream, "  /Capture:<filename>                 record into a binary capture file (no display)\n");
+    fprintf(stream, "  /PCAPNG:<filename>                  record into a pcapng file (no display)\n");
+    fprintf(stream, "  /ROTATE-SIZE:<megabytes>            rotate the pcapng file after n megabytes\n");
+    fprintf(stream, "  /ROTATE-TIME:<seconds>              rotate the pcapng file after n seconds\n");
+    fprintf(stream, "  /BACKLOG:(WAIT|DROP)                wait or drop when the display lags behind (default=WAIT)\n");
+    fprintf(stream, "  /STATISTICS[:<seconds>]             display a statistics table per CAN-ID (default=1s)\n");
     fprintf(stream, "  /CODE:<id>                          acceptance code for 11-bit IDs (default=0x%03lx)\n", CANACC_CODE_11BIT);
     fprintf(stream, "  /MASK:<id>                          acceptance mask for 11-bit IDs (default=0x%03lx)\n", CANACC_MASK_11BIT);
     fprintf(stream, "  /XTD-CODE:<id>                      acceptance code for 29-bit IDs (default=0x%08lx)\n", CANACC_CODE_29BIT);
@@ -0,0 +1,198 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  CAN Monitor for generic Interfaces (CAN API V3)
+//
+//  Copyright (c) 2007,2012-2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+#include "Output.h"
+
+#include <string.h>
+#include <errno.h>
+#include <chrono>
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <unistd.h>
+#else
+#include <io.h>
+#define write(fd,buf,len)  _write(fd,buf,(unsigned int)(len))
+#define fileno  _fileno
+#endif
+
+COutput::COutput(size_t nCapacity, EBacklog backlog) {
+    size_t capacity = 1U;
+    // capacity rounded up to a power of 2
+    while (capacity < nCapacity)
+        capacity <<= 1;
+    m_pRing = new SEntry[capacity];
+    m_nMask = capacity - 1U;
+    m_nHead = 0U;
+    m_nTail = 0U;
+    m_pBuffer = new char[BUFFER_SIZE];
+    m_nFile = -1;
+    m_Backlog = backlog;
+    msg_formatter_init(&m_Formatter);
+    m_fSleeping = false;
+    m_fRunning = false;
+    memset(&m_Statistics, 0, sizeof(SStatistics));
+    m_u64Skipped = 0U;
+    m_nError = 0;
+}
+
+COutput::~COutput() {
+    Stop();
+    delete[] m_pRing;
+    delete[] m_pBuffer;
+}
+
+bool COutput::Start(FILE* stream) {
+    if (m_fRunning || !stream)
+        return false;
+    // note: the formatter options are set when the writer is started
+    msg_formatter_init(&m_Formatter);
+    fflush(stream);
+    m_nFile = fileno(stream);
+    m_fRunning = true;
+    m_Writer = std::thread(&COutput::WriterThread, this);
+    return true;
+}
+
+bool COutput::Push(const can_message_t& message, uint64_t counter, const volatile int* pRunning) {
+    size_t head = m_nHead.load(std::memory_order_relaxed);
+    size_t tail = m_nTail.load(std::memory_order_acquire);
+
+    // (1) ring buffer full: the writer lags behind
+    if ((head - tail) > m_nMask) {
+        if (m_Backlog == BacklogDrop) {
+            m_Statistics.m_u64Dropped++;
+            return false;
+        }
+        m_Statistics.m_u64Waits++;
+        do {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            tail = m_nTail.load(std::memory_order_acquire);
+            // note: the caller's running flag ends the wait (e.g. on Ctrl-C)
+        } while (((head - tail) > m_nMask) && m_fRunning && (!pRunning || *pRunning));
+        if ((head - tail) > m_nMask) {
+            m_Statistics.m_u64Dropped++;
+            return false;
+        }
+    }
+    // (2) put the message into the ring buffer
+    m_pRing[head & m_nMask].m_Message = message;
+    m_pRing[head & m_nMask].m_u64Counter = counter;
+    m_nHead.store(head + 1U);
+    m_Statistics.m_u64Received++;
+    if ((head + 1U - tail) > m_Statistics.m_u64MaxBacklog)
+        m_Statistics.m_u64MaxBacklog = (uint64_t)(head + 1U - tail);
+    // (3) wake up the writer (only when it is waiting)
+    if (m_fSleeping.load()) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Signal.notify_one();
+    }
+    return true;
+}
+
+void COutput::Stop() {
+    if (!m_Writer.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_fRunning = false;
+        m_Signal.notify_one();
+    }
+    m_Writer.join();
+}
+
+void COutput::WriterThread() {
+    size_t length = 0U;
+    size_t pending = 0U;
+    size_t tail = m_nTail.load(std::memory_order_relaxed);
+    size_t head;
+    int n;
+
+    for (;;) {
+        head = m_nHead.load();
+        if (tail == head) {
+            // ring buffer empty: write the pending output, then wait
+            Commit(length, pending);
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            if (!m_fRunning && (m_nHead.load() == tail))
+                break;
+            m_fSleeping.store(true);
+            if ((m_nHead.load() == tail) && m_fRunning)
+                m_Signal.wait_for(lock, std::chrono::milliseconds(100));
+            m_fSleeping.store(false);
+            continue;
+        }
+        // format all pending messages into the output buffer
+        while (tail != head) {
+            if ((BUFFER_SIZE - length) <= (MSG_STRING_LENGTH + 1U))
+                Commit(length, pending);
+            const SEntry* entry = &m_pRing[tail & m_nMask];
+            n = msg_format_message_r(&m_Formatter, &m_pBuffer[length], BUFFER_SIZE - length - 1U,
+                                     &entry->m_Message, MSG_RX_MESSAGE, entry->m_u64Counter, 0);
+            if ((n >= 0) && ((size_t)n < (BUFFER_SIZE - length - 1U))) {
+                length += (size_t)n;
+                m_pBuffer[length++] = '\n';
+                pending++;
+            } else {
+                m_u64Skipped++;  // note: too large, counted as dropped
+            }
+            m_nTail.store(++tail, std::memory_order_release);
+        }
+    }
+}
+
+COutput::SStatistics COutput::GetStatistics() const {
+    SStatistics statistics = m_Statistics;
+    // note: the producer and the writer do not share a counter
+    statistics.m_u64Dropped += m_u64Skipped;
+    return statistics;
+}
+
+void COutput::Commit(size_t& length, size_t& pending) {
+    // the messages in the output buffer are counted as written when the
+    // buffer has been written, otherwise as dropped (after the first
+    // write error the output is discarded, the error is kept)
+    if ((m_nError.load() == 0) && Flush(length)) {
+        m_Statistics.m_u64Written += pending;
+    } else {
+        if (m_nError.load() == 0)
+            m_nError.store(errno ? errno : EIO);
+        m_u64Skipped += pending;
+        length = 0U;
+    }
+    pending = 0U;
+}
+
+bool COutput::Flush(size_t& length) {
+    size_t offset = 0U;
+    bool result = true;
+
+    while (offset < length) {
+        long n = (long)write(m_nFile, &m_pBuffer[offset], length - offset);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            result = false;  // output discarded
+            break;
+        }
+        offset += (size_t)n;
+        m_Statistics.m_u64Writes++;
+        m_Statistics.m_u64Bytes += (uint64_t)n;
+    }
+    length = 0U;
+    return result;
+}
@@ -0,0 +1,94 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  CAN Monitor for generic Interfaces (CAN API V3)
+//
+//  Copyright (c) 2007,2012-2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+#ifndef CAN_MONI_OUTPUT_H_INCLUDED
+#define CAN_MONI_OUTPUT_H_INCLUDED
+
+#include "CANAPI_Types.h"
+#include "can_msg.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/// \name   Asynchronous Output
+/// \brief  Decouples the reception of CAN messages from formatting and
+///         writing them: the reception loop only puts the messages into a
+///         ring buffer (single producer, single consumer), a writer thread
+///         formats them and writes the text in large blocks.
+/// \{
+class COutput {
+public:
+    static const size_t DEFAULT_CAPACITY = 65536U;  // messages (power of 2)
+    static const size_t BUFFER_SIZE = 262144U;  // output buffer (bytes)
+    enum EBacklog {  // when the writer lags behind:
+        BacklogWait = 0,  // wait for free space (backpressure)
+        BacklogDrop = 1   // drop the message
+    };
+    struct SStatistics {
+        uint64_t m_u64Received;  // messages put into the ring buffer
+        uint64_t m_u64Written;  // messages formatted and written
+        uint64_t m_u64Dropped;  // messages dropped (BacklogDrop, too large, or not written)
+        uint64_t m_u64Waits;  // reception stalled (BacklogWait)
+        uint64_t m_u64MaxBacklog;  // max. number of pending messages
+        uint64_t m_u64Writes;  // number of write calls
+        uint64_t m_u64Bytes;  // number of bytes written
+    };
+private:
+    struct SEntry {
+        can_message_t m_Message;
+        uint64_t m_u64Counter;
+    };
+    SEntry* m_pRing;  // ring buffer
+    size_t m_nMask;  // capacity - 1
+    std::atomic<size_t> m_nHead;  // next entry to write (producer)
+    std::atomic<size_t> m_nTail;  // next entry to read (consumer)
+    char* m_pBuffer;  // output buffer
+    int m_nFile;  // file descriptor
+    EBacklog m_Backlog;
+    msg_formatter_t m_Formatter;  // owned by the writer thread
+    std::thread m_Writer;
+    std::mutex m_Mutex;
+    std::condition_variable m_Signal;
+    std::atomic<bool> m_fSleeping;  // writer waits for messages
+    std::atomic<bool> m_fRunning;
+    SStatistics m_Statistics;  // producer and writer counters (read after Stop)
+    uint64_t m_u64Skipped;  // messages too large or not written (writer)
+    std::atomic<int> m_nError;  // error code of the first failed write
+public:
+    COutput(size_t nCapacity = DEFAULT_CAPACITY, EBacklog backlog = BacklogWait);
+    virtual ~COutput();
+
+    bool Start(FILE* stream);  // start the writer thread
+    bool Push(const can_message_t& message, uint64_t counter, const volatile int* pRunning = NULL);  // false when dropped
+    void Stop();  // write all pending messages and stop the writer thread
+
+    SStatistics GetStatistics() const;
+    int GetError() const { return m_nError.load(); }  // 0 = no write error
+private:
+    void WriterThread();
+    void Commit(size_t& length, size_t& pending);
+    bool Flush(size_t& length);
+};
+/// \}
+
+#endif  // CAN_MONI_OUTPUT_H_INCLUDED
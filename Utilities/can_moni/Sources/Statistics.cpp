@@ -0,0 +1,201 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  CAN Monitor for generic Interfaces (CAN API V3)
+//
+//  Copyright (c) 2007,2012-2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+#include "Statistics.h"
+
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <new>
+
+#define NSEC_PER_SEC  1000000000ULL
+
+
+CStatistics::CStatistics(uint32_t u32NominalSpeed, uint32_t u32DataSpeed) {
+    m_pStdEntries = new SEntry[MAX_STD_IDS];
+    m_pStdUsed = new bool[MAX_STD_IDS];
+    memset(m_pStdUsed, 0, MAX_STD_IDS * sizeof(bool));
+    m_u32StdCount = 0U;
+    if (stat_idmap_init(&m_XtdMap, XTD_SLOTS) < 0)
+        throw std::bad_alloc();
+    m_u64Frames = 0U;
+    m_u64IntervalFrames = 0U;
+    m_u64IntervalBits = 0U;
+    m_dBusLoad = 0.0;
+    m_dFrameRate = 0.0;
+    m_u32NominalSpeed = u32NominalSpeed;
+    // note: the data phase is counted in nominal bit-times
+    if (u32NominalSpeed && u32DataSpeed)
+        m_dDataRatio = (double)u32NominalSpeed / (double)u32DataSpeed;
+    else
+        m_dDataRatio = 1.0;
+}
+
+CStatistics::~CStatistics() {
+    delete[] m_pStdEntries;
+    delete[] m_pStdUsed;
+    stat_idmap_free(&m_XtdMap);
+}
+
+void CStatistics::Update(const can_message_t& message) {
+    SEntry* entry;
+    uint64_t now, delta;
+    double diff;
+
+    // (1) look up the identifier: flat array or hash table
+    if (!message.xtd) {
+        uint32_t id = message.id & CAN_MAX_STD_ID;
+        entry = &m_pStdEntries[id];
+        if (!m_pStdUsed[id]) {
+            Reset(entry, id, false);
+            m_pStdUsed[id] = true;
+            m_u32StdCount++;
+        }
+    } else {
+        entry = Lookup(message.id);
+    }
+    // (2) inter-arrival time: min, max, mean and variance (Welford)
+    now = (uint64_t)message.timestamp.tv_sec * NSEC_PER_SEC + (uint64_t)message.timestamp.tv_nsec;
+    if (entry->m_u64Count && (now >= entry->m_u64Last)) {
+        delta = now - entry->m_u64Last;
+        if (delta < entry->m_u64Min)
+            entry->m_u64Min = delta;
+        if (delta > entry->m_u64Max)
+            entry->m_u64Max = delta;
+        entry->m_u64Samples++;
+        diff = (double)delta - entry->m_dMean;
+        entry->m_dMean += diff / (double)entry->m_u64Samples;
+        entry->m_dM2 += diff * ((double)delta - entry->m_dMean);
+    }
+    entry->m_u64Last = now;
+    // (3) DLC changes and last payload
+    if (entry->m_u64Count && (entry->m_u8Dlc != message.dlc))
+        entry->m_u64DlcChanges++;
+    entry->m_u8Dlc = message.dlc;
+    entry->m_fRtr = message.rtr ? true : false;
+    if (!message.rtr)
+        memcpy(entry->m_au8Data, message.data, CANFD_DLC2LEN(message.dlc & 0xFU));
+    // (4) counters and bit-times
+    delta = stat_frame_bits(&message, m_dDataRatio);
+    entry->m_u64Count++;
+    entry->m_u64Frames++;
+    entry->m_u64Bits += delta;
+    m_u64Frames++;
+    m_u64IntervalFrames++;
+    m_u64IntervalBits += delta;
+}
+
+void CStatistics::Evaluate(double dInterval) {
+    SEntry* entry;
+    size_t i;
+
+    if (dInterval <= 0.0)
+        return;
+    for (i = 0U; i < (MAX_STD_IDS + m_XtdEntries.size()); i++) {
+        if (i < MAX_STD_IDS) {
+            if (!m_pStdUsed[i])
+                continue;
+            entry = &m_pStdEntries[i];
+        } else {
+            entry = &m_XtdEntries[i - MAX_STD_IDS];
+        }
+        entry->m_dRate = (double)entry->m_u64Frames / dInterval;
+        entry->m_dShare = m_u64IntervalBits ? ((double)entry->m_u64Bits * 100.0) / (double)m_u64IntervalBits : 0.0;
+        entry->m_u64Frames = 0U;
+        entry->m_u64Bits = 0U;
+    }
+    m_dFrameRate = (double)m_u64IntervalFrames / dInterval;
+    m_dBusLoad = m_u32NominalSpeed ? ((double)m_u64IntervalBits * 100.0) / ((double)m_u32NominalSpeed * dInterval) : 0.0;
+    m_u64IntervalFrames = 0U;
+    m_u64IntervalBits = 0U;
+}
+
+void CStatistics::Print(FILE* stream, bool fRefresh) {
+    std::vector<const SEntry*> xtd;
+    uint32_t i;
+
+    if (!stream)
+        return;
+    // (1) header: clear the screen on a terminal
+    if (fRefresh)
+        fputs("\033[H\033[2J", stream);
+    fprintf(stream, "Frames: %llu, %.1f frame(s)/s, Identifiers: %u (11-bit), %u (29-bit)",
+        (unsigned long long)m_u64Frames, m_dFrameRate, m_u32StdCount, (unsigned)m_XtdEntries.size());
+    if (m_u32NominalSpeed)
+        fprintf(stream, ", Bus-load: %.1f%% of %.0fkbps\n", m_dBusLoad, (double)m_u32NominalSpeed / 1000.);
+    else
+        fprintf(stream, "\n");
+    fprintf(stream, "  CAN-ID       Count  Rate[1/s]   Min[ms]   Avg[ms]   Max[ms] Jitter[ms] DLC-chg Load[%%]  Last payload\n");
+    // (2) 11-bit identifiers in ascending order
+    for (i = 0U; i < MAX_STD_IDS; i++) {
+        if (m_pStdUsed[i])
+            PrintEntry(stream, &m_pStdEntries[i]);
+    }
+    // (3) 29-bit identifiers in ascending order
+    xtd.reserve(m_XtdEntries.size());
+    for (i = 0U; i < (uint32_t)m_XtdEntries.size(); i++)
+        xtd.push_back(&m_XtdEntries[i]);
+    std::sort(xtd.begin(), xtd.end(), [](const SEntry* a, const SEntry* b) { return a->m_u32Id < b->m_u32Id; });
+    for (i = 0U; i < (uint32_t)xtd.size(); i++)
+        PrintEntry(stream, xtd[i]);
+    fflush(stream);
+}
+
+CStatistics::SEntry* CStatistics::Lookup(uint32_t u32Id) {
+    size_t index;
+    int rc;
+
+    // the identifier map yields the index of the entry (new ones are appended)
+    if ((rc = stat_idmap_lookup(&m_XtdMap, u32Id, &index)) < 0)
+        throw std::bad_alloc();
+    if (rc > 0) {
+        m_XtdEntries.resize(index + 1U);
+        Reset(&m_XtdEntries[index], u32Id, true);
+    }
+    return &m_XtdEntries[index];
+}
+
+void CStatistics::Reset(SEntry* entry, uint32_t u32Id, bool fXtd) {
+    memset(entry, 0, sizeof(SEntry));
+    entry->m_u32Id = u32Id;
+    entry->m_fXtd = fXtd;
+    entry->m_u64Min = UINT64_MAX;
+}
+
+void CStatistics::PrintEntry(FILE* stream, const SEntry* entry) {
+    uint8_t length = entry->m_fRtr ? 0U : (uint8_t)CANFD_DLC2LEN(entry->m_u8Dlc & 0xFU);
+    uint8_t i;
+
+    fprintf(stream, entry->m_fXtd ? "%08X" : "%8X", entry->m_u32Id);
+    fprintf(stream, " %11llu %10.1f", (unsigned long long)entry->m_u64Count, entry->m_dRate);
+    if (entry->m_u64Samples)
+        fprintf(stream, " %9.3f %9.3f %9.3f %10.3f",
+            (double)entry->m_u64Min / 1000000., entry->m_dMean / 1000000., (double)entry->m_u64Max / 1000000.,
+            sqrt(entry->m_dM2 / (double)entry->m_u64Samples) / 1000000.);
+    else
+        fprintf(stream, " %9s %9s %9s %10s", "-", "-", "-", "-");
+    fprintf(stream, " %7llu %7.1f  [%u]", (unsigned long long)entry->m_u64DlcChanges, entry->m_dShare, entry->m_u8Dlc);
+    if (entry->m_fRtr)
+        fprintf(stream, " RTR");
+    for (i = 0U; (i < length) && (i < CAN_MAX_LEN); i++)
+        fprintf(stream, " %02X", entry->m_au8Data[i]);
+    if (length > CAN_MAX_LEN)
+        fprintf(stream, " ...");
+    fprintf(stream, "\n");
+}
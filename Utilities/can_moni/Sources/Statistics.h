@@ -0,0 +1,90 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  CAN Monitor for generic Interfaces (CAN API V3)
+//
+//  Copyright (c) 2007,2012-2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+#ifndef CAN_MONI_STATISTICS_H_INCLUDED
+#define CAN_MONI_STATISTICS_H_INCLUDED
+
+#include "CANAPI_Types.h"
+#include "can_stat.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+/// \name   Per-ID Statistics
+/// \brief  Collects statistics per CAN identifier: count, rate, inter-arrival
+///         time (min/avg/max), jitter (standard deviation of the inter-arrival
+///         time), DLC changes, last payload and the share of the bus-load.
+///         11-bit identifiers are held in a flat array, 29-bit identifiers
+///         in an open-addressing hash table; so it is O(1) per frame.
+/// \{
+class CStatistics {
+public:
+    static const uint32_t MAX_STD_IDS = 2048U;  // 11-bit identifier
+    static const size_t XTD_SLOTS = 4096U;  // initial hash table size (power of 2)
+    struct SEntry {
+        uint32_t m_u32Id;  // CAN identifier
+        bool m_fXtd;  // extended format
+        bool m_fRtr;  // remote frame (last)
+        uint8_t m_u8Dlc;  // data length code (last)
+        uint8_t m_au8Data[CANFD_MAX_LEN];  // payload (last)
+        uint64_t m_u64Count;  // number of frames (total)
+        uint64_t m_u64Frames;  // number of frames (current interval)
+        uint64_t m_u64Bits;  // bit-times (current interval)
+        uint64_t m_u64DlcChanges;  // number of DLC changes
+        uint64_t m_u64Samples;  // number of inter-arrival times
+        uint64_t m_u64Last;  // time-stamp of the last frame (in [ns])
+        uint64_t m_u64Min;  // min. inter-arrival time (in [ns])
+        uint64_t m_u64Max;  // max. inter-arrival time (in [ns])
+        double m_dMean;  // mean inter-arrival time (in [ns])
+        double m_dM2;  // sum of squared differences (Welford)
+        double m_dRate;  // frames per second (last interval)
+        double m_dShare;  // share of the bit-times (last interval)
+    };
+private:
+    SEntry* m_pStdEntries;  // flat array for 11-bit identifiers
+    bool* m_pStdUsed;  // identifier seen
+    uint32_t m_u32StdCount;  // number of 11-bit identifiers
+    std::vector<SEntry> m_XtdEntries;  // entries for 29-bit identifiers
+    stat_idmap_t m_XtdMap;  // hash table: identifier to index
+    uint64_t m_u64Frames;  // number of frames (total)
+    uint64_t m_u64IntervalFrames;  // number of frames (current interval)
+    uint64_t m_u64IntervalBits;  // bit-times (current interval)
+    double m_dBusLoad;  // bus-load in percent (last interval)
+    double m_dFrameRate;  // frames per second (last interval)
+    uint32_t m_u32NominalSpeed;  // nominal bit-rate (0 = unknown)
+    double m_dDataRatio;  // nominal / data bit-rate (CAN FD with BRS)
+public:
+    CStatistics(uint32_t u32NominalSpeed = 0U, uint32_t u32DataSpeed = 0U);
+    virtual ~CStatistics();
+
+    void Update(const can_message_t& message);  // O(1) per frame
+    void Evaluate(double dInterval);  // end of an interval (in [s])
+    void Print(FILE* stream, bool fRefresh);  // print the table
+
+    uint64_t GetFrames() const { return m_u64Frames; }
+    size_t GetIdentifiers() const { return (size_t)m_u32StdCount + m_XtdEntries.size(); }
+private:
+    SEntry* Lookup(uint32_t u32Id);  // 29-bit identifier (inserts)
+    static void Reset(SEntry* entry, uint32_t u32Id, bool fXtd);
+    static void PrintEntry(FILE* stream, const SEntry* entry);
+};
+/// \}
+
+#endif  // CAN_MONI_STATISTICS_H_INCLUDED
@@ -21,6 +21,10 @@
 #include "Options.h"
 #include "Message.h"
 #include "Timer.h"
+#include "Output.h"
+#include "Statistics.h"
+#include "can_cap.h"
+#include "can_pcapng.h"
 #if (SERIAL_CAN_SUPPORTED != 0)
 #include "SerialCAN_Defines.h"
 #endif
@@ -32,6 +36,13 @@
 #include <signal.h>
 #include <errno.h>
 #include <time.h>
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <unistd.h>
+#else
+#include <io.h>
+#define isatty  _isatty
+#define fileno  _fileno
+#endif
 
 #include <inttypes.h>
 
@@ -60,7 +71,8 @@ static int get_exclusion(const char* arg);
 
 class CCanDevice : public CCanDriver {
 public:
-    uint64_t ReceptionLoop();
+    uint64_t ReceptionLoop(cap_writer_t capture = NULL, pcapng_writer_t pcapng = NULL, bool dropOnBacklog = false);
+    uint64_t StatisticsLoop(uint32_t interval);
 public:
     int ListCanDevices(void);
     int TestCanDevices(CANAPI_OpMode_t opMode);
@@ -87,6 +99,10 @@ int main(int argc, const char* argv[]) {
     CANAPI_Return_t retVal = CANERR_FATAL;
     char property[CANPROP_MAX_BUFFER_SIZE] = "";
     char* string = NULL;
+    cap_writer_t capture = NULL;
+    pcapng_writer_t pcapng = NULL;
+    pcapng_param_t pcapngParam;
+    uint64_t frames = 0U;
 
     /* device parameter */
     void* devParam = NULL;
@@ -314,8 +330,48 @@ int main(int argc, const char* argv[]) {
         goto teardown;
     }
     fprintf(stdout, "OK!\n");
+    /* - capture file (optional) */
+    if (opts.m_szCaptureFile) {
+        if ((capture = cap_create(opts.m_szCaptureFile, 0U)) == NULL) {
+            fprintf(stderr, "+++ error: capture file '%s' could not be created (%s)\n", opts.m_szCaptureFile, strerror(errno));
+            goto teardown;
+        }
+    }
+    /* - pcapng file (optional) */
+    if (opts.m_szPcapngFile) {
+        pcapngParam.application = CAN_MONI_APPLICATION;
+        pcapngParam.buffer_size = 0U;
+        pcapngParam.rotate_size = opts.m_u64RotateSize;
+        pcapngParam.rotate_time = opts.m_u32RotateTime;
+        if (((pcapng = pcapng_create(opts.m_szPcapngFile, &pcapngParam)) == NULL) ||
+            (pcapng_add_interface(pcapng, opts.m_szInterface) < 0)) {
+            fprintf(stderr, "+++ error: pcapng file '%s' could not be created (%s)\n", opts.m_szPcapngFile, strerror(errno));
+            if (pcapng)
+                (void)pcapng_close(pcapng);
+            if (capture)
+                (void)cap_finish(capture);
+            goto teardown;
+        }
+    }
     /* - reception loop */
-    canDevice.ReceptionLoop();
+    if (opts.m_u32Statistics)
+        frames = canDevice.StatisticsLoop(opts.m_u32Statistics);
+    else
+        frames = canDevice.ReceptionLoop(capture, pcapng, opts.m_fBacklogDrop);
+    /* - close the capture file (writes the index) */
+    if (capture) {
+        if (cap_finish(capture) < 0)
+            fprintf(stderr, "+++ error: capture file '%s' could not be written (%s)\n", opts.m_szCaptureFile, strerror(errno));
+        else
+            fprintf(stdout, "Captured: %" PRIu64 " message(s) to '%s'\n", frames, opts.m_szCaptureFile);
+    }
+    /* - close the pcapng file (writes the buffered blocks) */
+    if (pcapng) {
+        if (pcapng_close(pcapng) < 0)
+            fprintf(stderr, "+++ error: pcapng file '%s' could not be written (%s)\n", opts.m_szPcapngFile, strerror(errno));
+        else
+            fprintf(stdout, "Captured: %" PRIu64 " message(s) to '%s'\n", frames, opts.m_szPcapngFile);
+    }
     /* - show interface information */
     if ((string = canDevice.GetHardwareVersion()) != NULL)
         fprintf(stdout, "Hardware: %s\n", string);
@@ -644,28 +700,94 @@ bool CCanDevice::WriteJsonFile(const char* filename) {
 #endif
 
 /*  Reception loop: count received CAN messages until Ctrl-C
+ *  - capture: record into a capture file instead of displaying (or NULL)
+ *  - pcapng: record into a pcapng file instead of displaying (or NULL)
  */
-uint64_t CCanDevice::ReceptionLoop() {
+uint64_t CCanDevice::ReceptionLoop(cap_writer_t capture, pcapng_writer_t pcapng, bool dropOnBacklog) {
     CANAPI_Message_t message;
     CANAPI_Return_t retVal;
     uint64_t frames = 0U;
 
-    char string[CANPROP_MAX_STRING_LENGTH+1];
-    memset(string, 0, CANPROP_MAX_STRING_LENGTH+1);
+    // note: messages are formatted and written by a writer thread
+    COutput output(COutput::DEFAULT_CAPACITY, dropOnBacklog ? COutput::BacklogDrop : COutput::BacklogWait);
 
     fprintf(stderr, "\nPress ^C to abort.\n\n");
+    if (!capture && !pcapng && !output.Start(stdout)) {
+        fprintf(stderr, "+++ error: output thread could not be started\n");
+        return frames;
+    }
     while(running) {
         if ((retVal = ReadMessage(message)) == CCanApi::NoError) {
             if ((((message.id < MAX_ID) && can_id[message.id]) || ((message.id >= MAX_ID) && can_id_xtd))) {
-                (void)CCanMessage::Format(message, ++frames, string, CANPROP_MAX_STRING_LENGTH);
-                fprintf(stdout, "%s\n", string);
+                if (capture || pcapng) {
+                    if (capture && (cap_write(capture, &message) < 0)) {
+                        fprintf(stderr, "+++ error: capture file could not be written (%s)\n", strerror(errno));
+                        break;
+                    }
+                    if (pcapng && (pcapng_write(pcapng, 0, &message) < 0)) {
+                        fprintf(stderr, "+++ error: pcapng file could not be written (%s)\n", strerror(errno));
+                        break;
+                    }
+                    frames++;
+                    continue;
+                }
+                (void)output.Push(message, ++frames, &running);
             }
         }
+        if (output.GetError()) {
+            fprintf(stderr, "+++ error: output could not be written (%s)\n", strerror(output.GetError()));
+            break;
+        }
+    }
+    if (!capture && !pcapng) {
+        output.Stop();
+        COutput::SStatistics stats = output.GetStatistics();
+        if (stats.m_u64Dropped || stats.m_u64Waits)
+            fprintf(stderr, "Output: %" PRIu64 " message(s) written, %" PRIu64 " dropped, %" PRIu64 " wait(s) (max. backlog %" PRIu64 ")\n",
+                    stats.m_u64Written, stats.m_u64Dropped, stats.m_u64Waits, stats.m_u64MaxBacklog);
     }
     fprintf(stdout, "\n");
     return frames;
 }
 
+uint64_t CCanDevice::StatisticsLoop(uint32_t interval) {
+    CANAPI_Message_t message;
+    CANAPI_Return_t retVal;
+    CANAPI_BusSpeed_t speed;
+    uint32_t nominal = 0U, data = 0U;
+
+    // note: the bus-load is only shown when the bus speed is known
+    if (GetBusSpeed(speed) == CCanApi::NoError) {
+        nominal = (uint32_t)speed.nominal.speed;
+#if (OPTION_CAN_2_0_ONLY == 0)
+        data = (uint32_t)speed.data.speed;
+#endif
+    }
+    CStatistics statistics(nominal, data);
+    CTimer timer(interval * CTimer::SEC);
+    struct timespec start = CTimer::GetTime();
+    struct timespec now;
+    bool refresh = isatty(fileno(stdout)) ? true : false;
+
+    fprintf(stderr, "\nPress ^C to abort.\n\n");
+    while(running) {
+        if ((retVal = ReadMessage(message, 100U)) == CCanApi::NoError) {
+            if (!message.sts &&
+                (((message.id < MAX_ID) && can_id[message.id]) || ((message.id >= MAX_ID) && can_id_xtd)))
+                statistics.Update(message);
+        }
+        if (timer.Timeout()) {
+            now = CTimer::GetTime();
+            statistics.Evaluate(CTimer::DiffTime(start, now));
+            statistics.Print(stdout, refresh);
+            (void)timer.Restart(interval * CTimer::SEC);
+            start = now;
+        }
+    }
+    fprintf(stdout, "\n");
+    return statistics.GetFrames();
+}
+
 // FIXME: matured code from can_moni for BerliOS SocketCAN
 static int get_exclusion(const char* arg)
 {
@@ -0,0 +1,192 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  Trace Replay for CAN-over-Serial-Line Interfaces (Lawicel protocol)
+//
+//  Copyright (c) 2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+#include "replay.h"
+#include "slcan.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <signal.h>
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+
+#if defined(__linux__)
+#define PLATFORM  "Linux"
+#elif defined(__APPLE__)
+#define PLATFORM  "macOS"
+#else
+#error Platform not supported
+#endif
+
+#define APPLICATION  "Trace Replay for CAN-over-Serial-Line Interfaces, Version 0.1"
+#define COPYRIGHT    "Copyright (c) 2024 by Uwe Vogt, UV Software, Berlin"
+
+#define QUEUE_SIZE   256U               // reception queue (received frames are discarded)
+
+static const struct {                   // bit-rates supported by SLCAN:
+    uint32_t kbps;                      //   bit-rate (in [kbit/s])
+    uint8_t index;                      //   SLCAN bit-rate index
+}   bitrates[] = {
+    { 10U, CAN_10K }, { 20U, CAN_20K }, { 50U, CAN_50K }, { 100U, CAN_100K },
+    { 125U, CAN_125K }, { 250U, CAN_250K }, { 500U, CAN_500K }, { 800U, CAN_800K },
+    { 1000U, CAN_1000K }
+};
+
+static replay_t replay = NULL;
+
+static void sigterm(int signo);
+static void usage(FILE *stream, const char *program);
+
+int main(int argc, const char *argv[]) {
+    replay_param_t param = { 1.0, 100U, 0U, REPLAY_TIME_ABSOLUTE };
+    replay_stats_t stats;
+    slcan_attr_t attr = { 115200U, BYTESIZE8, PARITYNONE, STOPBITS1, 0U };
+    slcan_port_t port = NULL;
+    uint32_t kbps = 250U;
+    int index = -1;
+    int opt, res;
+
+    struct option long_options[] = {
+        {"baudrate", required_argument, 0, 'b'},
+        {"speed", required_argument, 0, 's'},
+        {"time", required_argument, 0, 't'},
+        {"spin", required_argument, 0, 'p'},
+        {"window", required_argument, 0, 'w'},
+        {"uart", required_argument, 0, 'u'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+    while ((opt = getopt_long(argc, (char * const *)argv, "b:s:t:p:w:u:h", long_options, NULL)) != -1) {
+        switch (opt) {
+        case 'b': kbps = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 's': param.speed = strtod(optarg, NULL); break;
+        case 'p': param.spin = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'w': param.window = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'u': attr.baudrate = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 't':
+            if (!strcasecmp(optarg, "ABS") || !strcasecmp(optarg, "ZERO"))
+                param.time_mode = REPLAY_TIME_ABSOLUTE;
+            else if (!strcasecmp(optarg, "REL"))
+                param.time_mode = REPLAY_TIME_RELATIVE;
+            else {
+                fprintf(stderr, "+++ error: illegal argument for option `--time' (%s)\n", optarg);
+                return 1;
+            }
+            break;
+        case 'h':
+            usage(stdout, argv[0]);
+            return 0;
+        default:
+            usage(stderr, argv[0]);
+            return 1;
+        }
+    }
+    if ((argc - optind) != 2) {
+        usage(stderr, argv[0]);
+        return 1;
+    }
+    for (size_t i = 0U; i < (sizeof(bitrates) / sizeof(bitrates[0])); i++)
+        if (bitrates[i].kbps == kbps)
+            index = (int)bitrates[i].index;
+    if ((index < 0) || (param.speed < 0.0)) {
+        fprintf(stderr, "+++ error: illegal bit-rate or playback speed\n");
+        return 1;
+    }
+    fprintf(stdout, "%s (%s)\n%s\n\n", APPLICATION, PLATFORM, COPYRIGHT);
+    if (signal(SIGINT, sigterm) == SIG_ERR ||
+        signal(SIGTERM, sigterm) == SIG_ERR) {
+        perror("+++ error");
+        return 1;
+    }
+    /* (1) map the trace file into memory */
+    fprintf(stdout, "Trace=%s...", argv[optind + 1]);
+    fflush(stdout);
+    if ((replay = replay_open(argv[optind + 1])) == NULL) {
+        fprintf(stdout, "FAILED!\n");
+        perror("+++ error");
+        return 1;
+    }
+    fprintf(stdout, "OK!\n");
+    /* (2) open the SLCAN channel */
+    fprintf(stdout, "Hardware=%s...", argv[optind]);
+    fflush(stdout);
+    if (((port = slcan_create(QUEUE_SIZE)) == NULL) ||
+        (slcan_connect(port, argv[optind], &attr) < 0) ||
+        (slcan_setup_bitrate(port, (uint8_t)index) < 0) ||
+        (slcan_open_channel(port) < 0)) {
+        fprintf(stdout, "FAILED!\n");
+        perror("+++ error");
+        goto teardown;
+    }
+    fprintf(stdout, "OK!\n");
+    fprintf(stdout, "Baudrate=%" PRIu32 "kbps\n", kbps);
+    if (param.speed > 0.0)
+        fprintf(stdout, "Speed=%gx (spin %" PRIu32 "us, window %" PRIu32 "us)\n", param.speed, param.spin, param.window);
+    else
+        fprintf(stdout, "Speed=unlimited\n");
+    fprintf(stdout, "Press ^C to abort.\n\n");
+    /* (3) replay the trace */
+    res = replay_run(replay, port, &param, &stats);
+    if (res < 0)
+        perror("+++ error");
+    fprintf(stdout, "Frames=%" PRIu64 " (batches %" PRIu64 ", errors %" PRIu64 ", skipped %" PRIu64 ")\n",
+            stats.frames, stats.batches, stats.errors, stats.skipped);
+    fprintf(stdout, "Duration=%.6fs\n", (double)stats.duration / 1e9);
+    fprintf(stdout, "Timing error [us]: min=%.3f mean=%.3f max=%.3f\n",
+            (double)stats.min / 1e3, stats.mean / 1e3, (double)stats.max / 1e3);
+    fprintf(stdout, "Timing error [us]: p50=%.3f p90=%.3f p99=%.3f p99.9=%.3f\n",
+            (double)stats.p50 / 1e3, (double)stats.p90 / 1e3, (double)stats.p99 / 1e3, (double)stats.p999 / 1e3);
+teardown:
+    if (port) {
+        (void)slcan_close_channel(port);
+        (void)slcan_disconnect(port);
+        (void)slcan_destroy(port);
+    }
+    (void)replay_close(replay);
+    return 0;
+}
+
+static void sigterm(int signo) {
+    (void)signo;
+    (void)replay_stop(replay);
+}
+
+static void usage(FILE *stream, const char *program) {
+    fprintf(stream, "%s (%s)\n%s\n\n", APPLICATION, PLATFORM, COPYRIGHT);
+    fprintf(stream, "Usage: %s <interface> <trace-file> [<option>...]\n", strrchr(program, '/') ? strrchr(program, '/') + 1 : program);
+    fprintf(stream, "Options:\n");
+    fprintf(stream, " -b, --baudrate=<baudrate>            CAN bit-timing in kbps (default=250)\n");
+    fprintf(stream, " -s, --speed=<factor>                 playback speed (default=1.0, 0 = as fast as possible)\n");
+    fprintf(stream, " -t, --time=(ZERO|ABS|REL)            time-stamps of the trace (default=ABS)\n");
+    fprintf(stream, " -p, --spin=<us>                      busy-wait before each deadline (default=100)\n");
+    fprintf(stream, " -w, --window=<us>                    merge frames within into one serial write (default=0)\n");
+    fprintf(stream, " -u, --uart=<baudrate>                baud rate of the serial port (default=115200)\n");
+    fprintf(stream, " -h, --help                           display this help screen and exit\n");
+    fprintf(stream, "Trace file:\n");
+    fprintf(stream, "  capture file of can_moni, e.g. `can_moni <interface> --capture=<trace-file>'\n");
+    fprintf(stream, "  text output of can_moni, e.g. `can_moni <interface> --time=ZERO > <trace-file>'\n");
+}
@@ -0,0 +1,445 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  Trace Replay for CAN-over-Serial-Line Interfaces (Lawicel protocol)
+//
+//  Copyright (c) 2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+#include "replay.h"
+#include "can_cap.h"
+#include "can_stat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define NSEC_PER_SEC  1000000000ULL
+#define NSEC_PER_DAY  (86400ULL * NSEC_PER_SEC)
+#define NSEC_PER_USEC  1000ULL
+
+#define START_DELAY  (10ULL * 1000000ULL)  // lead time before the first frame (10ms)
+
+#define MAX_TOKENS  (5U + CAN_LEN_MAX)  // [counter] time id flags dlc data (the rest is ignored)
+
+typedef struct replay_frame_t_ {        // frame from the trace:
+    slcan_message_t message;            //   CAN message
+    uint64_t time;                      //   trace time (in [ns])
+}   replay_frame_t;
+
+typedef struct replay_ {                // trace replay:
+    cap_reader_t capture;               //   capture file (or NULL)
+    const char *data;                   //   trace file (mapped into memory)
+    size_t size;                        //   size of the trace file
+    size_t offset;                      //   read position
+    volatile int stop;                  //   stop request
+    stat_histo_t histogram;             //   timing errors (log-linear buckets)
+}   replay_object_t;
+
+static bool next_frame(replay_object_t *replay, int time_mode, uint64_t *last, replay_frame_t *frame, uint64_t *skipped);
+static bool next_record(replay_object_t *replay, replay_frame_t *frame, uint64_t *skipped);
+static bool parse_line(const char *line, size_t length, slcan_message_t *message, uint64_t *time);
+static bool parse_time(const char *token, size_t length, uint64_t *time);
+static void wait_until(uint64_t deadline, uint64_t spin);
+static uint64_t now_ns(void);
+
+replay_t replay_open(const char *filename) {
+    replay_object_t *replay = NULL;
+    cap_reader_t capture;
+    struct stat st;
+    int fd;
+
+    errno = 0;
+    if (!filename) {
+        errno = EINVAL;
+        return NULL;
+    }
+    /* a capture file of can_moni (option '--capture') */
+    if ((capture = cap_open(filename)) != NULL) {
+        if ((replay = (replay_object_t*)calloc(1, sizeof(replay_object_t))) == NULL) {
+            (void)cap_close(capture);
+            return NULL;
+        }
+        replay->capture = capture;
+        return (replay_t)replay;
+    }
+    if (errno != EBADMSG)
+        return NULL;
+    /* otherwise a text trace of can_moni */
+    errno = 0;
+    if ((fd = open(filename, O_RDONLY)) < 0)
+        return NULL;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return NULL;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        errno = ENODATA;
+        return NULL;
+    }
+    if ((replay = (replay_object_t*)calloc(1, sizeof(replay_object_t))) == NULL) {
+        close(fd);
+        return NULL;
+    }
+    replay->size = (size_t)st.st_size;
+    replay->data = (const char*)mmap(NULL, replay->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // the mapping is kept
+    if (replay->data == (const char*)MAP_FAILED) {
+        free(replay);
+        return NULL;
+    }
+    /* note: the trace is streamed from begin to end */
+    (void)madvise((void*)replay->data, replay->size, MADV_SEQUENTIAL);
+    return (replay_t)replay;
+}
+
+int replay_close(replay_t handle) {
+    replay_object_t *replay = (replay_object_t*)handle;
+
+    errno = 0;
+    if (!replay) {
+        errno = ENODEV;
+        return -1;
+    }
+    if (replay->capture)
+        (void)cap_close(replay->capture);
+    else
+        (void)munmap((void*)replay->data, replay->size);
+    free(replay);
+    return 0;
+}
+
+int replay_stop(replay_t handle) {
+    replay_object_t *replay = (replay_object_t*)handle;
+
+    errno = 0;
+    if (!replay) {
+        errno = ENODEV;
+        return -1;
+    }
+    replay->stop = 1;
+    return 0;
+}
+
+int replay_run(replay_t handle, slcan_port_t port, const replay_param_t *param, replay_stats_t *stats) {
+    replay_object_t *replay = (replay_object_t*)handle;
+    replay_param_t defaults = { 1.0, 100U, 0U, REPLAY_TIME_ABSOLUTE };
+    replay_stats_t result;
+    replay_frame_t pending;
+    slcan_message_t batch[REPLAY_MAX_BATCH];
+    uint64_t deadlines[REPLAY_MAX_BATCH];
+    uint64_t last = 0U, first = 0U, start, spin, window, now;
+    double sum = 0.0;
+    bool have;
+    int res = 0;
+
+    errno = 0;
+    if (!replay) {
+        errno = ENODEV;
+        return -1;
+    }
+    memset(&pending, 0, sizeof(replay_frame_t));
+    if (!port || (param && (param->speed < 0.0))) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!param)
+        param = &defaults;
+    memset(&result, 0, sizeof(replay_stats_t));
+    stat_histo_reset(&replay->histogram);
+    result.min = INT64_MAX;
+    result.max = INT64_MIN;
+    spin = (uint64_t)param->spin * NSEC_PER_USEC;
+    window = (uint64_t)param->window * NSEC_PER_USEC;
+    replay->offset = 0U;
+    replay->stop = 0;
+    if (replay->capture && (cap_seek(replay->capture, CAP_TIME_BEGIN) < 0))
+        return -1;
+
+    /* the first frame defines the time base */
+    have = next_frame(replay, param->time_mode, &last, &pending, &result.skipped);
+    first = pending.time;
+    start = now_ns() + ((param->speed > 0.0) ? START_DELAY : 0U);
+    while (have && !replay->stop) {
+        size_t n = 0U;
+        /* collect frames whose deadlines fall into the batch window */
+        do {
+            uint64_t offset = pending.time - first;
+            batch[n] = pending.message;
+            deadlines[n] = start + ((param->speed > 0.0) ? (uint64_t)((double)offset / param->speed) : 0U);
+            n++;
+            have = next_frame(replay, param->time_mode, &last, &pending, &result.skipped);
+        } while (have && (n < REPLAY_MAX_BATCH) &&
+                 ((param->speed <= 0.0) ||
+                  ((start + (uint64_t)((double)(pending.time - first) / param->speed)) <= (deadlines[0] + window))));
+        /* sleep until shortly before the deadline, then spin */
+        if (param->speed > 0.0)
+            wait_until(deadlines[0], spin);
+        now = now_ns();
+        for (size_t i = 0U; i < n; i++) {
+            int64_t error = (int64_t)(now - deadlines[i]);
+            if (error < result.min) result.min = error;
+            if (error > result.max) result.max = error;
+            sum += (double)error;
+            stat_histo_record(&replay->histogram, (error > 0) ? (uint64_t)error : 0U);
+        }
+        /* transmit the batch (resubmit from the first unanswered frame) */
+        for (size_t sent = 0U; sent < n; ) {
+            size_t rejected = 0U;
+            int rc = slcan_write_messages(port, &batch[sent], n - sent, 0U, &rejected);
+            if (rc > 0) {
+                sent += (size_t)rc;
+                result.errors += rejected;  // frames rejected by the device (NAK)
+            } else if ((errno == EBADMSG) || (errno == ETIMEDOUT)) {
+                result.errors++;  // skip the frame that was not answered
+                sent++;
+            } else {
+                res = -1;
+                replay->stop = 1;
+                break;
+            }
+        }
+        result.frames += n;
+        result.batches++;
+    }
+    now = now_ns();
+    result.duration = (now > start) ? (now - start) : 0U;
+    if (result.frames) {
+        result.mean = sum / (double)result.frames;
+        result.p50 = stat_histo_percentile(&replay->histogram, 50.0);
+        result.p90 = stat_histo_percentile(&replay->histogram, 90.0);
+        result.p99 = stat_histo_percentile(&replay->histogram, 99.0);
+        result.p999 = stat_histo_percentile(&replay->histogram, 99.9);
+    } else {
+        result.min = result.max = 0;
+    }
+    if (stats)
+        memcpy(stats, &result, sizeof(replay_stats_t));
+    return res;
+}
+
+static bool next_frame(replay_object_t *replay, int time_mode, uint64_t *last, replay_frame_t *frame, uint64_t *skipped) {
+    uint64_t time;
+
+    if (replay->capture) {
+        /* note: time-stamps of a capture are always absolute */
+        if (!next_record(replay, frame, skipped))
+            return false;
+        if (frame->time < *last)
+            frame->time = *last;  // out of order, replay it immediately
+        *last = frame->time;
+        return true;
+    }
+    while (replay->offset < replay->size) {
+        const char *line = &replay->data[replay->offset];
+        const char *end = memchr(line, '\n', replay->size - replay->offset);
+        size_t length = end ? (size_t)(end - line) : (replay->size - replay->offset);
+
+        replay->offset += length + (end ? 1U : 0U);
+        if (!parse_line(line, length, &frame->message, &time)) {
+            if (length && skipped)
+                (*skipped)++;
+            continue;
+        }
+        if (time_mode == REPLAY_TIME_RELATIVE) {
+            /* time-stamp relative to the previous frame */
+            time += *last;
+        } else if ((time < *last) && ((*last - time) > (NSEC_PER_DAY / 2U))) {
+            /* wrap-around at midnight (format 'hh:mm:ss') */
+            while (time < *last)
+                time += NSEC_PER_DAY;
+        } else if (time < *last) {
+            /* note: out of order, replay it immediately */
+            time = *last;
+        }
+        frame->time = *last = time;
+        return true;
+    }
+    return false;
+}
+
+static bool next_record(replay_object_t *replay, replay_frame_t *frame, uint64_t *skipped) {
+    can_message_t message;
+
+    while (cap_read(replay->capture, &message) == 0) {
+        /* status messages and CAN FD frames cannot be transmitted */
+#if (OPTION_CAN_2_0_ONLY == 0)
+        if (message.sts || message.fdf || (message.dlc > CAN_DLC_MAX)) {
+#else
+        if (message.sts || (message.dlc > CAN_DLC_MAX)) {
+#endif
+            if (skipped)
+                (*skipped)++;
+            continue;
+        }
+        memset(&frame->message, 0, sizeof(slcan_message_t));
+        frame->message.can_id = message.id;
+        if (message.xtd)
+            frame->message.can_id |= CAN_XTD_FRAME;
+        if (message.rtr)
+            frame->message.can_id |= CAN_RTR_FRAME;
+        frame->message.can_dlc = message.dlc;
+        if (!message.rtr)
+            memcpy(frame->message.data, message.data, message.dlc);
+        frame->time = ((uint64_t)message.timestamp.tv_sec * NSEC_PER_SEC) + (uint64_t)message.timestamp.tv_nsec;
+        return true;
+    }
+    /* note: ENOMSG at the end of the capture */
+    return false;
+}
+
+static bool parse_line(const char *line, size_t length, slcan_message_t *message, uint64_t *time) {
+    const char *token[MAX_TOKENS];
+    size_t size[MAX_TOKENS];
+    size_t count = 0U, index = 0U, first;
+    unsigned long value;
+    char *stop;
+    char tmp[16];
+
+    /* split the line into tokens (separated by spaces or tabs) */
+    while ((index < length) && (count < MAX_TOKENS)) {
+        while ((index < length) && ((line[index] == ' ') || (line[index] == '\t') || (line[index] == '\r')))
+            index++;
+        if (index >= length)
+            break;
+        token[count] = &line[index];
+        while ((index < length) && (line[index] != ' ') && (line[index] != '\t') && (line[index] != '\r'))
+            index++;
+        size[count] = (size_t)(&line[index] - token[count]);
+        count++;
+    }
+    /* [counter] time id flags dlc data... */
+    if (count < 4U)
+        return false;
+    first = (memchr(token[0], ':', size[0]) || memchr(token[0], '.', size[0])) ? 0U : 1U;
+    if ((count - first) < 4U)
+        return false;
+    if (!parse_time(token[first], size[first], time))
+        return false;
+    /* identifier (hex) */
+    if ((size[first + 1U] == 0U) || (size[first + 1U] >= sizeof(tmp)))
+        return false;
+    memcpy(tmp, token[first + 1U], size[first + 1U]);
+    tmp[size[first + 1U]] = '\0';
+    value = strtoul(tmp, &stop, 16);
+    if (*stop != '\0')
+        return false;
+    /* flags: 'S' or 'X' (CAN 2.0: [S|X][R|-], CAN FD: [S|X][F|-][B|-][E|-][R|-]) */
+    if ((token[first + 2U][0] != 'S') && (token[first + 2U][0] != 'X'))
+        return false;
+    if ((size[first + 2U] != 2U) && (size[first + 2U] != 5U))
+        return false;
+    memset(message, 0, sizeof(slcan_message_t));
+    message->can_id = (uint32_t)value;
+    if (token[first + 2U][0] == 'X')
+        message->can_id |= CAN_XTD_FRAME;
+    else if (value > CAN_STD_MASK)
+        return false;
+    if (token[first + 2U][size[first + 2U] - 1U] == 'R')
+        message->can_id |= CAN_RTR_FRAME;
+    if ((size[first + 2U] == 5U) && (token[first + 2U][1] == 'F'))
+        return false;  // CAN FD frames cannot be transmitted (CAN 2.0 only)
+    /* data length code */
+    if ((size[first + 3U] != 1U) || (token[first + 3U][0] < '0') || (token[first + 3U][0] > '8'))
+        return false;
+    message->can_dlc = (uint8_t)(token[first + 3U][0] - '0');
+    if (message->can_id & CAN_RTR_FRAME)
+        return true;
+    /* data bytes (hex) */
+    if ((count - first - 4U) < message->can_dlc)
+        return false;
+    for (uint8_t i = 0U; i < message->can_dlc; i++) {
+        const char *byte = token[first + 4U + i];
+        if (size[first + 4U + i] != 2U)
+            return false;
+        memcpy(tmp, byte, 2U);
+        tmp[2] = '\0';
+        value = strtoul(tmp, &stop, 16);
+        if (*stop != '\0')
+            return false;
+        message->data[i] = (uint8_t)value;
+    }
+    return true;
+}
+
+static bool parse_time(const char *token, size_t length, uint64_t *time) {
+    uint64_t seconds = 0U, field = 0U, fraction = 0U, scale = NSEC_PER_SEC;
+    bool fractional = false;
+    size_t i;
+
+    /* 'hh:mm:ss.ffff' or 'sss.ffffff' (fractions of arbitrary length) */
+    for (i = 0U; i < length; i++) {
+        char c = token[i];
+        if ((c >= '0') && (c <= '9')) {
+            if (fractional) {
+                if (scale >= 10U) {
+                    scale /= 10U;
+                    fraction += (uint64_t)(c - '0') * scale;
+                }
+            } else {
+                field = (field * 10U) + (uint64_t)(c - '0');
+            }
+        } else if ((c == ':') && !fractional) {
+            seconds = (seconds + field) * 60U;
+            field = 0U;
+        } else if ((c == '.') && !fractional) {
+            fractional = true;
+        } else {
+            return false;
+        }
+    }
+    *time = ((seconds + field) * NSEC_PER_SEC) + fraction;
+    return true;
+}
+
+static void wait_until(uint64_t deadline, uint64_t spin) {
+    uint64_t now = now_ns();
+
+    /* sleep until shortly before the deadline */
+    if ((now + spin) < deadline) {
+#if defined(__linux__)
+        struct timespec ts;
+        ts.tv_sec = (time_t)((deadline - spin) / NSEC_PER_SEC);
+        ts.tv_nsec = (long)((deadline - spin) % NSEC_PER_SEC);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+            ;
+#else
+        /* note: no absolute sleep on macOS, the remainder is spun anyway */
+        struct timespec ts;
+        uint64_t delta = deadline - spin - now;
+        ts.tv_sec = (time_t)(delta / NSEC_PER_SEC);
+        ts.tv_nsec = (long)(delta % NSEC_PER_SEC);
+        (void)nanosleep(&ts, NULL);
+#endif
+    }
+    /* spin for the last microseconds */
+    while (now_ns() < deadline)
+        ;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * NSEC_PER_SEC) + (uint64_t)ts.tv_nsec;
+}
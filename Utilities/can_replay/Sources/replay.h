@@ -0,0 +1,159 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  Trace Replay for CAN-over-Serial-Line Interfaces (Lawicel protocol)
+//
+//  Copyright (c) 2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+/** @file        replay.h
+ *
+ *  @brief       Trace replay with the original inter-frame timing.
+ *
+ *  @remarks     A text trace is mapped into memory and streamed frame by frame,
+ *               a capture file is read block by block (see 'can_cap.h').
+ *               Each frame is scheduled at an absolute deadline (trace time
+ *               divided by the playback speed), waited for by a sleep until
+ *               shortly before the deadline and a busy-wait for the remainder.
+ *               Frames whose deadlines fall into the same batch window are
+ *               transmitted with one serial write (see 'slcan_write_messages').
+ *
+ *  @remarks     Supported trace formats: text output of 'can_moni' (one frame per
+ *               line: [counter] time id flags dlc data..., where time is either
+ *               'hh:mm:ss.ffff' or 'sss.ffffff'). Lines that cannot be parsed
+ *               (e.g. headers) are skipped.
+ *
+ *  @remarks     Or a capture file of 'can_moni' (option '--capture'). Its time-
+ *               stamps are always absolute (the time mode is ignored). Status
+ *               messages and CAN FD frames are skipped.
+ *
+ *  @defgroup    replay Trace Replay
+ *  @{
+ */
+#ifndef REPLAY_H_INCLUDED
+#define REPLAY_H_INCLUDED
+
+#include "slcan.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*  -----------  defines  ------------------------------------------------
+ */
+
+#define REPLAY_TIME_ABSOLUTE  0         /**< time-stamps are absolute (or zero-based) */
+#define REPLAY_TIME_RELATIVE  1         /**< time-stamps are relative to the previous frame */
+
+#define REPLAY_MAX_BATCH  64U           /**< max. number of frames per serial write */
+
+#define REPLAY_SPEED_UNLIMITED  0.0     /**< playback speed: as fast as possible */
+
+
+/*  -----------  types  --------------------------------------------------
+ */
+
+typedef void *replay_t;                 /**< trace replay (opaque data type) */
+
+/** @brief  Replay parameters
+ */
+typedef struct replay_param_t_ {        /* replay parameters: */
+    double speed;                       /**< playback speed (1.0 = original timing, 0.0 = unlimited) */
+    uint32_t spin;                      /**< busy-wait before a deadline (in [us]) */
+    uint32_t window;                    /**< batch window: deadlines within are merged (in [us]) */
+    int time_mode;                      /**< time-stamps: absolute or relative */
+} replay_param_t;
+
+/** @brief  Replay statistics (timing error = start of the write minus deadline)
+ *
+ *  @note   Frames sent ahead of their deadline (batch window) count as zero
+ *          in the percentiles, but not in min. and mean.
+ */
+typedef struct replay_stats_t_ {        /* replay statistics: */
+    uint64_t frames;                    /**< frames transmitted */
+    uint64_t batches;                   /**< serial writes */
+    uint64_t errors;                    /**< frames not confirmed by the device */
+    uint64_t skipped;                   /**< lines or records skipped (not a frame) */
+    int64_t min;                        /**< min. timing error (in [ns]) */
+    int64_t max;                        /**< max. timing error (in [ns]) */
+    double mean;                        /**< mean timing error (in [ns]) */
+    uint64_t p50;                       /**< 50th percentile of the timing error (in [ns]) */
+    uint64_t p90;                       /**< 90th percentile of the timing error (in [ns]) */
+    uint64_t p99;                       /**< 99th percentile of the timing error (in [ns]) */
+    uint64_t p999;                      /**< 99.9th percentile of the timing error (in [ns]) */
+    uint64_t duration;                  /**< duration of the replay (in [ns]) */
+} replay_stats_t;
+
+
+/*  -----------  prototypes  ---------------------------------------------
+ */
+
+/** @brief       opens a trace file (capture file or text trace).
+ *
+ *  @remarks     A text trace is mapped into memory.
+ *
+ *  @param[in]   filename  - name of the trace file
+ *
+ *  @returns     a pointer to a replay instance if successful, or NULL on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ */
+extern replay_t replay_open(const char *filename);
+
+
+/** @brief       closes a trace file and releases the replay instance.
+ *
+ *  @param[in]   replay  - pointer to a replay instance
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @retval      ENODEV  - no such device (invalid replay instance)
+ */
+extern int replay_close(replay_t replay);
+
+
+/** @brief       replays the trace to an open SLCAN channel.
+ *
+ *  @remarks     The function returns when the end of the trace has been reached
+ *               or when 'replay_stop' has been called.
+ *
+ *  @param[in]   replay  - pointer to a replay instance
+ *  @param[in]   port    - pointer to a SLCAN instance (channel open)
+ *  @param[in]   param   - replay parameters (NULL = original timing)
+ *  @param[out]  stats   - replay statistics (optional)
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @note        System variable 'errno' will be set in case of an error.
+ *
+ *  @retval      ENODEV  - no such device (invalid replay instance)
+ *  @retval      EINVAL  - invalid argument (port or param)
+ *  @retval      'errno' - error code from 'slcan_write_messages'
+ */
+extern int replay_run(replay_t replay, slcan_port_t port, const replay_param_t *param, replay_stats_t *stats);
+
+
+/** @brief       signals a running replay to stop (e.g. from a signal handler).
+ *
+ *  @param[in]   replay  - pointer to a replay instance
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @retval      ENODEV  - no such device (invalid replay instance)
+ */
+extern int replay_stop(replay_t replay);
+
+#endif /* REPLAY_H_INCLUDED */
+/** @}
+ */
@@ -0,0 +1,71 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  CAN Tester for generic Interfaces (CAN API V3)
+//
+//  Copyright (c) 2005-2010 Uwe Vogt, UV Software, Friedrichshafen
+//  Copyright (c) 2012-2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+#include "Histogram.h"
+
+#include <inttypes.h>
+
+CHistogram::CHistogram() {
+    m_pHisto = new stat_histo_t;
+    Reset();
+}
+
+CHistogram::CHistogram(const CHistogram& other) {
+    m_pHisto = new stat_histo_t;
+    Reset();
+    Add(other);
+}
+
+CHistogram& CHistogram::operator=(const CHistogram& other) {
+    if (this != &other) {
+        Reset();
+        Add(other);
+    }
+    return *this;
+}
+
+CHistogram::~CHistogram() {
+    delete m_pHisto;
+}
+
+void CHistogram::Record(uint64_t value) {
+    stat_histo_record(m_pHisto, value);
+}
+
+void CHistogram::Add(const CHistogram& other) {
+    stat_histo_add(m_pHisto, other.m_pHisto);
+}
+
+void CHistogram::Reset() {
+    stat_histo_reset(m_pHisto);
+}
+
+void CHistogram::Print(FILE* stream, const char* label, double divisor, const char* unit) const {
+    if (!stream)
+        return;
+    if (!m_pHisto->total) {
+        fprintf(stream, "%-12s n=0\n", label);
+        return;
+    }
+    fprintf(stream, "%-12s n=%" PRIu64 " min=%.3f p50=%.3f p99=%.3f p99.9=%.3f max=%.3f (%s)\n", label,
+        m_pHisto->total, (double)GetMin() / divisor,
+        (double)GetPercentile(50.0) / divisor, (double)GetPercentile(99.0) / divisor,
+        (double)GetPercentile(99.9) / divisor, (double)GetMax() / divisor, unit);
+}
@@ -0,0 +1,59 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  CAN Tester for generic Interfaces (CAN API V3)
+//
+//  Copyright (c) 2005-2010 Uwe Vogt, UV Software, Friedrichshafen
+//  Copyright (c) 2012-2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+#ifndef CAN_TEST_HISTOGRAM_H_INCLUDED
+#define CAN_TEST_HISTOGRAM_H_INCLUDED
+
+#include "can_stat.h"
+
+#include <stdio.h>
+#include <stdint.h>
+
+/// \name   HDR Histogram
+/// \brief  High-dynamic-range histogram with log-linear buckets (see 'can_stat.h'):
+///         values are recorded with a relative error of less than 0.8% over
+///         the full 64-bit range, e.g. 1ns to some hours.
+///         Recording a value is O(1) and does not allocate memory.
+/// \{
+class CHistogram {
+private:
+    stat_histo_t* m_pHisto;  // counts per bucket, total, min., max. and sum
+public:
+    CHistogram();
+    CHistogram(const CHistogram& other);
+    CHistogram& operator=(const CHistogram& other);
+    virtual ~CHistogram();
+
+    void Record(uint64_t value);
+    void Add(const CHistogram& other);
+    void Reset();
+
+    uint64_t GetTotal() const { return m_pHisto->total; }
+    uint64_t GetMin() const { return m_pHisto->total ? m_pHisto->min : 0U; }
+    uint64_t GetMax() const { return m_pHisto->max; }
+    double GetMean() const { return m_pHisto->total ? m_pHisto->sum / (double)m_pHisto->total : 0.0; }
+    uint64_t GetPercentile(double percentile) const { return stat_histo_percentile(m_pHisto, percentile); }  // 0.0 .. 100.0
+
+    // prints: n, min, p50, p99, p99.9, max (values in [ns] scaled by 1/divisor)
+    void Print(FILE* stream, const char* label, double divisor = 1000000.0, const char* unit = "ms") const;
+};
+/// \}
+
+#endif  // CAN_TEST_HISTOGRAM_H_INCLUDED
@@ -0,0 +1,268 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  CAN Tester for generic Interfaces (CAN API V3)
+//
+//  Copyright (c) 2005-2010 Uwe Vogt, UV Software, Friedrichshafen
+//  Copyright (c) 2012-2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+#include "Latency.h"
+#include "Parallel.h"
+#include "Timer.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+#include <inttypes.h>
+
+#ifdef _MSC_VER
+//not #if defined(_WIN32) || defined(_WIN64) because we have strncasecmp in mingw
+#define strcasecmp _stricmp
+#endif
+
+CLatencyTest::CLatencyTest(const SOptions& opts) : m_Options(opts) {
+    m_pSender = NULL;
+    m_pEcho = NULL;
+    m_u32PingId = opts.m_nTxCanId;
+    m_u32PongId = opts.m_nTxCanId;
+    m_u64Sent = 0U;
+    m_u64Received = 0U;
+    m_u64Timeouts = 0U;
+    m_u64Late = 0U;
+    m_u64Errors = 0U;
+    m_u64Start = 0U;
+    m_u64Stop = 0U;
+    m_u64Echoed = 0U;
+    m_u64EchoErrors = 0U;
+    m_fStop = false;
+}
+
+CLatencyTest::~CLatencyTest() {
+    Close();
+}
+
+bool CLatencyTest::Open(CCanDriver& sender, FILE* err) {
+    m_pSender = &sender;
+    // note: without a second interface the bus echoes the ping (loop-back)
+    if (!m_Options.m_szEchoInterface || !strcasecmp(m_Options.m_szEchoInterface, m_Options.m_szInterface))
+        return true;
+    m_pEcho = new CCanDriver[1];
+    if (!CParallelTest::OpenInterface(*m_pEcho, m_Options.m_szEchoInterface, m_Options, err)) {
+        delete[] m_pEcho;
+        m_pEcho = NULL;
+        return false;
+    }
+    // the echoing interface answers with the next identifier
+    m_u32PongId = (m_u32PingId + 1U) & CAN_MAX_STD_ID;
+    return true;
+}
+
+void CLatencyTest::Close() {
+    if (m_pEcho) {
+        (void)m_pEcho->TeardownChannel();
+        delete[] m_pEcho;
+        m_pEcho = NULL;
+    }
+    m_pSender = NULL;
+}
+
+uint64_t CLatencyTest::Run(volatile int& running) {
+    CANAPI_Message_t message;
+    CANAPI_Return_t retVal;
+    uint64_t now, sent, deadline, until, report;
+    uint32_t number, value, time;
+    std::thread echo;
+
+    if (!m_pSender)
+        return 0U;
+    memset(&message, 0, sizeof(CANAPI_Message_t));
+    message.id = m_u32PingId;
+    message.xtd = 0;
+    message.rtr = 0;
+#if (CAN_FD_SUPPORTED != 0)
+    message.fdf = m_Options.m_OpMode.fdoe;
+    message.brs = m_Options.m_OpMode.brse;
+#endif
+    message.dlc = m_Options.m_nTxCanDlc;
+    number = (uint32_t)m_Options.m_nStartNumber;
+    m_fStop = false;
+    if (m_pEcho)
+        echo = std::thread(&CLatencyTest::EchoThread, this);
+    fprintf(stderr, "\nPress ^C to abort.\n");
+    fprintf(stdout, "\nMeasuring latency (%s)...\n", m_pEcho ? "ping-pong" : "loop-back");
+    fflush(stdout);
+    m_u64Start = m_u64Stop = now = CParallelTest::GetTime();
+    until = m_u64Start + (uint64_t)m_Options.m_nTxTime * 1000000000U;
+    report = m_u64Start + REPORT_INTERVAL;
+    while (running) {
+        if (m_Options.m_TestMode == SOptions::TxMODE) {
+            if (now >= until)
+                break;
+        } else if (m_u64Sent >= m_Options.m_nTxFrames)
+            break;
+        /* send the ping (repeat when busy) */
+        sent = CParallelTest::GetTime();
+        SetPayload(message, number, (uint32_t)sent);
+        do {
+            retVal = m_pSender->WriteMessage(message);
+        } while ((retVal == CCanApi::TransmitterBusy) && running);
+        if (retVal == CCanApi::NoError) {
+            m_u64Sent++;
+            /* wait for the pong (or time-out) */
+            deadline = sent + ECHO_TIMEOUT;
+            while (running) {
+                now = CParallelTest::GetTime();
+                if (now >= deadline) {
+                    m_u64Timeouts++;
+                    break;
+                }
+                CANAPI_Message_t pong;
+                /* note: the time-out in [ns], not rounded up to milliseconds */
+                retVal = m_pSender->ReadMessageNs(pong, deadline - now);
+                if (retVal == CCanApi::ReceiverEmpty)
+                    continue;
+                if (retVal != CCanApi::NoError) {
+                    m_u64Errors++;
+                    continue;
+                }
+                if ((pong.id != m_u32PongId) || !GetPayload(pong, value, time))
+                    continue;
+                if (value != number) {
+                    /* pong of a ping already timed out */
+                    m_u64Late++;
+                    continue;
+                }
+                now = CParallelTest::GetTime();
+                m_RoundTrip.Record(now - sent);
+                m_RoundTripInterval.Record(now - sent);
+                m_u64Received++;
+                break;
+            }
+            number++;
+        } else
+            m_u64Errors++;
+        /* show the latency of the last interval */
+        now = CParallelTest::GetTime();
+        if (now >= report) {
+            PrintInterval(stdout, (now - m_u64Start) / 1000000000U);
+            while (report <= now)
+                report += REPORT_INTERVAL;
+        }
+        /* pause between two pings, as you please */
+        if (m_Options.m_nTxDelay) {
+            CTimer::Delay(CTimer::USEC * m_Options.m_nTxDelay);
+            now = CParallelTest::GetTime();
+        }
+    }
+    m_u64Stop = CParallelTest::GetTime();
+    if (m_pEcho) {
+        /* note: the last pong is not waited for */
+        m_fStop = true;
+        echo.join();
+    }
+    fprintf(stdout, "%s\n\n", running ? "OK!" : "STOP!");
+    return m_u64Sent;
+}
+
+void CLatencyTest::Report(FILE* out) {
+    if (!out)
+        return;
+    fprintf(out, "Sent=%" PRIu64 "\n", m_u64Sent);
+    fprintf(out, "Received=%" PRIu64 "\n", m_u64Received);
+    fprintf(out, "Timeouts=%" PRIu64 " (%.3f%%)\n", m_u64Timeouts,
+        m_u64Sent ? ((double)m_u64Timeouts * 100.0) / (double)m_u64Sent : 0.0);
+    fprintf(out, "Late=%" PRIu64 "\n", m_u64Late);
+    fprintf(out, "Error(s)=%" PRIu64 "\n", m_u64Errors);
+    if (m_pEcho) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        fprintf(out, "Echoed=%" PRIu64 " (%s)\n", m_u64Echoed, m_Options.m_szEchoInterface);
+        fprintf(out, "Echo error(s)=%" PRIu64 "\n", m_u64EchoErrors);
+    }
+    fprintf(out, "Time=%.3fsec\n\n", (m_u64Stop > m_u64Start) ? (double)(m_u64Stop - m_u64Start) / 1000000000. : 0.0);
+    m_RoundTrip.Print(out, "Round-trip");
+    if (m_pEcho) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_OneWay.Print(out, "One-way");
+    }
+    fputc('\n', out);
+}
+
+void CLatencyTest::PrintInterval(FILE* out, uint64_t seconds) {
+    char label[32];
+
+    snprintf(label, sizeof(label), "%4" PRIu64 "s RTT", seconds);
+    m_RoundTripInterval.Print(out, label);
+    m_RoundTripInterval.Reset();
+    if (m_pEcho) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        snprintf(label, sizeof(label), "%4" PRIu64 "s 1-way", seconds);
+        m_OneWayInterval.Print(out, label);
+        m_OneWayInterval.Reset();
+    }
+    fflush(out);
+}
+
+void CLatencyTest::EchoThread() {
+    CANAPI_Message_t message;
+    CANAPI_Return_t retVal;
+    uint32_t number, time, latency;
+
+    while (!m_fStop) {
+        retVal = m_pEcho->ReadMessage(message, 100U);
+        if (retVal == CCanApi::ReceiverEmpty)
+            continue;
+        if (retVal != CCanApi::NoError) {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_u64EchoErrors++;
+            continue;
+        }
+        if ((message.id != m_u32PingId) || !GetPayload(message, number, time))
+            continue;
+        /* note: the low 32 bits of the time wrap around every 4.29s */
+        latency = (uint32_t)CParallelTest::GetTime() - time;
+        /* send the pong (repeat when busy) */
+        message.id = m_u32PongId;
+        do {
+            retVal = m_pEcho->WriteMessage(message);
+        } while ((retVal == CCanApi::TransmitterBusy) && !m_fStop);
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (retVal == CCanApi::NoError) {
+            m_OneWay.Record((uint64_t)latency);
+            m_OneWayInterval.Record((uint64_t)latency);
+            m_u64Echoed++;
+        } else
+            m_u64EchoErrors++;
+    }
+}
+
+void CLatencyTest::SetPayload(CANAPI_Message_t& message, uint32_t number, uint32_t time) {
+    for (int i = 0; i < 4; i++) {
+        message.data[i] = (uint8_t)(number >> (8 * i));
+        message.data[4 + i] = (uint8_t)(time >> (8 * i));
+    }
+}
+
+bool CLatencyTest::GetPayload(const CANAPI_Message_t& message, uint32_t& number, uint32_t& time) {
+    if (message.sts || message.xtd || message.rtr || (message.dlc < 8U))
+        return false;
+    number = 0U;
+    time = 0U;
+    for (int i = 0; i < 4; i++) {
+        number |= (uint32_t)message.data[i] << (8 * i);
+        time |= (uint32_t)message.data[4 + i] << (8 * i);
+    }
+    return true;
+}
@@ -0,0 +1,85 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  CAN Tester for generic Interfaces (CAN API V3)
+//
+//  Copyright (c) 2005-2010 Uwe Vogt, UV Software, Friedrichshafen
+//  Copyright (c) 2012-2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+#ifndef CAN_TEST_LATENCY_H_INCLUDED
+#define CAN_TEST_LATENCY_H_INCLUDED
+
+#include "Driver.h"
+#include "Options.h"
+#include "Histogram.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+
+/// \name   Round-trip Latency Test
+/// \brief  Sends timestamped frames (ping) and waits for each echo (pong),
+///         either from a second interface on the same bus that is operated
+///         by an echo thread, or from the bus itself (loop-back, e.g. PTY).
+///         The payload carries a sequence number (bytes 0..3) and the low
+///         32 bits of the transmission time in [ns] (bytes 4..7).
+///         Round-trip and one-way latency are recorded in HDR histograms
+///         and reported every second and at the end of the test.
+/// \{
+class CLatencyTest {
+public:
+    static const uint64_t ECHO_TIMEOUT = 100000000U;  // 100ms (in [ns])
+    static const uint64_t REPORT_INTERVAL = 1000000000U;  // 1s (in [ns])
+private:
+    const SOptions& m_Options;
+    CCanDriver* m_pSender;  // sending interface (ping)
+    CCanDriver* m_pEcho;  // echoing interface (pong) or NULL (loop-back)
+    uint32_t m_u32PingId;  // CAN identifier of the ping
+    uint32_t m_u32PongId;  // CAN identifier of the pong
+    // sender statistics (sender thread only)
+    uint64_t m_u64Sent;  // number of transmitted pings
+    uint64_t m_u64Received;  // number of pongs in time
+    uint64_t m_u64Timeouts;  // number of pings without pong
+    uint64_t m_u64Late;  // pongs of a ping already timed out
+    uint64_t m_u64Errors;  // errors from the driver
+    uint64_t m_u64Start;  // begin and end of the test (in [ns])
+    uint64_t m_u64Stop;
+    CHistogram m_RoundTrip;  // round-trip time (total and interval)
+    CHistogram m_RoundTripInterval;
+    // echo thread statistics (protected by the mutex)
+    std::mutex m_Mutex;
+    uint64_t m_u64Echoed;  // number of echoed pings
+    uint64_t m_u64EchoErrors;  // errors from the driver
+    CHistogram m_OneWay;  // one-way latency (total and interval)
+    CHistogram m_OneWayInterval;
+    std::atomic<bool> m_fStop;  // stop the echo thread
+public:
+    CLatencyTest(const SOptions& opts);
+    virtual ~CLatencyTest();
+
+    bool Open(CCanDriver& sender, FILE* err = stderr);  // open the echoing interface (if any)
+    uint64_t Run(volatile int& running);  // run the test (abort with ^C)
+    void Report(FILE* out);  // latency histograms
+    void Close();  // close the echoing interface
+private:
+    void EchoThread();
+    void PrintInterval(FILE* out, uint64_t seconds);
+    static void SetPayload(CANAPI_Message_t& message, uint32_t number, uint32_t time);
+    static bool GetPayload(const CANAPI_Message_t& message, uint32_t& number, uint32_t& time);
+};
+/// \}
+
+#endif  // CAN_TEST_LATENCY_H_INCLUDED
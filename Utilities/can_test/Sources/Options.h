@@ -78,11 +78,17 @@ struct SOptions {
     uint64_t m_nStartNumber;
     bool m_fCheckNumber;
     bool m_fStopOnError;
+    uint32_t m_u32Analyze;
     time_t m_nTxTime;
     uint64_t m_nTxFrames;
     uint64_t m_nTxDelay;
     uint32_t m_nTxCanId;
     uint8_t m_nTxCanDlc;
+    char* m_szParallel;
+    char* m_szAffinity;
+    bool m_fLatency;
+    char* m_szEchoInterface;
+    char* m_szProfile;
     bool m_fListBitrates;
     bool m_fListBoards;
     bool m_fTestBoards;
@@ -83,11 +83,17 @@ SOptions::SOptions() {
     m_nStartNumber = (uint64_t)0;
     m_fCheckNumber = false;
     m_fStopOnError = false;
+    m_u32Analyze = 0U;
     m_nTxTime = (time_t)0;
     m_nTxFrames = (uint64_t)0;
     m_nTxDelay = (uint64_t)0;
     m_nTxCanId = (uint32_t)DEFAULT_CAN_ID;
     m_nTxCanDlc = (uint8_t)DEFAULT_LENGTH;
+    m_szParallel = (char*)NULL;
+    m_szAffinity = (char*)NULL;
+    m_fLatency = false;
+    m_szEchoInterface = (char*)NULL;
+    m_szProfile = (char*)NULL;
     m_fListBitrates = false;
     m_fListBoards = false;
     m_fTestBoards = false;
@@ -115,12 +121,17 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
     int optReceive = 0;
     int optNumber = 0;
     int optStop = 0;
+    int optAnalyze = 0;
     int optTransmit = 0;
     int optFrames = 0;
     int optRandom = 0;
     int optCycle = 0;
     int optDlc = 0;
     int optId = 0;
+    int optParallel = 0;
+    int optAffinity = 0;
+    int optLatency = 0;
+    int optProfile = 0;
     int optListBitrates = 0;
     int optListBoards = 0;
     int optTestBoards = 0;
@@ -148,6 +159,7 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
         {"receive", no_argument, 0, 'r'},
         {"number", required_argument, 0, 'n'},
         {"stop", no_argument, 0, 's'},
+        {"analyze", optional_argument, 0, '9'},
         {"transmit", required_argument, 0, 't'},
         {"frames", required_argument, 0, 'f'},
         {"random", required_argument, 0, 'F'},
@@ -156,6 +168,10 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
         {"dlc", required_argument, 0, 'd'},
         {"data", required_argument, 0, 'd'},
         {"id", required_argument, 0, 'i'},
+        {"parallel", required_argument, 0, '5'},
+        {"affinity", required_argument, 0, '6'},
+        {"latency", optional_argument, 0, '7'},
+        {"profile", required_argument, 0, '8'},
         {"list-bitrates", optional_argument, 0, 'l'},
 #if (OPTION_CANAPI_LIBRARY != 0)
         {"list-boards", optional_argument, 0, 'L'},
@@ -477,6 +493,21 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
             }
             m_fStopOnError = 1;
             break;
+        /* option '--analyze[=<seconds>]' */
+        case '9':
+            if (optAnalyze++) {
+                fprintf(err, "%s: duplicated option `--analyze'\n", m_szBasename);
+                return 1;
+            }
+            if (optarg != NULL) {
+                if ((sscanf(optarg, "%" SCNi64, &intarg) != 1) || (intarg < 1) || (intarg > 3600)) {
+                    fprintf(err, "%s: illegal argument for option `--analyze'\n", m_szBasename);
+                    return 1;
+                }
+                m_u32Analyze = (uint32_t)intarg;
+            } else
+                m_u32Analyze = 10U;
+            break;
         /* option '--transmit=<duration>' (-t) in [s] */
         case 't':
             if (optTransmit++) {
@@ -626,6 +657,59 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
             }
             m_nTxCanId = (uint32_t)intarg;
             break;
+        /* option '--parallel=<interface>{,<interface>}' */
+        case '5':
+            if (optParallel++) {
+                fprintf(err, "%s: duplicated option `--parallel'\n", m_szBasename);
+                return 1;
+            }
+            if ((optarg == NULL) || (*optarg == '\0')) {
+                fprintf(err, "%s: missing argument for option `--parallel'\n", m_szBasename);
+                return 1;
+            }
+            m_szParallel = optarg;
+            break;
+        /* option '--affinity=<cpu>{,<cpu>}' */
+        case '6':
+            if (optAffinity++) {
+                fprintf(err, "%s: duplicated option `--affinity'\n", m_szBasename);
+                return 1;
+            }
+            if (optarg == NULL) {
+                fprintf(err, "%s: missing argument for option `--affinity'\n", m_szBasename);
+                return 1;
+            }
+            if (strspn(optarg, "0123456789,") != strlen(optarg)) {
+                fprintf(err, "%s: illegal argument for option `--affinity'\n", m_szBasename);
+                return 1;
+            }
+            m_szAffinity = optarg;
+            break;
+        /* option '--latency[=<interface>]' */
+        case '7':
+            if (optLatency++) {
+                fprintf(err, "%s: duplicated option `--latency'\n", m_szBasename);
+                return 1;
+            }
+            if ((optarg != NULL) && (*optarg == '\0')) {
+                fprintf(err, "%s: missing argument for option `--latency'\n", m_szBasename);
+                return 1;
+            }
+            m_fLatency = true;
+            m_szEchoInterface = optarg;
+            break;
+        /* option '--profile=<filename>' */
+        case '8':
+            if (optProfile++) {
+                fprintf(err, "%s: duplicated option `--profile'\n", m_szBasename);
+                return 1;
+            }
+            if ((optarg == NULL) || (*optarg == '\0')) {
+                fprintf(err, "%s: missing argument for option `--profile'\n", m_szBasename);
+                return 1;
+            }
+            m_szProfile = optarg;
+            break;
         /* option '--list-bitrates[=(2.0|FDF[+BRS])]' */
         case 'l':
             if (optListBitrates++) {
@@ -773,6 +857,46 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
         else if (m_nTxCanDlc > 8) m_nTxCanDlc = 0x9;
     }
 #endif
+    /* - check sequence analyzer (receiver test) */
+    if (optAnalyze && (m_TestMode != SOptions::RxMODE) && !m_fExit) {
+        fprintf(err, "%s: option `--analyze' requires a receiver test\n", m_szBasename);
+        return 1;
+    }
+    if (optAnalyze && optNumber && !m_fExit) {
+        fprintf(err, "%s: illegal combination of options `--analyze' and `--number' (n)\n", m_szBasename);
+        return 1;
+    }
+    /* - check parallel load test (transmitter test) */
+    if (optParallel && (m_TestMode == SOptions::RxMODE) && !m_fExit) {
+        fprintf(err, "%s: option `--parallel' requires a transmitter test\n", m_szBasename);
+        return 1;
+    }
+    if (optAffinity && !optParallel && !m_fExit) {
+        fprintf(err, "%s: option `--affinity' requires option `--parallel'\n", m_szBasename);
+        return 1;
+    }
+    /* - check round-trip latency test (transmitter test) */
+    if (optLatency && (m_TestMode != SOptions::TxMODE) && (m_TestMode != SOptions::TxFRAMES) && !m_fExit) {
+        fprintf(err, "%s: option `--latency' requires option `--transmit' (t) or `--frames' (f)\n", m_szBasename);
+        return 1;
+    }
+    if (optLatency && optParallel && !m_fExit) {
+        fprintf(err, "%s: illegal combination of options `--latency' and `--parallel'\n", m_szBasename);
+        return 1;
+    }
+    if (optLatency && (m_nTxCanDlc < 8U) && !m_fExit) {
+        fprintf(err, "%s: option `--latency' requires a data length of at least 8 bytes\n", m_szBasename);
+        return 1;
+    }
+    /* - check traffic profile generator (transmitter test) */
+    if (optProfile && (m_TestMode != SOptions::TxMODE) && (m_TestMode != SOptions::TxFRAMES) && !m_fExit) {
+        fprintf(err, "%s: option `--profile' requires option `--transmit' (t) or `--frames' (f)\n", m_szBasename);
+        return 1;
+    }
+    if (optProfile && (optParallel || optLatency) && !m_fExit) {
+        fprintf(err, "%s: illegal combination of options `--profile' and `--%s'\n", m_szBasename, optParallel ? "parallel" : "latency");
+        return 1;
+    }
     /* - check operation mode flags */
     if ((m_TestMode != SOptions::RxMODE) && m_OpMode.mon && !m_fExit) {
         fprintf(err, "%s: illegal option `--listen-only' for transmitter test\n", m_szBasename);
@@ -819,7 +943,8 @@ void SOptions::ShowUsage(FILE* stream, bool args) {
     fprintf(stream, "Options for receiver test (default test mode):\n");
     fprintf(stream, " -r, --receive                        count received messages until ^C is pressed\n");
     fprintf(stream, " -n, --number=<number>                check up-counting numbers starting with <number>\n");
-    fprintf(stream, " -s, --stop                           stop on error (with option --number)\n");
+    fprintf(stream, " -s, --stop                           stop on error (with option --number or --analyze)\n");
+    fprintf(stream, "     --analyze[=<seconds>]            check up-counting numbers per CAN-ID (loss window)\n");
 #if (OPTION_CANAPI_LIBRARY != 0)
     fprintf(stream, " -p, --path=<pathname>                search path for JSON configuration files\n");
 #endif
@@ -845,6 +970,10 @@ void SOptions::ShowUsage(FILE* stream, bool args) {
     fprintf(stream, " -d, --dlc=<length>                   send messages of given length (default=8)\n");
     fprintf(stream, " -i, --id=<can-id>                    use given identifier (default=100h)\n");
     fprintf(stream, " -n, --number=<number>                set first up-counting number (default=0)\n");
+    fprintf(stream, "     --parallel=<interface>,...       receive on these interfaces in parallel\n");
+    fprintf(stream, "     --affinity=<cpu>,...             pin the transmitter and the receivers to CPUs\n");
+    fprintf(stream, "     --latency[=<interface>]          measure round-trip latency (echo from <interface>)\n");
+    fprintf(stream, "     --profile=<filename>             send messages as described in a traffic profile\n");
 #if (OPTION_CANAPI_LIBRARY != 0)
     fprintf(stream, " -p, --path=<pathname>                search path for JSON configuration files\n");
 #endif
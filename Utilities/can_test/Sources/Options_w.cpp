@@ -67,36 +67,41 @@ extern "C" {
 #define NUMBER_CHR        24
 #define STOP_STR          25
 #define STOP_CHR          26
-#define TRANSMIT_STR      27
-#define TRANSMIT_CHR      28
-#define FRAMES_STR        29
-#define FRAMES_CHR        30
-#define RANDOM_STR        31
-#define RANDOM_CHR        32
-#define CYCLE_STR         33
-#define CYCLE_CHR         34
-#define USEC_STR          35
-#define USEC_CHR          36
-#define DLC_STR           37
-#define DLC_CHR           38
-#define DLC_LEN           39
-#define CAN_STR           40
-#define CAN_CHR           41
-#define CAN_ID            42
-#define COB_ID            43
-#define LISTBITRATES_STR  44
-#define LISTBOARDS_STR    45
-#define LISTBOARDS_CHR    46
-#define TESTBOARDS_STR    47
-#define TESTBOARDS_CHR    48
-#define JSON_STR          49
-#define JSON_CHR          50
-#define HELP              51
-#define QUESTION_MARK     52
-#define ABOUT             53
-#define CHARACTER_MJU     54
-#define VERSION           55
-#define MAX_OPTIONS       56
+#define ANALYZE_STR       27
+#define TRANSMIT_STR      28
+#define TRANSMIT_CHR      29
+#define FRAMES_STR        30
+#define FRAMES_CHR        31
+#define RANDOM_STR        32
+#define RANDOM_CHR        33
+#define CYCLE_STR         34
+#define CYCLE_CHR         35
+#define USEC_STR          36
+#define USEC_CHR          37
+#define DLC_STR           38
+#define DLC_CHR           39
+#define DLC_LEN           40
+#define CAN_STR           41
+#define CAN_CHR           42
+#define CAN_ID            43
+#define COB_ID            44
+#define PARALLEL_STR      45
+#define AFFINITY_STR      46
+#define LATENCY_STR       47
+#define PROFILE_STR       48
+#define LISTBITRATES_STR  49
+#define LISTBOARDS_STR    50
+#define LISTBOARDS_CHR    51
+#define TESTBOARDS_STR    52
+#define TESTBOARDS_CHR    53
+#define JSON_STR          54
+#define JSON_CHR          55
+#define HELP              56
+#define QUESTION_MARK     57
+#define ABOUT             58
+#define CHARACTER_MJU     59
+#define VERSION           60
+#define MAX_OPTIONS       61
 
 static char* option[MAX_OPTIONS] = {
     (char*)"BAUDRATE", (char*)"bd",
@@ -113,6 +118,7 @@ static char* option[MAX_OPTIONS] = {
     (char*)"RECEIVE", (char*)"rx",
     (char*)"NUMBER", (char*)"n",
     (char*)"STOP", (char*)"s",
+    (char*)"ANALYZE",
     (char*)"TRANSMIT", (char*)"tx",
     (char*)"FRAMES", (char*)"fr",
     (char*)"RANDOM", (char*)"rand",
@@ -120,6 +126,10 @@ static char* option[MAX_OPTIONS] = {
     (char*)"USEC", (char*)"u",
     (char*)"DLC", (char*)"d", (char*)"DATA",
     (char*)"CAN-ID", (char*)"id", (char*)"i", (char*)"COP-ID",
+    (char*)"PARALLEL",
+    (char*)"AFFINITY",
+    (char*)"LATENCY",
+    (char*)"PROFILE",
     (char*)"LIST-BITRATES",
     (char*)"LIST-BOARDS", (char*)"list",
     (char*)"TEST-BOARDS", (char*)"test",
@@ -167,11 +177,17 @@ SOptions::SOptions() {
     m_nStartNumber = (uint64_t)0;
     m_fCheckNumber = false;
     m_fStopOnError = false;
+    m_u32Analyze = 0U;
     m_nTxTime = (time_t)0;
     m_nTxFrames = (uint64_t)0;
     m_nTxDelay = (uint64_t)0;
     m_nTxCanId = (uint32_t)DEFAULT_CAN_ID;
     m_nTxCanDlc = (uint8_t)DEFAULT_LENGTH;
+    m_szParallel = (char*)NULL;
+    m_szAffinity = (char*)NULL;
+    m_fLatency = false;
+    m_szEchoInterface = (char*)NULL;
+    m_szProfile = (char*)NULL;
     m_fListBitrates = false;
     m_fListBoards = false;
     m_fTestBoards = false;
@@ -201,12 +217,17 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
     int optReceive = 0;
     int optNumber = 0;
     int optStop = 0;
+    int optAnalyze = 0;
     int optTransmit = 0;
     int optFrames = 0;
     int optRandom = 0;
     int optCycle = 0;
     int optDlc = 0;
     int optId = 0;
+    int optParallel = 0;
+    int optAffinity = 0;
+    int optLatency = 0;
+    int optProfile = 0;
     int optListBitrates = 0;
     int optListBoards = 0;
     int optTestBoards = 0;
@@ -577,6 +598,21 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
             }
             m_fStopOnError = 1;
             break;
+        /* option '--analyze[=<seconds>]' */
+        case ANALYZE_STR:
+            if ((optAnalyze++)) {
+                fprintf(err, "%s: duplicated option /ANALYZE\n", m_szBasename);
+                return 1;
+            }
+            if ((optarg = getOptionParameter()) != NULL) {
+                if ((sscanf_s(optarg, "%lli", &intarg) != 1) || (intarg < 1) || (intarg > 3600)) {
+                    fprintf(err, "%s: illegal argument for option /ANALYZE\n", m_szBasename);
+                    return 1;
+                }
+                m_u32Analyze = (uint32_t)intarg;
+            } else
+                m_u32Analyze = 10U;
+            break;
         /* option '--transmit=<duration>' (-t) in [s] */
         case TRANSMIT_STR:
         case TRANSMIT_CHR:
@@ -736,6 +772,59 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
             }
             m_nTxCanId = (uint32_t)intarg;
             break;
+        /* option '--parallel=<interface>{,<interface>}' */
+        case PARALLEL_STR:
+            if ((optParallel++)) {
+                fprintf(err, "%s: duplicated option /PARALLEL\n", m_szBasename);
+                return 1;
+            }
+            if (((optarg = getOptionParameter()) == NULL) || (*optarg == '\0')) {
+                fprintf(err, "%s: missing argument for option /PARALLEL\n", m_szBasename);
+                return 1;
+            }
+            m_szParallel = optarg;
+            break;
+        /* option '--affinity=<cpu>{,<cpu>}' */
+        case AFFINITY_STR:
+            if ((optAffinity++)) {
+                fprintf(err, "%s: duplicated option /AFFINITY\n", m_szBasename);
+                return 1;
+            }
+            if ((optarg = getOptionParameter()) == NULL) {
+                fprintf(err, "%s: missing argument for option /AFFINITY\n", m_szBasename);
+                return 1;
+            }
+            if (strspn(optarg, "0123456789,") != strlen(optarg)) {
+                fprintf(err, "%s: illegal argument for option /AFFINITY\n", m_szBasename);
+                return 1;
+            }
+            m_szAffinity = optarg;
+            break;
+        /* option '--latency[=<interface>]' */
+        case LATENCY_STR:
+            if ((optLatency++)) {
+                fprintf(err, "%s: duplicated option /LATENCY\n", m_szBasename);
+                return 1;
+            }
+            if (((optarg = getOptionParameter()) != NULL) && (*optarg == '\0')) {
+                fprintf(err, "%s: missing argument for option /LATENCY\n", m_szBasename);
+                return 1;
+            }
+            m_fLatency = true;
+            m_szEchoInterface = optarg;
+            break;
+        /* option '--profile=<filename>' */
+        case PROFILE_STR:
+            if ((optProfile++)) {
+                fprintf(err, "%s: duplicated option /PROFILE\n", m_szBasename);
+                return 1;
+            }
+            if (((optarg = getOptionParameter()) == NULL) || (*optarg == '\0')) {
+                fprintf(err, "%s: missing argument for option /PROFILE\n", m_szBasename);
+                return 1;
+            }
+            m_szProfile = optarg;
+            break;
         /* option '--list-bitrates[=(2.0|FDF[+BRS])]' */
         case LISTBITRATES_STR:
             if ((optListBitrates++)) {
@@ -871,6 +960,46 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
         else if (m_nTxCanDlc > 8) m_nTxCanDlc = 0x9;
     }
 #endif
+    /* - check sequence analyzer (receiver test) */
+    if (optAnalyze && (m_TestMode != ETestMode::RxMODE) && !m_fExit) {
+        fprintf(err, "%s: option /ANALYZE requires a receiver test\n", m_szBasename);
+        return 1;
+    }
+    if (optAnalyze && optNumber && !m_fExit) {
+        fprintf(err, "%s: illegal combination of options /ANALYZE and /NUMBER\n", m_szBasename);
+        return 1;
+    }
+    /* - check parallel load test (transmitter test) */
+    if (optParallel && (m_TestMode == ETestMode::RxMODE) && !m_fExit) {
+        fprintf(err, "%s: option /PARALLEL requires a transmitter test\n", m_szBasename);
+        return 1;
+    }
+    if (optAffinity && !optParallel && !m_fExit) {
+        fprintf(err, "%s: option /AFFINITY requires option /PARALLEL\n", m_szBasename);
+        return 1;
+    }
+    /* - check round-trip latency test (transmitter test) */
+    if (optLatency && (m_TestMode != ETestMode::TxMODE) && (m_TestMode != ETestMode::TxFRAMES) && !m_fExit) {
+        fprintf(err, "%s: option /LATENCY requires option /TRANSMIT or /FRAMES\n", m_szBasename);
+        return 1;
+    }
+    if (optLatency && optParallel && !m_fExit) {
+        fprintf(err, "%s: illegal combination of options /LATENCY and /PARALLEL\n", m_szBasename);
+        return 1;
+    }
+    if (optLatency && (m_nTxCanDlc < 8U) && !m_fExit) {
+        fprintf(err, "%s: option /LATENCY requires a data length of at least 8 bytes\n", m_szBasename);
+        return 1;
+    }
+    /* - check traffic profile generator (transmitter test) */
+    if (optProfile && (m_TestMode != ETestMode::TxMODE) && (m_TestMode != ETestMode::TxFRAMES) && !m_fExit) {
+        fprintf(err, "%s: option /PROFILE requires option /TRANSMIT or /FRAMES\n", m_szBasename);
+        return 1;
+    }
+    if (optProfile && (optParallel || optLatency) && !m_fExit) {
+        fprintf(err, "%s: illegal combination of options /PROFILE and /%s\n", m_szBasename, optParallel ? "PARALLEL" : "LATENCY");
+        return 1;
+    }
     /* - check operation mode flags */
     if ((m_TestMode != ETestMode::RxMODE) && m_OpMode.mon && !m_fExit) {
         fprintf(err, "%s: illegal option /MON:YES alias /LISTEN-ONLY for transmitter test\n", m_szBasename);
@@ -917,7 +1046,8 @@ void SOptions::ShowUsage(FILE* stream, bool args) {
     fprintf(stream, "Options for receiver test (default test mode):\n");
     fprintf(stream, "  /RECEIVE | /RX                      count received messages until ^C is pressed\n");
     fprintf(stream, "  /Number:<number>                    check up-counting numbers starting with <number>\n");
-    fprintf(stream, "  /Stop                               stop on error (with option /NUMBER)\n");
+    fprintf(stream, "  /Stop                               stop on error (with option /NUMBER or /ANALYZE)\n");
+    fprintf(stream, "  /ANALYZE[:<seconds>]                check up-counting numbers per CAN-ID (loss window)\n");
 #if (CAN_FD_SUPPORTED != 0)
     fprintf(stream, "  /Mode:(2.0|FDf[+BRS])               CAN operation mode: CAN 2.0 or CAN FD mode\n");
 #else
@@ -947,6 +1077,10 @@ void SOptions::ShowUsage(FILE* stream, bool args) {
     fprintf(stream, "  /Dlc:<length>                       send messages of given length (default=8)\n");
     fprintf(stream, "  /can-Id:<can-id>                    use given identifier (default=100h)\n");
     fprintf(stream, "  /Number:<number>                    set first up-counting number (default=0)\n");
+    fprintf(stream, "  /PARALLEL:<interface>,...           receive on these interfaces in parallel\n");
+    fprintf(stream, "  /AFFINITY:<cpu>,...                 pin the transmitter and the receivers to CPUs\n");
+    fprintf(stream, "  /LATENCY[:<interface>]              measure round-trip latency (echo from <interface>)\n");
+    fprintf(stream, "  /PROFILE:<filename>                 send messages as described in a traffic profile\n");
 #if (CAN_FD_SUPPORTED != 0)
     fprintf(stream, "  /Mode:(2.0|FDf[+BRS])               CAN operation mode: CAN 2.0 or CAN FD mode\n");
 #else
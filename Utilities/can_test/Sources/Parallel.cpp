@@ -0,0 +1,459 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  CAN Tester for generic Interfaces (CAN API V3)
+//
+//  Copyright (c) 2005-2010 Uwe Vogt, UV Software, Friedrichshafen
+//  Copyright (c) 2012-2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+#include "Parallel.h"
+#include "Timer.h"
+#if (SERIAL_CAN_SUPPORTED != 0)
+#include "SerialCAN_Defines.h"
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <chrono>
+#include <thread>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <inttypes.h>
+
+#ifdef _MSC_VER
+//not #if defined(_WIN32) || defined(_WIN64) because we have strncasecmp in mingw
+#define strcasecmp _stricmp
+#define strdup _strdup
+#endif
+
+#define AFTERBURNER_IDLE  500000000U  // receivers idle for 500ms
+#define AFTERBURNER_MAX  3000000000U  // but not longer than 3s
+#define INVALID_NUMBER  UINT64_MAX
+
+CParallelTest::CParallelTest(const SOptions& opts) : m_Options(opts) {
+    SPort port;
+    char* name;
+    char* cpu;
+    int i;
+
+    memset(&port, 0, sizeof(SPort));
+    port.m_nCpu = (-1);
+    port.m_u64LatMin = UINT64_MAX;
+    port.m_u64Expected = opts.m_nStartNumber;
+    // (1) the transmitter: interface given as argument
+    m_Transmitter = port;
+    m_Transmitter.m_szName = opts.m_szInterface;
+    // (2) the receivers: comma-separated list of interfaces
+    m_szList = opts.m_szParallel ? strdup(opts.m_szParallel) : NULL;
+    for (name = m_szList; name && *name && (m_Receivers.size() < (size_t)MAX_INTERFACES); ) {
+        char* next = strchr(name, ',');
+        if (next)
+            *next++ = '\0';
+        port.m_szName = name;
+        m_Receivers.push_back(port);
+        name = next;
+    }
+    // (3) CPU affinity: the transmitter first, then the receivers
+    cpu = opts.m_szAffinity;
+    for (i = 0; cpu && *cpu && (i <= (int)m_Receivers.size()); i++) {
+        int n = (int)strtol(cpu, &cpu, 0);
+        if (i == 0)
+            m_Transmitter.m_nCpu = n;
+        else
+            m_Receivers[i - 1].m_nCpu = n;
+        if (*cpu == ',')
+            cpu++;
+        else
+            break;
+    }
+    m_pDrivers = NULL;
+    m_pSeqHistory = new std::atomic<uint64_t>[HISTORY];
+    m_pTimeHistory = new std::atomic<uint64_t>[HISTORY];
+    for (size_t n = 0U; n < HISTORY; n++) {
+        m_pSeqHistory[n] = INVALID_NUMBER;
+        m_pTimeHistory[n] = 0U;
+    }
+    m_u64Sent = 0U;
+    m_u64LastRx = 0U;
+    m_fStop = false;
+    m_nReady = 0;
+    m_fStart = false;
+}
+
+CParallelTest::~CParallelTest() {
+    Close();
+    delete[] m_pDrivers;
+    delete[] m_pSeqHistory;
+    delete[] m_pTimeHistory;
+    if (m_szList)
+        free(m_szList);
+}
+
+bool CParallelTest::Open(CCanDriver& transmitter, FILE* err) {
+    m_Transmitter.m_pDriver = &transmitter;
+    m_Transmitter.m_fOwner = false;
+    if (!m_pDrivers && !m_Receivers.empty())
+        m_pDrivers = new CCanDriver[m_Receivers.size()];
+    for (size_t i = 0U; i < m_Receivers.size(); i++) {
+        SPort* port = &m_Receivers[i];
+        // note: the transmitting interface can also be a receiver (loop-back)
+        if (!strcasecmp(port->m_szName, m_Transmitter.m_szName)) {
+            port->m_pDriver = &transmitter;
+            port->m_fOwner = false;
+            continue;
+        }
+        port->m_pDriver = &m_pDrivers[i];
+        port->m_fOwner = true;
+        if (!OpenInterface(*port->m_pDriver, port->m_szName, m_Options, err))
+            return false;
+    }
+    return true;
+}
+
+bool CParallelTest::OpenInterface(CCanDriver& driver, const char* name, const SOptions& opts, FILE* err) {
+    CANAPI_Return_t retVal;
+
+    fprintf(stdout, "Hardware=%s...", name);
+    fflush(stdout);
+#if (SERIAL_CAN_SUPPORTED != 0)
+    /* - CAN-over-Serial-Line (SLCAN protocol) */
+    can_sio_param_t sioParam;
+    sioParam.name = (char*)name;
+    sioParam.attr.options = CANSIO_SLCAN;
+    sioParam.attr.baudrate = CANSIO_BD57600;
+    sioParam.attr.bytesize = CANSIO_8DATABITS;
+    sioParam.attr.parity = CANSIO_NOPARITY;
+    sioParam.attr.stopbits = CANSIO_1STOPBIT;
+#if (OPTION_CANAPI_LIBRARY != 0)
+    retVal = driver.InitializeChannel(CANLIB_SERIALCAN, CANDEV_SERIAL, opts.m_OpMode, (void*)&sioParam);
+#else
+    retVal = driver.InitializeChannel(CANDEV_SERIAL, opts.m_OpMode, (void*)&sioParam);
+#endif
+#else
+    /* - search the interface by its name in the device list */
+    CCanDriver::SChannelInfo channel = { (-1), "", "", (-1), "" };
+    bool flagFound = false;
+#if (OPTION_CANAPI_LIBRARY != 0)
+    CCanDriver::SLibraryInfo library = { (-1), "", "" };
+    bool iterLibrary = CCanDriver::GetFirstLibrary(library);
+    while (iterLibrary && !flagFound) {
+        bool iterChannel = CCanDriver::GetFirstChannel(library.m_nLibraryId, channel);
+        while (iterChannel) {
+            if (strcasecmp(name, channel.m_szDeviceName) == 0) {
+                flagFound = true;
+                break;
+            }
+            iterChannel = CCanDriver::GetNextChannel(channel);
+        }
+        iterLibrary = CCanDriver::GetNextLibrary(library);
+    }
+#else
+    bool iterChannel = CCanDriver::GetFirstChannel(channel);
+    while (iterChannel) {
+        if (strcasecmp(name, channel.m_szDeviceName) == 0) {
+            flagFound = true;
+            break;
+        }
+        iterChannel = CCanDriver::GetNextChannel(channel);
+    }
+#endif
+    if (!flagFound) {
+        fprintf(stdout, "FAILED!\n");
+        fprintf(err, "+++ error: %s could not be found\n", name);
+        return false;
+    }
+#if (OPTION_CANAPI_LIBRARY != 0)
+    retVal = driver.InitializeChannel(channel.m_nLibraryId, channel.m_nChannelNo, opts.m_OpMode);
+#else
+    retVal = driver.InitializeChannel(channel.m_nChannelNo, opts.m_OpMode);
+#endif
+#endif
+    if (retVal != CCanApi::NoError) {
+        fprintf(stdout, "FAILED!\n");
+        fprintf(err, "+++ error: CAN Controller could not be initialized (%i)\n", retVal);
+        return false;
+    }
+    retVal = driver.StartController(opts.m_Bitrate);
+    if (retVal != CCanApi::NoError) {
+        fprintf(stdout, "FAILED!\n");
+        fprintf(err, "+++ error: CAN Controller could not be started (%i)\n", retVal);
+        (void)driver.TeardownChannel();
+        return false;
+    }
+    fprintf(stdout, "OK!\n");
+    return true;
+}
+
+void CParallelTest::Close() {
+    for (size_t i = 0U; i < m_Receivers.size(); i++) {
+        if (m_Receivers[i].m_pDriver && m_Receivers[i].m_fOwner)
+            (void)m_Receivers[i].m_pDriver->TeardownChannel();
+        m_Receivers[i].m_pDriver = NULL;
+    }
+}
+
+uint64_t CParallelTest::Run(volatile int& running) {
+    std::vector<std::thread> receivers;
+    uint64_t start, expected;
+
+    if (!m_Transmitter.m_pDriver)
+        return 0U;
+    // (1) start a thread for each interface
+    m_nReady = 0;
+    m_fStart = false;
+    m_fStop = false;
+    for (size_t i = 0U; i < m_Receivers.size(); i++) {
+        if (m_Receivers[i].m_pDriver)
+            receivers.push_back(std::thread(&CParallelTest::ReceiverThread, this, &m_Receivers[i]));
+    }
+    std::thread transmitter(&CParallelTest::TransmitterThread, this, &running);
+    // (2) synchronized start when all threads are ready
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        while (m_nReady < (int)(receivers.size() + 1U))
+            m_Signal.wait(lock);
+        m_u64LastRx = GetTime();
+        m_fStart = true;
+        m_Signal.notify_all();
+    }
+    fprintf(stderr, "\nPress ^C to abort.\n");
+    fprintf(stdout, "\nTransmitting message(s) to %u receiver(s)...", (unsigned)receivers.size());
+    fflush(stdout);
+    transmitter.join();
+    // (3) afterburner: wait until the receivers are idle
+    start = GetTime();
+    while (running && ((GetTime() - start) < AFTERBURNER_MAX) &&
+           ((GetTime() - m_u64LastRx.load()) < AFTERBURNER_IDLE))
+        CTimer::Delay(10U * CTimer::MSEC);
+    m_fStop = true;
+    for (size_t i = 0U; i < receivers.size(); i++)
+        receivers[i].join();
+    fprintf(stdout, "%s\n\n", running ? "OK!" : "STOP!");
+    // (4) frames sent but never received are lost too
+    expected = m_Options.m_nStartNumber + m_u64Sent.load();
+    for (size_t i = 0U; i < m_Receivers.size(); i++) {
+        if (m_Receivers[i].m_pDriver && (m_Receivers[i].m_u64Expected < expected) &&
+            (CCanApi::Dlc2Len(m_Options.m_nTxCanDlc) || (m_Options.m_TestMode == SOptions::TxRANDOM)))
+            m_Receivers[i].m_u64Lost += expected - m_Receivers[i].m_u64Expected;
+    }
+    return m_u64Sent.load();
+}
+
+void CParallelTest::Report(FILE* out) {
+    uint64_t received = 0U, lost = 0U, reordered = 0U, latencies = 0U;
+    uint64_t latMin = UINT64_MAX, latMax = 0U;
+    double latSum = 0.0, duration;
+    size_t i;
+
+    if (!out)
+        return;
+    fprintf(out, "   Interface                 Frames  Rate[1/s]   Errors      Lost Reordered  Lat.min[ms] Lat.avg[ms] Lat.max[ms]\n");
+    for (i = 0U; i <= m_Receivers.size(); i++) {
+        const SPort* port = (i == 0U) ? &m_Transmitter : &m_Receivers[i - 1U];
+        if (!port->m_pDriver)
+            continue;
+        duration = (port->m_u64Stop > port->m_u64Start) ? (double)(port->m_u64Stop - port->m_u64Start) / 1000000000. : 0.0;
+        fprintf(out, "%s %-22s %10" PRIu64 " %10.1f %8" PRIu64,
+            (i == 0U) ? "TX" : "RX", port->m_szName, port->m_u64Frames,
+            (duration > 0.0) ? (double)port->m_u64Frames / duration : 0.0, port->m_u64Errors);
+        if (i == 0U) {
+            fprintf(out, "\n");
+            continue;
+        }
+        fprintf(out, " %9" PRIu64 " %9" PRIu64, port->m_u64Lost, port->m_u64Reordered);
+        if (port->m_u64Latencies)
+            fprintf(out, "  %11.3f %11.3f %11.3f\n", (double)port->m_u64LatMin / 1000000.,
+                port->m_dLatSum / (double)port->m_u64Latencies / 1000000., (double)port->m_u64LatMax / 1000000.);
+        else
+            fprintf(out, "  %11s %11s %11s\n", "-", "-", "-");
+        received += port->m_u64Frames;
+        lost += port->m_u64Lost;
+        reordered += port->m_u64Reordered;
+        latencies += port->m_u64Latencies;
+        latSum += port->m_dLatSum;
+        if (port->m_u64Latencies && (port->m_u64LatMin < latMin))
+            latMin = port->m_u64LatMin;
+        if (port->m_u64Latencies && (port->m_u64LatMax > latMax))
+            latMax = port->m_u64LatMax;
+    }
+    fprintf(out, "\nSent=%" PRIu64 "\n", m_Transmitter.m_u64Frames);
+    fprintf(out, "Received=%" PRIu64 " (%u receiver(s))\n", received, (unsigned)m_Receivers.size());
+    fprintf(out, "Lost=%" PRIu64 " (%.3f%%)\n", lost,
+        (m_Transmitter.m_u64Frames && m_Receivers.size()) ? ((double)lost * 100.0) / ((double)m_Transmitter.m_u64Frames * (double)m_Receivers.size()) : 0.0);
+    fprintf(out, "Reordered=%" PRIu64 "\n", reordered);
+    if (latencies)
+        fprintf(out, "Latency=%.3f/%.3f/%.3fms (min/avg/max)\n",
+            (double)latMin / 1000000., latSum / (double)latencies / 1000000., (double)latMax / 1000000.);
+    duration = (m_Transmitter.m_u64Stop > m_Transmitter.m_u64Start) ? (double)(m_Transmitter.m_u64Stop - m_Transmitter.m_u64Start) / 1000000000. : 0.0;
+    fprintf(out, "Time=%.3fsec\n\n", duration);
+}
+
+uint64_t CParallelTest::GetTime() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void CParallelTest::TransmitterThread(volatile int* running) {
+    CANAPI_Message_t message;
+    CANAPI_Return_t retVal;
+    SPort* port = &m_Transmitter;
+    uint64_t frames = 0U;
+    uint64_t number, until, slot;
+    uint8_t dlc = m_Options.m_nTxCanDlc;
+    bool random = (m_Options.m_TestMode == SOptions::TxRANDOM) ? true : false;
+
+    if ((port->m_nCpu >= 0) && !PinThread(port->m_nCpu))
+        fprintf(stderr, "+++ warning: transmitter could not be pinned to CPU %i\n", port->m_nCpu);
+    memset(&message, 0, sizeof(CANAPI_Message_t));
+    message.id = m_Options.m_nTxCanId;
+    message.xtd = 0;
+    message.rtr = 0;
+#if (CAN_FD_SUPPORTED != 0)
+    message.fdf = m_Options.m_OpMode.fdoe;
+    message.brs = m_Options.m_OpMode.brse;
+#endif
+    message.dlc = dlc;
+    WaitForStart();
+    port->m_u64Start = port->m_u64Stop = GetTime();
+    until = port->m_u64Start + (uint64_t)m_Options.m_nTxTime * 1000000000U;
+    while (*running && !m_fStop) {
+        if (m_Options.m_TestMode == SOptions::TxMODE) {
+            if (GetTime() >= until)
+                break;
+        } else if (frames >= m_Options.m_nTxFrames)
+            break;
+        number = frames + m_Options.m_nStartNumber;
+        for (int i = 0; i < 8; i++)
+            message.data[i] = (uint8_t)(number >> (8 * i));
+        if (random)
+#if (CAN_FD_SUPPORTED != 0)
+            message.dlc = dlc + (uint8_t)(rand() % ((CANFD_MAX_DLC - dlc) + 1));
+#else
+            message.dlc = dlc + (uint8_t)(rand() % ((CAN_MAX_DLC - dlc) + 1));
+#endif
+        /* remember the transmission time (seqlock) */
+        slot = number & (HISTORY - 1U);
+        m_pSeqHistory[slot].store(INVALID_NUMBER, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_pTimeHistory[slot].store(GetTime(), std::memory_order_relaxed);
+        m_pSeqHistory[slot].store(number, std::memory_order_release);
+        /* transmit message (repeat when busy) */
+        do {
+            port->m_u64Calls++;
+            retVal = port->m_pDriver->WriteMessage(message);
+        } while ((retVal == CCanApi::TransmitterBusy) && *running);
+        if (retVal == CCanApi::NoError) {
+            frames++;
+            m_u64Sent.store(frames, std::memory_order_relaxed);
+        } else
+            port->m_u64Errors++;
+        /* pause between two messages, as you please */
+        if (random)
+            CTimer::Delay(CTimer::USEC * (m_Options.m_nTxDelay + (uint64_t)(rand() % 54945)));
+        else if (m_Options.m_nTxDelay)
+            CTimer::Delay(CTimer::USEC * m_Options.m_nTxDelay);
+    }
+    port->m_u64Stop = GetTime();
+    port->m_u64Frames = frames;
+}
+
+void CParallelTest::ReceiverThread(SPort* port) {
+    CANAPI_Message_t message;
+    CANAPI_Return_t retVal;
+    uint64_t now, value, mask, diff, number, sent;
+    uint8_t length;
+
+    if ((port->m_nCpu >= 0) && !PinThread(port->m_nCpu))
+        fprintf(stderr, "+++ warning: receiver %s could not be pinned to CPU %i\n", port->m_szName, port->m_nCpu);
+    WaitForStart();
+    while (!m_fStop) {
+        retVal = port->m_pDriver->ReadMessage(message, 100U);
+        port->m_u64Calls++;
+        if (retVal == CCanApi::ReceiverEmpty)
+            continue;
+        if (retVal != CCanApi::NoError) {
+            port->m_u64Errors++;
+            continue;
+        }
+        /* only the frames of the transmitter */
+        if (message.sts || message.xtd || message.rtr || (message.id != m_Options.m_nTxCanId))
+            continue;
+        now = GetTime();
+        m_u64LastRx.store(now, std::memory_order_relaxed);
+        if (!port->m_u64Frames++)
+            port->m_u64Start = now;
+        port->m_u64Stop = now;
+        /* cross-check the up-counting number (as far as transmitted) */
+        length = CCanApi::Dlc2Len(message.dlc);
+        if (length == 0U)
+            continue;
+        if (length > 8U)
+            length = 8U;
+        value = 0U;
+        for (uint8_t i = 0U; i < length; i++)
+            value |= (uint64_t)message.data[i] << (8U * i);
+        mask = (length < 8U) ? ((1ULL << (8U * length)) - 1U) : UINT64_MAX;
+        diff = (value - port->m_u64Expected) & mask;
+        if (diff <= (mask >> 1)) {
+            /* in sequence, or frames are missing */
+            port->m_u64Lost += diff;
+            number = port->m_u64Expected + diff;
+            port->m_u64Expected = number + 1U;
+        } else {
+            /* duplicated or out of order */
+            port->m_u64Reordered++;
+            number = port->m_u64Expected - ((port->m_u64Expected - value) & mask);
+        }
+        /* latency from the transmission time (seqlock) */
+        size_t slot = (size_t)(number & (HISTORY - 1U));
+        value = m_pSeqHistory[slot].load(std::memory_order_acquire);
+        sent = m_pTimeHistory[slot].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if ((value == number) && (m_pSeqHistory[slot].load(std::memory_order_relaxed) == number) && (now >= sent)) {
+            now -= sent;
+            if (now < port->m_u64LatMin)
+                port->m_u64LatMin = now;
+            if (now > port->m_u64LatMax)
+                port->m_u64LatMax = now;
+            port->m_dLatSum += (double)now;
+            port->m_u64Latencies++;
+        }
+    }
+}
+
+void CParallelTest::WaitForStart() {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_nReady++;
+    m_Signal.notify_all();
+    while (!m_fStart)
+        m_Signal.wait(lock);
+}
+
+bool CParallelTest::PinThread(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set) == 0) ? true : false;
+#elif defined(_WIN32) || defined(_WIN64)
+    return (SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0) ? true : false;
+#else
+    (void)cpu;  // note: no thread affinity API on macOS
+    return false;
+#endif
+}
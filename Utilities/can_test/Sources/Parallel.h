@@ -0,0 +1,98 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  CAN Tester for generic Interfaces (CAN API V3)
+//
+//  Copyright (c) 2005-2010 Uwe Vogt, UV Software, Friedrichshafen
+//  Copyright (c) 2012-2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+#ifndef CAN_TEST_PARALLEL_H_INCLUDED
+#define CAN_TEST_PARALLEL_H_INCLUDED
+
+#include "Driver.h"
+#include "Options.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+/// \name   Parallel Load Test
+/// \brief  Runs a transmitter on the given interface and receivers on one or
+///         more other interfaces on the same bus, each on its own thread
+///         (optionally pinned to a CPU). All threads are started together;
+///         the receivers cross-check the up-counting numbers sent by the
+///         transmitter and measure the transmission latency.
+/// \{
+class CParallelTest {
+public:
+    static const int MAX_INTERFACES = 16;  // receiving interfaces
+    static const size_t HISTORY = 65536U;  // transmission times (power of 2)
+    struct SPort {
+        const char* m_szName;  // interface name
+        CCanDriver* m_pDriver;  // CAN API V3 driver
+        bool m_fOwner;  // driver opened by the test
+        int m_nCpu;  // CPU for the thread (-1 = any)
+        // transmitter or receiver statistics
+        uint64_t m_u64Frames;  // number of transmitted/received frames
+        uint64_t m_u64Errors;  // number of errors from the driver
+        uint64_t m_u64Calls;  // number of driver calls
+        uint64_t m_u64Lost;  // missing up-counting numbers
+        uint64_t m_u64Reordered;  // duplicated or out-of-order numbers
+        uint64_t m_u64Expected;  // next expected number
+        uint64_t m_u64Latencies;  // number of latency samples
+        uint64_t m_u64LatMin;  // latency (in [ns])
+        uint64_t m_u64LatMax;
+        double m_dLatSum;
+        uint64_t m_u64Start;  // first and last frame (in [ns])
+        uint64_t m_u64Stop;
+    };
+private:
+    const SOptions& m_Options;
+    char* m_szList;  // copy of the interface list
+    SPort m_Transmitter;
+    std::vector<SPort> m_Receivers;
+    CCanDriver* m_pDrivers;  // drivers of the receiving interfaces
+    std::atomic<uint64_t>* m_pSeqHistory;  // number of the frame in the slot
+    std::atomic<uint64_t>* m_pTimeHistory;  // transmission time of the frame
+    std::atomic<uint64_t> m_u64Sent;  // number of transmitted frames
+    std::atomic<uint64_t> m_u64LastRx;  // time of the last reception (in [ns])
+    std::atomic<bool> m_fStop;  // stop the receivers
+    std::mutex m_Mutex;  // synchronized start
+    std::condition_variable m_Signal;
+    int m_nReady;
+    bool m_fStart;
+public:
+    CParallelTest(const SOptions& opts);
+    virtual ~CParallelTest();
+
+    bool Open(CCanDriver& transmitter, FILE* err = stderr);  // open the receiving interfaces
+    uint64_t Run(volatile int& running);  // run the test (abort with ^C)
+    void Report(FILE* out);  // throughput, loss and latency
+    void Close();  // close the receiving interfaces
+
+    static bool OpenInterface(CCanDriver& driver, const char* name, const SOptions& opts, FILE* err = stderr);
+    static uint64_t GetTime();  // monotonic time (in [ns])
+private:
+    void TransmitterThread(volatile int* running);
+    void ReceiverThread(SPort* port);
+    void WaitForStart();
+    static bool PinThread(int cpu);
+};
+/// \}
+
+#endif  // CAN_TEST_PARALLEL_H_INCLUDED
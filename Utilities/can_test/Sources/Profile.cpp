@@ -0,0 +1,378 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  CAN Tester for generic Interfaces (CAN API V3)
+//
+//  Copyright (c) 2005-2010 Uwe Vogt, UV Software, Friedrichshafen
+//  Copyright (c) 2012-2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+#include "Profile.h"
+#include "Parallel.h"
+#include "Timer.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <queue>
+#include <utility>
+#include <functional>
+
+#include <inttypes.h>
+
+#define SPIN_TIME  100000U  // busy waiting for the last 100us (in [ns])
+
+CProfileTest::CProfileTest(const SOptions& opts) : m_Options(opts) {
+    m_u64Start = 0U;
+    m_u64Stop = 0U;
+}
+
+bool CProfileTest::Load(const char* filename, FILE* err) {
+    char line[MAX_LINE];
+    unsigned lineNo = 0U;
+    const char* error;
+    SMessage message;
+    FILE* fp;
+
+    if ((fp = fopen(filename, "r")) == NULL) {
+        fprintf(err, "+++ error: profile %s could not be opened\n", filename);
+        return false;
+    }
+    m_Messages.clear();
+    while (fgets(line, MAX_LINE, fp) != NULL) {
+        lineNo++;
+        if ((error = ParseLine(line, message)) != NULL) {
+            fprintf(err, "+++ error: %s:%u: %s\n", filename, lineNo, error);
+            fclose(fp);
+            return false;
+        }
+        if (message.m_u64Period == 0U)  // empty line or comment
+            continue;
+        if (m_Messages.size() >= (size_t)MAX_MESSAGES) {
+            fprintf(err, "+++ error: %s:%u: too many messages (max. %i)\n", filename, lineNo, MAX_MESSAGES);
+            fclose(fp);
+            return false;
+        }
+        m_Messages.push_back(message);
+    }
+    fclose(fp);
+    if (m_Messages.empty()) {
+        fprintf(err, "+++ error: profile %s contains no messages\n", filename);
+        return false;
+    }
+    return true;
+}
+
+const char* CProfileTest::ParseLine(char* line, SMessage& message) {
+    static const uint8_t fd_lengths[] = { 0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 12U, 16U, 20U, 24U, 32U, 48U, 64U };
+    uint8_t maxLength = m_Options.m_OpMode.fdoe ? 64U : 8U;
+    bool hasId = false;
+    char* token;
+    char* value;
+    char* end;
+    char* ptr;
+
+    memset(&message, 0, sizeof(SMessage));
+    message.m_u32Burst = 1U;
+    message.m_Lengths[0] = 8U;
+    message.m_nLengths = 1;
+    message.m_Payload = PayloadCounter;
+    if ((ptr = strchr(line, '#')) != NULL)
+        *ptr = '\0';
+    for (ptr = line; *ptr; ) {
+        /* next token: <key>[=<value>] */
+        while (*ptr && isspace((unsigned char)*ptr))
+            ptr++;
+        if (!*ptr)
+            break;
+        token = ptr;
+        while (*ptr && !isspace((unsigned char)*ptr))
+            ptr++;
+        if (*ptr)
+            *ptr++ = '\0';
+        if ((value = strchr(token, '=')) != NULL)
+            *value++ = '\0';
+        /* - id=<can-id> */
+        if (!strcmp(token, "id")) {
+            if (!value || !*value)
+                return "missing CAN identifier";
+            unsigned long id = strtoul(value, &end, 0);
+            if (*end || (id > CAN_MAX_XTD_ID))
+                return "illegal CAN identifier";
+            message.m_u32Id = (uint32_t)id;
+            if (id > CAN_MAX_STD_ID)
+                message.m_fXtd = true;
+            hasId = true;
+        }
+        /* - xtd */
+        else if (!strcmp(token, "xtd")) {
+            message.m_fXtd = true;
+        }
+        /* - period=<ms>, gap=<ms>, offset=<ms> */
+        else if (!strcmp(token, "period") || !strcmp(token, "gap") || !strcmp(token, "offset")) {
+            if (!value || !*value)
+                return "missing time value";
+            double ms = strtod(value, &end);
+            if (*end || (ms < 0.0) || (ms > 3600000.0))
+                return "illegal time value";
+            uint64_t ns = (uint64_t)(ms * 1000000.0 + 0.5);
+            if (token[0] == 'p') {
+                if (ns < 1000U)
+                    return "period must be at least 1us";
+                message.m_u64Period = ns;
+            } else if (token[0] == 'g')
+                message.m_u64Gap = ns;
+            else
+                message.m_u64Offset = ns;
+        }
+        /* - burst=<n> */
+        else if (!strcmp(token, "burst")) {
+            if (!value || !*value)
+                return "missing burst length";
+            unsigned long n = strtoul(value, &end, 0);
+            if (*end || (n < 1U) || (n > 65535U))
+                return "illegal burst length";
+            message.m_u32Burst = (uint32_t)n;
+        }
+        /* - dlc=<length>|<min>-<max>|<length>,<length>,... */
+        else if (!strcmp(token, "dlc") || !strcmp(token, "len")) {
+            if (!value || !*value)
+                return "missing data length";
+            unsigned long lo = strtoul(value, &end, 10);
+            if (end == value)
+                return "illegal data length";
+            message.m_nLengths = 0;
+            if (*end == '-') {
+                /* all valid lengths in the range */
+                unsigned long hi = strtoul(end + 1, &end, 10);
+                if (*end || (hi < lo) || (hi > maxLength))
+                    return "illegal data length";
+                for (int i = 0; i < 16; i++) {
+                    if ((fd_lengths[i] >= lo) && (fd_lengths[i] <= hi))
+                        message.m_Lengths[message.m_nLengths++] = fd_lengths[i];
+                }
+            } else {
+                /* one or more lengths (repeat a length for weight) */
+                for (;;) {
+                    if ((lo > maxLength) || (message.m_nLengths >= 16))
+                        return "illegal data length";
+                    message.m_Lengths[message.m_nLengths++] = (uint8_t)lo;
+                    if (*end != ',')
+                        break;
+                    value = end + 1;
+                    lo = strtoul(value, &end, 10);
+                    if (end == value)
+                        return "illegal data length";
+                }
+                if (*end)
+                    return "illegal data length";
+            }
+            if (message.m_nLengths == 0)
+                return "illegal data length";
+        }
+        /* - data=counter|random|<hex-bytes> */
+        else if (!strcmp(token, "data")) {
+            if (!value || !*value)
+                return "missing payload pattern";
+            if (!strcmp(value, "counter"))
+                message.m_Payload = PayloadCounter;
+            else if (!strcmp(value, "random"))
+                message.m_Payload = PayloadRandom;
+            else {
+                size_t n = strlen(value);
+                if ((n % 2U) || (n > 128U) || (strspn(value, "0123456789abcdefABCDEF") != n))
+                    return "illegal payload pattern";
+                for (size_t i = 0U; i < n; i += 2U) {
+                    char byte[3] = { value[i], value[i + 1U], '\0' };
+                    message.m_Data[i / 2U] = (uint8_t)strtoul(byte, NULL, 16);
+                }
+                message.m_u8Size = (uint8_t)(n / 2U);
+                message.m_Payload = PayloadFixed;
+            }
+        }
+        else
+            return "unknown key";
+    }
+    if (!hasId && !message.m_u64Period)
+        return NULL;  // empty line or comment
+    if (!hasId)
+        return "missing key `id'";
+    if (!message.m_u64Period)
+        return "missing key `period'";
+    if ((uint64_t)(message.m_u32Burst - 1U) * message.m_u64Gap >= message.m_u64Period)
+        return "burst longer than period";
+    if (message.m_fXtd && m_Options.m_OpMode.nxtd)
+        return "extended identifier not allowed";
+    return NULL;
+}
+
+uint64_t CProfileTest::Run(CCanDriver& driver, volatile int& running) {
+    std::priority_queue<std::pair<uint64_t, size_t>, std::vector<std::pair<uint64_t, size_t> >,
+                        std::greater<std::pair<uint64_t, size_t> > > schedule;
+    CANAPI_Message_t message;
+    CANAPI_Return_t retVal;
+    uint64_t frames = 0U;
+    uint64_t until, now;
+
+    memset(&message, 0, sizeof(CANAPI_Message_t));
+    fprintf(stderr, "\nPress ^C to abort.\n");
+    fprintf(stdout, "\nTransmitting %u message(s) by profile...", (unsigned)m_Messages.size());
+    fflush(stdout);
+    m_u64Start = CParallelTest::GetTime();
+    until = m_u64Start + (uint64_t)m_Options.m_nTxTime * 1000000000U;
+    for (size_t i = 0U; i < m_Messages.size(); i++) {
+        SMessage& entry = m_Messages[i];
+        entry.m_u64Cycle = entry.m_u64Due = m_u64Start + entry.m_u64Offset;
+        entry.m_u32InBurst = 0U;
+        entry.m_u64Number = m_Options.m_nStartNumber;
+        entry.m_u64Frames = entry.m_u64Errors = entry.m_u64Busy = 0U;
+        entry.m_u64LagMax = entry.m_u64Bits = 0U;
+        entry.m_dLagSum = 0.0;
+        schedule.push(std::make_pair(entry.m_u64Due, i));
+    }
+    while (running) {
+        SMessage& entry = m_Messages[schedule.top().second];
+        size_t index = schedule.top().second;
+        schedule.pop();
+        if (m_Options.m_TestMode == SOptions::TxMODE) {
+            if (entry.m_u64Due >= until)
+                break;
+        } else if (frames >= m_Options.m_nTxFrames)
+            break;
+        /* wait for the due time of the message */
+        WaitUntil(entry.m_u64Due, running);
+        if (!running)
+            break;
+        now = CParallelTest::GetTime();
+        /* transmit message (repeat when busy) */
+        message.id = entry.m_u32Id;
+        message.xtd = entry.m_fXtd ? 1 : 0;
+        message.rtr = 0;
+#if (CAN_FD_SUPPORTED != 0)
+        message.fdf = m_Options.m_OpMode.fdoe;
+        message.brs = m_Options.m_OpMode.brse;
+#endif
+        MakePayload(entry, message);
+        while ((retVal = driver.WriteMessage(message)) == CCanApi::TransmitterBusy) {
+            entry.m_u64Busy++;
+            if (!running)
+                break;
+        }
+        if (retVal == CCanApi::NoError) {
+            uint64_t lag = (now > entry.m_u64Due) ? (now - entry.m_u64Due) : 0U;
+            if (lag > entry.m_u64LagMax)
+                entry.m_u64LagMax = lag;
+            entry.m_dLagSum += (double)lag;
+            entry.m_u64Bits += stat_frame_bits(&message, 1.0);
+            entry.m_u64Frames++;
+            frames++;
+        } else
+            entry.m_u64Errors++;
+        /* schedule the next message (note: no catch-up skipping) */
+        if (++entry.m_u32InBurst < entry.m_u32Burst) {
+            entry.m_u64Due += entry.m_u64Gap;
+        } else {
+            entry.m_u32InBurst = 0U;
+            entry.m_u64Cycle += entry.m_u64Period;
+            entry.m_u64Due = entry.m_u64Cycle;
+        }
+        schedule.push(std::make_pair(entry.m_u64Due, index));
+    }
+    m_u64Stop = CParallelTest::GetTime();
+    if ((m_Options.m_TestMode == SOptions::TxMODE) && running && (m_u64Stop < until))
+        m_u64Stop = until;  // the rates refer to the given time
+    fprintf(stdout, "%s\n\n", running ? "OK!" : "STOP!");
+    return frames;
+}
+
+void CProfileTest::Report(FILE* out) {
+    uint64_t frames = 0U, errors = 0U, busy = 0U;
+    double planned = 0.0, plannedBits = 0.0, achievedBits = 0.0;
+    CANAPI_Message_t frame;
+    double duration, rate;
+
+    if (!out)
+        return;
+    duration = (m_u64Stop > m_u64Start) ? (double)(m_u64Stop - m_u64Start) / 1000000000. : 0.0;
+    fprintf(out, "     CAN-ID  Period[ms]  Burst  Planned[1/s] Achieved[1/s]     Frames   Errors     Busy  Lag.avg[ms] Lag.max[ms]\n");
+    for (size_t i = 0U; i < m_Messages.size(); i++) {
+        const SMessage& entry = m_Messages[i];
+        double bits = 0.0;
+        rate = (double)entry.m_u32Burst * 1000000000. / (double)entry.m_u64Period;
+        memset(&frame, 0, sizeof(CANAPI_Message_t));
+        frame.xtd = entry.m_fXtd ? 1 : 0;
+        for (int j = 0; j < entry.m_nLengths; j++) {
+            frame.dlc = CCanApi::Len2Dlc(entry.m_Lengths[j]);
+            bits += (double)stat_frame_bits(&frame, 1.0);
+        }
+        planned += rate;
+        plannedBits += rate * bits / (double)entry.m_nLengths;
+        achievedBits += (double)entry.m_u64Bits;
+        fprintf(out, entry.m_fXtd ? "   %08" PRIX32 : "        %03" PRIX32, entry.m_u32Id);
+        fprintf(out, " %11.3f %6" PRIu32 " %13.1f %13.1f %10" PRIu64 " %8" PRIu64 " %8" PRIu64,
+            (double)entry.m_u64Period / 1000000., entry.m_u32Burst, rate,
+            (duration > 0.0) ? (double)entry.m_u64Frames / duration : 0.0,
+            entry.m_u64Frames, entry.m_u64Errors, entry.m_u64Busy);
+        if (entry.m_u64Frames)
+            fprintf(out, "  %11.3f %11.3f\n", entry.m_dLagSum / (double)entry.m_u64Frames / 1000000.,
+                (double)entry.m_u64LagMax / 1000000.);
+        else
+            fprintf(out, "  %11s %11s\n", "-", "-");
+        frames += entry.m_u64Frames;
+        errors += entry.m_u64Errors;
+        busy += entry.m_u64Busy;
+    }
+    rate = (duration > 0.0) ? (double)frames / duration : 0.0;
+    fprintf(out, "\nMessage(s)=%" PRIu64 "\n", frames);
+    fprintf(out, "Error(s)=%" PRIu64 "\n", errors);
+    fprintf(out, "Busy=%" PRIu64 "\n", busy);
+    fprintf(out, "Planned=%.1f msg/s\n", planned);
+    fprintf(out, "Achieved=%.1f msg/s (%.1f%%)\n", rate, (planned > 0.0) ? (rate * 100.0) / planned : 0.0);
+    if (!m_Options.m_OpMode.fdoe && (m_Options.m_BusSpeed.nominal.speed > 0.0))
+        fprintf(out, "Bus-load=%.1f%% planned, %.1f%% achieved (w/o bit-stuffing)\n",
+            (plannedBits * 100.0) / m_Options.m_BusSpeed.nominal.speed,
+            (duration > 0.0) ? (achievedBits * 100.0) / duration / m_Options.m_BusSpeed.nominal.speed : 0.0);
+    fprintf(out, "Time=%.3fsec\n\n", duration);
+}
+
+void CProfileTest::MakePayload(SMessage& entry, CANAPI_Message_t& message) {
+    uint8_t length = entry.m_Lengths[(entry.m_nLengths > 1) ? (rand() % entry.m_nLengths) : 0];
+
+    message.dlc = CCanApi::Len2Dlc(length);
+    memset(message.data, 0, length);
+    switch (entry.m_Payload) {
+    case PayloadCounter:
+        for (uint8_t i = 0U; (i < length) && (i < 8U); i++)
+            message.data[i] = (uint8_t)(entry.m_u64Number >> (8U * i));
+        entry.m_u64Number++;
+        break;
+    case PayloadRandom:
+        for (uint8_t i = 0U; i < length; i++)
+            message.data[i] = (uint8_t)(rand() & 0xFF);
+        break;
+    case PayloadFixed:
+        memcpy(message.data, entry.m_Data, (length < entry.m_u8Size) ? length : entry.m_u8Size);
+        break;
+    }
+}
+
+void CProfileTest::WaitUntil(uint64_t due, volatile int& running) {
+    uint64_t now = CParallelTest::GetTime();
+
+    /* sleep as long as possible, then spin for the last microseconds */
+    if (due > (now + SPIN_TIME))
+        CTimer::Delay(CTimer::USEC * ((due - now - SPIN_TIME) / 1000U));
+    while (running && (CParallelTest::GetTime() < due))
+        ;
+}
@@ -0,0 +1,100 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  CAN Tester for generic Interfaces (CAN API V3)
+//
+//  Copyright (c) 2005-2010 Uwe Vogt, UV Software, Friedrichshafen
+//  Copyright (c) 2012-2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+#ifndef CAN_TEST_PROFILE_H_INCLUDED
+#define CAN_TEST_PROFILE_H_INCLUDED
+
+#include "Driver.h"
+#include "Options.h"
+#include "can_stat.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+/// \name   Traffic Profile Generator
+/// \brief  Sends the messages described in a profile file, each with its
+///         own period, data length distribution, payload pattern and burst
+///         shape. The messages are scheduled by their due time and paced
+///         precisely; the planned and the achieved message rate per CAN
+///         identifier are reported to find the point of saturation.
+///
+///         A profile file contains one message per line (key=value pairs):
+///
+///             id=<can-id> period=<ms> [xtd] [dlc=<length>|<min>-<max>|<len>,...]
+///                [data=counter|random|<hex-bytes>] [burst=<n>] [gap=<ms>] [offset=<ms>]
+///
+///         Everything after '#' is a comment.
+/// \{
+class CProfileTest {
+public:
+    static const int MAX_MESSAGES = 4096;  // messages per profile
+    static const int MAX_LINE = 1024;  // characters per line
+    enum EPayload {
+        PayloadCounter = 0,  // up-counting number (per CAN identifier)
+        PayloadRandom,  // random data
+        PayloadFixed  // constant data
+    };
+    struct SMessage {
+        // message description
+        uint32_t m_u32Id;  // CAN identifier
+        bool m_fXtd;  // extended identifier
+        uint64_t m_u64Period;  // period (in [ns])
+        uint64_t m_u64Offset;  // phase offset (in [ns])
+        uint32_t m_u32Burst;  // messages per period
+        uint64_t m_u64Gap;  // gap between the messages of a burst (in [ns])
+        uint8_t m_Lengths[16];  // data lengths (evenly distributed)
+        int m_nLengths;
+        EPayload m_Payload;  // payload pattern
+        uint8_t m_Data[64];  // constant data
+        uint8_t m_u8Size;
+        // run-time data
+        uint64_t m_u64Cycle;  // begin of the current period (in [ns])
+        uint64_t m_u64Due;  // due time of the next message (in [ns])
+        uint32_t m_u32InBurst;  // messages sent in the current period
+        uint64_t m_u64Number;  // up-counting number
+        // statistics
+        uint64_t m_u64Frames;  // number of transmitted messages
+        uint64_t m_u64Errors;  // number of errors from the driver
+        uint64_t m_u64Busy;  // number of retries (transmitter busy)
+        uint64_t m_u64LagMax;  // delay behind the schedule (in [ns])
+        double m_dLagSum;
+        uint64_t m_u64Bits;  // sum of the frame lengths (in [bit], w/o stuffing)
+    };
+private:
+    const SOptions& m_Options;
+    std::vector<SMessage> m_Messages;
+    uint64_t m_u64Start;  // begin and end of the test (in [ns])
+    uint64_t m_u64Stop;
+public:
+    CProfileTest(const SOptions& opts);
+    virtual ~CProfileTest() {}
+
+    bool Load(const char* filename, FILE* err = stderr);  // read the profile file
+    uint64_t Run(CCanDriver& driver, volatile int& running);  // run the test (abort with ^C)
+    void Report(FILE* out);  // planned and achieved rates
+private:
+    const char* ParseLine(char* line, SMessage& message);  // returns an error text
+    void MakePayload(SMessage& entry, CANAPI_Message_t& message);
+    static void WaitUntil(uint64_t due, volatile int& running);
+};
+/// \}
+
+#endif  // CAN_TEST_PROFILE_H_INCLUDED
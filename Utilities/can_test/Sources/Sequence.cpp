@@ -0,0 +1,363 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  CAN Tester for generic Interfaces (CAN API V3)
+//
+//  Copyright (c) 2005-2010 Uwe Vogt, UV Software, Friedrichshafen
+//  Copyright (c) 2012-2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+#include "Sequence.h"
+#include "Parallel.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <new>
+
+#include <inttypes.h>
+
+#define STATUS_INTERVAL  100000000U  // status register at most every 100ms
+#define MAX_GAP  0x10000U  // larger gaps are taken as counter restart
+#define HISTORY  CSequenceAnalyzer::MAX_HISTORY  // remembered numbers below the expected
+
+static bool CompareId(const CSequenceAnalyzer::SEntry* a, const CSequenceAnalyzer::SEntry* b) {
+    return (a->m_u32Id < b->m_u32Id);
+}
+
+CSequenceAnalyzer::CSequenceAnalyzer(CCanDriver& driver, const SOptions& opts) : m_Driver(driver), m_Options(opts) {
+    m_StdEntries = new SEntry[CAN_MAX_STD_ID + 1];
+    for (uint32_t i = 0U; i <= CAN_MAX_STD_ID; i++)
+        Reset(&m_StdEntries[i], i, false);
+    m_XtdEntries.reserve(4096U);
+    if (stat_idmap_init(&m_XtdMap, 8192U) < 0)
+        throw std::bad_alloc();
+    m_u32Window = opts.m_u32Analyze ? opts.m_u32Analyze : 1U;
+    m_Window.assign(m_u32Window, SBucket());
+    m_u64Frames = 0U;
+    m_u64Unchecked = 0U;
+    m_u64Errors = 0U;
+    m_u64Lost = 0U;
+    m_u64Bursts = 0U;
+    m_u64BurstsOverflow = 0U;
+    m_u64BurstsStatus = 0U;
+    m_u64Overflows = 0U;
+    m_u64OverflowsStart = 0U;
+    m_u8Status = 0x00U;
+    m_u8LastStatus = 0x00U;
+    m_u64LastStatus = 0U;
+    m_u64Start = 0U;
+    m_u64Stop = 0U;
+}
+
+CSequenceAnalyzer::~CSequenceAnalyzer() {
+    delete[] m_StdEntries;
+    stat_idmap_free(&m_XtdMap);
+}
+
+uint64_t CSequenceAnalyzer::Run(volatile int& running) {
+    CANAPI_Message_t message;
+    CANAPI_Return_t retVal;
+    uint64_t now, second, counted, tick = 0U;
+    int64_t lost;
+    uint8_t length;
+
+    /* note: overflows before the start are not counted */
+    (void)m_Driver.GetProperty(CANPROP_GET_RCV_QUEUE_OVFL, (void*)&m_u64Overflows, sizeof(uint64_t));
+    m_u64OverflowsStart = m_u64Overflows;
+    fprintf(stderr, "\nPress ^C to abort.\n");
+    fprintf(stdout, "\nReceiving message(s) and checking up-counting numbers per CAN identifier...\n");
+    fflush(stdout);
+    m_u64Start = CParallelTest::GetTime();
+    while (running) {
+        retVal = m_Driver.ReadMessage(message, 100U);
+        now = CParallelTest::GetTime();
+        /* next second: print the last one and clear its bucket */
+        second = (now - m_u64Start) / 1000000000U;
+        while (tick < second) {
+            tick++;
+            PrintInterval(stdout, tick);
+            m_Window[tick % m_u32Window].m_u64Frames = 0U;
+            m_Window[tick % m_u32Window].m_u64Lost = 0U;
+        }
+        if (retVal == CCanApi::ReceiverEmpty)
+            continue;
+        if (retVal != CCanApi::NoError) {
+            m_u64Errors++;
+            continue;
+        }
+        m_u64Frames++;
+        m_Window[tick % m_u32Window].m_u64Frames++;
+        /* only data frames with an up-counting number */
+        length = (message.sts || message.rtr) ? 0U : CCanApi::Dlc2Len(message.dlc);
+        if (length == 0U) {
+            m_u64Unchecked++;
+            continue;
+        }
+        counted = tick;
+        if ((lost = Analyze(message, (length < 8U) ? length : 8U, counted)) > 0) {
+            m_Window[tick % m_u32Window].m_u64Lost += (uint64_t)lost;
+            Correlate(now);
+            if (m_Options.m_fStopOnError) {
+                fprintf(stdout, "+++ %" PRIi64 " frame(s) of CAN-ID %" PRIX32 "h lost\n", lost, message.id);
+                break;
+            }
+        } else if (lost < 0) {
+            /* a late frame: taken back from the second it was counted in
+             * (note: unless this second has left the sliding window)
+             */
+            SBucket& bucket = m_Window[counted % m_u32Window];
+            if (((tick - counted) < m_u32Window) && bucket.m_u64Lost)
+                bucket.m_u64Lost--;
+        }
+    }
+    m_u64Stop = CParallelTest::GetTime();
+    /* the queue overflow counter at the end */
+    (void)m_Driver.GetProperty(CANPROP_GET_RCV_QUEUE_OVFL, (void*)&m_u64Overflows, sizeof(uint64_t));
+    fprintf(stdout, "%s\n\n", running ? "STOP!" : "OK!");
+    return m_u64Frames;
+}
+
+void CSequenceAnalyzer::Report(FILE* out) {
+    std::vector<const SEntry*> entries;
+    uint64_t ids = 0U, duplicates = 0U, reordered = 0U, restarts = 0U;
+    double duration;
+    size_t i;
+
+    if (!out)
+        return;
+    /* CAN identifier with anomalies (or all if verbose) */
+    for (i = 0U; i <= (size_t)CAN_MAX_STD_ID; i++) {
+        if (!m_StdEntries[i].m_fSynced)
+            continue;
+        ids++;
+        if (m_StdEntries[i].m_u64Lost || m_StdEntries[i].m_u64Duplicates || m_StdEntries[i].m_u64Reordered ||
+            m_StdEntries[i].m_u64Restarts || m_Options.m_fVerbose)
+            entries.push_back(&m_StdEntries[i]);
+    }
+    std::vector<const SEntry*> xtd;
+    for (i = 0U; i < m_XtdEntries.size(); i++) {
+        ids++;
+        if (m_XtdEntries[i].m_u64Lost || m_XtdEntries[i].m_u64Duplicates || m_XtdEntries[i].m_u64Reordered ||
+            m_XtdEntries[i].m_u64Restarts || m_Options.m_fVerbose)
+            xtd.push_back(&m_XtdEntries[i]);
+    }
+    std::sort(xtd.begin(), xtd.end(), CompareId);
+    entries.insert(entries.end(), xtd.begin(), xtd.end());
+    if (!entries.empty()) {
+        fprintf(out, "     CAN-ID       Frames       Lost   Bursts  Max.burst  Duplicates  Reordered  Restarts\n");
+        for (i = 0U; i < entries.size(); i++) {
+            const SEntry* entry = entries[i];
+            fprintf(out, entry->m_fXtd ? "   %08" PRIX32 : "        %03" PRIX32, entry->m_u32Id);
+            fprintf(out, " %12" PRIu64 " %10" PRIu64 " %8" PRIu64 " %10" PRIu64 " %11" PRIu64 " %10" PRIu64 " %9" PRIu64 "\n",
+                entry->m_u64Frames, entry->m_u64Lost, entry->m_u64Bursts, entry->m_u64MaxBurst,
+                entry->m_u64Duplicates, entry->m_u64Reordered, entry->m_u64Restarts);
+        }
+        fputc('\n', out);
+    }
+    for (i = 0U; i <= (size_t)CAN_MAX_STD_ID; i++) {
+        duplicates += m_StdEntries[i].m_u64Duplicates;
+        reordered += m_StdEntries[i].m_u64Reordered;
+        restarts += m_StdEntries[i].m_u64Restarts;
+    }
+    for (i = 0U; i < m_XtdEntries.size(); i++) {
+        duplicates += m_XtdEntries[i].m_u64Duplicates;
+        reordered += m_XtdEntries[i].m_u64Reordered;
+        restarts += m_XtdEntries[i].m_u64Restarts;
+    }
+    duration = (m_u64Stop > m_u64Start) ? (double)(m_u64Stop - m_u64Start) / 1000000000. : 0.0;
+    fprintf(out, "Message(s)=%" PRIu64 " (%" PRIu64 " w/o number)\n", m_u64Frames, m_u64Unchecked);
+    fprintf(out, "Error(s)=%" PRIu64 "\n", m_u64Errors);
+    fprintf(out, "Identifier(s)=%" PRIu64 " (%u with anomalies)\n", ids, (unsigned)entries.size());
+    fprintf(out, "Lost=%" PRIu64 " (%.3f%%)\n", m_u64Lost,
+        (m_u64Frames + m_u64Lost) ? ((double)m_u64Lost * 100.0) / (double)(m_u64Frames + m_u64Lost) : 0.0);
+    fprintf(out, "Duplicates=%" PRIu64 "\n", duplicates);
+    fprintf(out, "Reordered=%" PRIu64 "\n", reordered);
+    fprintf(out, "Restarts=%" PRIu64 "\n", restarts);
+    fprintf(out, "Loss burst(s)=%" PRIu64 " (%" PRIu64 " with queue overflow, %" PRIu64 " with status flags",
+        m_u64Bursts, m_u64BurstsOverflow, m_u64BurstsStatus);
+    PrintStatus(out, m_u8Status);
+    fprintf(out, ")\n");
+    fprintf(out, "Queue overflow(s)=%" PRIu64 "\n", m_u64Overflows - m_u64OverflowsStart);
+    fprintf(out, "Time=%.3fsec\n\n", duration);
+}
+
+int64_t CSequenceAnalyzer::Analyze(const CANAPI_Message_t& message, uint8_t length, uint64_t& second) {
+    SEntry* entry = message.xtd ? Lookup(message.id) : &m_StdEntries[message.id & CAN_MAX_STD_ID];
+    uint64_t value = 0U, mask, diff;
+
+    for (uint8_t i = 0U; i < length; i++)
+        value |= (uint64_t)message.data[i] << (8U * i);
+    mask = (length < 8U) ? ((1ULL << (8U * length)) - 1U) : UINT64_MAX;
+    entry->m_u64Frames++;
+    if (!entry->m_fSynced) {
+        /* first frame: synchronize on its number */
+        entry->m_fSynced = true;
+        entry->m_u64Expected = value + 1U;
+        entry->m_u64Received = 1U;
+        entry->m_u64Late = 0U;
+        return 0;
+    }
+    diff = (value - entry->m_u64Expected) & mask;
+    if (diff == 0U) {
+        /* in sequence */
+        entry->m_u64Received = (entry->m_u64Received << 1) | 1U;
+        entry->m_u64Late <<= 1;
+        entry->m_u64Expected++;
+        return 0;
+    }
+    if ((diff <= (mask >> 1)) && (diff < MAX_GAP)) {
+        /* frames are missing (loss burst) */
+        entry->m_u64Received = (((diff + 1U) < HISTORY) ? (entry->m_u64Received << (diff + 1U)) : 0U) | 1U;
+        entry->m_u64Late = ((diff + 1U) < HISTORY) ? (entry->m_u64Late << (diff + 1U)) : 0U;
+        /* note: the second of the loss is remembered per missing number */
+        for (uint64_t n = (diff < HISTORY) ? (value - diff) : (value - HISTORY); n != value; n++)
+            entry->m_u32Second[n % HISTORY] = (uint32_t)second;
+        entry->m_u64Expected += diff + 1U;
+        entry->m_u64Lost += diff;
+        entry->m_u64Bursts++;
+        if (diff > entry->m_u64MaxBurst)
+            entry->m_u64MaxBurst = diff;
+        m_u64Lost += diff;
+        return (int64_t)diff;
+    }
+    diff = (entry->m_u64Expected - value) & mask;
+    if ((diff > 0U) && (diff <= HISTORY)) {
+        /* a number already received (duplicate) or missed (late) */
+        uint64_t bit = 1ULL << (diff - 1U);
+        if (entry->m_u64Received & bit) {
+            entry->m_u64Duplicates++;
+        } else {
+            entry->m_u64Received |= bit;
+            entry->m_u64Late |= bit;
+            entry->m_u64Reordered++;
+            if (entry->m_u64Lost) {
+                entry->m_u64Lost--;
+                m_u64Lost--;
+                second = (uint64_t)entry->m_u32Second[value % HISTORY];
+                /* the gap is closed when all of its frames have been received */
+                if (IsGapClosed(entry, diff) && entry->m_u64Bursts) {
+                    entry->m_u64Bursts--;
+                    if (m_u64Bursts)
+                        m_u64Bursts--;
+                }
+                return -1;
+            }
+        }
+        return 0;
+    }
+    /* counter restart: synchronize again */
+    entry->m_u64Expected = value + 1U;
+    entry->m_u64Received = 1U;
+    entry->m_u64Late = 0U;
+    entry->m_u64Restarts++;
+    return 0;
+}
+
+void CSequenceAnalyzer::Correlate(uint64_t now) {
+    CANAPI_Status_t status;
+    uint64_t overflows = 0U;
+
+    m_u64Bursts++;
+    /* - receive queue overflow since the last loss burst */
+    if ((m_Driver.GetProperty(CANPROP_GET_RCV_QUEUE_OVFL, (void*)&overflows, sizeof(uint64_t)) == CCanApi::NoError) &&
+        (overflows > m_u64Overflows)) {
+        m_u64Overflows = overflows;
+        m_u64BurstsOverflow++;
+    }
+    /* - status register (note: may require a round-trip to the interface) */
+    if ((now - m_u64LastStatus) >= STATUS_INTERVAL) {
+        if (m_Driver.GetStatus(status) == CCanApi::NoError)
+            m_u8LastStatus = status.byte;
+        m_u64LastStatus = now;
+    }
+    status.byte = m_u8LastStatus;
+    if (status.bus_off || status.warning_level || status.bus_error || status.message_lost || status.queue_overrun) {
+        m_u64BurstsStatus++;
+        m_u8Status |= status.byte;
+    }
+}
+
+void CSequenceAnalyzer::PrintInterval(FILE* out, uint64_t seconds) {
+    uint64_t frames = 0U, lost = 0U;
+
+    for (uint32_t i = 0U; i < m_u32Window; i++) {
+        frames += m_Window[i].m_u64Frames;
+        lost += m_Window[i].m_u64Lost;
+    }
+    fprintf(out, "%6" PRIu64 "s  Frames=%" PRIu64 "  Lost=%" PRIu64 "  Loss=%.3f%% (last %" PRIu32 "s)  Bursts=%" PRIu64 " (QUE=%" PRIu64 ", Status=%" PRIu64 ")\n",
+        seconds, m_u64Frames, m_u64Lost, (frames + lost) ? ((double)lost * 100.0) / (double)(frames + lost) : 0.0,
+        (seconds < m_u32Window) ? (uint32_t)seconds : m_u32Window, m_u64Bursts, m_u64BurstsOverflow, m_u64BurstsStatus);
+    fflush(out);
+}
+
+CSequenceAnalyzer::SEntry* CSequenceAnalyzer::Lookup(uint32_t u32Id) {
+    size_t index;
+    int rc;
+
+    // the identifier map yields the index of the entry (new ones are appended)
+    if ((rc = stat_idmap_lookup(&m_XtdMap, u32Id, &index)) < 0)
+        throw std::bad_alloc();
+    if (rc > 0) {
+        m_XtdEntries.resize(index + 1U);
+        Reset(&m_XtdEntries[index], u32Id, true);
+    }
+    return &m_XtdEntries[index];
+}
+
+void CSequenceAnalyzer::Reset(SEntry* entry, uint32_t u32Id, bool fXtd) {
+    memset(entry, 0, sizeof(SEntry));
+    entry->m_u32Id = u32Id;
+    entry->m_fXtd = fXtd;
+}
+
+bool CSequenceAnalyzer::IsGapClosed(const SEntry* entry, uint64_t diff) {
+    uint64_t inOrder = entry->m_u64Received & ~entry->m_u64Late;
+    uint64_t bit;
+    uint32_t i;
+
+    /* the gap of a late number is bounded by the numbers received in order
+     * (the frames before and after the gap), and it is closed when none of
+     * its numbers is missing (note: 'diff' is the distance to the expected)
+     */
+    for (i = (uint32_t)diff + 1U; i <= HISTORY; i++) {  /* older numbers */
+        bit = 1ULL << (i - 1U);
+        if (inOrder & bit)
+            break;
+        if (!(entry->m_u64Received & bit))
+            return false;
+    }
+    if (i > HISTORY)  /* note: the gap begins beyond the history */
+        return false;
+    for (i = (uint32_t)diff - 1U; i > 0U; i--) {  /* newer numbers */
+        bit = 1ULL << (i - 1U);
+        if (inOrder & bit)
+            break;
+        if (!(entry->m_u64Received & bit))
+            return false;
+    }
+    return true;
+}
+
+void CSequenceAnalyzer::PrintStatus(FILE* out, uint8_t status) {
+    CANAPI_Status_t flags;
+
+    flags.byte = status;
+    fprintf(out, "%s%s%s%s%s",
+        (flags.bus_off) ? " BO" : "",
+        (flags.warning_level) ? " WL" : "",
+        (flags.bus_error) ? " BE" : "",
+        (flags.message_lost) ? " ML" : "",
+        (flags.queue_overrun) ? " QUE" : "");
+}
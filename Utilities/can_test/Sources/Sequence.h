@@ -0,0 +1,106 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  CAN Tester for generic Interfaces (CAN API V3)
+//
+//  Copyright (c) 2005-2010 Uwe Vogt, UV Software, Friedrichshafen
+//  Copyright (c) 2012-2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+#ifndef CAN_TEST_SEQUENCE_H_INCLUDED
+#define CAN_TEST_SEQUENCE_H_INCLUDED
+
+#include "Driver.h"
+#include "Options.h"
+#include "can_stat.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+/// \name   Sequence Analyzer
+/// \brief  Receiver test that checks the up-counting numbers (little-endian,
+///         first up to 8 data bytes) per CAN identifier: gaps (lost frames),
+///         duplicates, reordered frames and counter restarts. The frames of
+///         the last 64 numbers are remembered per identifier to tell late
+///         frames from duplicates. The loss rate is computed over a sliding
+///         window of seconds, and every loss burst is correlated with the
+///         overflow counter of the receive queue and the status register.
+///         Memory is allocated per new identifier only (amortized).
+/// \{
+class CSequenceAnalyzer {
+public:
+    static const uint32_t MAX_WINDOW = 3600U;  // sliding window (in [s])
+    static const uint32_t MAX_HISTORY = 64U;  // remembered numbers below the expected
+    struct SEntry {
+        uint32_t m_u32Id;  // CAN identifier
+        bool m_fXtd;  // extended identifier
+        bool m_fSynced;  // first number received
+        uint64_t m_u64Expected;  // next expected number
+        uint64_t m_u64Received;  // received numbers below the expected (bit 0 = expected - 1)
+        uint64_t m_u64Late;  // late numbers below the expected (received after the gap)
+        uint32_t m_u32Second[MAX_HISTORY];  // second of the loss per number (modulo MAX_HISTORY)
+        uint64_t m_u64Frames;  // number of received frames
+        uint64_t m_u64Lost;  // number of missing frames
+        uint64_t m_u64Bursts;  // number of gaps
+        uint64_t m_u64MaxBurst;  // largest gap
+        uint64_t m_u64Duplicates;  // number of duplicated frames
+        uint64_t m_u64Reordered;  // number of late frames
+        uint64_t m_u64Restarts;  // number of counter restarts
+    };
+    struct SBucket {
+        uint64_t m_u64Frames;  // frames and lost frames in one second
+        uint64_t m_u64Lost;
+    };
+private:
+    CCanDriver& m_Driver;
+    const SOptions& m_Options;
+    SEntry* m_StdEntries;  // 11-bit identifier (direct)
+    std::vector<SEntry> m_XtdEntries;  // 29-bit identifier (hashed)
+    stat_idmap_t m_XtdMap;  // identifier to index into m_XtdEntries
+    std::vector<SBucket> m_Window;  // loss over the last seconds
+    uint32_t m_u32Window;
+    // totals
+    uint64_t m_u64Frames;  // received frames
+    uint64_t m_u64Unchecked;  // frames w/o a number (RTR, DLC 0, error frames)
+    uint64_t m_u64Errors;  // errors from the driver
+    uint64_t m_u64Lost;  // lost frames
+    uint64_t m_u64Bursts;  // loss bursts (gaps)
+    uint64_t m_u64BurstsOverflow;  // loss bursts with queue overflow
+    uint64_t m_u64BurstsStatus;  // loss bursts with status flags
+    uint64_t m_u64Overflows;  // queue overflow counter (from the driver)
+    uint64_t m_u64OverflowsStart;  // queue overflow counter at the start
+    uint8_t m_u8Status;  // status flags seen with loss bursts
+    uint8_t m_u8LastStatus;  // last read status register
+    uint64_t m_u64LastStatus;  // time of the last status request (in [ns])
+    uint64_t m_u64Start;  // begin and end of the test (in [ns])
+    uint64_t m_u64Stop;
+public:
+    CSequenceAnalyzer(CCanDriver& driver, const SOptions& opts);
+    virtual ~CSequenceAnalyzer();
+
+    uint64_t Run(volatile int& running);  // run the test (abort with ^C)
+    void Report(FILE* out);  // per CAN identifier with anomalies
+private:
+    int64_t Analyze(const CANAPI_Message_t& message, uint8_t length, uint64_t& second);  // returns the lost frames (-1 = late frame)
+    void Correlate(uint64_t now);
+    void PrintInterval(FILE* out, uint64_t seconds);
+    SEntry* Lookup(uint32_t u32Id);  // 29-bit identifier (inserts)
+    static void Reset(SEntry* entry, uint32_t u32Id, bool fXtd);
+    static bool IsGapClosed(const SEntry* entry, uint64_t diff);
+    static void PrintStatus(FILE* out, uint8_t status);
+};
+/// \}
+
+#endif  // CAN_TEST_SEQUENCE_H_INCLUDED
@@ -21,6 +21,10 @@
 #include "Driver.h"
 #include "Options.h"
 #include "Timer.h"
+#include "Parallel.h"
+#include "Latency.h"
+#include "Profile.h"
+#include "Sequence.h"
 #if (SERIAL_CAN_SUPPORTED != 0)
 #include "SerialCAN_Defines.h"
 #endif
@@ -301,7 +305,27 @@ int main(int argc, const char* argv[]) {
     }
     fprintf(stdout, "OK!\n");
     /* - do your job well: */
-    switch (opts.m_TestMode) {
+    if (opts.m_szParallel) {  /* parallel load test (transmitter and receivers) */
+        CParallelTest parallelTest(opts);
+        if (parallelTest.Open(canDevice)) {
+            (void)parallelTest.Run(running);
+            parallelTest.Report(stdout);
+        }
+        parallelTest.Close();
+    } else if (opts.m_fLatency) {  /* round-trip latency test (ping-pong) */
+        CLatencyTest latencyTest(opts);
+        if (latencyTest.Open(canDevice)) {
+            (void)latencyTest.Run(running);
+            latencyTest.Report(stdout);
+        }
+        latencyTest.Close();
+    } else if (opts.m_szProfile) {  /* traffic profile generator */
+        CProfileTest profileTest(opts);
+        if (profileTest.Load(opts.m_szProfile)) {
+            (void)profileTest.Run(canDevice, running);
+            profileTest.Report(stdout);
+        }
+    } else switch (opts.m_TestMode) {
     case SOptions::TxMODE:   /* transmitter test (duration) */
         (void)canDevice.TransmitterTest(opts.m_nTxTime, opts.m_OpMode, opts.m_nTxCanId, opts.m_nTxCanDlc, opts.m_nTxDelay, opts.m_nStartNumber);
         break;
@@ -313,6 +337,12 @@ int main(int argc, const char* argv[]) {
         break;
     case SOptions::RxMODE:   /* receiver test (abort with Ctrl+C) */
     default:
+        if (opts.m_u32Analyze) {  /* - with sequence analyzer per CAN-ID */
+            CSequenceAnalyzer analyzer(canDevice, opts);
+            (void)analyzer.Run(running);
+            analyzer.Report(stdout);
+            break;
+        }
         (void)canDevice.ReceiverTest(opts.m_fCheckNumber, opts.m_nStartNumber, opts.m_fStopOnError);
         break;
     }
@@ -0,0 +1,563 @@
+//  SPDX-License-Identifier: GPL-3.0-or-later
+//
+//  SLCAN Emulator for CAN-over-Serial-Line Interfaces (Lawicel protocol)
+//
+//  Copyright (c) 2024 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <getopt.h>
+#include <termios.h>
+#include <inttypes.h>
+
+#if defined(__linux__)
+#define PLATFORM  "Linux"
+#elif defined(__APPLE__)
+#define PLATFORM  "macOS"
+#else
+#error Platform not supported
+#endif
+
+#define APPLICATION  "SLCAN Emulator for CAN-over-Serial-Line Interfaces, Version 0.1"
+#define COPYRIGHT    "Copyright (c) 2024 by Uwe Vogt, UV Software, Berlin"
+
+#define HW_VERSION   0x10U              // hardware version (response to 'V')
+#define SW_VERSION   0x13U              // software version (response to 'V')
+#define SERIAL_NO    "0815"             // serial number (response to 'N')
+
+#define CMD_SIZE     64U                // max. length of a command
+#define OUT_SIZE     65536U             // output buffer (device to host)
+#define PENDING_MAX  4096U              // delayed responses (ACK latency)
+#define BURST_MAX    1000U              // max. frames generated at once
+#define POLL_MAX     100                // max. wait time (to see a stop signal) [ms]
+
+#define FLAG_OVERRUN 0x08U              // status flag: data overrun
+
+#define CR           '\r'
+
+typedef enum {                          // traffic profiles:
+    PROFILE_COUNT,                      //   fixed ID, 8 data bytes with a sequence counter
+    PROFILE_RANDOM,                     //   random ID, DLC and data
+    PROFILE_SWEEP                       //   incrementing ID and DLC, sequence counter
+}   profile_t;
+
+typedef struct {                        // delayed response:
+    uint64_t due;                       //   time of delivery (in [ns])
+    size_t length;                      //   length of the response
+    char data[CMD_SIZE];                //   response string
+}   pending_t;
+
+static struct {                         // command line options:
+    const char *link;                   //   symbolic link to the pty slave
+    uint32_t rate;                      //   frames per second (0 = off)
+    uint64_t count;                     //   number of frames (0 = infinite)
+    profile_t profile;                  //   traffic profile
+    uint32_t can_id;                    //   CAN identifier (PROFILE_COUNT/SWEEP)
+    bool xtd;                           //   extended identifier (29-bit)
+    uint32_t delay;                     //   ACK latency (in [us])
+    uint32_t nak;                       //   NAK rate (in [%])
+    bool echo;                          //   loop back transmitted frames
+    bool verbose;                       //   print commands
+}   opts = { NULL, 0U, 0U, PROFILE_COUNT, 0x100U, false, 0U, 0U, false, false };
+
+static struct {                         // emulated CAN channel:
+    bool open;                          //   channel open ('O' or 'L')
+    bool listen_only;                   //   listen-only mode ('L')
+    bool timestamp;                     //   time-stamps on ('Z1')
+    uint8_t flags;                      //   status flags ('F')
+    int bitrate;                        //   bit-rate index ('S'), -1 = BTR0BTR1 ('s')
+}   channel = { false, false, false, 0x00U, 4 };
+
+static struct {                         // statistics:
+    uint64_t commands;                  //   commands received
+    uint64_t transmitted;               //   frames received from the host
+    uint64_t generated;                 //   frames generated (traffic profile)
+    uint64_t echoed;                    //   frames looped back
+    uint64_t naks;                      //   negative acknowledgements
+    uint64_t dropped;                   //   frames dropped (output buffer full)
+}   stats = { 0U, 0U, 0U, 0U, 0U, 0U };
+
+static int master = -1;                 // pty master (our end)
+static int slave = -1;                  // pty slave (kept open, no hang-up w/o client)
+
+static char out_buf[OUT_SIZE];          // output buffer (device to host)
+static size_t out_len = 0U;
+
+static pending_t pending[PENDING_MAX];  // delayed responses (FIFO)
+static size_t pending_head = 0U;
+static size_t pending_used = 0U;
+
+static volatile int running = 1;
+static uint64_t t_start = 0U;
+static uint32_t seed = 0x2545F491U;
+
+static void sigterm(int signo);
+static void usage(FILE *stream, const char *program);
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t random32(void) {
+    // xorshift32 (reproducible, no libc state)
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+static int hex2int(char c) {
+    if ((c >= '0') && (c <= '9')) return c - '0';
+    if ((c >= 'A') && (c <= 'F')) return c - 'A' + 10;
+    if ((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+    return -1;
+}
+
+static bool parse_hex(const char *str, size_t digits, uint32_t *value) {
+    *value = 0U;
+    for (size_t i = 0U; i < digits; i++) {
+        int digit = hex2int(str[i]);
+        if (digit < 0)
+            return false;
+        *value = (*value << 4) | (uint32_t)digit;
+    }
+    return true;
+}
+
+static void flush_output(void) {
+    while (out_len > 0U) {
+        ssize_t n = write(master, out_buf, out_len);
+        if (n > 0) {
+            memmove(out_buf, &out_buf[n], out_len - (size_t)n);
+            out_len -= (size_t)n;
+        } else if ((n < 0) && (errno == EINTR)) {
+            continue;
+        } else {
+            break;  // EAGAIN: the host is not reading, retry on POLLOUT
+        }
+    }
+}
+
+static bool emit(const char *data, size_t length) {
+    // note: a frame is either buffered completely or dropped (like a FIFO overrun)
+    if ((out_len + length) > OUT_SIZE) {
+        channel.flags |= FLAG_OVERRUN;
+        stats.dropped++;
+        return false;
+    }
+    memcpy(&out_buf[out_len], data, length);
+    out_len += length;
+    return true;
+}
+
+static void respond(const char *data, size_t length, bool delayed) {
+    // note: responses are delivered in order, hence all go through the FIFO when delayed
+    if ((!delayed || !opts.delay) && !pending_used) {
+        (void)emit(data, length);
+        return;
+    }
+    if ((pending_used >= PENDING_MAX) || (length > CMD_SIZE)) {
+        channel.flags |= FLAG_OVERRUN;
+        stats.dropped++;
+        return;
+    }
+    pending_t *entry = &pending[(pending_head + pending_used) % PENDING_MAX];
+    entry->due = now_ns() + (delayed ? (uint64_t)opts.delay * 1000U : 0U);
+    entry->length = length;
+    memcpy(entry->data, data, length);
+    pending_used++;
+}
+
+static uint64_t deliver_pending(uint64_t now) {
+    while (pending_used) {
+        pending_t *entry = &pending[pending_head];
+        if (entry->due > now)
+            return entry->due;
+        (void)emit(entry->data, entry->length);
+        pending_head = (pending_head + 1U) % PENDING_MAX;
+        pending_used--;
+    }
+    return UINT64_MAX;
+}
+
+static size_t format_frame(char *buffer, uint32_t can_id, bool xtd, bool rtr, uint8_t dlc, const uint8_t *data) {
+    size_t n;
+    if (xtd)
+        n = (size_t)sprintf(buffer, "%c%08" PRIX32 "%u", rtr ? 'R' : 'T', can_id & 0x1FFFFFFFU, (unsigned)dlc);
+    else
+        n = (size_t)sprintf(buffer, "%c%03" PRIX32 "%u", rtr ? 'r' : 't', can_id & 0x7FFU, (unsigned)dlc);
+    if (!rtr) {
+        for (uint8_t i = 0U; i < dlc; i++)
+            n += (size_t)sprintf(&buffer[n], "%02X", data[i]);
+    }
+    if (channel.timestamp)
+        n += (size_t)sprintf(&buffer[n], "%04X", (unsigned)(((now_ns() - t_start) / 1000000U) % 60000U));
+    buffer[n++] = CR;
+    return n;
+}
+
+static void generate_frame(void) {
+    uint8_t data[8] = { 0 };
+    uint32_t can_id = opts.can_id;
+    uint8_t dlc = 8U;
+    uint64_t counter = stats.generated;
+    char buffer[CMD_SIZE];
+
+    switch (opts.profile) {
+    case PROFILE_RANDOM:
+        can_id = random32() & (opts.xtd ? 0x1FFFFFFFU : 0x7FFU);
+        dlc = (uint8_t)(random32() % 9U);
+        for (uint8_t i = 0U; i < dlc; i++)
+            data[i] = (uint8_t)random32();
+        break;
+    case PROFILE_SWEEP:
+        can_id = (opts.can_id + (uint32_t)counter) & (opts.xtd ? 0x1FFFFFFFU : 0x7FFU);
+        dlc = (uint8_t)(counter % 9U);
+        /* fall through */
+    default:
+        // note: sequence counter in little-endian byte order
+        for (uint8_t i = 0U; i < 8U; i++)
+            data[i] = (uint8_t)(counter >> (8U * i));
+        break;
+    }
+    // note: dropped frames are counted too, so the host sees a gap in the sequence
+    (void)emit(buffer, format_frame(buffer, can_id, opts.xtd, false, dlc, data));
+    stats.generated++;
+}
+
+static void transmit_frame(const char *cmd, size_t length) {
+    bool xtd = (cmd[0] == 'T') || (cmd[0] == 'R');
+    bool rtr = (cmd[0] == 'r') || (cmd[0] == 'R');
+    size_t digits = xtd ? 8U : 3U;
+    uint32_t can_id, dlc, value;
+    uint8_t data[8] = { 0 };
+    char buffer[CMD_SIZE];
+
+    // (1) syntax check: identifier, DLC and data bytes
+    if ((length < (digits + 2U)) || !parse_hex(&cmd[1], digits, &can_id) ||
+        (can_id > (xtd ? 0x1FFFFFFFU : 0x7FFU)) ||
+        !parse_hex(&cmd[1 + digits], 1U, &dlc) || (dlc > 8U) ||
+        (length != (digits + 2U + (rtr ? 0U : (size_t)dlc * 2U)))) {
+        respond("\a", 1U, false);
+        return;
+    }
+    for (uint32_t i = 0U; !rtr && (i < dlc); i++) {
+        if (!parse_hex(&cmd[digits + 2U + (i * 2U)], 2U, &value)) {
+            respond("\a", 1U, false);
+            return;
+        }
+        data[i] = (uint8_t)value;
+    }
+    // (2) channel state and simulated NAK (e.g. no other node acknowledges)
+    if (!channel.open || channel.listen_only ||
+        (opts.nak && ((random32() % 100U) < opts.nak))) {
+        stats.naks++;
+        respond("\a", 1U, true);
+        return;
+    }
+    stats.transmitted++;
+    respond(xtd ? "Z\r" : "z\r", 2U, true);
+    // (3) loop back the transmitted frame (after its confirmation)
+    if (opts.echo) {
+        respond(buffer, format_frame(buffer, can_id, xtd, rtr, (uint8_t)dlc, data), true);
+        stats.echoed++;
+    }
+}
+
+static void execute(const char *cmd, size_t length) {
+    char buffer[CMD_SIZE];
+    uint32_t value;
+
+    stats.commands++;
+    if (opts.verbose)
+        fprintf(stderr, "<<< %.*s\n", (int)length, cmd);
+    if (length == 0U) {
+        respond("\r", 1U, false);
+        return;
+    }
+    switch (cmd[0]) {
+    case 'S':  // setup with standard CAN bit-rates
+        if (channel.open || (length != 2U) || (cmd[1] < '0') || (cmd[1] > '8'))
+            break;
+        channel.bitrate = cmd[1] - '0';
+        respond("\r", 1U, false);
+        return;
+    case 's':  // setup with BTR0/BTR1 CAN bit-rates
+        if (channel.open || (length != 5U) || !parse_hex(&cmd[1], 4U, &value))
+            break;
+        channel.bitrate = -1;
+        respond("\r", 1U, false);
+        return;
+    case 'O':  // open the CAN channel
+    case 'L':  // open the CAN channel in listen-only mode
+        if (channel.open || (length != 1U))
+            break;
+        channel.open = true;
+        channel.listen_only = (cmd[0] == 'L');
+        channel.flags = 0x00U;
+        respond("\r", 1U, false);
+        return;
+    case 'C':  // close the CAN channel
+        // note: lenient, a closed channel can be closed again
+        channel.open = false;
+        channel.listen_only = false;
+        respond("\r", 1U, false);
+        return;
+    case 't':  // transmit a standard frame
+    case 'T':  // transmit an extended frame
+    case 'r':  // transmit a standard remote frame
+    case 'R':  // transmit an extended remote frame
+        transmit_frame(cmd, length);
+        return;
+    case 'F':  // read status flags (cleared by reading)
+        if (!channel.open || (length != 1U))
+            break;
+        respond(buffer, (size_t)sprintf(buffer, "F%02X\r", channel.flags), false);
+        channel.flags = 0x00U;
+        return;
+    case 'M':  // acceptance code register
+    case 'm':  // acceptance mask register
+        if (channel.open || (length != 9U) || !parse_hex(&cmd[1], 8U, &value))
+            break;
+        respond("\r", 1U, false);
+        return;
+    case 'V':  // hardware and software version
+        respond(buffer, (size_t)sprintf(buffer, "V%02X%02X\r", HW_VERSION, SW_VERSION), false);
+        return;
+    case 'N':  // serial number
+        respond(buffer, (size_t)sprintf(buffer, "N%s\r", SERIAL_NO), false);
+        return;
+    case 'Z':  // time-stamps on/off
+        if (channel.open || (length != 2U) || ((cmd[1] != '0') && (cmd[1] != '1')))
+            break;
+        channel.timestamp = (cmd[1] == '1');
+        respond("\r", 1U, false);
+        return;
+    default:
+        break;
+    }
+    respond("\a", 1U, false);
+}
+
+int main(int argc, const char *argv[]) {
+    char command[CMD_SIZE];
+    size_t index = 0U;
+    uint64_t next_frame = 0U;
+    int opt;
+
+    struct option long_options[] = {
+        {"link", required_argument, 0, 'l'},
+        {"rate", required_argument, 0, 'r'},
+        {"count", required_argument, 0, 'n'},
+        {"profile", required_argument, 0, 'p'},
+        {"id", required_argument, 0, 'i'},
+        {"extended", no_argument, 0, 'x'},
+        {"delay", required_argument, 0, 'd'},
+        {"nak", required_argument, 0, 'k'},
+        {"echo", no_argument, 0, 'e'},
+        {"seed", required_argument, 0, 's'},
+        {"verbose", no_argument, 0, 'v'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+    while ((opt = getopt_long(argc, (char * const *)argv, "l:r:n:p:i:xd:k:es:vh", long_options, NULL)) != -1) {
+        switch (opt) {
+        case 'l': opts.link = optarg; break;
+        case 'r': opts.rate = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'n': opts.count = (uint64_t)strtoull(optarg, NULL, 0); break;
+        case 'i': opts.can_id = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'x': opts.xtd = true; break;
+        case 'd': opts.delay = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'k': opts.nak = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'e': opts.echo = true; break;
+        case 's': seed = (uint32_t)strtoul(optarg, NULL, 0) | 1U; break;
+        case 'v': opts.verbose = true; break;
+        case 'p':
+            if (!strcasecmp(optarg, "COUNT"))
+                opts.profile = PROFILE_COUNT;
+            else if (!strcasecmp(optarg, "RANDOM"))
+                opts.profile = PROFILE_RANDOM;
+            else if (!strcasecmp(optarg, "SWEEP"))
+                opts.profile = PROFILE_SWEEP;
+            else {
+                fprintf(stderr, "+++ error: illegal traffic profile '%s'\n", optarg);
+                return 1;
+            }
+            break;
+        case 'h':
+            usage(stdout, argv[0]);
+            return 0;
+        default:
+            usage(stderr, argv[0]);
+            return 1;
+        }
+    }
+    if ((optind < argc) || (opts.nak > 100U) ||
+        (opts.can_id > (opts.xtd ? 0x1FFFFFFFU : 0x7FFU))) {
+        usage(stderr, argv[0]);
+        return 1;
+    }
+    // create the pty pair: the host connects to the slave side
+    if (((master = posix_openpt(O_RDWR | O_NOCTTY)) < 0) ||
+        (grantpt(master) < 0) || (unlockpt(master) < 0)) {
+        perror("+++ error: posix_openpt");
+        return 1;
+    }
+    const char *name = ptsname(master);
+    if (!name || ((slave = open(name, O_RDWR | O_NOCTTY)) < 0)) {
+        perror("+++ error: ptsname");
+        return 1;
+    }
+    struct termios attr;
+    if (tcgetattr(slave, &attr) == 0) {
+        cfmakeraw(&attr);
+        (void)tcsetattr(slave, TCSANOW, &attr);
+    }
+    (void)fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    if (opts.link) {
+        (void)unlink(opts.link);
+        if (symlink(name, opts.link) < 0) {
+            perror("+++ error: symlink");
+            return 1;
+        }
+    }
+    if ((signal(SIGINT, sigterm) == SIG_ERR) ||
+        (signal(SIGTERM, sigterm) == SIG_ERR)) {
+        perror("+++ error");
+        return 1;
+    }
+    fprintf(stderr, "%s (%s)\n%s\n\n", APPLICATION, PLATFORM, COPYRIGHT);
+    // note: the pty name on stdout (e.g. for scripts)
+    fprintf(stdout, "%s\n", opts.link ? opts.link : name);
+    fflush(stdout);
+
+    t_start = now_ns();
+    while (running) {
+        uint64_t now = now_ns();
+        uint64_t wakeup = deliver_pending(now);
+
+        // traffic generator (only when the channel is open)
+        if (channel.open && opts.rate && (!opts.count || (stats.generated < opts.count))) {
+            uint64_t period = 1000000000U / opts.rate;
+            uint32_t burst = 0U;
+            if (!next_frame)
+                next_frame = now;
+            while ((next_frame <= now) && (burst++ < BURST_MAX) &&
+                   (!opts.count || (stats.generated < opts.count))) {
+                generate_frame();
+                next_frame += period ? period : 1U;
+            }
+            if (next_frame < now)  // note: cannot keep up, do not catch up later
+                next_frame = now;
+            if (next_frame < wakeup)
+                wakeup = next_frame;
+        } else {
+            next_frame = 0U;
+        }
+        flush_output();
+
+        // wait for commands, output space or the next event
+        struct pollfd fds;
+        fds.fd = master;
+        fds.events = POLLIN | ((out_len > 0U) ? POLLOUT : 0);
+        fds.revents = 0;
+        // note: a signal between the check of 'running' and poll() is not
+        //       seen by poll(), so the wait time is limited
+        int timeout = POLL_MAX;
+        if (wakeup != UINT64_MAX) {
+            now = now_ns();
+            timeout = (wakeup > now) ? (int)((wakeup - now + 999999U) / 1000000U) : 0;
+            if (timeout > POLL_MAX)
+                timeout = POLL_MAX;
+        }
+        if (poll(&fds, 1, timeout) < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("+++ error: poll");
+            break;
+        }
+        if (fds.revents & POLLIN) {
+            char buffer[1024];
+            ssize_t n = read(master, buffer, sizeof(buffer));
+            for (ssize_t i = 0; i < n; i++) {
+                if (buffer[i] == CR) {
+                    execute(command, index);
+                    index = 0U;
+                } else if (buffer[i] == '\n') {
+                    continue;
+                } else if (index < CMD_SIZE) {
+                    command[index++] = buffer[i];
+                }
+            }
+        }
+    }
+    if (opts.link)
+        (void)unlink(opts.link);
+    close(slave);
+    close(master);
+
+    fprintf(stderr, "\n");
+    fprintf(stderr, "Commands received:   %" PRIu64 "\n", stats.commands);
+    fprintf(stderr, "Frames transmitted:  %" PRIu64 " (by the host)\n", stats.transmitted);
+    fprintf(stderr, "Frames looped back:  %" PRIu64 "\n", stats.echoed);
+    fprintf(stderr, "Frames generated:    %" PRIu64 "\n", stats.generated);
+    fprintf(stderr, "Frames dropped:      %" PRIu64 " (output buffer full)\n", stats.dropped);
+    fprintf(stderr, "NAKs:                %" PRIu64 "\n", stats.naks);
+    return 0;
+}
+
+static void sigterm(int signo) {
+    (void)signo;
+    running = 0;
+}
+
+static void usage(FILE *stream, const char *program) {
+    fprintf(stream, "%s (%s)\n%s\n\n", APPLICATION, PLATFORM, COPYRIGHT);
+    fprintf(stream, "Usage: %s [<option>...]\n", strrchr(program, '/') ? strrchr(program, '/') + 1 : program);
+    fprintf(stream, "Options:\n");
+    fprintf(stream, " -l, --link=<path>                    create a symbolic link to the pty slave\n");
+    fprintf(stream, " -r, --rate=<frames/s>                generate traffic when the channel is open (default=0)\n");
+    fprintf(stream, " -n, --count=<number>                 stop generating after <number> frames (default=infinite)\n");
+    fprintf(stream, " -p, --profile=(COUNT|RANDOM|SWEEP)   traffic profile (default=COUNT):\n");
+    fprintf(stream, "                                      COUNT  - fixed ID, 8 bytes sequence counter (little-endian)\n");
+    fprintf(stream, "                                      RANDOM - random ID, DLC and data\n");
+    fprintf(stream, "                                      SWEEP  - incrementing ID and DLC, sequence counter\n");
+    fprintf(stream, " -i, --id=<id>                        CAN identifier for COUNT and SWEEP (default=0x100)\n");
+    fprintf(stream, " -x, --extended                       generate extended frames (29-bit identifier)\n");
+    fprintf(stream, " -d, --delay=<us>                     ACK latency for transmitted frames (default=0)\n");
+    fprintf(stream, " -k, --nak=<percent>                  NAK rate for transmitted frames (default=0)\n");
+    fprintf(stream, " -e, --echo                           loop back transmitted frames\n");
+    fprintf(stream, " -s, --seed=<number>                  seed for the RANDOM profile and NAKs\n");
+    fprintf(stream, " -v, --verbose                        print received commands\n");
+    fprintf(stream, " -h, --help                           display this help screen and exit\n");
+    fprintf(stream, "Commands:\n");
+    fprintf(stream, "  S<n> s<xxyy> O L C t T r R F M<xxxxxxxx> m<xxxxxxxx> V N Z<n>\n");
+}